@@ -0,0 +1,115 @@
+// ============================================================
+//  AllocTracker.cpp — Heap allocation tracking (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Counters are thread_local, so the tuning watcher thread (which
+//  does allocate, on purpose) never shows up in the tick's numbers.
+//  They are plain integers: no constructor, so they are safe to
+//  touch from operator new before anything else is initialised.
+//
+//  The replacements forward to malloc/free. operator delete can't
+//  know the size of an unsized free, so only allocation bytes are
+//  tracked.
+// ============================================================
+
+#include "AllocTracker.h"
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+#if defined(COMPANION_TRACK_ALLOCS)
+static thread_local uint64_t t_allocations = 0;
+static thread_local uint64_t t_frees = 0;
+static thread_local uint64_t t_bytes = 0;
+#endif
+
+static AllocTracker::ViolationHandler g_violationHandler = nullptr;
+static void* g_violationUser = nullptr;
+
+namespace AllocTracker
+{
+    AllocCounts ThisThread()
+    {
+        AllocCounts c;
+#if defined(COMPANION_TRACK_ALLOCS)
+        c.allocations = t_allocations;
+        c.frees = t_frees;
+        c.bytes = t_bytes;
+#endif
+        return c;
+    }
+
+    void SetViolationHandler(ViolationHandler handler, void* user)
+    {
+        g_violationHandler = handler;
+        g_violationUser = user;
+    }
+}
+
+uint64_t AllocScope::End(bool mustBeZero)
+{
+    AllocTracker::AllocCounts now = AllocTracker::ThisThread();
+    m_last = now.allocations - m_start.allocations;
+    m_total += m_last;
+
+    if (mustBeZero && m_last > 0)
+    {
+        m_violations++;
+        uint64_t bytes = now.bytes - m_start.bytes;
+
+        if (g_violationHandler != nullptr)
+            g_violationHandler(m_name, m_last, bytes, g_violationUser);
+        else
+            assert(!"heap allocation inside a no-allocation scope");
+    }
+
+    return m_last;
+}
+
+// --------------------------------------------------------
+//  Global operator new / delete (tracking builds only)
+// --------------------------------------------------------
+#if defined(COMPANION_TRACK_ALLOCS)
+
+static void* TrackedAlloc(std::size_t size)
+{
+    t_allocations++;
+    t_bytes += size;
+    return std::malloc(size ? size : 1);
+}
+
+static void TrackedFree(void* p)
+{
+    if (p == nullptr)
+        return;
+    t_frees++;
+    std::free(p);
+}
+
+void* operator new(std::size_t size)
+{
+    if (void* p = TrackedAlloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if (void* p = TrackedAlloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return TrackedAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return TrackedAlloc(size); }
+
+void operator delete(void* p) noexcept { TrackedFree(p); }
+void operator delete[](void* p) noexcept { TrackedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { TrackedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { TrackedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { TrackedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { TrackedFree(p); }
+
+#endif
@@ -0,0 +1,91 @@
+// ============================================================
+//  AllocTracker.h — Heap allocation tracking for the tick loop
+// ============================================================
+//
+//  PURPOSE:
+//  The tick loop is allocation-free today (fixed arrays, rings,
+//  statics), and it has to stay that way: a heap allocation on
+//  the script fiber can take a lock the game's own threads are
+//  holding. This makes the rule checkable instead of a habit.
+//
+//  With COMPANION_TRACK_ALLOCS defined (Debug builds, the bench),
+//  AllocTracker.cpp replaces the global operator new / delete and
+//  counts allocations per thread. main.cpp wraps each tick in an
+//  AllocScope that must end with zero allocations; a violation is
+//  reported through the handler (logged in game) — or asserts if
+//  no handler is set.
+//
+//  Without the define nothing is replaced, every count reads 0
+//  and AllocScope compiles down to nothing that matters.
+//
+//  Scratch memory for new subsystems: FrameArena.h, not new.
+//
+//  Not counted: the over-aligned (std::align_val_t) operators,
+//  which nothing in this mod uses.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+
+namespace AllocTracker
+{
+#if defined(COMPANION_TRACK_ALLOCS)
+    static constexpr bool kEnabled = true;
+#else
+    static constexpr bool kEnabled = false;
+#endif
+
+    struct AllocCounts
+    {
+        uint64_t allocations = 0;
+        uint64_t frees = 0;
+        uint64_t bytes = 0;          // requested bytes, allocations only
+    };
+
+    // Totals for the calling thread since it started
+    AllocCounts ThisThread();
+
+    // Called when a must-be-zero scope saw allocations
+    using ViolationHandler = void (*)(const char* scope, uint64_t allocations, uint64_t bytes, void* user);
+    void SetViolationHandler(ViolationHandler handler, void* user);
+}
+
+// Measures allocations between Begin() and End() on this thread
+class AllocScope
+{
+public:
+    explicit AllocScope(const char* name) : m_name(name) {}
+
+    void Begin() { m_start = AllocTracker::ThisThread(); }
+
+    // Returns the allocations since Begin(). With mustBeZero, any
+    // allocation is a violation (handler / assert).
+    uint64_t End(bool mustBeZero);
+
+    const char* Name() const { return m_name; }
+    uint64_t Last() const { return m_last; }
+    uint64_t Total() const { return m_total; }
+    uint32_t Violations() const { return m_violations; }
+
+private:
+    const char* m_name;
+    AllocTracker::AllocCounts m_start{};
+    uint64_t m_last = 0;
+    uint64_t m_total = 0;
+    uint32_t m_violations = 0;
+};
+
+// A block that must not allocate:
+//     { NoAllocGuard guard(scope); ... }
+class NoAllocGuard
+{
+public:
+    explicit NoAllocGuard(AllocScope& scope) : m_scope(scope) { m_scope.Begin(); }
+    ~NoAllocGuard() { m_scope.End(true); }
+
+    NoAllocGuard(const NoAllocGuard&) = delete;
+    NoAllocGuard& operator=(const NoAllocGuard&) = delete;
+
+private:
+    AllocScope& m_scope;
+};
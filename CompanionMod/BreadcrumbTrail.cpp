@@ -0,0 +1,337 @@
+// ============================================================
+//  BreadcrumbTrail.cpp — Recent player path for catch-up (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  The ring only wraps once it is full: until then crumbs sit in
+//  slots 0..count-1 (m_first stays 0), so NearestK can always be
+//  handed the first m_count entries of the arrays. Slot order and
+//  age order differ once it wraps; ids translate between them.
+//
+//  Collinear test ("sleeve" / cone intersection): a point p at
+//  horizontal distance d from the run's start A stays within tol
+//  of a line from A whose heading is within asin(tol / d) of p's
+//  own heading. The run keeps the intersection of those intervals
+//  over all its points (and the same for grade, tol / d); a new
+//  point can be merged if its heading and grade are inside. That
+//  bounds every point the crumb replaced, not just the last one,
+//  so a slow curve can't be merged away step by step. A point no
+//  further from A than the crumb (walking back) never merges.
+// ============================================================
+
+#include "BreadcrumbTrail.h"
+#include "GeometryKernels.h"
+#include <cmath>
+
+static float WrapAngle(float a)
+{
+    while (a > 3.14159265f) a -= 6.2831853f;
+    while (a < -3.14159265f) a += 6.2831853f;
+    return a;
+}
+
+// Squared distance from p to the segment a -> b
+static float DistSqToLeg(const Vec3& p, const Vec3& a, const Vec3& b)
+{
+    float lx = b.x - a.x, ly = b.y - a.y, lz = b.z - a.z;
+    float lenSq = lx * lx + ly * ly + lz * lz;
+    float t = 0.0f;
+    if (lenSq > 1e-6f)
+    {
+        t = ((p.x - a.x) * lx + (p.y - a.y) * ly + (p.z - a.z) * lz) / lenSq;
+        t = (t < 0.0f) ? 0.0f : (t > 1.0f) ? 1.0f : t;
+    }
+    Vec3 q{ a.x + lx * t, a.y + ly * t, a.z + lz * t };
+    return Geometry::DistSq(p, q);
+}
+
+bool BreadcrumbTrail::Offer(const Vec3& pos)
+{
+    if (m_hasOffered && Geometry::DistSq(pos, m_lastOffered) > config.breakJump * config.breakJump)
+    {
+        if (m_count > 0)
+            m_stats.breaks++;
+        Clear();
+    }
+    m_lastOffered = pos;
+    m_hasOffered = true;
+
+    if (m_count == 0)
+    {
+        Append(pos);
+        return true;
+    }
+
+    const uint32_t newest = NewestId();
+    Vec3 b = Crumb(newest);
+    if (Geometry::DistSq(pos, b) < config.spacing * config.spacing)
+        return false;
+
+    if (m_count >= 2)
+    {
+        Vec3 a = Crumb(newest - 1);
+        float dx = pos.x - a.x, dy = pos.y - a.y;
+        float run = sqrtf(dx * dx + dy * dy);
+
+        if (run > m_runLength && run <= config.maxMergedLength)
+        {
+            float heading = WrapAngle(atan2f(dy, dx) - m_runHeading);
+            float grade = (pos.z - a.z) / run;
+
+            if (heading >= m_coneLo && heading <= m_coneHi && grade >= m_gradeLo && grade <= m_gradeHi)
+            {
+                NarrowRun(a, pos, false);
+
+                uint32_t slot = Slot(newest);
+                m_x[slot] = pos.x;
+                m_y[slot] = pos.y;
+                m_z[slot] = pos.z;
+                m_stats.merged++;
+                return true;
+            }
+        }
+    }
+
+    Append(pos);
+    return true;
+}
+
+void BreadcrumbTrail::Append(const Vec3& pos)
+{
+    uint32_t slot;
+    if (m_count < kCapacity)
+    {
+        slot = (m_first + m_count) % kCapacity;
+        m_count++;
+    }
+    else
+    {
+        // Full: the oldest crumb's slot becomes the newest
+        slot = m_first;
+        m_first = (m_first + 1) % kCapacity;
+    }
+
+    m_x[slot] = pos.x;
+    m_y[slot] = pos.y;
+    m_z[slot] = pos.z;
+    m_nextId++;
+    m_stats.stored++;
+
+    // New run: the crumb before this one to this one
+    if (m_count >= 2)
+        NarrowRun(Crumb(NewestId() - 1), pos, true);
+}
+
+void BreadcrumbTrail::NarrowRun(const Vec3& from, const Vec3& to, bool first)
+{
+    float dx = to.x - from.x, dy = to.y - from.y;
+    float run = sqrtf(dx * dx + dy * dy);
+    if (run < 1e-3f)
+        run = 1e-3f;
+
+    float slack = config.collinearTolerance / run;
+    float half = (slack < 1.0f) ? asinf(slack) : 1.5707963f;
+    float grade = (to.z - from.z) / run;
+
+    if (first)
+    {
+        m_runHeading = atan2f(dy, dx);
+        m_coneLo = -half;
+        m_coneHi = half;
+        m_gradeLo = grade - slack;
+        m_gradeHi = grade + slack;
+    }
+    else
+    {
+        float heading = WrapAngle(atan2f(dy, dx) - m_runHeading);
+        if (heading - half > m_coneLo) m_coneLo = heading - half;
+        if (heading + half < m_coneHi) m_coneHi = heading + half;
+        if (grade - slack > m_gradeLo) m_gradeLo = grade - slack;
+        if (grade + slack < m_gradeHi) m_gradeHi = grade + slack;
+    }
+    m_runLength = run;
+}
+
+void BreadcrumbTrail::Clear()
+{
+    // Ids keep counting, so old cursors can never match a new trail
+    m_first = 0;
+    m_count = 0;
+}
+
+Vec3 BreadcrumbTrail::Crumb(uint32_t id) const
+{
+    uint32_t slot = Slot(id);
+    return Vec3{ m_x[slot], m_y[slot], m_z[slot] };
+}
+
+bool BreadcrumbTrail::Nearest(const Vec3& pos, float maxDist, uint32_t& outId, float& outDistSq) const
+{
+    if (m_count == 0)
+        return false;
+
+    PositionsSoA pts;
+    pts.x = m_x;
+    pts.y = m_y;
+    pts.z = m_z;
+    pts.count = m_count;
+
+    uint32_t slot = 0;
+    if (Geometry::NearestK(pos, pts, 1, maxDist, &slot, &outDistSq) == 0)
+        return false;
+
+    outId = OldestId() + (slot + kCapacity - m_first) % kCapacity;
+    return true;
+}
+
+bool BreadcrumbTrail::Track(TrailCursor& cursor, const Vec3& pos, float reach, float maxDist)
+{
+    m_stats.tracks++;
+
+    // Still on the leg into the cursor's crumb? (Merged crumbs are
+    // up to maxMergedLength apart, so distance to the crumb alone
+    // would call a companion halfway along a straight lost.)
+    bool search = !cursor.valid || !Contains(cursor.id);
+    if (!search)
+    {
+        Vec3 to = Crumb(cursor.id);
+        Vec3 from = Contains(cursor.id - 1) ? Crumb(cursor.id - 1) : to;
+        search = DistSqToLeg(pos, from, to) > maxDist * maxDist;
+    }
+
+    if (search)
+    {
+        m_stats.fullSearches++;
+        float distSq = 0.0f;
+        cursor.valid = Nearest(pos, maxDist, cursor.id, distSq);
+        if (!cursor.valid)
+            return false;
+    }
+
+    const float reachSq = reach * reach;
+    while (cursor.id != NewestId())
+    {
+        Vec3 cur = Crumb(cursor.id);
+        Vec3 next = Crumb(cursor.id + 1);
+
+        bool reached = Geometry::DistSq(pos, cur) <= reachSq;
+
+        // Beyond cur, standing on the leg cur -> next (cut the corner)
+        float lx = next.x - cur.x, ly = next.y - cur.y;
+        bool beyond = (pos.x - cur.x) * lx + (pos.y - cur.y) * ly > 0.0f
+            && DistSqToLeg(pos, cur, next) <= reachSq;
+
+        if (!reached && !beyond)
+            break;
+        cursor.id++;
+    }
+    return true;
+}
+
+uint32_t BreadcrumbTrail::Route(uint32_t fromId, Vec3* out, uint32_t max) const
+{
+    if (m_count == 0)
+        return 0;
+    if (!Contains(fromId))
+    {
+        if ((int32_t)(fromId - OldestId()) > 0)
+            return 0;               // past the newest crumb
+        fromId = OldestId();        // overwritten: start at the oldest
+    }
+
+    uint32_t n = 0;
+    for (uint32_t id = fromId; n < max && Contains(id); ++id)
+        out[n++] = Crumb(id);
+    return n;
+}
+
+// --------------------------------------------------------
+//  TrailFollow
+// --------------------------------------------------------
+TrailPlan TrailFollow::Plan(TrailFollowState& s, BreadcrumbTrail& trail, const Vec3& companionPos,
+    const Vec3& playerPos, bool sampled, uint32_t tick)
+{
+    const bool wasOnTrail = s.onTrail;
+
+    if (sampled)
+    {
+        float gap = sqrtf(Geometry::DistSq(companionPos, playerPos));
+
+        if (!s.onTrail)
+        {
+            if (gap <= config.startMeters)
+            {
+                trail.Anchor(s.cursor);
+                s.watching = false;
+            }
+            else if (Stalled(s, playerPos, companionPos, tick, config.stallMeters))
+            {
+                s.onTrail = trail.Track(s.cursor, companionPos, config.reachMeters, config.maxOffMeters);
+                if (s.onTrail)
+                    m_stats.engaged++;
+            }
+        }
+        else if (gap < config.stopMeters)
+        {
+            s.onTrail = false;
+        }
+        else
+        {
+            uint32_t before = s.cursor.id;
+            s.onTrail = trail.Track(s.cursor, companionPos, config.reachMeters, config.maxOffMeters);
+
+            if (s.onTrail && s.cursor.id != before)
+            {
+                s.watching = false;
+            }
+            else if (s.onTrail && Stalled(s, trail.Crumb(s.cursor.id), companionPos, tick, config.routeStallMeters)
+                && trail.Contains(s.cursor.id - 1))
+            {
+                s.cursor.id--;
+                s.backedUp = true;
+                m_stats.backUps++;
+            }
+        }
+
+        if (s.onTrail != wasOnTrail)
+            s.watching = false;
+    }
+
+    TrailPlan plan;
+    plan.onTrail = s.onTrail;
+    plan.changed = s.onTrail != wasOnTrail;
+
+    if (s.onTrail)
+    {
+        // The trail grows at the player's end: a new route once the
+        // companion is part way along the last one, or at its end
+        // with newer crumbs laid since
+        bool advanced = (int32_t)(s.cursor.id - s.routeFrom) >= (int32_t)config.reissueCrumbs
+            || ((int32_t)(s.cursor.id - s.routeLast) >= 0 && trail.NewestId() != s.routeLast);
+        bool stale = (tick - s.issuedTick) > config.reissueTicks;
+        plan.issueRoute = !wasOnTrail || s.backedUp || advanced || stale;
+    }
+    return plan;
+}
+
+// Progress windows: the first call opens one (distance to target
+// now), the first call stallTicks later closes it and says
+// whether the companion got at least minMeters closer.
+bool TrailFollow::Stalled(TrailFollowState& s, const Vec3& target, const Vec3& pos, uint32_t tick, float minMeters) const
+{
+    if (!s.watching)
+    {
+        s.watching = true;
+        s.watchTarget = target;
+        s.watchDist = sqrtf(Geometry::DistSq(pos, target));
+        s.watchTick = tick;
+        return false;
+    }
+    if (tick - s.watchTick < config.stallTicks)
+        return false;
+
+    s.watching = false;
+    float progress = s.watchDist - sqrtf(Geometry::DistSq(pos, s.watchTarget));
+    return progress < minMeters;
+}
@@ -0,0 +1,243 @@
+// ============================================================
+//  BreadcrumbTrail.h — Recent player path for catch-up
+// ============================================================
+//
+//  PURPOSE:
+//  A companion that fell behind is told to follow the player, and
+//  the game paths it straight at where the player is now. Around
+//  a building, through a door or over a footbridge that path
+//  doesn't exist or runs the long way round, so it stalls until
+//  the 50 m teleport. The way the player actually walked does
+//  exist. This file remembers it:
+//
+//      player walked:   P ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ ~ @ now
+//      crumbs kept:     o - - - - o     o - - - - - - - o @
+//                                  \   /
+//                                   o      (corners only)
+//
+//  RECORDING (Offer, every frame, no natives):
+//    - a crumb every `spacing` meters walked, not every frame;
+//      standing still records nothing
+//    - collinear compression: if every point the newest crumb
+//      stands for would stay within collinearTolerance of the
+//      line from the crumb before it to the new point (sideways,
+//      and in height, so stairs and slopes count as bends), the
+//      newest crumb is moved to the new point instead of a new
+//      crumb being added. Straight stretches cost one crumb per
+//      maxMergedLength, corners keep theirs.
+//    - a jump bigger than breakJump (the player teleported,
+//      respawned, got out of a car far away) drops the trail
+//  Fixed-size ring of kCapacity crumbs, stored as x[] / y[] / z[]
+//  arrays; inserting or merging is O(1) and nothing is allocated.
+//
+//  FOLLOWING (Track + Route):
+//  Crumbs have ids that keep counting up, so a companion's
+//  TrailCursor stays valid while older crumbs are overwritten.
+//  While a companion keeps up, Anchor() keeps its cursor at the
+//  head of the trail. Track() then only moves the cursor forward past
+//  crumbs the companion has reached; a full nearest-crumb scan
+//  (GeometryKernels NearestK, SIMD) is the fallback for a cursor
+//  that was lost. Route() copies the next few crumbs for a
+//  point-route task.
+//
+//  WHEN (TrailFollow, per companion, on LOD samples):
+//  Being far behind isn't enough: a sprinting player outruns the
+//  companion on open ground too, and there the follow task's
+//  straight line (with the lead) is the faster way. The trail is
+//  taken when the companion stalls: more than startMeters behind
+//  and not getting closer to where the player was over stallTicks.
+//  On the trail, a companion that isn't getting closer to its
+//  crumb (it is round a corner it can't see) backs up one crumb
+//  to where the path came from. Back to normal follow within
+//  stopMeters; the teleport stays the last resort.
+//
+//  Engine-agnostic; builds on Linux.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+#include "CompanionCore.h"
+
+struct BreadcrumbConfig
+{
+    float spacing = 2.0f;               // meters walked between crumbs
+    float collinearTolerance = 0.35f;   // off-line distance that still counts as straight
+    float maxMergedLength = 15.0f;      // longest straight stretch one crumb may cover
+    float breakJump = 20.0f;            // moved further than this in one Offer: new trail
+};
+
+// One companion's place on the trail
+struct TrailCursor
+{
+    uint32_t id = 0;                    // crumb it is heading for
+    bool valid = false;                 // false => Track() does a full search
+};
+
+struct BreadcrumbStats
+{
+    uint32_t stored = 0;                // new crumbs
+    uint32_t merged = 0;                // crumbs moved along a straight line instead
+    uint32_t breaks = 0;                // trail dropped after a jump
+    uint32_t fullSearches = 0;          // Track() nearest-crumb scans
+    uint32_t tracks = 0;
+};
+
+class BreadcrumbTrail
+{
+public:
+    static constexpr uint32_t kCapacity = 128;     // ~250+ m of walking at 2 m spacing
+
+    BreadcrumbConfig config{};
+
+    // Feed the player's position (every frame is fine).
+    // Returns true if the trail changed.
+    bool Offer(const Vec3& pos);
+
+    void Clear();
+
+    uint32_t Count() const { return m_count; }
+    bool Empty() const { return m_count == 0; }
+
+    // Ids of the oldest and newest crumb (valid while Count() > 0)
+    uint32_t OldestId() const { return m_nextId - m_count; }
+    uint32_t NewestId() const { return m_nextId - 1; }
+    bool Contains(uint32_t id) const { return m_count > 0 && id - OldestId() < m_count; }
+
+    Vec3 Crumb(uint32_t id) const;
+
+    // The companion is with the player: point its cursor at the
+    // start of the leg being laid (the newest crumb itself still
+    // moves while straight walking is merged into it), so if it
+    // falls behind it picks the trail up where the two parted
+    // rather than at whichever crumb is nearest (which may be
+    // through a wall).
+    void Anchor(TrailCursor& cursor) const
+    {
+        cursor.id = (m_count >= 2) ? NewestId() - 1 : NewestId();
+        cursor.valid = m_count > 0;
+    }
+
+    // Crumb closest to pos within maxDist. false if none.
+    bool Nearest(const Vec3& pos, float maxDist, uint32_t& outId, float& outDistSq) const;
+
+    // Points the companion at pos at the crumb to walk to next:
+    // past every crumb within reach, and past any crumb it is
+    // already beyond while within reach of the leg to the next
+    // one (a corner it cut, never one round a wall). A cursor
+    // that is not valid any more (or never was), or more than
+    // maxDist off the leg into its crumb, starts from Nearest().
+    // false if the companion is more than maxDist from the trail.
+    bool Track(TrailCursor& cursor, const Vec3& pos, float reach, float maxDist);
+
+    // Copies crumbs fromId.. (towards the newest) into out.
+    // Returns how many (<= max).
+    uint32_t Route(uint32_t fromId, Vec3* out, uint32_t max) const;
+
+    const BreadcrumbStats& Stats() const { return m_stats; }
+    void ResetTotals() { m_stats = {}; }
+
+private:
+    uint32_t Slot(uint32_t id) const { return (m_first + (id - OldestId())) % kCapacity; }
+    void Append(const Vec3& pos);
+    void NarrowRun(const Vec3& from, const Vec3& to, bool first);
+
+    float m_x[kCapacity];
+    float m_y[kCapacity];
+    float m_z[kCapacity];
+
+    uint32_t m_first = 0;               // slot of the oldest crumb
+    uint32_t m_count = 0;
+    uint32_t m_nextId = 1;              // id the next crumb gets
+
+    Vec3 m_lastOffered{};
+    bool m_hasOffered = false;
+
+    // Directions from the newest crumb's predecessor that keep
+    // every point merged into the newest crumb within tolerance:
+    // heading (radians, relative to m_runHeading) and grade
+    // (rise / run). Narrows with each merge.
+    float m_runHeading = 0.0f;
+    float m_coneLo = 0.0f, m_coneHi = 0.0f;
+    float m_gradeLo = 0.0f, m_gradeHi = 0.0f;
+    float m_runLength = 0.0f;           // predecessor -> newest crumb, horizontal
+
+    BreadcrumbStats m_stats{};
+};
+
+// --------------------------------------------------------
+//  Trail-follow planning
+// --------------------------------------------------------
+struct TrailFollowConfig
+{
+    float startMeters = 12.0f;          // further behind than this: watch for a stall
+    float stopMeters = 6.0f;            // back to normal follow once this close
+    float reachMeters = 1.5f;           // crumb counts as reached
+    float maxOffMeters = 8.0f;          // further than this from the trail: not on it
+    uint32_t stallTicks = 90;           // progress is judged over this many frames:
+    float stallMeters = 3.0f;           //   off the trail, closer to where the player was by less = stalled
+    float routeStallMeters = 1.0f;      //   on it, closer to the crumb by less = back up one crumb
+    uint32_t reissueCrumbs = 4;         // new route once the cursor moved this many crumbs
+                                        // (or reached the end of a shorter route)...
+    uint32_t reissueTicks = 120;        // ...or this long after the last one
+};
+
+// Per companion
+struct TrailFollowState
+{
+    TrailCursor cursor;
+    bool onTrail = false;
+
+    // Progress window
+    bool watching = false;
+    Vec3 watchTarget{};
+    float watchDist = 0.0f;
+    uint32_t watchTick = 0;
+
+    uint32_t routeFrom = 0;             // first crumb of the issued route...
+    uint32_t routeLast = 0;             // ...and its last
+    uint32_t issuedTick = 0;
+    bool backedUp = false;              // cursor moved back: issue now
+};
+
+struct TrailPlan
+{
+    bool onTrail = false;
+    bool changed = false;               // onTrail differs from the last frame
+    bool issueRoute = false;            // issue Route(cursor) now
+};
+
+struct TrailFollowStats
+{
+    uint32_t engaged = 0;               // stalls that put a companion on the trail
+    uint32_t backUps = 0;
+    uint32_t routes = 0;
+};
+
+class TrailFollow
+{
+public:
+    TrailFollowConfig config{};
+
+    // Once per frame. companionPos is the last LOD sample; sampled =
+    // it was taken this frame (decisions only change then).
+    TrailPlan Plan(TrailFollowState& s, BreadcrumbTrail& trail, const Vec3& companionPos,
+        const Vec3& playerPos, bool sampled, uint32_t tick);
+
+    // The host issued Route(s.cursor.id), `count` crumbs long
+    void NoteIssued(TrailFollowState& s, uint32_t count, uint32_t tick)
+    {
+        s.routeFrom = s.cursor.id;
+        s.routeLast = s.cursor.id + (count > 0 ? count - 1 : 0);
+        s.issuedTick = tick;
+        s.backedUp = false;
+        m_stats.routes++;
+    }
+
+    const TrailFollowStats& Stats() const { return m_stats; }
+    void ResetTotals() { m_stats = {}; }
+
+private:
+    bool Stalled(TrailFollowState& s, const Vec3& target, const Vec3& pos, uint32_t tick, float minMeters) const;
+
+    TrailFollowStats m_stats{};
+};
@@ -0,0 +1,330 @@
+// ============================================================
+//  CoTask.cpp — Coroutine tasks driven once per frame (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Frame pool: kPoolBlocks fixed blocks and a free list threaded
+//  through them. promise_type::operator new is noexcept, so a
+//  failed allocation makes the coroutine call return
+//  get_return_object_on_allocation_failure() (an empty CoTask)
+//  instead of throwing. Frame size is decided by the compiler
+//  (locals that live across a co_await, plus bookkeeping); the
+//  largest one seen is in the stats, to keep kBlockBytes honest.
+//
+//  Task ids are slot index + generation, so a stale id (the task
+//  finished and the slot was reused) is never mistaken for the
+//  new occupant.
+// ============================================================
+
+#include "CoTask.h"
+
+// --------------------------------------------------------
+//  Frame pool
+// --------------------------------------------------------
+namespace
+{
+    struct alignas(std::max_align_t) PoolBlock
+    {
+        unsigned char bytes[CoScheduler::kBlockBytes];
+    };
+
+    PoolBlock g_blocks[CoScheduler::kPoolBlocks];
+    PoolBlock* g_freeList = nullptr;
+    bool g_poolInit = false;
+    uint32_t g_blocksUsed = 0;
+    uint32_t g_largestFrame = 0;
+
+    void InitPool()
+    {
+        for (uint32_t i = 0; i < CoScheduler::kPoolBlocks; ++i)
+        {
+            PoolBlock* next = (i + 1 < CoScheduler::kPoolBlocks) ? &g_blocks[i + 1] : nullptr;
+            *reinterpret_cast<PoolBlock**>(g_blocks[i].bytes) = next;
+        }
+        g_freeList = &g_blocks[0];
+        g_poolInit = true;
+    }
+}
+
+void* CoTask::promise_type::operator new(std::size_t size) noexcept
+{
+    if (!g_poolInit)
+        InitPool();
+
+    if (size > g_largestFrame)
+        g_largestFrame = (uint32_t)size;
+
+    if (size > CoScheduler::kBlockBytes || g_freeList == nullptr)
+        return nullptr;
+
+    PoolBlock* block = g_freeList;
+    g_freeList = *reinterpret_cast<PoolBlock**>(block->bytes);
+    g_blocksUsed++;
+    return block;
+}
+
+void CoTask::promise_type::operator delete(void* p, std::size_t) noexcept
+{
+    if (p == nullptr)
+        return;
+
+    PoolBlock* block = static_cast<PoolBlock*>(p);
+    *reinterpret_cast<PoolBlock**>(block->bytes) = g_freeList;
+    g_freeList = block;
+    g_blocksUsed--;
+}
+
+// --------------------------------------------------------
+//  CoTask
+// --------------------------------------------------------
+CoTask& CoTask::operator=(CoTask&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (m_handle)
+            m_handle.destroy();
+        m_handle = other.m_handle;
+        other.m_handle = nullptr;
+    }
+    return *this;
+}
+
+CoTask::~CoTask()
+{
+    // Never started: nobody else owns it
+    if (m_handle)
+        m_handle.destroy();
+}
+
+// --------------------------------------------------------
+//  Awaitables
+// --------------------------------------------------------
+void CoAwait::await_suspend(CoTask::Handle h) noexcept
+{
+    CoTask::promise_type& promise = h.promise();
+    const CoScheduler& s = *promise.scheduler;
+
+    CoWait w;
+    w.kind = kind;
+    w.pred = pred;
+    w.user = user;
+    w.untilTick = s.CurrentTick() + frames;
+    w.untilSeconds = s.CurrentSeconds() + seconds;
+
+    promise.wait = w;
+    m_promise = &promise;
+}
+
+CoAwait NextFrame()
+{
+    return Frames(1);
+}
+
+CoAwait Frames(uint32_t n)
+{
+    CoAwait a;
+    a.kind = CoWaitKind::Ticks;
+    a.frames = (n > 0) ? n : 1;
+    return a;
+}
+
+CoAwait Seconds(double seconds)
+{
+    CoAwait a;
+    a.kind = CoWaitKind::Time;
+    a.seconds = seconds;
+    return a;
+}
+
+CoAwait Until(bool (*pred)(void* user), void* user, double timeoutSeconds)
+{
+    CoAwait a;
+    a.kind = CoWaitKind::Until;
+    a.pred = pred;
+    a.user = user;
+    a.seconds = timeoutSeconds;
+    return a;
+}
+
+// --------------------------------------------------------
+//  CoScheduler
+// --------------------------------------------------------
+static uint32_t MakeId(uint32_t index, uint32_t generation)
+{
+    return (generation << 8) | (index + 1);
+}
+
+int CoScheduler::Find(CoTaskId id) const
+{
+    if (id == 0)
+        return -1;
+
+    uint32_t index = (id & 0xFF) - 1;
+    if (index >= kMaxTasks)
+        return -1;
+
+    const Slot& slot = m_slots[index];
+    if (!slot.handle || MakeId(index, slot.generation) != id)
+        return -1;
+    return (int)index;
+}
+
+CoTaskId CoScheduler::Start(CoTask&& task)
+{
+    if (!task.Valid())
+    {
+        m_startFailures++;
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < kMaxTasks; ++i)
+    {
+        Slot& slot = m_slots[i];
+        if (slot.handle)
+            continue;
+
+        slot.handle = task.Release();
+        slot.generation = (slot.generation + 1) & 0xFFFFFF;
+        if (slot.generation == 0)
+            slot.generation = 1;
+        slot.handle.promise().scheduler = this;
+
+        CoTaskId id = MakeId(i, slot.generation);
+
+        m_started++;
+        m_running++;
+        if (m_running > m_peakRunning)
+            m_peakRunning = m_running;
+
+        Resume(i);
+        return id;
+    }
+
+    // Table full: the CoTask destructor frees the frame
+    m_startFailures++;
+    return 0;
+}
+
+bool CoScheduler::IsReady(CoWait& wait) const
+{
+    if (wait.woken)
+    {
+        wait.result = false;
+        return true;
+    }
+
+    switch (wait.kind)
+    {
+    case CoWaitKind::None:
+        return true;
+
+    case CoWaitKind::Ticks:
+        wait.result = true;
+        return m_tick >= wait.untilTick;
+
+    case CoWaitKind::Time:
+        wait.result = true;
+        return m_now >= wait.untilSeconds;
+
+    case CoWaitKind::Until:
+        if (wait.pred(wait.user))
+        {
+            wait.result = true;
+            return true;
+        }
+        wait.result = false;
+        return m_now >= wait.untilSeconds;
+    }
+    return true;
+}
+
+void CoScheduler::Resume(uint32_t index)
+{
+    Slot& slot = m_slots[index];
+    slot.resumedTick = m_tick;
+
+    // Keep the result for await_resume(); drop the rest (and any
+    // Wake() that arrived after the wait was already over)
+    CoWait& wait = slot.handle.promise().wait;
+    bool result = wait.result;
+    wait = CoWait{};
+    wait.result = result;
+
+    slot.handle.resume();
+
+    if (slot.handle.done())
+    {
+        m_finished++;
+        Free(index);
+    }
+}
+
+void CoScheduler::Free(uint32_t index)
+{
+    Slot& slot = m_slots[index];
+    slot.handle.destroy();
+    slot.handle = nullptr;
+    m_running--;
+}
+
+void CoScheduler::Tick()
+{
+    for (uint32_t i = 0; i < kMaxTasks; ++i)
+    {
+        Slot& slot = m_slots[i];
+        if (!slot.handle || slot.resumedTick == m_tick)
+            continue;
+
+        if (IsReady(slot.handle.promise().wait))
+            Resume(i);
+    }
+}
+
+bool CoScheduler::IsRunning(CoTaskId id) const
+{
+    return Find(id) >= 0;
+}
+
+void CoScheduler::Cancel(CoTaskId id)
+{
+    int index = Find(id);
+    if (index < 0)
+        return;
+
+    m_cancelled++;
+    Free((uint32_t)index);
+}
+
+void CoScheduler::CancelAll()
+{
+    for (uint32_t i = 0; i < kMaxTasks; ++i)
+    {
+        if (m_slots[i].handle)
+        {
+            m_cancelled++;
+            Free(i);
+        }
+    }
+}
+
+void CoScheduler::Wake(CoTaskId id)
+{
+    int index = Find(id);
+    if (index >= 0)
+        m_slots[index].handle.promise().wait.woken = true;
+}
+
+CoSchedulerStats CoScheduler::Stats() const
+{
+    CoSchedulerStats s;
+    s.running = m_running;
+    s.peakRunning = m_peakRunning;
+    s.started = m_started;
+    s.finished = m_finished;
+    s.cancelled = m_cancelled;
+    s.startFailures = m_startFailures;
+    s.poolBlocksUsed = g_blocksUsed;
+    s.largestFrame = g_largestFrame;
+    return s;
+}
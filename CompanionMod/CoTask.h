@@ -0,0 +1,235 @@
+// ============================================================
+//  CoTask.h — Coroutine tasks driven once per frame
+// ============================================================
+//
+//  PURPOSE:
+//  Anything that takes more than one frame (load a model, then
+//  spawn; retry a seat every second; re-snap the stay anchor)
+//  used to be a tick counter plus flags spread over main.cpp,
+//  or a WAIT() loop that stalled the whole script. A CoTask is a
+//  C++20 coroutine that reads top to bottom instead:
+//
+//      static CoTask SpawnCompanion()
+//      {
+//          uint32_t model = RequestModel();
+//          if (!co_await ModelLoaded(model, 2.0))    // polled each frame
+//              co_return;
+//          CreatePed(model);
+//          co_await Seconds(0.5);
+//          ...
+//      }
+//
+//      CoTaskId id = g_tasks.Start(SpawnCompanion());
+//
+//  AWAITABLES:
+//    co_await NextFrame()              resume next Tick()
+//    co_await Frames(n)                resume n Tick()s from now
+//    co_await Seconds(s)               resume once s seconds passed
+//    co_await Until(pred, user, s)     resume when pred(user) is
+//                                      true (-> true) or after s
+//                                      seconds (-> false)
+//  A sleeping task can be woken early with CoScheduler::Wake();
+//  the co_await then returns false.
+//
+//  SCHEDULING:
+//    - BeginFrame() at the top of the frame sets the clock.
+//    - Start() runs the task right away up to its first co_await.
+//    - Tick() (once per frame, main loop) resumes every task
+//      whose wait is over, at most once per frame, in slot order.
+//    - Cancel() destroys a suspended task (its locals' destructors
+//      run, so RAII cleanup works). A task must not cancel itself.
+//
+//  MEMORY:
+//  Coroutine frames come from a fixed pool (kPoolBlocks blocks of
+//  kBlockBytes) — never the heap. If the pool is full or a
+//  coroutine's frame is too big, the call returns an empty CoTask
+//  and Start() returns 0; nothing is allocated per frame. Frame
+//  sizes are up to the compiler (bigger in Debug), so anything
+//  that must happen anyway (spawning, main.cpp) keeps a path
+//  that doesn't need a task.
+//
+//  Engine-agnostic; needs C++20 (<coroutine>), builds on Linux
+//  (Tools/Tests covers the scheduler and the pool).
+//  Script thread only.
+// ============================================================
+
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+
+// --------------------------------------------------------
+//  What a suspended task is waiting for
+// --------------------------------------------------------
+enum class CoWaitKind : uint8_t
+{
+    None,          // runnable
+    Ticks,         // until tick >= untilTick
+    Time,          // until now >= untilSeconds
+    Until          // until pred(user), or now >= untilSeconds
+};
+
+struct CoWait
+{
+    CoWaitKind kind = CoWaitKind::None;
+    bool result = false;          // what the co_await returns
+    bool woken = false;           // CoScheduler::Wake()
+    uint32_t untilTick = 0;
+    double untilSeconds = 0.0;
+    bool (*pred)(void* user) = nullptr;
+    void* user = nullptr;
+};
+
+class CoScheduler;
+
+// --------------------------------------------------------
+//  Task (coroutine return type)
+// --------------------------------------------------------
+class CoTask
+{
+public:
+    struct promise_type
+    {
+        CoWait wait;
+        CoScheduler* scheduler = nullptr;
+
+        CoTask get_return_object() { return CoTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        static CoTask get_return_object_on_allocation_failure() { return CoTask(); }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+
+        // Frames come from the pool (CoTask.cpp)
+        static void* operator new(std::size_t size) noexcept;
+        static void operator delete(void* p, std::size_t size) noexcept;
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    CoTask() = default;
+    CoTask(CoTask&& other) noexcept : m_handle(other.m_handle) { other.m_handle = nullptr; }
+    CoTask& operator=(CoTask&& other) noexcept;
+    ~CoTask();
+
+    CoTask(const CoTask&) = delete;
+    CoTask& operator=(const CoTask&) = delete;
+
+    bool Valid() const { return m_handle != nullptr; }
+
+    // Hands the coroutine over (to the scheduler)
+    Handle Release()
+    {
+        Handle h = m_handle;
+        m_handle = nullptr;
+        return h;
+    }
+
+private:
+    explicit CoTask(Handle h) : m_handle(h) {}
+    Handle m_handle = nullptr;
+};
+
+// --------------------------------------------------------
+//  Awaitables
+// --------------------------------------------------------
+// Holds a relative wait; await_suspend() makes it absolute with
+// the owning scheduler's clock and parks it in the promise.
+struct CoAwait
+{
+    CoWaitKind kind = CoWaitKind::Ticks;
+    uint32_t frames = 1;
+    double seconds = 0.0;
+    bool (*pred)(void* user) = nullptr;
+    void* user = nullptr;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(CoTask::Handle h) noexcept;
+    bool await_resume() const noexcept { return m_promise->wait.result; }
+
+    CoTask::promise_type* m_promise = nullptr;
+};
+
+CoAwait NextFrame();
+CoAwait Frames(uint32_t n);
+CoAwait Seconds(double seconds);
+CoAwait Until(bool (*pred)(void* user), void* user, double timeoutSeconds);
+
+// --------------------------------------------------------
+//  Scheduler
+// --------------------------------------------------------
+using CoTaskId = uint32_t;        // 0 = none
+
+struct CoSchedulerStats
+{
+    uint32_t running = 0;
+    uint32_t peakRunning = 0;
+    uint32_t started = 0;
+    uint32_t finished = 0;
+    uint32_t cancelled = 0;
+    uint32_t startFailures = 0;   // pool full / frame too big / table full
+    uint32_t poolBlocksUsed = 0;
+    uint32_t largestFrame = 0;    // bytes
+};
+
+class CoScheduler
+{
+public:
+    static constexpr uint32_t kMaxTasks = 16;
+    static constexpr uint32_t kPoolBlocks = 16;       // frame pool, shared by all schedulers
+    static constexpr uint32_t kBlockBytes = 1024;
+
+    // Top of the frame: the clock awaits are measured against
+    void BeginFrame(uint32_t tick, double nowSeconds)
+    {
+        m_tick = tick;
+        m_now = nowSeconds;
+    }
+
+    // Takes the task and runs it to its first co_await.
+    // Returns 0 if the task is empty (allocation failed) or the
+    // table is full.
+    CoTaskId Start(CoTask&& task);
+
+    // Main loop, once per frame: resumes tasks whose wait is over
+    void Tick();
+
+    bool IsRunning(CoTaskId id) const;
+    void Cancel(CoTaskId id);
+    void CancelAll();
+
+    // Ends the task's current wait now (it resumes on the next
+    // Tick, and its co_await returns false)
+    void Wake(CoTaskId id);
+
+    uint32_t CurrentTick() const { return m_tick; }
+    double CurrentSeconds() const { return m_now; }
+
+    CoSchedulerStats Stats() const;
+
+private:
+    struct Slot
+    {
+        CoTask::Handle handle = nullptr;
+        uint32_t generation = 0;
+        uint32_t resumedTick = 0;
+    };
+
+    bool IsReady(CoWait& wait) const;
+    void Resume(uint32_t index);
+    void Free(uint32_t index);
+    int Find(CoTaskId id) const;
+
+    Slot m_slots[kMaxTasks];
+    uint32_t m_tick = 0;
+    double m_now = 0.0;
+
+    uint32_t m_running = 0;
+    uint32_t m_peakRunning = 0;
+    uint32_t m_started = 0;
+    uint32_t m_finished = 0;
+    uint32_t m_cancelled = 0;
+    uint32_t m_startFailures = 0;
+};
@@ -1,5 +1,7 @@
 #pragma once
 #include <cstdint>
+#include "CompanionStateMachine.h"
+#include "EventBus.h"
 
 // Engine-agnostic types only (NO GTA natives/types in this file)
 
@@ -15,6 +17,25 @@ struct Vec3
     float x{}, y{}, z{};
 };
 
+// What the adapter can tell us about a ped, for threat scoring
+enum class WeaponClass : uint8_t
+{
+    None,
+    Melee,
+    Gun
+};
+
+struct PedThreatInfo
+{
+    bool exists = false;
+    bool dead = false;
+    bool hostile = false;            // relationship to player is dislike/hate
+    bool inCombatWithPlayer = false;
+    bool aimingAtPlayer = false;     // in combat, armed and facing the player
+    bool damagedPlayer = false;      // player has been damaged by this ped
+    WeaponClass weapon = WeaponClass::None;
+};
+
 struct CompanionContext
 {
     // Time
@@ -26,20 +47,30 @@ struct CompanionContext
     bool playerDead = false;
     bool playerInVehicle = false;
     Vec3 playerPos{};
+
+    // Protection: highest-ranked threat near the player (0 = none)
+    int topThreatHandle = 0;
+    float topThreatScore = 0.0f;
+
+    // Frenzy: target picked by the Frenzy pipeline (0 = none)
+    int frenzyTargetHandle = 0;
 };
 
 struct CompanionState
 {
     CompanionMode mode = CompanionMode::Protection;
 
+    // Lifecycle (see CompanionStateMachine.h). Only changed by
+    // CompanionCore (bus events, Tick, Dispatch).
+    CompanionActivity activity = CompanionActivity::Despawned;
+
+    // Inputs, refreshed by the host every tick
     bool spawned = false;
     bool stayEnabled = false;
 
     // Stay V2 anchor
     bool hasStayAnchor = false;
     Vec3 stayAnchor{};
-
-    bool ridingVehicle = false;
 };
 
 struct CompanionCommands
@@ -55,39 +86,246 @@ struct CompanionCommands
     uint32_t followRefreshTicks = 60; // how often to re-issue (60 = ~1s @60fps)
 
     bool requestStay = false;
+
+    // Ped the companion should engage (0 = none):
+    // the top threat in Protection, the current victim in Frenzy
+    int threatTarget = 0;
+
+    // CompanionAction bits from state transitions this tick
+    uint16_t actions = 0;
+};
+
+// ------------------------------------------------------------
+// Batch (structure-of-arrays) views for many companions.
+//
+// The caller owns the arrays; these are just pointers + count so
+// TickBatch never allocates. Flags are uint8_t (0/1) instead of
+// bool so the loop can be vectorized.
+// ------------------------------------------------------------
+struct CompanionStateArrays
+{
+    uint32_t count = 0;
+
+    const uint8_t* mode = nullptr;      // CompanionMode as uint8_t
+    const uint8_t* spawned = nullptr;
+    const uint8_t* stayEnabled = nullptr;
+};
+
+struct CompanionCommandArrays
+{
+    uint8_t* requestLog = nullptr;
+    uint8_t* requestSpawn = nullptr;
+    uint8_t* requestDespawn = nullptr;
+
+    uint8_t* requestFollow = nullptr;
+    float* followDistance = nullptr;
+    float* followSpeed = nullptr;
+    uint32_t* followRefreshTicks = nullptr;
+
+    uint8_t* requestStay = nullptr;
+    int32_t* threatTarget = nullptr;
+};
+
+// Follow parameters Core puts into its commands. Defaults are the
+// shipped values; main.cpp overrides them from the tuning file.
+struct CompanionCoreTuning
+{
+    float    followDistance = 2.0f;
+    float    followSpeed = 3.0f;
+    uint32_t followRefreshTicks = 60;
 };
 
 class CompanionCore
 {
 public:
+    static constexpr uint32_t kLogIntervalTicks = 120;
+
+    void SetTuning(const CompanionCoreTuning& tuning) { m_tuning = tuning; }
+    const CompanionCoreTuning& Tuning() const { return m_tuning; }
+
+    // Registers for the edge events that drive the lifecycle FSM.
+    // The bus stores `this`, so the core must outlive it.
+    void Subscribe(EventBus& bus)
+    {
+        static const GameEventType kTypes[] =
+        {
+            GameEventType::MissionStarted, GameEventType::MissionEnded,
+            GameEventType::CompanionSpawned, GameEventType::CompanionDespawned,
+            GameEventType::StayToggled,
+            GameEventType::PlayerEnteredVehicle, GameEventType::PlayerExitedVehicle
+        };
+
+        for (GameEventType t : kTypes)
+            bus.Subscribe(t, &CompanionCore::OnGameEvent, this);
+    }
+
     void Tick(const CompanionContext& ctx, CompanionState& state, CompanionCommands& out)
     {
         // Clear commands each tick
         out = {};
 
         // Heartbeat log every ~2 seconds at 60fps
-        if (ctx.tickCount % 120 == 0)
+        if (ctx.tickCount % kLogIntervalTicks == 0)
             out.requestLog = true;
 
-        bool requestToggleSpawn = false;
+        // Lifecycle only moves when an event arrived since last tick
+        if (m_inputsDirty)
+        {
+            Reconcile(state, out.actions);
+            m_inputsDirty = false;
+        }
 
-        if (state.spawned && ctx.playerExists && !ctx.playerDead)
+        if (ctx.playerExists && !ctx.playerDead)
         {
-            if (state.stayEnabled)
+            if (state.activity == CompanionActivity::Staying)
             {
                 out.requestStay = true;
                 out.requestFollow = false;
             }
+            else if (state.activity != CompanionActivity::Following)
+            {
+                // Suspended, despawned or riding: nothing to drive
+            }
+            else if (state.mode == CompanionMode::Protection && ctx.topThreatHandle != 0 && !ctx.playerInVehicle)
+            {
+                // Deal with the threat first; follow resumes once it's gone
+                out.requestStay = false;
+                out.requestFollow = false;
+                out.threatTarget = ctx.topThreatHandle;
+            }
+            else if (state.mode == CompanionMode::Frenzy && ctx.frenzyTargetHandle != 0 && !ctx.playerInVehicle)
+            {
+                out.requestStay = false;
+                out.requestFollow = false;
+                out.threatTarget = ctx.frenzyTargetHandle;
+            }
             else
             {
                 out.requestStay = false;
                 out.requestFollow = true;
-                out.followDistance = 2.0f;
-                out.followSpeed = 3.0f;
-                out.followRefreshTicks = 60;
+                out.followDistance = m_tuning.followDistance;
+                out.followSpeed = m_tuning.followSpeed;
+                out.followRefreshTicks = m_tuning.followRefreshTicks;
             }
         }
+    }
+
+    // Latest lifecycle inputs, as last reported by the bus
+    bool MissionActive() const { return m_missionActive; }
+
+    // For events the host observes after Tick (boarding, desync,
+    // manual despawn...). Adds the resulting actions to `actions`.
+    bool Dispatch(CompanionState& state, CompanionEvent event, uint16_t& actions)
+    {
+        return CompanionFsm::Dispatch(state.activity, event, actions);
+    }
+
+    // Same follow/stay/engage decisions as Tick(), for N companions
+    // sharing one player snapshot (lifecycle transitions are not
+    // tracked per batch slot; `spawned` stands in for Active).
+    // Written branch-free (flags combined with & / |) so
+    // the compiler can vectorize the loop.
+    void TickBatch(const CompanionContext& ctx, const CompanionStateArrays& states, const CompanionCommandArrays& out)
+    {
+        const uint8_t log = (ctx.tickCount % kLogIntervalTicks == 0) ? 1 : 0;
+        const uint8_t playerOk = (ctx.playerExists && !ctx.playerDead) ? 1 : 0;
+        const uint8_t hasThreat = (ctx.topThreatHandle != 0 && !ctx.playerInVehicle) ? 1 : 0;
+        const int32_t threat = ctx.topThreatHandle;
+        const uint8_t hasVictim = (ctx.frenzyTargetHandle != 0 && !ctx.playerInVehicle) ? 1 : 0;
+        const int32_t victim = ctx.frenzyTargetHandle;
+
+        const uint8_t* __restrict mode = states.mode;
+        const uint8_t* __restrict spawned = states.spawned;
+        const uint8_t* __restrict stayEnabled = states.stayEnabled;
+
+        uint8_t* __restrict requestLog = out.requestLog;
+        uint8_t* __restrict requestSpawn = out.requestSpawn;
+        uint8_t* __restrict requestDespawn = out.requestDespawn;
+        uint8_t* __restrict requestFollow = out.requestFollow;
+        uint8_t* __restrict requestStay = out.requestStay;
+        int32_t* __restrict threatTarget = out.threatTarget;
+        float* __restrict followDistance = out.followDistance;
+        float* __restrict followSpeed = out.followSpeed;
+        uint32_t* __restrict followRefreshTicks = out.followRefreshTicks;
+
+        // Locals, so the loop doesn't re-read members through `this`
+        const float followDist = m_tuning.followDistance;
+        const float followSpd = m_tuning.followSpeed;
+        const uint32_t followRefresh = m_tuning.followRefreshTicks;
+
+        for (uint32_t i = 0; i < states.count; ++i)
+        {
+            const uint8_t active = (uint8_t)(spawned[i] & playerOk);
+            const uint8_t stay = (uint8_t)(stayEnabled[i] & 1);
+            const uint8_t protect = (uint8_t)(mode[i] == (uint8_t)CompanionMode::Protection);
+            const uint8_t frenzy = (uint8_t)(mode[i] == (uint8_t)CompanionMode::Frenzy);
+            const uint8_t engageThreat = (uint8_t)(active & (stay ^ 1) & protect & hasThreat);
+            const uint8_t engageVictim = (uint8_t)(active & (stay ^ 1) & frenzy & hasVictim);
+            const uint8_t engage = (uint8_t)(engageThreat | engageVictim);
+
+            requestLog[i] = log;
+            requestSpawn[i] = 0;
+            requestDespawn[i] = 0;
 
-        (void)ctx;
+            requestStay[i] = (uint8_t)(active & stay);
+            requestFollow[i] = (uint8_t)(active & (stay ^ 1) & (engage ^ 1));
+            threatTarget[i] = (threat & -(int32_t)engageThreat) | (victim & -(int32_t)engageVictim);
+
+            followDistance[i] = followDist;
+            followSpeed[i] = followSpd;
+            followRefreshTicks[i] = followRefresh;
+        }
+    }
+
+private:
+    CompanionCoreTuning m_tuning{};
+
+    // Lifecycle inputs latched from bus events. Edges alone can
+    // be lost (e.g. stay toggled while Suspended ignores StayOn),
+    // so Reconcile replays the latched levels into the FSM until
+    // it settles — but only on ticks where an event arrived.
+    bool m_missionActive = false;
+    bool m_spawned = false;
+    bool m_stayOn = false;
+    bool m_playerInVehicle = false;
+    bool m_inputsDirty = false;
+
+    static void OnGameEvent(const GameEvent& e, void* user)
+    {
+        static_cast<CompanionCore*>(user)->HandleEvent(e);
+    }
+
+    void HandleEvent(const GameEvent& e)
+    {
+        switch (e.type)
+        {
+        case GameEventType::MissionStarted:       m_missionActive = true; break;
+        case GameEventType::MissionEnded:         m_missionActive = false; break;
+        case GameEventType::CompanionSpawned:     m_spawned = true; break;
+        case GameEventType::CompanionDespawned:   m_spawned = false; break;
+        case GameEventType::StayToggled:          m_stayOn = (e.a != 0); break;
+        case GameEventType::PlayerEnteredVehicle: m_playerInVehicle = true; break;
+        case GameEventType::PlayerExitedVehicle:  m_playerInVehicle = false; break;
+        default: return;
+        }
+        m_inputsDirty = true;
+    }
+
+    void Reconcile(CompanionState& state, uint16_t& actions)
+    {
+        // Every pass either changes state or stops; the bound is a
+        // guard against a future table with a cycle.
+        for (int pass = 0; pass < CompanionFsm::kStateCount; ++pass)
+        {
+            bool changed = false;
+            changed |= Dispatch(state, m_missionActive ? CompanionEvent::MissionStarted : CompanionEvent::MissionEnded, actions);
+            changed |= Dispatch(state, m_spawned ? CompanionEvent::Spawned : CompanionEvent::Despawned, actions);
+            changed |= Dispatch(state, m_stayOn ? CompanionEvent::StayOn : CompanionEvent::StayOff, actions);
+            if (!m_playerInVehicle)
+                changed |= Dispatch(state, CompanionEvent::LeftVehicle, actions);
+
+            if (!changed)
+                break;
+        }
     }
 };
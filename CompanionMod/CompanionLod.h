@@ -0,0 +1,213 @@
+// ============================================================
+//  CompanionLod.h — Distance-based AI Level-of-Detail
+// ============================================================
+//
+//  PURPOSE:
+//  A companion standing next to the player needs per-frame
+//  attention. One that is 40 m behind, off-screen, does not —
+//  re-reading its position and re-issuing follow every frame
+//  just burns natives.
+//
+//  Each companion is sorted into a tier from its distance to
+//  the player (with hysteresis so it doesn't flicker at the
+//  boundaries) and whether it is on screen:
+//
+//    Near : sampled every frame, normal follow refresh
+//    Mid  : sampled every few frames, slower follow refresh
+//    Far  : sampled rarely, only a coarse catch-up/teleport check
+//
+//  Being off-screen demotes a companion one tier.
+//
+//  Engine-agnostic: main.cpp feeds in the sampled distance and
+//  on-screen flag, and this file only decides WHEN to sample and
+//  how to scale the commands Core emitted.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+#include "CompanionCore.h"
+
+enum class LodTier : uint8_t
+{
+    Near,
+    Mid,
+    Far,
+    Count
+};
+
+inline const char* LodTierName(LodTier t)
+{
+    switch (t)
+    {
+    case LodTier::Near: return "Near";
+    case LodTier::Mid:  return "Mid";
+    case LodTier::Far:  return "Far";
+    default:            return "?";
+    }
+}
+
+// Tuning (all values are "per companion")
+struct LodConfig
+{
+    // Tier boundaries (meters, companion-to-player)
+    float nearDistMeters = 15.0f;
+    float farDistMeters = 35.0f;
+    float hysteresisMeters = 2.0f;   // must move this far past a boundary to change tier
+
+    // Off-screen companions drop one tier
+    bool offscreenDemotes = true;
+
+    // How often to sample position/visibility (1 = every frame)
+    uint32_t nearSampleTicks = 1;
+    uint32_t midSampleTicks = 6;     // ~10 Hz @60fps
+    uint32_t farSampleTicks = 30;    // ~2 Hz @60fps
+
+    // Follow re-issue rate per tier (Near uses whatever Core asked for)
+    uint32_t midFollowRefreshTicks = 120;
+    uint32_t farFollowRefreshTicks = 240;
+
+    // Far companions get a single "catch up" follow at a higher speed
+    float farCatchUpSpeed = 4.0f;
+};
+
+// Per-companion LOD bookkeeping
+struct LodState
+{
+    LodTier tier = LodTier::Near;         // effective tier (after visibility)
+    LodTier distanceTier = LodTier::Near; // distance-only tier (hysteresis reference)
+    bool hasSample = false;               // false => sample on the next tick
+    uint32_t lastSampleTick = 0;
+    float distSq = 0.0f;                  // last sampled companion-to-player distance²
+    bool onScreen = true;
+};
+
+struct LodStats
+{
+    // Companions currently in each tier (rebuilt every frame)
+    uint32_t tierCounts[(int)LodTier::Count] = {};
+
+    // Running totals since the last ResetTotals()
+    uint32_t samplesTaken = 0;
+    uint32_t samplesSkipped = 0;
+    uint32_t tierChanges = 0;
+};
+
+class CompanionLod
+{
+public:
+    LodConfig config{};
+
+    // Call once per frame before any companion is processed.
+    void BeginFrame()
+    {
+        for (uint32_t& c : m_stats.tierCounts)
+            c = 0;
+    }
+
+    // True if this companion should read its position (and
+    // run distance-dependent logic) this tick.
+    bool IsSampleDue(const LodState& s, uint32_t tickCount) const
+    {
+        if (!s.hasSample)
+            return true;
+
+        return (tickCount - s.lastSampleTick) >= SampleTicksFor(s.tier);
+    }
+
+    // Record a fresh sample and re-classify.
+    void Sample(LodState& s, float distSq, bool onScreen, uint32_t tickCount)
+    {
+        LodTier distanceTier = ClassifyDistance(s.hasSample ? s.distanceTier : LodTier::Near, distSq);
+
+        LodTier next = distanceTier;
+        if (!onScreen && config.offscreenDemotes && next != LodTier::Far)
+            next = (LodTier)((uint8_t)next + 1);
+
+        if (s.hasSample && next != s.tier)
+            m_stats.tierChanges++;
+
+        s.tier = next;
+        s.distanceTier = distanceTier;
+        s.distSq = distSq;
+        s.onScreen = onScreen;
+        s.lastSampleTick = tickCount;
+        s.hasSample = true;
+
+        m_stats.samplesTaken++;
+    }
+
+    void NoteSkipped() { m_stats.samplesSkipped++; }
+
+    // Count this companion towards this frame's tier totals.
+    void Account(const LodState& s)
+    {
+        m_stats.tierCounts[(int)s.tier]++;
+    }
+
+    // Scale what Core asked for to what this tier can afford.
+    void ApplyToCommands(const LodState& s, CompanionCommands& cmd) const
+    {
+        if (!cmd.requestFollow)
+            return;
+
+        switch (s.tier)
+        {
+        case LodTier::Near:
+            break;
+
+        case LodTier::Mid:
+            if (cmd.followRefreshTicks < config.midFollowRefreshTicks)
+                cmd.followRefreshTicks = config.midFollowRefreshTicks;
+            break;
+
+        case LodTier::Far:
+            if (cmd.followRefreshTicks < config.farFollowRefreshTicks)
+                cmd.followRefreshTicks = config.farFollowRefreshTicks;
+            cmd.followSpeed = config.farCatchUpSpeed;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // Pure distance -> tier mapping with hysteresis.
+    LodTier ClassifyDistance(LodTier current, float distSq) const
+    {
+        const float nearIn  = config.nearDistMeters - config.hysteresisMeters;
+        const float nearOut = config.nearDistMeters + config.hysteresisMeters;
+        const float farIn   = config.farDistMeters - config.hysteresisMeters;
+        const float farOut  = config.farDistMeters + config.hysteresisMeters;
+
+        // Boundaries depend on where we are now, so a companion
+        // sitting right on 15 m doesn't flip every sample
+        float nearEdge = (current == LodTier::Near) ? nearOut : nearIn;
+        float farEdge = (current == LodTier::Far) ? farIn : farOut;
+
+        if (distSq <= nearEdge * nearEdge)
+            return LodTier::Near;
+        if (distSq <= farEdge * farEdge)
+            return LodTier::Mid;
+        return LodTier::Far;
+    }
+
+    uint32_t SampleTicksFor(LodTier t) const
+    {
+        uint32_t ticks = config.nearSampleTicks;
+        if (t == LodTier::Mid) ticks = config.midSampleTicks;
+        if (t == LodTier::Far) ticks = config.farSampleTicks;
+        return (ticks > 0) ? ticks : 1;
+    }
+
+    const LodStats& Stats() const { return m_stats; }
+
+    void ResetTotals()
+    {
+        m_stats.samplesTaken = 0;
+        m_stats.samplesSkipped = 0;
+        m_stats.tierChanges = 0;
+    }
+
+private:
+    LodStats m_stats{};
+};
@@ -0,0 +1,321 @@
+// ============================================================
+//  CompanionSave.cpp — Companion state kept across sessions (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Like the tick trace, the record is stored in the host's
+//  native layout (x86/x64, little-endian), no byte swapping.
+//
+//  Replacing the file: POSIX rename() replaces an existing
+//  target atomically; on Windows rename() refuses to, so it's
+//  MoveFileExA(REPLACE_EXISTING | WRITE_THROUGH), which is a
+//  single metadata operation on NTFS.
+//
+//  WRITE_THROUGH only covers the rename. The .tmp file's data is
+//  flushed to the disk first (FlushFileBuffers / fsync): without
+//  that, a power cut can leave the rename done and the data not,
+//  an empty or zero-filled save that the checksum rejects, with
+//  the previous good save already replaced.
+//
+//  The saver thread copies the pending record under the mutex
+//  and writes outside it, so Offer() never waits on the disk.
+//  A stop skips the settle: the thread writes what's pending
+//  and leaves. Like the tuning watcher it is never joined from
+//  DllMain; on FreeLibrary DllMain waits for m_running to drop,
+//  so the last write happens on this thread, not under the
+//  loader lock. At process exit the thread is already gone and
+//  nothing writes: at most the last kSettleMs of changes are
+//  lost, the previous save stays intact.
+// ============================================================
+
+#include "CompanionSave.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// --------------------------------------------------------
+//  Read-only file mapping
+// --------------------------------------------------------
+namespace
+{
+    struct MappedFile
+    {
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#else
+        int fd = -1;
+#endif
+
+        // false + exists = false: no such file
+        bool Open(const char* path, bool& exists)
+        {
+            exists = false;
+#ifdef _WIN32
+            file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                return false;
+            exists = true;
+
+            LARGE_INTEGER length;
+            if (!GetFileSizeEx(file, &length) || length.QuadPart == 0)
+                return false;                   // an empty file can't be mapped
+            size = (size_t)length.QuadPart;
+
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping == nullptr)
+                return false;
+
+            data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            return data != nullptr;
+#else
+            fd = open(path, O_RDONLY);
+            if (fd < 0)
+                return false;
+            exists = true;
+
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size == 0)
+                return false;
+            size = (size_t)st.st_size;
+
+            void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+                return false;
+
+            data = (const unsigned char*)p;
+            return true;
+#endif
+        }
+
+        ~MappedFile()
+        {
+#ifdef _WIN32
+            if (data != nullptr)
+                UnmapViewOfFile(data);
+            if (mapping != nullptr)
+                CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE)
+                CloseHandle(file);
+#else
+            if (data != nullptr)
+                munmap((void*)data, size);
+            if (fd >= 0)
+                close(fd);
+#endif
+        }
+    };
+
+    // Written data -> disk (not just the OS cache)
+    bool FlushToDisk(FILE* f)
+    {
+        if (fflush(f) != 0)
+            return false;
+#ifdef _WIN32
+        return FlushFileBuffers((HANDLE)_get_osfhandle(_fileno(f))) != 0;
+#else
+        return fsync(fileno(f)) == 0;
+#endif
+    }
+
+    // Not "ReplaceFile": <windows.h> maps that to ReplaceFileW
+    bool RenameOver(const char* from, const char* to)
+    {
+#ifdef _WIN32
+        return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return rename(from, to) == 0;
+#endif
+    }
+}
+
+// --------------------------------------------------------
+//  Format
+// --------------------------------------------------------
+namespace CompanionSave
+{
+    uint32_t Checksum(const void* data, uint32_t size)
+    {
+        const unsigned char* p = (const unsigned char*)data;
+        uint32_t h = 2166136261u;
+        for (uint32_t i = 0; i < size; ++i)
+        {
+            h ^= p[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    SaveLoadResult Load(const char* path, CompanionSaveRecord& out)
+    {
+        memset(&out, 0, sizeof(out));
+
+        MappedFile file;
+        bool exists = false;
+        if (!file.Open(path, exists))
+            return exists ? SaveLoadResult::Invalid : SaveLoadResult::Missing;
+
+        CompanionSaveHeader h;
+        if (file.size < sizeof(h))
+            return SaveLoadResult::Invalid;
+        memcpy(&h, file.data, sizeof(h));
+
+        if (h.magic != kSaveMagic || h.recordSize == 0 || file.size < sizeof(h) + h.recordSize)
+            return SaveLoadResult::Invalid;
+        if (h.version > kSaveVersion)
+            return SaveLoadResult::TooNew;
+
+        const unsigned char* record = file.data + sizeof(h);
+        if (Checksum(record, h.recordSize) != h.checksum)
+            return SaveLoadResult::Invalid;
+
+        // Older writers: the tail stays zero. Newer writers: cut.
+        memcpy(&out, record, h.recordSize < sizeof(out) ? h.recordSize : sizeof(out));
+        return SaveLoadResult::Loaded;
+    }
+
+    bool Write(const char* path, const CompanionSaveRecord& rec)
+    {
+        char tmp[272];
+        snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+        FILE* f = fopen(tmp, "wb");
+        if (f == nullptr)
+            return false;
+
+        CompanionSaveHeader h{};
+        h.magic = kSaveMagic;
+        h.version = kSaveVersion;
+        h.recordSize = (uint16_t)sizeof(rec);
+        h.checksum = Checksum(&rec, sizeof(rec));
+
+        bool ok = fwrite(&h, sizeof(h), 1, f) == 1
+            && fwrite(&rec, sizeof(rec), 1, f) == 1
+            && FlushToDisk(f);
+        ok = (fclose(f) == 0) && ok;
+
+        if (!ok || !RenameOver(tmp, path))
+        {
+            remove(tmp);
+            return false;
+        }
+        return true;
+    }
+}
+
+// --------------------------------------------------------
+//  CompanionSaver
+// --------------------------------------------------------
+
+CompanionSaver::~CompanionSaver()
+{
+    Detach();
+}
+
+void CompanionSaver::Start(const char* path)
+{
+    snprintf(m_path, sizeof(m_path), "%s", path);
+
+    m_stop = false;
+    m_running = true;
+    m_thread = std::thread(&CompanionSaver::Run, this);
+}
+
+void CompanionSaver::Offer(const CompanionSaveRecord& rec)
+{
+    if (m_hasOffered && memcmp(&rec, &m_offered, sizeof(rec)) == 0)
+        return;
+
+    m_offered = rec;
+    m_hasOffered = true;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending = rec;
+        m_dirty = true;
+    }
+    m_wake.notify_one();
+}
+
+void CompanionSaver::RequestStop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+}
+
+bool CompanionSaver::WaitStopped(uint32_t timeoutMs) const
+{
+    for (uint32_t waited = 0; m_running.load(std::memory_order_acquire); ++waited)
+    {
+        if (waited >= timeoutMs)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void CompanionSaver::Stop()
+{
+    RequestStop();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void CompanionSaver::Detach()
+{
+    if (m_thread.joinable())
+        m_thread.detach();
+}
+
+void CompanionSaver::Run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (;;)
+    {
+        m_wake.wait(lock, [this] { return m_dirty || m_stop; });
+
+        // Let a burst of changes settle into one write
+        if (!m_stop)
+            m_wake.wait_for(lock, std::chrono::milliseconds(kSettleMs), [this] { return m_stop; });
+
+        if (m_dirty)
+        {
+            CompanionSaveRecord rec = m_pending;
+            m_dirty = false;
+
+            lock.unlock();
+            if (CompanionSave::Write(m_path, rec))
+                m_writes.fetch_add(1, std::memory_order_relaxed);
+            else
+                m_failures.fetch_add(1, std::memory_order_relaxed);
+            lock.lock();
+        }
+
+        if (m_stop && !m_dirty)
+            break;
+    }
+
+    lock.unlock();
+    m_running.store(false, std::memory_order_release);
+}
@@ -0,0 +1,169 @@
+// ============================================================
+//  CompanionSave.h — Companion state kept across sessions
+// ============================================================
+//
+//  PURPOSE:
+//  Everything about the companion (mode, stay + its anchor,
+//  riding, spawned) lived in statics, so a game restart or an
+//  ASI reload started from "despawned, Protection, no stay".
+//  The host now packs that into a CompanionSaveRecord every
+//  frame and hands it to CompanionSaver; the record is written
+//  to CompanionMod.save when it changes, and read back once at
+//  startup.
+//
+//  FILE FORMAT:
+//    CompanionSaveHeader (16 bytes), then one CompanionSaveRecord.
+//    recordSize is stored in the header, like the tick trace:
+//    newer writers append fields, older readers ignore them, and
+//    fields missing from an older file read as 0. So a new field
+//    must treat 0 as "not saved". version only goes up for a
+//    change old readers can't skip; they reject the file.
+//    checksum (FNV-1a over the record bytes) rejects a damaged
+//    file instead of restoring garbage.
+//
+//  WRITING:
+//    main thread   Offer() every frame: a 32-byte compare, and on
+//                  a change a copy under a mutex + a wake-up
+//    saver thread  waits kSettleMs for the state to settle (F6
+//                  spam, spawn -> stay in a few frames = one
+//                  write), writes CompanionMod.save.tmp and
+//                  renames it over CompanionMod.save
+//
+//  The .tmp data is flushed to the disk before the rename, and
+//  the rename replaces the file in one step, so a crash, a kill
+//  or a power cut mid-write leaves the previous save, never half
+//  a file.
+//
+//  READING:
+//  Load() maps the file read-only and copies the record out; no
+//  buffered stream, one open + map + unmap at startup.
+//
+//  Engine-agnostic; builds on Linux (mmap / rename there).
+// ============================================================
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+struct CompanionSaveHeader
+{
+    uint32_t magic;          // kSaveMagic
+    uint16_t version;
+    uint16_t recordSize;     // sizeof(CompanionSaveRecord) of the writer
+    uint32_t checksum;       // FNV-1a over the recordSize record bytes
+    uint32_t reserved;
+};
+
+static constexpr uint32_t kSaveMagic = 0x56534D43;   // "CMSV"
+static constexpr uint16_t kSaveVersion = 1;
+
+enum CompanionSaveFlag : uint8_t
+{
+    SaveFlag_Spawned   = 1 << 0,     // out, or suspended by a mission while out
+    SaveFlag_Stay      = 1 << 1,     // stay toggle (the pre-mission one while suspended)
+    SaveFlag_HasAnchor = 1 << 2,     // stayAnchor is valid
+    SaveFlag_Riding    = 1 << 3      // in the player's vehicle
+};
+
+struct CompanionSaveRecord
+{
+    uint8_t  mode;                   // CompanionMode
+    uint8_t  flags;                  // CompanionSaveFlag
+    uint8_t  activity;               // CompanionActivity (informational)
+    uint8_t  pad;
+    float    stayAnchor[3];
+    int32_t  rideSeat;               // seat ridden, if SaveFlag_Riding
+    uint32_t reserved[3];
+};
+
+static_assert(sizeof(CompanionSaveRecord) == 32, "CompanionSaveRecord is a fixed 32-byte on-disk record");
+
+enum class SaveLoadResult : uint8_t
+{
+    Loaded,
+    Missing,                         // no file (first run)
+    Invalid,                         // bad magic / size / checksum
+    TooNew                           // a newer, incompatible version
+};
+
+inline const char* SaveLoadResultName(SaveLoadResult r)
+{
+    switch (r)
+    {
+    case SaveLoadResult::Loaded:  return "Loaded";
+    case SaveLoadResult::Missing: return "Missing";
+    case SaveLoadResult::Invalid: return "Invalid";
+    case SaveLoadResult::TooNew:  return "TooNew";
+    default:                      return "?";
+    }
+}
+
+namespace CompanionSave
+{
+    uint32_t Checksum(const void* data, uint32_t size);
+
+    // Maps `path` and copies its record into `out` (zeroed first)
+    SaveLoadResult Load(const char* path, CompanionSaveRecord& out);
+
+    // Writes `<path>.tmp`, then renames it over `path`
+    bool Write(const char* path, const CompanionSaveRecord& rec);
+}
+
+class CompanionSaver
+{
+public:
+    static constexpr uint32_t kSettleMs = 250;
+
+    ~CompanionSaver();
+
+    // Starts the saver thread. Nothing is written until the first
+    // Offer(). Main thread, once.
+    void Start(const char* path);
+
+    // Main thread, every frame. Cheap when nothing changed.
+    void Offer(const CompanionSaveRecord& rec);
+
+    // Asks the saver thread to write what's pending and exit;
+    // does not wait for it.
+    void RequestStop();
+
+    // Waits up to timeoutMs for the saver to finish its last write
+    // and leave its loop, without joining (what DllMain uses). True
+    // if it has, or never started.
+    bool WaitStopped(uint32_t timeoutMs) const;
+
+    // RequestStop + join. Not from DllMain.
+    void Stop();
+
+    // Lets go of the thread without waiting for it: after
+    // WaitStopped, or at process exit when it's already gone.
+    void Detach();
+
+    // Saver thread counters, for the heartbeat
+    uint32_t Writes() const { return m_writes.load(std::memory_order_relaxed); }
+    uint32_t Failures() const { return m_failures.load(std::memory_order_relaxed); }
+
+private:
+    void Run();
+
+    char m_path[260] = {};
+    std::thread m_thread;
+
+    // Main thread only
+    CompanionSaveRecord m_offered{};
+    bool m_hasOffered = false;
+
+    // Shared
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    CompanionSaveRecord m_pending{};
+    bool m_dirty = false;
+    bool m_stop = false;
+    std::atomic<bool> m_running{ false };       // cleared as the saver's last step
+
+    std::atomic<uint32_t> m_writes{ 0 };
+    std::atomic<uint32_t> m_failures{ 0 };
+};
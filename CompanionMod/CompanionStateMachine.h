@@ -0,0 +1,278 @@
+// ============================================================
+//  CompanionStateMachine.h — Table-driven companion lifecycle
+// ============================================================
+//
+//  PURPOSE:
+//  "Is the companion out? Are we in a mission? Staying? Riding?"
+//  used to be a pile of static bools in main.cpp, each with its
+//  own "was it different last frame?" copy. This file replaces
+//  them with ONE state value and two constexpr tables.
+//
+//  STATES (hierarchical — a child inherits its parent's
+//  transitions unless it overrides them):
+//
+//    Despawned
+//    Suspended                 (mission running)
+//      SuspendedWasActive      (respawn when the mission ends)
+//      SuspendedWasIdle        (stay despawned)
+//    Active                    (companion exists)
+//      Following   <- initial child
+//      Staying
+//      Riding
+//
+//  ACTIONS:
+//  Entering/leaving a state, and transitions themselves, emit
+//  CompanionAction bits. main.cpp executes them (natives live
+//  there, not here).
+//
+//  COST:
+//  Dispatch = one table lookup per level of the hierarchy (max
+//  2 here) + a few bit-ORs. Adding states or events grows the
+//  tables, not the per-tick work.
+//
+//  Engine-agnostic: included by CompanionCore.h.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+
+enum class CompanionActivity : uint8_t
+{
+    None,                   // "no state" marker (parent of top-level states)
+    Despawned,
+    Suspended,
+    SuspendedWasActive,
+    SuspendedWasIdle,
+    Active,
+    Following,
+    Staying,
+    Riding,
+    Count
+};
+
+enum class CompanionEvent : uint8_t
+{
+    MissionStarted,
+    MissionEnded,
+    Spawned,
+    Despawned,
+    StayOn,
+    StayOff,
+    Boarded,            // companion was warped into the player's vehicle
+    LeftVehicle,        // player is on foot
+    RideDesync,         // companion is not in the vehicle we think it is
+    Count
+};
+
+// Side effects for main.cpp to carry out. Several can fire in one
+// dispatch; main.cpp runs them in the order they're listed here.
+enum CompanionAction : uint16_t
+{
+    CompanionAction_None               = 0,
+    CompanionAction_ExitStay           = 1 << 0,   // unfreeze, drop anchor
+    CompanionAction_ClearRiding        = 1 << 1,   // forget latched vehicle/seat
+    CompanionAction_ReleaseFromVehicle = 1 << 2,   // teleport next to player
+    CompanionAction_MissionSuspend     = 1 << 3,   // remember inputs, log
+    CompanionAction_Despawn            = 1 << 4,
+    CompanionAction_MissionResume      = 1 << 5,   // restore inputs, log
+    CompanionAction_Respawn            = 1 << 6,
+    CompanionAction_EnterStay          = 1 << 7,   // capture anchor, freeze
+    CompanionAction_ResetTimers        = 1 << 8    // follow/teleport/ride attempts re-issue immediately
+};
+
+struct CompanionStateDef
+{
+    CompanionActivity id;
+    CompanionActivity parent;
+    CompanionActivity initialChild;    // None = leaf
+    uint16_t onEnter;
+    uint16_t onExit;
+    const char* name;
+};
+
+struct CompanionTransition
+{
+    CompanionActivity from;
+    CompanionEvent event;
+    CompanionActivity to;
+    uint16_t action;
+};
+
+namespace CompanionFsm
+{
+    using A = CompanionActivity;
+    using E = CompanionEvent;
+
+    // Indexed by CompanionActivity (checked below)
+    constexpr CompanionStateDef kStates[] =
+    {
+        { A::None,               A::None,      A::None,      0, 0, "None" },
+        { A::Despawned,          A::None,      A::None,      0, 0, "Despawned" },
+        { A::Suspended,          A::None,      A::None,
+            CompanionAction_MissionSuspend | CompanionAction_ResetTimers,
+            CompanionAction_MissionResume | CompanionAction_ResetTimers,
+            "Suspended" },
+        { A::SuspendedWasActive, A::Suspended, A::None,      0, 0, "Suspended.WasActive" },
+        { A::SuspendedWasIdle,   A::Suspended, A::None,      0, 0, "Suspended.WasIdle" },
+        { A::Active,             A::None,      A::Following, CompanionAction_ResetTimers, CompanionAction_ClearRiding, "Active" },
+        { A::Following,          A::Active,    A::None,      0, 0, "Active.Following" },
+        { A::Staying,            A::Active,    A::None,      CompanionAction_EnterStay, CompanionAction_ExitStay, "Active.Staying" },
+        { A::Riding,             A::Active,    A::None,      0, CompanionAction_ClearRiding, "Active.Riding" },
+    };
+
+    constexpr CompanionTransition kTransitions[] =
+    {
+        // Lifecycle
+        { A::Despawned,          E::Spawned,        A::Active,             0 },
+        { A::Active,             E::Despawned,      A::Despawned,          0 },
+
+        // Mission gate
+        { A::Despawned,          E::MissionStarted, A::SuspendedWasIdle,   0 },
+        { A::Active,             E::MissionStarted, A::SuspendedWasActive, CompanionAction_Despawn },
+        { A::SuspendedWasIdle,   E::MissionEnded,   A::Despawned,          0 },
+        { A::SuspendedWasActive, E::MissionEnded,   A::Despawned,          CompanionAction_Respawn },
+
+        // Stay
+        { A::Following,          E::StayOn,         A::Staying,            0 },
+        { A::Riding,             E::StayOn,         A::Staying,            CompanionAction_ReleaseFromVehicle },
+        { A::Staying,            E::StayOff,        A::Following,          0 },
+
+        // Vehicle riding
+        { A::Following,          E::Boarded,        A::Riding,             0 },
+        { A::Riding,             E::LeftVehicle,    A::Following,          CompanionAction_ReleaseFromVehicle },
+        { A::Riding,             E::RideDesync,     A::Following,          0 },
+    };
+
+    constexpr int kStateCount = (int)A::Count;
+    constexpr int kEventCount = (int)E::Count;
+    constexpr int kTransitionCount = (int)(sizeof(kTransitions) / sizeof(kTransitions[0]));
+
+    // --------------------------------------------------------
+    //  [state][event] -> transition index, built at compile time
+    // --------------------------------------------------------
+    struct Lookup
+    {
+        int8_t index[kStateCount][kEventCount];
+    };
+
+    constexpr Lookup BuildLookup()
+    {
+        Lookup t{};
+        for (int s = 0; s < kStateCount; ++s)
+            for (int e = 0; e < kEventCount; ++e)
+                t.index[s][e] = -1;
+
+        for (int i = 0; i < kTransitionCount; ++i)
+            t.index[(int)kTransitions[i].from][(int)kTransitions[i].event] = (int8_t)i;
+
+        return t;
+    }
+
+    constexpr Lookup kLookup = BuildLookup();
+
+    constexpr bool StatesInEnumOrder()
+    {
+        if ((int)(sizeof(kStates) / sizeof(kStates[0])) != kStateCount)
+            return false;
+        for (int i = 0; i < kStateCount; ++i)
+        {
+            if ((int)kStates[i].id != i)
+                return false;
+        }
+        return true;
+    }
+
+    static_assert(StatesInEnumOrder(), "kStates must list every CompanionActivity in enum order");
+    static_assert(kTransitionCount < 127, "transition index is int8_t");
+
+    inline const CompanionStateDef& Def(A s) { return kStates[(int)s]; }
+    inline const char* Name(A s) { return Def(s).name; }
+
+    inline int Depth(A s)
+    {
+        int d = 0;
+        for (A p = Def(s).parent; p != A::None; p = Def(p).parent)
+            d++;
+        return d;
+    }
+
+    // True if `s` is `ancestor` or one of its children.
+    inline bool IsIn(A s, A ancestor)
+    {
+        for (; s != A::None; s = Def(s).parent)
+        {
+            if (s == ancestor) return true;
+        }
+        return false;
+    }
+
+    // --------------------------------------------------------
+    //  Dispatch
+    // --------------------------------------------------------
+    //  Finds the transition on the current state or its nearest
+    //  ancestor, then: exit actions up to the common ancestor,
+    //  the transition's own action, entry actions down to the
+    //  target (drilling into initial children).
+    //
+    //  Events with no transition are ignored, so callers can
+    //  send level-style events ("stay is on") every tick.
+    //  Returns true if the state changed.
+    // --------------------------------------------------------
+    inline bool Dispatch(A& current, E event, uint16_t& actions)
+    {
+        int idx = -1;
+        for (A s = current; s != A::None && idx < 0; s = Def(s).parent)
+            idx = kLookup.index[(int)s][(int)event];
+
+        if (idx < 0)
+            return false;
+
+        const CompanionTransition& t = kTransitions[idx];
+
+        A target = t.to;
+        while (Def(target).initialChild != A::None)
+            target = Def(target).initialChild;
+
+        // Common ancestor of current and target
+        A from = current;
+        A to = target;
+        int df = Depth(from);
+        int dt = Depth(to);
+        while (df > dt) { from = Def(from).parent; df--; }
+        while (dt > df) { to = Def(to).parent; dt--; }
+        while (from != to) { from = Def(from).parent; to = Def(to).parent; }
+        const A common = from;
+
+        for (A s = current; s != common; s = Def(s).parent)
+            actions |= Def(s).onExit;
+
+        actions |= t.action;
+
+        for (A s = target; s != common; s = Def(s).parent)
+            actions |= Def(s).onEnter;
+
+        current = target;
+        return true;
+    }
+
+    // One line per transition, for logging the table.
+    // Returns false once i is past the end.
+    inline bool DescribeTransition(int i, const char*& from, const char*& event, const char*& to, uint16_t& action)
+    {
+        static const char* const kEventNames[kEventCount] =
+        {
+            "MissionStarted", "MissionEnded", "Spawned", "Despawned",
+            "StayOn", "StayOff", "Boarded", "LeftVehicle", "RideDesync"
+        };
+
+        if (i < 0 || i >= kTransitionCount)
+            return false;
+
+        const CompanionTransition& t = kTransitions[i];
+        from = Name(t.from);
+        event = kEventNames[(int)t.event];
+        to = Name(t.to);
+        action = t.action;
+        return true;
+    }
+}
@@ -42,6 +42,7 @@
 
 #include "types.h"
 #include "nativeCaller.h"
+#include "main.h"        // worldGetAllPeds / worldGetAllVehicles
 #include "EngineAdapter.h"
 #include "Logger.h"
 #include <Windows.h>
@@ -75,6 +76,7 @@ static const UINT64 HASH_DOES_ENTITY_EXIST                        = 0x7239B21A38
 static const UINT64 HASH_IS_PED_DEAD_OR_DYING                     = 0x3317DEDB88C95038;
 static const UINT64 HASH_IS_PED_IN_ANY_VEHICLE                    = 0x997ABD671D25CA0B;
 static const UINT64 HASH_GET_ENTITY_COORDS                        = 0x3FEF770D40960D5A;
+static const UINT64 HASH_GET_ENTITY_FORWARD_VECTOR                = 0x0A794A5A57F8DF91;
 
 static const UINT64 HASH_REQUEST_MODEL                            = 0x963D27A58DF860AC;
 static const UINT64 HASH_HAS_MODEL_LOADED                         = 0x98A4EB5D89A0C952;
@@ -93,18 +95,98 @@ static const UINT64 HASH_FREEZE_ENTITY_POSITION                   = 0x428CA6DBD1
 static const UINT64 HASH_SET_ENTITY_DYNAMIC                       = 0x1718DE8E3F2823CA;
 static const UINT64 HASH_CLEAR_PED_TASKS                          = 0xE1EF3C1216AFF2CD;
 static const UINT64 HASH_TASK_FOLLOW_TO_OFFSET_OF_ENTITY          = 0x304AE42E357B8C7E;
+static const UINT64 HASH_TASK_FLUSH_ROUTE                         = 0x841142A1376E9006;
+static const UINT64 HASH_TASK_EXTEND_ROUTE                        = 0x1E7889778264843A;
+static const UINT64 HASH_TASK_FOLLOW_POINT_ROUTE                  = 0x595583281858626E;
 
 static const UINT64 HASH_SET_ENTITY_COORDS_NO_OFFSET              = 0x239A3351AC1DA385;
 static const UINT64 HASH_SET_ENTITY_VELOCITY                      = 0x1C99BB7B6E96D16F;
 static const UINT64 HASH_CLEAR_PED_TASKS_IMMEDIATELY              = 0xAAA34F8A7CB32098;
+static const UINT64 HASH_IS_ENTITY_ON_SCREEN                      = 0xE659E47AF827484B;
+static const UINT64 HASH_IS_ENTITY_A_MISSION_ENTITY               = 0x0A7B270912999B3C;
+
+// Ground / water / shape tests (teleport destination search)
+static const UINT64 HASH_GET_GROUND_Z_FOR_3D_COORD                = 0xC906A7DAB05C8D2B;
+static const UINT64 HASH_GET_WATER_HEIGHT_NO_WAVES                = 0x8EE6B53CE13A9794;
+static const UINT64 HASH_START_SHAPE_TEST_CAPSULE                 = 0x28579D1B8F8AAC80;
+static const UINT64 HASH_GET_SHAPE_TEST_RESULT                    = 0x3D87450E15D98694;
+
+// Stay anchor (drift correction)
+static const UINT64 HASH_IS_EXPLOSION_IN_SPHERE                   = 0xAB0F816885B0E483;
 
 // Vehicle
 static const UINT64 HASH_GET_VEHICLE_PED_IS_IN                    = 0x9A9112A0FE9A4713;
 static const UINT64 HASH_IS_VEHICLE_SEAT_FREE                     = 0x22AC59A870E6A669;
 static const UINT64 HASH_SET_PED_INTO_VEHICLE                     = 0xF75B0D629E1C063D;
+static const UINT64 HASH_GET_VEHICLE_PED_IS_TRYING_TO_ENTER       = 0x814FA8BE5449445D;
+static const UINT64 HASH_GET_VEHICLE_NUMBER_OF_PASSENGERS         = 0x24CB2137731FFE89;
+
+// Threat sampling / combat
+static const UINT64 HASH_GET_RELATIONSHIP_BETWEEN_PEDS            = 0xEBA5AD3A0EAF7121;
+static const UINT64 HASH_IS_PED_IN_COMBAT                         = 0x4859F1FC66A6278E;
+static const UINT64 HASH_IS_PED_ARMED                             = 0x475768A975D5AD17;
+static const UINT64 HASH_IS_PED_FACING_PED                        = 0xD71649DB0A545AA3;
+static const UINT64 HASH_HAS_ENTITY_BEEN_DAMAGED_BY_ENTITY        = 0xC86D67D52A707CF8;
+static const UINT64 HASH_TASK_COMBAT_PED                          = 0xF166E48407BAC484;
+
+// ============================================================
+//  COUNTED INVOKES
+// ============================================================
+//  Every native below goes through one of these instead of
+//  invoke<>() directly, so the per-frame cost report
+//  (NativeBudget.h) sees every call, split by what it does:
+//
+//      invokeQuery     reads        (DOES_ENTITY_EXIST, coords, ...)
+//      invokeMutation  writes       (coords, freeze, create/delete)
+//      invokeTask      AI tasks     (follow, combat, clear tasks)
+//      invokeDraw      text drawing
+//
+//  The counter is one increment on a static — nothing next to
+//  the cost of the native itself.
+// ============================================================
+
+static NativeFrameCounts g_frameNatives;
+
+template <typename R, typename... Args>
+static inline R invokeQuery(UINT64 hash, Args... args)
+{
+    g_frameNatives.Add(NativeCategory::Query);
+    return invoke<R>(hash, args...);
+}
+
+template <typename R, typename... Args>
+static inline R invokeMutation(UINT64 hash, Args... args)
+{
+    g_frameNatives.Add(NativeCategory::Mutation);
+    return invoke<R>(hash, args...);
+}
+
+template <typename R, typename... Args>
+static inline R invokeTask(UINT64 hash, Args... args)
+{
+    g_frameNatives.Add(NativeCategory::Task);
+    return invoke<R>(hash, args...);
+}
+
+template <typename R, typename... Args>
+static inline R invokeDraw(UINT64 hash, Args... args)
+{
+    g_frameNatives.Add(NativeCategory::Draw);
+    return invoke<R>(hash, args...);
+}
 
 namespace EngineAdapter
 {
+    // --------------------------------------------------------
+    //  TakeFrameNativeCounts
+    // --------------------------------------------------------
+    NativeFrameCounts TakeFrameNativeCounts()
+    {
+        NativeFrameCounts out = g_frameNatives;
+        g_frameNatives = NativeFrameCounts{};
+        return out;
+    }
+
     // --------------------------------------------------------
     //  IsMissionActive
     // --------------------------------------------------------
@@ -115,7 +197,27 @@ namespace EngineAdapter
     // --------------------------------------------------------
     bool IsMissionActive()
     {
-        return invoke<BOOL>(HASH_GET_MISSION_FLAG) != 0;
+        return invokeQuery<BOOL>(HASH_GET_MISSION_FLAG) != 0;
+    }
+
+    // --------------------------------------------------------
+    //  SampleWorld
+    // --------------------------------------------------------
+    //  PLAYER_PED_ID once instead of once per query, and the
+    //  vehicle handle only when the player is actually in one.
+    // --------------------------------------------------------
+    void SampleWorld(WorldSample& out)
+    {
+        out.missionActive = invokeQuery<BOOL>(HASH_GET_MISSION_FLAG) != 0;
+
+        Ped p = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
+        out.playerExists = (p != 0) && invokeQuery<BOOL>(HASH_DOES_ENTITY_EXIST, p) != 0;
+        out.playerDead = !out.playerExists || invokeQuery<BOOL>(HASH_IS_PED_DEAD_OR_DYING, p, TRUE) != 0;
+        out.playerInVehicle = out.playerExists && invokeQuery<BOOL>(HASH_IS_PED_IN_ANY_VEHICLE, p, FALSE) != 0;
+        out.playerVehicle = out.playerInVehicle ? (int)invokeQuery<Vehicle>(HASH_GET_VEHICLE_PED_IS_IN, p, FALSE) : 0;
+
+        out.companionExists = DoesTestPedExist();
+        out.companionDead = out.companionExists && invokeQuery<BOOL>(HASH_IS_PED_DEAD_OR_DYING, g_testPed, TRUE) != 0;
     }
 
     // --------------------------------------------------------
@@ -133,74 +235,87 @@ namespace EngineAdapter
     // --------------------------------------------------------
     void DrawDebugText(const char* text, float x, float y)
     {
-        invoke<Void>(HASH_SET_TEXT_FONT, 0);
-        invoke<Void>(HASH_SET_TEXT_SCALE, 0.0f, 0.35f);
-        invoke<Void>(HASH_SET_TEXT_COLOUR, 255, 255, 255, 255);
-        invoke<Void>(HASH_BEGIN_TEXT_COMMAND_DISPLAY_TEXT, "STRING");
-        invoke<Void>(HASH_ADD_TEXT_COMPONENT_SUBSTRING_PLAYER_NAME, text);
-        invoke<Void>(HASH_END_TEXT_COMMAND_DISPLAY_TEXT, x, y, 0);
+        invokeDraw<Void>(HASH_SET_TEXT_FONT, 0);
+        invokeDraw<Void>(HASH_SET_TEXT_SCALE, 0.0f, 0.35f);
+        invokeDraw<Void>(HASH_SET_TEXT_COLOUR, 255, 255, 255, 255);
+        invokeDraw<Void>(HASH_BEGIN_TEXT_COMMAND_DISPLAY_TEXT, "STRING");
+        invokeDraw<Void>(HASH_ADD_TEXT_COMPONENT_SUBSTRING_PLAYER_NAME, text);
+        invokeDraw<Void>(HASH_END_TEXT_COMMAND_DISPLAY_TEXT, x, y, 0);
     }
 
     bool PlayerExists()
     {
-        Ped p = invoke<Ped>(HASH_PLAYER_PED_ID);
+        Ped p = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
         if (p == 0) return false;
-        return invoke<BOOL>(HASH_DOES_ENTITY_EXIST, p) != 0;
+        return invokeQuery<BOOL>(HASH_DOES_ENTITY_EXIST, p) != 0;
     }
 
     bool IsPlayerDead()
     {
-        Ped p = invoke<Ped>(HASH_PLAYER_PED_ID);
+        Ped p = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
         if (p == 0) return true;
-        return invoke<BOOL>(HASH_IS_PED_DEAD_OR_DYING, p, TRUE) != 0;
+        return invokeQuery<BOOL>(HASH_IS_PED_DEAD_OR_DYING, p, TRUE) != 0;
     }
 
     bool IsPlayerInVehicle()
     {
-        Ped p = invoke<Ped>(HASH_PLAYER_PED_ID);
+        Ped p = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
         if (p == 0) return false;
-        return invoke<BOOL>(HASH_IS_PED_IN_ANY_VEHICLE, p, FALSE) != 0;
+        return invokeQuery<BOOL>(HASH_IS_PED_IN_ANY_VEHICLE, p, FALSE) != 0;
     }
 
     Vec3 GetPlayerPosition()
     {
         Vec3 out{};
-        Ped p = invoke<Ped>(HASH_PLAYER_PED_ID);
+        Ped p = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
         if (p == 0) return out;
 
         // native returns a Vector3 from types.h
-        Vector3 v = invoke<Vector3>(HASH_GET_ENTITY_COORDS, p, TRUE);
+        Vector3 v = invokeQuery<Vector3>(HASH_GET_ENTITY_COORDS, p, TRUE);
         out.x = v.x;
         out.y = v.y;
         out.z = v.z;
         return out;
     }
 
-    bool SpawnTestPed()
+    Vec3 GetPlayerForwardVector()
     {
-        // Already spawned?
-        if (g_testPed != 0 && invoke<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed))
-            return true;
+        Vec3 out{ 0.0f, 1.0f, 0.0f };
+        Ped p = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
+        if (p == 0) return out;
+
+        Vector3 v = invokeQuery<Vector3>(HASH_GET_ENTITY_FORWARD_VECTOR, p);
+        out.x = v.x;
+        out.y = v.y;
+        out.z = v.z;
+        return out;
+    }
 
+    uint32_t RequestCompanionModel()
+    {
         // Example model: a common ambient ped
         // "a_m_m_business_01"
         const Hash model = 0x7E6A64B7;
 
-        invoke<void>(HASH_REQUEST_MODEL, model);
+        invokeMutation<void>(HASH_REQUEST_MODEL, model);
+        return model;
+    }
 
-        // Wait up to ~2 seconds (120 frames)
-        for (int i = 0; i < 120; ++i)
-        {
-            if (invoke<BOOL>(HASH_HAS_MODEL_LOADED, model))
-                break;
-            WAIT(0);
-        }
+    bool IsModelLoaded(uint32_t model)
+    {
+        return invokeQuery<BOOL>(HASH_HAS_MODEL_LOADED, (Hash)model) != 0;
+    }
 
-        if (!invoke<BOOL>(HASH_HAS_MODEL_LOADED, model))
-        {
-            invoke<void>(HASH_SET_MODEL_AS_NO_LONGER_NEEDED, model);
-            return false;
-        }
+    void ReleaseModel(uint32_t model)
+    {
+        invokeMutation<void>(HASH_SET_MODEL_AS_NO_LONGER_NEEDED, (Hash)model);
+    }
+
+    bool CreateTestPed(uint32_t model)
+    {
+        // Already spawned?
+        if (g_testPed != 0 && invokeQuery<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed))
+            return true;
 
         Vec3 p = GetPlayerPosition();
 
@@ -211,25 +326,24 @@ namespace EngineAdapter
         // pedType: 4 = CIVMALE, usually safe for ambient peds
         const int pedType = 4;
 
-        g_testPed = invoke<Ped>(HASH_CREATE_PED, pedType, model, x, y, z, 0.0f, TRUE, TRUE);
+        g_testPed = invokeMutation<Ped>(HASH_CREATE_PED, pedType, (Hash)model, x, y, z, 0.0f, TRUE, TRUE);
 
-        if (g_testPed == 0 || !invoke<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed))
+        if (g_testPed == 0 || !invokeQuery<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed))
             return false;
 
-        invoke<void>(HASH_FREEZE_ENTITY_POSITION, g_testPed, FALSE);
-        invoke<void>(HASH_SET_ENTITY_DYNAMIC, g_testPed, TRUE);
+        invokeMutation<void>(HASH_FREEZE_ENTITY_POSITION, g_testPed, FALSE);
+        invokeMutation<void>(HASH_SET_ENTITY_DYNAMIC, g_testPed, TRUE);
 
         // Mark as ours so we can delete cleanly
-        invoke<void>(HASH_SET_ENTITY_AS_MISSION_ENTITY, g_testPed, TRUE, TRUE);
+        invokeMutation<void>(HASH_SET_ENTITY_AS_MISSION_ENTITY, g_testPed, TRUE, TRUE);
 
         // Make it "dumb" so it doesn't flee / do random ambient behavior
-        invoke<void>(HASH_SET_BLOCKING_OF_NON_TEMPORARY_EVENTS, g_testPed, TRUE);
-        invoke<void>(HASH_SET_PED_FLEE_ATTRIBUTES, g_testPed, 0, FALSE);
+        invokeMutation<void>(HASH_SET_BLOCKING_OF_NON_TEMPORARY_EVENTS, g_testPed, TRUE);
+        invokeMutation<void>(HASH_SET_PED_FLEE_ATTRIBUTES, g_testPed, 0, FALSE);
         // Disable a couple combat attributes so it doesn’t pick fights
-        invoke<void>(HASH_SET_PED_COMBAT_ATTRIBUTES, g_testPed, 46, FALSE); // BF_CanFightArmedPeds (common)
-        invoke<void>(HASH_SET_PED_COMBAT_ATTRIBUTES, g_testPed, 17, FALSE); // BF_AlwaysFight (common)
+        invokeMutation<void>(HASH_SET_PED_COMBAT_ATTRIBUTES, g_testPed, 46, FALSE); // BF_CanFightArmedPeds (common)
+        invokeMutation<void>(HASH_SET_PED_COMBAT_ATTRIBUTES, g_testPed, 17, FALSE); // BF_AlwaysFight (common)
 
-        invoke<void>(HASH_SET_MODEL_AS_NO_LONGER_NEEDED, model);
         return true;
     }
 
@@ -239,55 +353,72 @@ namespace EngineAdapter
             return;
 
         // Log before
-        BOOL existsBefore = invoke<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed);
+        BOOL existsBefore = invokeQuery<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed);
         Logger::Log("[Adapter] DespawnTestPed handle=%d existsBefore=%d", (int)g_testPed, (int)existsBefore);
 
         if (existsBefore)
         {
             // Make sure we "own" it
-            invoke<void>(HASH_SET_ENTITY_AS_MISSION_ENTITY, g_testPed, TRUE, TRUE);
+            invokeMutation<void>(HASH_SET_ENTITY_AS_MISSION_ENTITY, g_testPed, TRUE, TRUE);
 
             // Delete as PED (more reliable than DELETE_ENTITY)
             Ped p = g_testPed;
-            invoke<void>(HASH_DELETE_PED, &p);
+            invokeMutation<void>(HASH_DELETE_PED, &p);
         }
 
         // Log after (note: g_testPed is our stored handle, so this checks whether it’s still alive)
-        BOOL existsAfter = invoke<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed);
+        BOOL existsAfter = invokeQuery<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed);
         Logger::Log("[Adapter] DespawnTestPed existsAfter=%d", (int)existsAfter);
 
         g_testPed = 0;
     }
 
-    void TaskFollowPlayer(float followDist, float speed)
+    void TaskFollowPlayer(float offsetX, float offsetY, float stoppingRange, float speed)
     {
         if (g_testPed == 0) return;
-        if (!invoke<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed)) return;
+        if (!invokeQuery<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed)) return;
 
-        Ped player = invoke<Ped>(HASH_PLAYER_PED_ID);
+        Ped player = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
         if (player == 0) return;
 
         // Make sure ped is not stuck/frozen
-        invoke<void>(HASH_FREEZE_ENTITY_POSITION, g_testPed, FALSE);
+        invokeMutation<void>(HASH_FREEZE_ENTITY_POSITION, g_testPed, FALSE);
 
-        // Follow slightly behind/right for now
-        float offX = 0.5f;
-        float offY = -followDist;
-        float offZ = 0.0f;
-
-        // speed=2.0, timeout=-1, stoppingRange=followDist, persistFollowing=true
-        invoke<void>(
+        // Offsets are in the player's frame: +X = right, +Y = where they face
+        invokeTask<void>(
             HASH_TASK_FOLLOW_TO_OFFSET_OF_ENTITY,
             g_testPed,
             player,
-            offX, offY, offZ,
+            offsetX, offsetY, 0.0f,
             speed,    // speed
             -1,      // timeout
-            followDist, // stopping range
+            stoppingRange, // stopping range
             TRUE     // persist
         );
     }
 
+    // --------------------------------------------------------
+    //  TaskFollowRoute
+    // --------------------------------------------------------
+    //  The route is global script state: flush, extend point by
+    //  point, then hand it to the ped, all in the same frame.
+    //  The game holds up to 8 points. Mode 0 walks it once,
+    //  first to last.
+    // --------------------------------------------------------
+    void TaskFollowRoute(const Vec3* points, uint32_t count, float speed)
+    {
+        if (!DoesTestPedExist() || count == 0) return;
+        if (count > kMaxRoutePoints) count = kMaxRoutePoints;
+
+        invokeMutation<void>(HASH_FREEZE_ENTITY_POSITION, g_testPed, FALSE);
+
+        invokeTask<void>(HASH_TASK_FLUSH_ROUTE);
+        for (uint32_t i = 0; i < count; ++i)
+            invokeTask<void>(HASH_TASK_EXTEND_ROUTE, points[i].x, points[i].y, points[i].z);
+
+        invokeTask<void>(HASH_TASK_FOLLOW_POINT_ROUTE, g_testPed, speed, 0);
+    }
+
     bool IsKeyJustPressed(int vk)
     {
         static SHORT prev[256] = {};
@@ -302,7 +433,7 @@ namespace EngineAdapter
 
     bool DoesTestPedExist()
     {
-        return (g_testPed != 0) && invoke<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed);
+        return (g_testPed != 0) && invokeQuery<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed);
     }
 
     Vec3 GetTestPedPosition()
@@ -310,7 +441,7 @@ namespace EngineAdapter
         Vec3 out{};
         if (!DoesTestPedExist()) return out;
 
-        Vector3 v = invoke<Vector3>(HASH_GET_ENTITY_COORDS, g_testPed, TRUE);
+        Vector3 v = invokeQuery<Vector3>(HASH_GET_ENTITY_COORDS, g_testPed, TRUE);
         out.x = v.x;
         out.y = v.y;
         out.z = v.z;
@@ -322,48 +453,124 @@ namespace EngineAdapter
         if (!DoesTestPedExist()) return;
 
         // Teleport without physics offsets
-        invoke<void>(HASH_SET_ENTITY_COORDS_NO_OFFSET, g_testPed, pos.x, pos.y, pos.z, TRUE, TRUE, TRUE);
+        invokeMutation<void>(HASH_SET_ENTITY_COORDS_NO_OFFSET, g_testPed, pos.x, pos.y, pos.z, TRUE, TRUE, TRUE);
 
         // Kill velocity so it doesn’t slide or pop
-        invoke<void>(HASH_SET_ENTITY_VELOCITY, g_testPed, 0.0f, 0.0f, 0.0f);
+        invokeMutation<void>(HASH_SET_ENTITY_VELOCITY, g_testPed, 0.0f, 0.0f, 0.0f);
+    }
+
+    bool IsTestPedOnScreen()
+    {
+        if (!DoesTestPedExist()) return false;
+        return invokeQuery<BOOL>(HASH_IS_ENTITY_ON_SCREEN, g_testPed) != 0;
+    }
+
+    // --------------------------------------------------------
+    //  IsExplosionNear
+    // --------------------------------------------------------
+    //  Explosion type -1 = any kind. Polled by the stay drift
+    //  check (StayDrift.h) every few seconds at most.
+    // --------------------------------------------------------
+    bool IsExplosionNear(const Vec3& center, float radius)
+    {
+        return invokeQuery<BOOL>(HASH_IS_EXPLOSION_IN_SPHERE, -1, center.x, center.y, center.z, radius) != 0;
     }
 
     void TeleportTestPedNearPlayer(float offsetX, float offsetY, float offsetZ)
     {
         if (!DoesTestPedExist()) return;
 
-        Ped player = invoke<Ped>(HASH_PLAYER_PED_ID);
+        Ped player = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
         if (player == 0) return;
 
         Vec3 p = GetPlayerPosition();
+        TeleportTestPedTo(Vec3{ p.x + offsetX, p.y + offsetY, p.z + offsetZ });
+    }
 
-        float x = p.x + offsetX;
-        float y = p.y + offsetY;
-        float z = p.z + offsetZ;
+    void TeleportTestPedTo(const Vec3& pos)
+    {
+        if (!DoesTestPedExist()) return;
 
         // Stop whatever it was doing (prevents weird “rubberband” tasks)
-        invoke<void>(HASH_CLEAR_PED_TASKS_IMMEDIATELY, g_testPed);
+        invokeTask<void>(HASH_CLEAR_PED_TASKS_IMMEDIATELY, g_testPed);
 
         // Teleport without physics offsets
-        invoke<void>(HASH_SET_ENTITY_COORDS_NO_OFFSET, g_testPed, x, y, z, TRUE, TRUE, TRUE);
+        invokeMutation<void>(HASH_SET_ENTITY_COORDS_NO_OFFSET, g_testPed, pos.x, pos.y, pos.z, TRUE, TRUE, TRUE);
 
         // Kill velocity so it doesn’t slide or pop
-        invoke<void>(HASH_SET_ENTITY_VELOCITY, g_testPed, 0.0f, 0.0f, 0.0f);
+        invokeMutation<void>(HASH_SET_ENTITY_VELOCITY, g_testPed, 0.0f, 0.0f, 0.0f);
 
         // Make sure it’s not frozen
-        invoke<void>(HASH_FREEZE_ENTITY_POSITION, g_testPed, FALSE);
+        invokeMutation<void>(HASH_FREEZE_ENTITY_POSITION, g_testPed, FALSE);
+    }
+
+    // --------------------------------------------------------
+    //  Teleport destination probes
+    // --------------------------------------------------------
+    //  GET_GROUND_Z_FOR_3D_COORD only finds ground where
+    //  collision is streamed in, which near the player it is;
+    //  "not found" further out is a rejected candidate, not an
+    //  error. The water height is read without waves so a
+    //  swell doesn't flip a beach spot back and forth.
+    //
+    //  Shape tests are asynchronous: START_* queues the test
+    //  for the physics update and returns a handle; the result
+    //  is read with GET_SHAPE_TEST_RESULT on a later frame
+    //  (1 = not ready, 2 = ready, 0 = handle no longer valid).
+    // --------------------------------------------------------
+    static const int SHAPE_TEST_FLAGS = 1 | 2 | 16;     // map, vehicles, objects (not peds)
+
+    GroundSample SampleGround(float x, float y, float zTop)
+    {
+        GroundSample out;
+
+        float groundZ = 0.0f;
+        out.found = invokeQuery<BOOL>(HASH_GET_GROUND_Z_FOR_3D_COORD, x, y, zTop, &groundZ, FALSE, FALSE) != 0;
+        out.groundZ = groundZ;
+
+        float waterZ = 0.0f;
+        out.water = invokeQuery<BOOL>(HASH_GET_WATER_HEIGHT_NO_WAVES, x, y, zTop, &waterZ) != 0;
+        out.waterZ = waterZ;
+        return out;
+    }
+
+    int StartClearanceProbe(const Vec3& from, const Vec3& to, float radius)
+    {
+        // The capsule starts inside the player. Peds aren't in the
+        // flags, but vehicles are: in a car (recall, release on
+        // Stay) every probe would hit the player's own car, so
+        // that is the entity to ignore.
+        Ped player = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
+        Vehicle vehicle = invokeQuery<Vehicle>(HASH_GET_VEHICLE_PED_IS_IN, player, FALSE);
+        Entity ignore = (vehicle != 0) ? (Entity)vehicle : (Entity)player;
+
+        return invokeQuery<int>(HASH_START_SHAPE_TEST_CAPSULE,
+            from.x, from.y, from.z, to.x, to.y, to.z, radius,
+            SHAPE_TEST_FLAGS, ignore, 7);
+    }
+
+    ProbeStatus PollClearanceProbe(int handle)
+    {
+        BOOL hit = FALSE;
+        Vector3 end{}, normal{};
+        Entity entity = 0;
+
+        int state = invokeQuery<int>(HASH_GET_SHAPE_TEST_RESULT, handle, &hit, &end, &normal, &entity);
+        if (state == 1) return ProbeStatus::Pending;
+        if (state != 2) return ProbeStatus::Failed;
+        return hit ? ProbeStatus::Blocked : ProbeStatus::Clear;
     }
 
     void ClearTestPedTasks()
     {
         if (!DoesTestPedExist()) return;
-        invoke<void>(HASH_CLEAR_PED_TASKS_IMMEDIATELY, g_testPed);
+        invokeTask<void>(HASH_CLEAR_PED_TASKS_IMMEDIATELY, g_testPed);
     }
 
     void FreezeTestPed(bool freeze)
     {
         if (!DoesTestPedExist()) return;
-        invoke<void>(HASH_FREEZE_ENTITY_POSITION, g_testPed, freeze ? TRUE : FALSE);
+        invokeMutation<void>(HASH_FREEZE_ENTITY_POSITION, g_testPed, freeze ? TRUE : FALSE);
     }
 
     // ============================================================
@@ -372,11 +579,11 @@ namespace EngineAdapter
 
     int GetPlayerVehicleHandle()
     {
-        Ped player = invoke<Ped>(HASH_PLAYER_PED_ID);
+        Ped player = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
         if (player == 0) return 0;
 
         // p1=false: current vehicle only (not last vehicle)
-        Vehicle v = invoke<Vehicle>(HASH_GET_VEHICLE_PED_IS_IN, player, FALSE);
+        Vehicle v = invokeQuery<Vehicle>(HASH_GET_VEHICLE_PED_IS_IN, player, FALSE);
         return (int)v;
     }
 
@@ -384,7 +591,7 @@ namespace EngineAdapter
     {
         if (vehicleHandle == 0) return false;
         Vehicle v = (Vehicle)vehicleHandle;
-        return invoke<BOOL>(HASH_IS_VEHICLE_SEAT_FREE, v, seatIndex) != 0;
+        return invokeQuery<BOOL>(HASH_IS_VEHICLE_SEAT_FREE, v, seatIndex) != 0;
     }
 
     bool PutTestPedIntoVehicle(int vehicleHandle, int seatIndex)
@@ -395,16 +602,16 @@ namespace EngineAdapter
         Vehicle v = (Vehicle)vehicleHandle;
 
         // Clear tasks first to avoid the ped fighting the warp.
-        invoke<void>(HASH_CLEAR_PED_TASKS_IMMEDIATELY, g_testPed);
+        invokeTask<void>(HASH_CLEAR_PED_TASKS_IMMEDIATELY, g_testPed);
 
         // Ensure not frozen (Stay mode freezes position).
-        invoke<void>(HASH_FREEZE_ENTITY_POSITION, g_testPed, FALSE);
+        invokeMutation<void>(HASH_FREEZE_ENTITY_POSITION, g_testPed, FALSE);
 
         // Warp instantly into the seat.
-        invoke<void>(HASH_SET_PED_INTO_VEHICLE, g_testPed, v, seatIndex);
+        invokeMutation<void>(HASH_SET_PED_INTO_VEHICLE, g_testPed, v, seatIndex);
 
         // Basic sanity: ped should still exist after.
-        return invoke<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed) != 0;
+        return invokeQuery<BOOL>(HASH_DOES_ENTITY_EXIST, g_testPed) != 0;
     }
 
     // ============================================================
@@ -413,7 +620,153 @@ namespace EngineAdapter
     int GetTestPedVehicleHandle()
     {
         if (!DoesTestPedExist()) return 0;
-        Vehicle v = invoke<Vehicle>(HASH_GET_VEHICLE_PED_IS_IN, g_testPed, FALSE);
+        Vehicle v = invokeQuery<Vehicle>(HASH_GET_VEHICLE_PED_IS_IN, g_testPed, FALSE);
         return (int)v;
     }
+
+    // --------------------------------------------------------
+    //  GetVehiclePlayerIsEntering / GetVehiclePassengerCount
+    // --------------------------------------------------------
+    //  Read by the ride phases (VehicleRide.h): the first only
+    //  while a vehicle is near the player on foot, the second
+    //  only while the companion is waiting for a seat.
+    // --------------------------------------------------------
+    int GetVehiclePlayerIsEntering()
+    {
+        Ped player = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
+        if (player == 0) return 0;
+
+        Vehicle v = invokeQuery<Vehicle>(HASH_GET_VEHICLE_PED_IS_TRYING_TO_ENTER, player);
+        return (int)v;
+    }
+
+    int GetVehiclePassengerCount(int vehicleHandle)
+    {
+        if (vehicleHandle == 0) return 0;
+        return invokeQuery<int>(HASH_GET_VEHICLE_NUMBER_OF_PASSENGERS, (Vehicle)vehicleHandle);
+    }
+
+    // ============================================================
+    // NEARBY ENTITIES
+    // ============================================================
+    //  worldGetAllPeds/Vehicles copy the game's entity pools into
+    //  our array (no natives). Every pool entity then costs one
+    //  GET_ENTITY_COORDS before the radius test: there is no
+    //  cheaper native that tells near from far. The walk stops
+    //  once the caller's buffer is full.
+    // ============================================================
+    static const int kPoolSnapshotSize = 1024;
+
+    static int CollectNearby(const int* pool, int poolCount, Entity skipA, Entity skipB,
+        float radius, int* outHandles, Vec3* outPositions, int maxCount)
+    {
+        Vec3 c = GetPlayerPosition();
+        const float r2 = radius * radius;
+
+        int written = 0;
+        for (int i = 0; i < poolCount && written < maxCount; ++i)
+        {
+            Entity e = pool[i];
+            if (e == 0 || e == skipA || e == skipB) continue;
+
+            Vector3 v = invokeQuery<Vector3>(HASH_GET_ENTITY_COORDS, e, TRUE);
+            float dx = v.x - c.x;
+            float dy = v.y - c.y;
+            float dz = v.z - c.z;
+            if (dx * dx + dy * dy + dz * dz > r2) continue;
+
+            outHandles[written] = (int)e;
+            outPositions[written] = Vec3{ v.x, v.y, v.z };
+            written++;
+        }
+        return written;
+    }
+
+    int GetNearbyPeds(float radius, int* outHandles, Vec3* outPositions, int maxCount)
+    {
+        static int s_pool[kPoolSnapshotSize];
+
+        Ped player = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
+        if (player == 0) return 0;
+
+        int n = worldGetAllPeds(s_pool, kPoolSnapshotSize);
+        return CollectNearby(s_pool, n, player, g_testPed, radius, outHandles, outPositions, maxCount);
+    }
+
+    int GetNearbyVehicles(float radius, int* outHandles, Vec3* outPositions, int maxCount)
+    {
+        static int s_pool[kPoolSnapshotSize];
+
+        Ped player = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
+        if (player == 0) return 0;
+
+        int n = worldGetAllVehicles(s_pool, kPoolSnapshotSize);
+        return CollectNearby(s_pool, n, 0, 0, radius, outHandles, outPositions, maxCount);
+    }
+
+    bool IsPedDead(int pedHandle)
+    {
+        if (pedHandle == 0) return true;
+        return invokeQuery<BOOL>(HASH_IS_PED_DEAD_OR_DYING, (Ped)pedHandle, TRUE) != 0;
+    }
+
+    bool IsMissionEntity(int entityHandle)
+    {
+        if (entityHandle == 0) return false;
+        return invokeQuery<BOOL>(HASH_IS_ENTITY_A_MISSION_ENTITY, (Entity)entityHandle) != 0;
+    }
+
+    // ============================================================
+    // PROTECTION
+    // ============================================================
+
+    PedThreatInfo QueryPedThreat(int pedHandle)
+    {
+        PedThreatInfo info{};
+
+        Ped ped = (Ped)pedHandle;
+        Ped player = invokeQuery<Ped>(HASH_PLAYER_PED_ID);
+        if (ped == 0 || player == 0) return info;
+
+        info.exists = invokeQuery<BOOL>(HASH_DOES_ENTITY_EXIST, ped) != 0;
+        if (!info.exists) return info;
+
+        info.dead = invokeQuery<BOOL>(HASH_IS_PED_DEAD_OR_DYING, ped, TRUE) != 0;
+        if (info.dead) return info;
+
+        // Relationship: 4 = dislike, 5 = hate
+        int rel = invokeQuery<int>(HASH_GET_RELATIONSHIP_BETWEEN_PEDS, ped, player);
+        info.hostile = (rel == 4 || rel == 5);
+        info.inCombatWithPlayer = invokeQuery<BOOL>(HASH_IS_PED_IN_COMBAT, ped, player) != 0;
+        info.damagedPlayer = invokeQuery<BOOL>(HASH_HAS_ENTITY_BEEN_DAMAGED_BY_ENTITY, player, ped, TRUE) != 0;
+
+        // Not hostile, not fighting, hasn't hurt us: skip the rest
+        if (!info.hostile && !info.inCombatWithPlayer && !info.damagedPlayer)
+            return info;
+
+        // IS_PED_ARMED flags: 1 = melee, 2 = explosives, 4 = guns
+        if (invokeQuery<BOOL>(HASH_IS_PED_ARMED, ped, 6) != 0)
+            info.weapon = WeaponClass::Gun;
+        else if (invokeQuery<BOOL>(HASH_IS_PED_ARMED, ped, 1) != 0)
+            info.weapon = WeaponClass::Melee;
+
+        // No direct "is aiming at" native for NPCs: fighting us with
+        // a gun while facing us (within 20 degrees) is close enough.
+        if (info.inCombatWithPlayer && info.weapon == WeaponClass::Gun)
+            info.aimingAtPlayer = invokeQuery<BOOL>(HASH_IS_PED_FACING_PED, ped, player, 20.0f) != 0;
+
+        return info;
+    }
+
+    void TaskCombatPed(int pedHandle)
+    {
+        if (!DoesTestPedExist()) return;
+        if (pedHandle == 0) return;
+
+        // Stay mode freezes position; make sure we can move
+        invokeMutation<void>(HASH_FREEZE_ENTITY_POSITION, g_testPed, FALSE);
+
+        // p2 = 0, p3 = 16 (standard "fight this ped" flags)
+        invokeTask<void>(HASH_TASK_COMBAT_PED, g_testPed, (Ped)pedHandle, 0, 16);
+    }
 }
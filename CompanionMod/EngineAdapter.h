@@ -44,9 +44,18 @@
 #pragma once  // Ensures this file is only included once per compilation
 
 #include "CompanionCore.h"
+#include "NativeBudget.h"
+#include "TeleportSearch.h"
 
 namespace EngineAdapter
 {
+    // --- COST ACCOUNTING ---
+
+    // Natives this adapter invoked since the last call, by
+    // category (query / mutation / task / draw). main.cpp calls
+    // it once per frame, right before WAIT(0).
+    NativeFrameCounts TakeFrameNativeCounts();
+
     // --- GAME STATE QUERIES ---
 
     // Checks if a mission is currently active.
@@ -58,6 +67,13 @@ namespace EngineAdapter
     // Used in: main tick loop (mission suppression gate)
     bool IsMissionActive();
 
+    // One read of everything the edge sampler (EventBus.h) watches:
+    // mission flag, player alive / vehicle, companion exists / dead.
+    // stayEnabled is host input and left untouched.
+    // Wraps: GET_MISSION_FLAG, PLAYER_PED_ID, DOES_ENTITY_EXIST,
+    //        IS_PED_DEAD_OR_DYING, IS_PED_IN_ANY_VEHICLE, GET_VEHICLE_PED_IS_IN
+    void SampleWorld(WorldSample& out);
+
     // --- DEBUG DRAWING ---
 
     // Draws text on screen at the given position.
@@ -77,8 +93,19 @@ namespace EngineAdapter
     bool IsPlayerDead();
     bool IsPlayerInVehicle();
     Vec3 GetPlayerPosition();
-
-    bool SpawnTestPed();
+    Vec3 GetPlayerForwardVector();          // unit vector the player faces (world)
+
+    // Spawning is split so nothing here ever WAITs: request the
+    // model, poll until it's loaded (main.cpp does this from a
+    // coroutine, one check per frame), create the ped, release.
+    // Wraps: REQUEST_MODEL, HAS_MODEL_LOADED, SET_MODEL_AS_NO_LONGER_NEEDED
+    uint32_t RequestCompanionModel();         // returns the model hash
+    bool IsModelLoaded(uint32_t model);
+    void ReleaseModel(uint32_t model);
+
+    // Creates + configures the companion next to the player. The
+    // model must be loaded. true if it already exists.
+    bool CreateTestPed(uint32_t model);
     void DespawnTestPed();
 
     bool IsKeyJustPressed(int vk);
@@ -86,10 +113,49 @@ namespace EngineAdapter
     bool DoesTestPedExist();
     Vec3 GetTestPedPosition();
     void SetTestPedPosition(const Vec3& pos);
+
+    // True if the companion is currently rendered on screen.
+    // Wraps: IS_ENTITY_ON_SCREEN
+    // Used by the LOD system (off-screen companions drop a tier).
+    bool IsTestPedOnScreen();
+
+    // True while an explosion is going off within radius of center.
+    // Wraps: IS_EXPLOSION_IN_SPHERE
+    bool IsExplosionNear(const Vec3& center, float radius);
+
     void TeleportTestPedNearPlayer(float offsetX = 1.2f, float offsetY = 0.8f, float offsetZ = 0.0f);
 
-    // Replace the old one-arg declaration:
-    void TaskFollowPlayer(float followDist, float speed);
+    // Puts the companion at pos (entity coords), tasks cleared,
+    // not moving, not frozen. Used with a spot from TeleportSearch.
+    void TeleportTestPedTo(const Vec3& pos);
+
+    // --- TELEPORT DESTINATION PROBES (TeleportSearch.h) ---
+
+    // Ground Z under (x, y) searching down from zTop, and the
+    // water surface there if any.
+    // Wraps: GET_GROUND_Z_FOR_3D_COORD, GET_WATER_HEIGHT_NO_WAVES
+    GroundSample SampleGround(float x, float y, float zTop);
+
+    // Async capsule test (map, vehicles, objects; ignores the
+    // player). Returns the shape test handle, 0 on failure.
+    // Wraps: START_SHAPE_TEST_CAPSULE
+    int StartClearanceProbe(const Vec3& from, const Vec3& to, float radius);
+
+    // Wraps: GET_SHAPE_TEST_RESULT
+    ProbeStatus PollClearanceProbe(int handle);
+
+    // Follows a point at (offsetX, offsetY) in the player's frame
+    // (+X right, +Y ahead): the companion's formation slot
+    // (Formation.h), moved ahead by the lead while catching up
+    // (MotionPredictor.h).
+    void TaskFollowPlayer(float offsetX, float offsetY, float stoppingRange, float speed);
+
+    // Walks the companion through points in order (the player's
+    // breadcrumb trail, BreadcrumbTrail.h). At most
+    // kMaxRoutePoints; extra points are ignored.
+    // Wraps: TASK_FLUSH_ROUTE, TASK_EXTEND_ROUTE, TASK_FOLLOW_POINT_ROUTE
+    static constexpr uint32_t kMaxRoutePoints = 8;
+    void TaskFollowRoute(const Vec3* points, uint32_t count, float speed);
 
     void ClearTestPedTasks();
     void FreezeTestPed(bool freeze);
@@ -117,4 +183,45 @@ namespace EngineAdapter
     // VEHICLE RIDING (V2)
     // ============================================================
     int GetTestPedVehicleHandle();
+
+    // Vehicle the player is getting into (enter task running),
+    // 0 if none. Wraps: GET_VEHICLE_PED_IS_TRYING_TO_ENTER
+    int GetVehiclePlayerIsEntering();
+
+    // Passengers in a vehicle, driver not counted.
+    // Wraps: GET_VEHICLE_NUMBER_OF_PASSENGERS
+    int GetVehiclePassengerCount(int vehicleHandle);
+
+    // ============================================================
+    // NEARBY ENTITIES (spatial grid feed)
+    // ============================================================
+
+    // Collects peds within radius of the player (excluding the
+    // player and our companion). Writes handle + position for
+    // up to maxCount of them and returns how many were written.
+    //
+    // Uses ScriptHookV's worldGetAllPeds pool snapshot, then one
+    // GET_ENTITY_COORDS per ped — call it on a cadence, not every frame.
+    int GetNearbyPeds(float radius, int* outHandles, Vec3* outPositions, int maxCount);
+
+    // Same for vehicles.
+    int GetNearbyVehicles(float radius, int* outHandles, Vec3* outPositions, int maxCount);
+
+    // Per-entity state for cheap filtering (Frenzy targeting).
+    // Wraps: IS_PED_DEAD_OR_DYING, IS_ENTITY_A_MISSION_ENTITY
+    bool IsPedDead(int pedHandle);
+    bool IsMissionEntity(int entityHandle);
+
+    // ============================================================
+    // PROTECTION (threat sampling + engaging)
+    // ============================================================
+
+    // Everything the threat engine wants to know about one ped.
+    // Bails out early for peds that clearly aren't threats, so
+    // a calm civilian costs ~4 natives instead of ~8.
+    PedThreatInfo QueryPedThreat(int pedHandle);
+
+    // Tasks our companion to fight the given ped.
+    // Wraps: TASK_COMBAT_PED
+    void TaskCombatPed(int pedHandle);
 }
@@ -0,0 +1,151 @@
+// ============================================================
+//  EventBus.cpp — Edge-triggered game events (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  The queue indices are free-running uint32_t counters and
+//  masked on access, so "full" is tail - head == capacity with
+//  no wasted slot and no special-casing of wrap-around.
+//
+//  Dispatch pops one event at a time, so a handler that
+//  publishes (e.g. a subscriber reacting to MissionStarted by
+//  publishing something else) has its event delivered in the
+//  same Dispatch call, after everything queued before it.
+// ============================================================
+
+#include "EventBus.h"
+
+const char* GameEventTypeName(GameEventType type)
+{
+    switch (type)
+    {
+    case GameEventType::MissionStarted:       return "MissionStarted";
+    case GameEventType::MissionEnded:         return "MissionEnded";
+    case GameEventType::PlayerEnteredVehicle: return "PlayerEnteredVehicle";
+    case GameEventType::PlayerExitedVehicle:  return "PlayerExitedVehicle";
+    case GameEventType::VehicleChanged:       return "VehicleChanged";
+    case GameEventType::PlayerDied:           return "PlayerDied";
+    case GameEventType::PlayerRespawned:      return "PlayerRespawned";
+    case GameEventType::CompanionSpawned:     return "CompanionSpawned";
+    case GameEventType::CompanionDespawned:   return "CompanionDespawned";
+    case GameEventType::CompanionDied:        return "CompanionDied";
+    case GameEventType::StayToggled:          return "StayToggled";
+    default:                                  return "?";
+    }
+}
+
+// --------------------------------------------------------
+//  EventBus
+// --------------------------------------------------------
+
+bool EventBus::Subscribe(GameEventType type, GameEventHandler handler, void* user)
+{
+    int t = (int)type;
+    if (t < 0 || t >= (int)GameEventType::Count || handler == nullptr)
+        return false;
+
+    if (m_subCount[t] >= kMaxSubscribers)
+        return false;
+
+    m_subs[t][m_subCount[t]++] = { handler, user };
+    return true;
+}
+
+bool EventBus::Publish(const GameEvent& e)
+{
+    if (m_tail - m_head >= kQueueCapacity)
+    {
+        m_stats.dropped++;
+        return false;
+    }
+
+    m_queue[m_tail & (kQueueCapacity - 1)] = e;
+    m_tail++;
+    m_stats.published++;
+    return true;
+}
+
+bool EventBus::Publish(GameEventType type, uint32_t tick, int a, int b)
+{
+    GameEvent e;
+    e.type = type;
+    e.tick = tick;
+    e.a = a;
+    e.b = b;
+    return Publish(e);
+}
+
+uint32_t EventBus::Dispatch()
+{
+    uint32_t n = 0;
+
+    while (m_head != m_tail)
+    {
+        // Copy out first: a handler may publish and reuse the slot
+        GameEvent e = m_queue[m_head & (kQueueCapacity - 1)];
+        m_head++;
+        n++;
+
+        int t = (int)e.type;
+        if (t < 0 || t >= (int)GameEventType::Count)
+            continue;
+
+        for (uint32_t i = 0; i < m_subCount[t]; ++i)
+        {
+            m_subs[t][i].handler(e, m_subs[t][i].user);
+            m_stats.delivered++;
+        }
+    }
+
+    return n;
+}
+
+// --------------------------------------------------------
+//  EdgeSampler
+// --------------------------------------------------------
+
+uint32_t EdgeSampler::Update(const WorldSample& now, uint32_t tickCount, EventBus& bus)
+{
+    const WorldSample& was = m_prev;
+    uint32_t n = 0;
+
+    auto publish = [&](GameEventType type, int a = 0, int b = 0)
+    {
+        if (bus.Publish(type, tickCount, a, b))
+            n++;
+    };
+
+    // Mission first: the lifecycle FSM suspends before anything else moves
+    if (now.missionActive != was.missionActive)
+        publish(now.missionActive ? GameEventType::MissionStarted : GameEventType::MissionEnded);
+
+    if (now.playerDead != was.playerDead)
+        publish(now.playerDead ? GameEventType::PlayerDied : GameEventType::PlayerRespawned);
+
+    if (now.playerInVehicle && !was.playerInVehicle)
+    {
+        publish(GameEventType::PlayerEnteredVehicle, now.playerVehicle);
+    }
+    else if (!now.playerInVehicle && was.playerInVehicle)
+    {
+        publish(GameEventType::PlayerExitedVehicle, was.playerVehicle);
+    }
+    else if (now.playerInVehicle && now.playerVehicle != was.playerVehicle)
+    {
+        publish(GameEventType::VehicleChanged, now.playerVehicle, was.playerVehicle);
+    }
+
+    if (now.companionExists != was.companionExists)
+        publish(now.companionExists ? GameEventType::CompanionSpawned : GameEventType::CompanionDespawned);
+
+    // Dying only counts while the ped still exists (despawn is its own event)
+    if (now.companionExists && now.companionDead && !(was.companionExists && was.companionDead))
+        publish(GameEventType::CompanionDied);
+
+    if (now.stayEnabled != was.stayEnabled)
+        publish(GameEventType::StayToggled, now.stayEnabled ? 1 : 0);
+
+    m_prev = now;
+    return n;
+}
@@ -0,0 +1,135 @@
+// ============================================================
+//  EventBus.h — Edge-triggered game events
+// ============================================================
+//
+//  PURPOSE:
+//  main.cpp used to find "did X just happen?" by keeping a
+//  g_wasX copy of every flag and comparing it each frame. That
+//  logic now lives in ONE place:
+//
+//    EngineAdapter::SampleWorld()  -> WorldSample (natives, once)
+//    EdgeSampler::Update()         -> compares with last frame,
+//                                     publishes typed events
+//    EventBus::Dispatch()          -> calls the subscribers
+//
+//  Subscribers (CompanionCore, parts of main.cpp) do their work
+//  when something happens, instead of re-checking conditions
+//  every tick.
+//
+//  NO ALLOCATION:
+//  The queue is a fixed ring, the subscriber table is a fixed
+//  array per event type, handlers are plain function pointers
+//  + a user pointer. If the queue is ever full the event is
+//  dropped and counted (Stats().dropped) — with ~10 event types
+//  that change at human speed, 64 slots is far more than a
+//  frame ever needs.
+//
+//  Engine-agnostic: no natives or game types here.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+
+enum class GameEventType : uint8_t
+{
+    MissionStarted,
+    MissionEnded,
+    PlayerEnteredVehicle,    // a = vehicle
+    PlayerExitedVehicle,     // a = vehicle the player left
+    VehicleChanged,          // a = new vehicle, b = old vehicle (player stayed inside)
+    PlayerDied,
+    PlayerRespawned,
+    CompanionSpawned,
+    CompanionDespawned,
+    CompanionDied,
+    StayToggled,             // a = 1 on, 0 off
+    Count
+};
+
+const char* GameEventTypeName(GameEventType type);
+
+struct GameEvent
+{
+    GameEventType type = GameEventType::Count;
+    uint32_t tick = 0;
+    int a = 0;               // payload, see GameEventType
+    int b = 0;
+};
+
+// Everything the edge sampler compares frame to frame.
+// Filled by EngineAdapter::SampleWorld (+ host inputs).
+struct WorldSample
+{
+    bool missionActive = false;
+    bool playerExists = false;
+    bool playerDead = false;
+    bool playerInVehicle = false;
+    int  playerVehicle = 0;          // 0 = on foot
+
+    bool companionExists = false;
+    bool companionDead = false;
+
+    bool stayEnabled = false;        // host input (F6 / recall)
+};
+
+using GameEventHandler = void(*)(const GameEvent& e, void* user);
+
+struct EventBusStats
+{
+    uint32_t published = 0;
+    uint32_t delivered = 0;          // handler calls
+    uint32_t dropped = 0;            // queue full
+};
+
+class EventBus
+{
+public:
+    static constexpr uint32_t kQueueCapacity = 64;     // power of two
+    static constexpr uint32_t kMaxSubscribers = 8;     // per event type
+
+    // Handlers run in subscription order. Returns false if the
+    // type already has kMaxSubscribers.
+    bool Subscribe(GameEventType type, GameEventHandler handler, void* user);
+
+    // Queues an event. Returns false (and counts a drop) when full.
+    bool Publish(const GameEvent& e);
+    bool Publish(GameEventType type, uint32_t tick, int a = 0, int b = 0);
+
+    // Delivers everything queued, including events that handlers
+    // publish while this runs. Returns the number of events.
+    uint32_t Dispatch();
+
+    uint32_t Pending() const { return m_tail - m_head; }
+    const EventBusStats& Stats() const { return m_stats; }
+
+private:
+    struct Subscriber
+    {
+        GameEventHandler handler;
+        void* user;
+    };
+
+    GameEvent m_queue[kQueueCapacity];
+    uint32_t m_head = 0;                 // free-running; masked on access
+    uint32_t m_tail = 0;
+
+    Subscriber m_subs[(int)GameEventType::Count][kMaxSubscribers];
+    uint8_t m_subCount[(int)GameEventType::Count] = {};
+
+    EventBusStats m_stats{};
+};
+
+// Turns consecutive WorldSamples into events. The first Update
+// compares against an all-false sample, so anything already
+// true at startup (companion out, mission running) is reported.
+class EdgeSampler
+{
+public:
+    // Returns the number of events published.
+    uint32_t Update(const WorldSample& now, uint32_t tickCount, EventBus& bus);
+
+    const WorldSample& Last() const { return m_prev; }
+
+private:
+    WorldSample m_prev{};
+};
@@ -0,0 +1,232 @@
+// ============================================================
+//  Formation.cpp — Squad slots around the player (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Cost of putting member i in slot j = straight-line distance
+//  from the member to the slot's world position (distance, not
+//  distance², so one long walk isn't traded for many short ones).
+//
+//  Optimal assignment: the O(n^3) Hungarian method with row/column
+//  potentials (the shortest augmenting path formulation), on a
+//  stack matrix of at most kHungarianMaxMembers². Above that,
+//  members pick the nearest free slot in index order: not optimal,
+//  but O(n^2) with no matrix, and a squad that big doesn't expect
+//  precise slots anyway.
+// ============================================================
+
+#include "Formation.h"
+#include <cmath>
+#include <cfloat>
+
+void FormationSolver::LayOut(const FormationLayout& layout, FormationSlot* out)
+{
+    const uint32_t n = layout.count;
+    const float d = layout.followDistance;
+    const float s = layout.spacing;
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        FormationSlot slot;
+
+        switch (layout.shape)
+        {
+        case FormationShape::Column:
+            slot.x = 0.0f;
+            slot.y = -d - (float)i * s;
+            break;
+
+        case FormationShape::Line:
+            slot.x = ((float)i - (float)(n - 1) * 0.5f) * s;
+            slot.y = -d;
+            break;
+
+        case FormationShape::Circle:
+        {
+            // Slot 0 behind, then round via the player's right. The
+            // ring grows once neighbours would be closer than spacing.
+            float radius = (float)n * s / 6.2831853f;
+            if (radius < d)
+                radius = d;
+            float a = 6.2831853f * (float)i / (float)n;
+            slot.x = radius * sinf(a);
+            slot.y = -radius * cosf(a);
+            break;
+        }
+
+        case FormationShape::Wedge:
+        default:
+        {
+            // Apex behind the player, then pairs left/right, one rank back each
+            uint32_t rank = (i + 1) / 2;
+            float side = (i == 0) ? 0.0f : ((i & 1) ? -1.0f : 1.0f);
+            slot.x = side * (float)rank * s;
+            slot.y = -d - (float)rank * s;
+            break;
+        }
+        }
+
+        slot.x += kSideBias;
+        out[i] = slot;
+    }
+}
+
+void FormationSolver::Assign(const FormationLayout& layout, const Vec3& playerPos, float forwardX, float forwardY,
+    const Vec3* memberPos)
+{
+    m_layout = layout;
+    if (m_layout.count > kMaxMembers)
+        m_layout.count = kMaxMembers;
+    m_assigned = true;
+
+    const uint32_t n = m_layout.count;
+    LayOut(m_layout, m_slots);
+
+    // Player frame -> world: right = forward turned 90° clockwise
+    const float rightX = forwardY;
+    const float rightY = -forwardX;
+
+    for (uint32_t j = 0; j < n; ++j)
+    {
+        m_slotX[j] = playerPos.x + rightX * m_slots[j].x + forwardX * m_slots[j].y;
+        m_slotY[j] = playerPos.y + rightY * m_slots[j].x + forwardY * m_slots[j].y;
+    }
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        m_memberX[i] = memberPos[i].x;
+        m_memberY[i] = memberPos[i].y;
+    }
+
+    m_stats.assignments++;
+    if (n <= kHungarianMaxMembers)
+    {
+        m_stats.lastCost = AssignOptimal(n);
+        m_stats.optimal++;
+    }
+    else
+    {
+        m_stats.lastCost = AssignGreedy(n);
+        m_stats.greedy++;
+    }
+}
+
+float FormationSolver::AssignOptimal(uint32_t n)
+{
+    // 1-based, row 0 / column 0 are the virtual start of each path
+    constexpr uint32_t N = kHungarianMaxMembers + 1;
+    float cost[N][N];
+    float u[N] = {}, v[N] = {}, minv[N];
+    uint32_t slotMember[N] = {};         // slot j -> member (0 = none)
+    uint32_t way[N];
+    bool used[N];
+
+    for (uint32_t i = 1; i <= n; ++i)
+    {
+        for (uint32_t j = 1; j <= n; ++j)
+        {
+            float dx = m_memberX[i - 1] - m_slotX[j - 1];
+            float dy = m_memberY[i - 1] - m_slotY[j - 1];
+            cost[i][j] = sqrtf(dx * dx + dy * dy);
+        }
+    }
+
+    for (uint32_t i = 1; i <= n; ++i)
+    {
+        slotMember[0] = i;
+        uint32_t j0 = 0;
+        for (uint32_t j = 0; j <= n; ++j)
+        {
+            minv[j] = FLT_MAX;
+            used[j] = false;
+        }
+
+        do
+        {
+            used[j0] = true;
+            uint32_t i0 = slotMember[j0];
+            uint32_t j1 = 0;
+            float delta = FLT_MAX;
+
+            for (uint32_t j = 1; j <= n; ++j)
+            {
+                if (used[j])
+                    continue;
+
+                float cur = cost[i0][j] - u[i0] - v[j];
+                if (cur < minv[j])
+                {
+                    minv[j] = cur;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta)
+                {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+
+            for (uint32_t j = 0; j <= n; ++j)
+            {
+                if (used[j])
+                {
+                    u[slotMember[j]] += delta;
+                    v[j] -= delta;
+                }
+                else
+                {
+                    minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (slotMember[j0] != 0);
+
+        // Flip the augmenting path
+        do
+        {
+            uint32_t j1 = way[j0];
+            slotMember[j0] = slotMember[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+
+    float total = 0.0f;
+    for (uint32_t j = 1; j <= n; ++j)
+    {
+        uint32_t member = slotMember[j] - 1;
+        m_slotOf[member] = (uint16_t)(j - 1);
+        total += cost[slotMember[j]][j];
+    }
+    return total;
+}
+
+float FormationSolver::AssignGreedy(uint32_t n)
+{
+    bool taken[kMaxMembers] = {};
+    float total = 0.0f;
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        uint32_t best = 0;
+        float bestSq = FLT_MAX;
+        for (uint32_t j = 0; j < n; ++j)
+        {
+            if (taken[j])
+                continue;
+
+            float dx = m_memberX[i] - m_slotX[j];
+            float dy = m_memberY[i] - m_slotY[j];
+            float dSq = dx * dx + dy * dy;
+            if (dSq < bestSq)
+            {
+                bestSq = dSq;
+                best = j;
+            }
+        }
+
+        taken[best] = true;
+        m_slotOf[i] = (uint16_t)best;
+        total += sqrtf(bestSq);
+    }
+    return total;
+}
@@ -0,0 +1,144 @@
+// ============================================================
+//  Formation.h — Squad slots around the player
+// ============================================================
+//
+//  PURPOSE:
+//  TaskFollowPlayer used to put the companion at one fixed spot
+//  (0.5 m right, followDist behind). Two companions would both
+//  aim for that spot and shove each other. The solver lays out
+//  one slot per companion in the player's frame and decides who
+//  takes which:
+//
+//      Wedge     Column    Line        Circle
+//        P         P         P            2
+//        0         0      0 1 2 3      3  P  1
+//       1 2        1                      0
+//      3   4       2
+//
+//  (P = player facing up; x = right, y = ahead, both meters.)
+//  A single companion always gets (0.5, -followDist), the old
+//  offset, in every shape.
+//
+//  WHEN IT RUNS:
+//    - Assign() only when the layout changes (shape, companion
+//      count, distance or spacing): slots are laid out and each
+//      companion gets the slot that keeps total travel lowest.
+//      Up to kHungarianMaxMembers that is the optimal assignment
+//      (Hungarian method, O(n^3)); above it, nearest free slot per
+//      companion (O(n^2)).
+//    - Every frame: SlotFor(i) is an array read. O(N) per frame
+//      for N companions, nothing allocated, ever.
+//
+//  Engine-agnostic; builds on Linux.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+#include "CompanionCore.h"
+
+enum class FormationShape : uint8_t
+{
+    Wedge,
+    Column,
+    Line,
+    Circle,
+    Count
+};
+
+inline const char* FormationShapeName(FormationShape s)
+{
+    switch (s)
+    {
+    case FormationShape::Wedge:  return "Wedge";
+    case FormationShape::Column: return "Column";
+    case FormationShape::Line:   return "Line";
+    case FormationShape::Circle: return "Circle";
+    default:                     return "?";
+    }
+}
+
+// Offset from the player, in the player's frame
+struct FormationSlot
+{
+    float x = 0.0f;             // + = right
+    float y = 0.0f;             // + = ahead
+};
+
+struct FormationLayout
+{
+    FormationShape shape = FormationShape::Wedge;
+    uint32_t count = 0;
+    float followDistance = 2.0f;    // first rank, behind the player
+    float spacing = 1.5f;           // between neighbouring slots
+
+    bool operator==(const FormationLayout& o) const
+    {
+        return shape == o.shape && count == o.count
+            && followDistance == o.followDistance && spacing == o.spacing;
+    }
+    bool operator!=(const FormationLayout& o) const { return !(*this == o); }
+};
+
+struct FormationStats
+{
+    uint32_t assignments = 0;       // Assign() calls
+    uint32_t optimal = 0;           // ...solved with the Hungarian method
+    uint32_t greedy = 0;            // ...solved nearest-slot
+    float lastCost = 0.0f;          // total travel (m) of the last assignment
+};
+
+class FormationSolver
+{
+public:
+    static constexpr uint32_t kMaxMembers = 256;
+    static constexpr uint32_t kHungarianMaxMembers = 16;
+    static constexpr float kSideBias = 0.5f;    // everything sits a little right of the player
+
+    // True if `layout` differs from what the slots were assigned for
+    bool NeedsAssign(const FormationLayout& layout) const
+    {
+        return !m_assigned || layout != m_layout;
+    }
+
+    // Lays out the slots and assigns them to the members
+    // (layout.count is clamped to kMaxMembers).
+    // memberPos[i] is member i's world position; forwardX/Y the
+    // player's facing (unit vector, world x/y).
+    void Assign(const FormationLayout& layout, const Vec3& playerPos, float forwardX, float forwardY,
+        const Vec3* memberPos);
+
+    // Member i's slot (valid after Assign, i < Count())
+    const FormationSlot& SlotFor(uint32_t member) const { return m_slots[m_slotOf[member]]; }
+
+    // How close to its slot a member has to get. Neighbours are
+    // `spacing` apart, so stopping short by more than half of it
+    // would blur the shape.
+    float StoppingRange() const
+    {
+        float half = m_layout.spacing * 0.5f;
+        return (m_layout.count > 1 && half < m_layout.followDistance) ? half : m_layout.followDistance;
+    }
+
+    uint32_t Count() const { return m_layout.count; }
+    const FormationLayout& Layout() const { return m_layout; }
+    const FormationStats& Stats() const { return m_stats; }
+
+    // Slot positions for a layout (no assignment). out has room for layout.count.
+    static void LayOut(const FormationLayout& layout, FormationSlot* out);
+
+private:
+    float AssignOptimal(uint32_t n);
+    float AssignGreedy(uint32_t n);
+
+    FormationLayout m_layout{};
+    bool m_assigned = false;
+
+    FormationSlot m_slots[kMaxMembers];
+    uint16_t m_slotOf[kMaxMembers] = {};        // member -> slot
+
+    // Assign() scratch: slot / member positions in world x/y
+    float m_slotX[kMaxMembers], m_slotY[kMaxMembers];
+    float m_memberX[kMaxMembers], m_memberY[kMaxMembers];
+
+    FormationStats m_stats{};
+};
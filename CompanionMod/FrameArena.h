@@ -0,0 +1,83 @@
+// ============================================================
+//  FrameArena.h — Per-frame scratch allocator
+// ============================================================
+//
+//  PURPOSE:
+//  Scratch data that only lives for one frame (query results,
+//  candidate lists, temporary arrays) goes here instead of the
+//  heap or another function-local static array. Allocation is a
+//  pointer bump; main.cpp calls Reset() at the start of every
+//  frame and everything handed out is gone.
+//
+//      Vec3* tmp = g_frameArena.AllocArray<Vec3>(count);
+//      if (tmp == nullptr) { ... arena full: skip / degrade ... }
+//
+//  RULES:
+//    - Only trivially destructible types (no destructors run).
+//    - Nothing from the arena may be kept across frames.
+//    - Full arena = nullptr, never a heap fallback (that would
+//      break the zero-allocation tick, AllocTracker.h). Overflows
+//      are counted; the heartbeat logs high-water and failures so
+//      the capacity can be sized from real sessions.
+//
+//  The backing buffer is allocated once, at construction.
+//  Single-threaded: script fiber only.
+// ============================================================
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t capacityBytes)
+        : m_buffer(new unsigned char[capacityBytes]), m_capacity(capacityBytes)
+    {
+    }
+
+    ~FrameArena() { delete[] m_buffer; }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // align must be a power of two. nullptr when the arena is full.
+    void* Allocate(size_t bytes, size_t align = alignof(std::max_align_t))
+    {
+        size_t start = (m_used + (align - 1)) & ~(align - 1);
+        if (start + bytes > m_capacity)
+        {
+            m_failures++;
+            return nullptr;
+        }
+
+        m_used = start + bytes;
+        if (m_used > m_highWater)
+            m_highWater = m_used;
+        return m_buffer + start;
+    }
+
+    // Uninitialized storage for count T's
+    template <typename T>
+    T* AllocArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Start of frame: everything allocated so far is released
+    void Reset() { m_used = 0; }
+
+    size_t Used() const { return m_used; }
+    size_t Capacity() const { return m_capacity; }
+    size_t HighWater() const { return m_highWater; }
+    uint32_t Failures() const { return m_failures; }
+
+private:
+    unsigned char* m_buffer;
+    size_t m_capacity;
+    size_t m_used = 0;
+    size_t m_highWater = 0;
+    uint32_t m_failures = 0;
+};
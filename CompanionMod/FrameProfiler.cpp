@@ -0,0 +1,327 @@
+// ============================================================
+//  FrameProfiler.cpp — Scoped-zone frame profiler (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Each frame owns one fixed slot of kMaxEventsPerFrame events.
+//  Begin() reserves the next event in the slot and pushes its
+//  index; End() pops and fills in the duration. Times are stored
+//  as 32-bit ns offsets from the frame start (4 s of headroom —
+//  far more than any frame should take).
+//
+//  Zones that don't fit (too many, too deep) are counted in
+//  ProfileFrame::dropped instead of being written, so a runaway
+//  Begin() can't corrupt other frames.
+//
+//  Chrome trace output uses "X" (complete) events with ts/dur in
+//  microseconds, one process/thread: the script fiber. The
+//  session capture is written in the JSON Array Format, which
+//  viewers accept without the closing bracket — a capture cut
+//  short by a crash still loads.
+// ============================================================
+
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <chrono>
+
+const char* ProfZoneName(ProfZone z)
+{
+    switch (z)
+    {
+    case ProfZone::Frame:        return "Frame";
+    case ProfZone::Input:        return "Input";
+    case ProfZone::WorldSample:  return "WorldSample";
+    case ProfZone::Context:      return "Context";
+    case ProfZone::NearbyScan:   return "NearbyScan";
+    case ProfZone::Threat:       return "Threat";
+    case ProfZone::CoreTick:     return "CoreTick";
+    case ProfZone::Lod:          return "Lod";
+    case ProfZone::Tasks:        return "Tasks";
+    case ProfZone::Protection:   return "Protection";
+    case ProfZone::Follow:       return "Follow";
+    case ProfZone::Teleport:     return "Teleport";
+    case ProfZone::SpawnDespawn: return "SpawnDespawn";
+    case ProfZone::DebugDraw:    return "DebugDraw";
+    case ProfZone::Heartbeat:    return "Heartbeat";
+    case ProfZone::Trace:        return "Trace";
+    case ProfZone::JobWait:      return "JobWait";
+    case ProfZone::Snapshot:     return "Snapshot";
+    default:                     return "?";
+    }
+}
+
+// Shared epoch so timestamps from every profiler line up
+static const std::chrono::steady_clock::time_point g_profileEpoch = std::chrono::steady_clock::now();
+
+FrameProfiler::FrameProfiler()
+{
+    for (uint32_t i = 0; i < kMaxDepth; ++i)
+    {
+        m_stack[i] = -1;
+        m_stackZone[i] = 0;
+    }
+}
+
+uint64_t ProfileNowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - g_profileEpoch).count();
+}
+
+// --------------------------------------------------------
+//  Recording
+// --------------------------------------------------------
+
+void FrameProfiler::BeginFrame()
+{
+    if (!m_enabled)
+    {
+        m_inFrame = false;
+        return;
+    }
+
+    m_frameStartNs = ProfileNowNs();
+
+    ProfileFrame& f = m_frames[Slot(m_frameCount)];
+    f = ProfileFrame{};
+    f.startNs = m_frameStartNs;
+    f.index = m_frameCount;
+
+    m_depth = 0;
+    m_overflow = 0;
+    m_inFrame = true;
+
+    Begin(ProfZone::Frame);
+}
+
+void FrameProfiler::EndFrame()
+{
+    if (!m_inFrame)
+        return;
+
+    // Anything still open is a missing End(): close it here
+    m_mismatches += m_overflow;
+    m_overflow = 0;
+    while (m_depth > 1)
+    {
+        m_mismatches++;
+        End((ProfZone)m_stackZone[m_depth - 1]);
+    }
+    End(ProfZone::Frame);
+
+    uint32_t slot = Slot(m_frameCount);
+    ProfileFrame& f = m_frames[slot];
+    f.durNs = (f.eventCount > 0) ? m_events[slot][0].durNs : 0;
+
+    m_inFrame = false;
+    m_frameCount++;
+
+    if (m_capture != nullptr)
+        WriteFrameEvents(m_capture, f, m_captureFirst);
+}
+
+void FrameProfiler::Begin(ProfZone zone)
+{
+    if (!m_inFrame)
+        return;
+
+    uint32_t slot = Slot(m_frameCount);
+    ProfileFrame& f = m_frames[slot];
+
+    if (m_depth >= kMaxDepth)
+    {
+        // Too deep: not recorded, but counted so the matching
+        // End() pops nothing and the zones below keep their time
+        f.dropped++;
+        m_overflow++;
+        return;
+    }
+
+    int16_t index = -1;
+    if (f.eventCount < kMaxEventsPerFrame)
+    {
+        index = (int16_t)f.eventCount++;
+        ProfileEvent& e = m_events[slot][index];
+        e.zone = (uint8_t)zone;
+        e.depth = (uint8_t)m_depth;
+        e.pad = 0;
+        e.startNs = (uint32_t)(ProfileNowNs() - m_frameStartNs);
+        e.durNs = 0;
+    }
+    else
+    {
+        f.dropped++;
+    }
+
+    m_stack[m_depth] = index;
+    m_stackZone[m_depth] = (uint8_t)zone;
+    m_depth++;
+}
+
+void FrameProfiler::End(ProfZone zone)
+{
+    if (!m_inFrame)
+        return;
+
+    if (m_overflow > 0)
+    {
+        m_overflow--;
+        return;
+    }
+
+    if (m_depth == 0)
+    {
+        m_mismatches++;
+        return;
+    }
+
+    m_depth--;
+    if (m_stackZone[m_depth] != (uint8_t)zone)
+        m_mismatches++;
+
+    int16_t index = m_stack[m_depth];
+    if (index < 0)
+        return;
+
+    ProfileEvent& e = m_events[Slot(m_frameCount)][index];
+    e.durNs = (uint32_t)(ProfileNowNs() - m_frameStartNs) - e.startNs;
+}
+
+// --------------------------------------------------------
+//  Queries
+// --------------------------------------------------------
+
+const ProfileFrame* FrameProfiler::LastFrame() const
+{
+    if (m_frameCount == 0)
+        return nullptr;
+    return &m_frames[Slot(m_frameCount - 1)];
+}
+
+const ProfileFrame* FrameProfiler::FrameByIndex(uint32_t index) const
+{
+    if (index >= m_frameCount || m_frameCount - index > kHistoryFrames)
+        return nullptr;
+    return &m_frames[Slot(index)];
+}
+
+const ProfileEvent* FrameProfiler::Events(const ProfileFrame& frame) const
+{
+    return m_events[Slot(frame.index)];
+}
+
+void FrameProfiler::ComputeStats(ProfZoneStats out[(int)ProfZone::Count]) const
+{
+    uint32_t frames = (m_frameCount < kHistoryFrames) ? m_frameCount : kHistoryFrames;
+    uint32_t first = m_frameCount - frames;
+
+    uint32_t values[kHistoryFrames];
+
+    for (int z = 0; z < (int)ProfZone::Count; ++z)
+    {
+        ProfZoneStats s;
+        uint32_t n = 0;
+        uint64_t sum = 0;
+
+        for (uint32_t i = first; i < m_frameCount; ++i)
+        {
+            uint32_t slot = Slot(i);
+            const ProfileFrame& f = m_frames[slot];
+
+            // A zone can run more than once per frame: time per frame is the sum
+            bool ran = false;
+            uint32_t total = 0;
+            for (uint32_t k = 0; k < f.eventCount; ++k)
+            {
+                const ProfileEvent& e = m_events[slot][k];
+                if (e.zone == z)
+                {
+                    ran = true;
+                    total += e.durNs;
+                }
+            }
+
+            if (ran)
+            {
+                values[n++] = total;
+                sum += total;
+            }
+        }
+
+        if (n > 0)
+        {
+            std::sort(values, values + n);
+            s.frames = n;
+            s.minNs = values[0];
+            s.maxNs = values[n - 1];
+            s.avgNs = (uint32_t)(sum / n);
+            s.p99Ns = values[(n * 99 + 99) / 100 - 1];
+        }
+
+        out[z] = s;
+    }
+}
+
+// --------------------------------------------------------
+//  Chrome trace export
+// --------------------------------------------------------
+
+void FrameProfiler::WriteFrameEvents(FILE* f, const ProfileFrame& frame, bool& first) const
+{
+    const ProfileEvent* events = m_events[Slot(frame.index)];
+
+    for (uint32_t k = 0; k < frame.eventCount; ++k)
+    {
+        const ProfileEvent& e = events[k];
+        double ts = (double)(frame.startNs + e.startNs) / 1000.0;
+        double dur = (double)e.durNs / 1000.0;
+
+        fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1",
+            first ? "" : ",\n", ProfZoneName((ProfZone)e.zone), ts, dur);
+
+        if (e.zone == (uint8_t)ProfZone::Frame)
+            fprintf(f, ",\"args\":{\"frame\":%u,\"dropped\":%u}", frame.index, (unsigned)frame.dropped);
+
+        fputc('}', f);
+        first = false;
+    }
+}
+
+void FrameProfiler::WriteChromeTrace(FILE* f, uint32_t frames) const
+{
+    uint32_t available = (m_frameCount < kHistoryFrames) ? m_frameCount : kHistoryFrames;
+    if (frames == 0 || frames > available)
+        frames = available;
+
+    fputs("{\"traceEvents\":[\n", f);
+
+    bool first = true;
+    for (uint32_t i = m_frameCount - frames; i < m_frameCount; ++i)
+        WriteFrameEvents(f, m_frames[Slot(i)], first);
+
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", f);
+}
+
+bool FrameProfiler::StartCapture(const char* path)
+{
+    StopCapture();
+
+    m_capture = fopen(path, "w");
+    if (m_capture == nullptr)
+        return false;
+
+    fputs("[\n", m_capture);
+    m_captureFirst = true;
+    return true;
+}
+
+void FrameProfiler::StopCapture()
+{
+    if (m_capture == nullptr)
+        return;
+
+    fputs("\n]\n", m_capture);
+    fclose(m_capture);
+    m_capture = nullptr;
+}
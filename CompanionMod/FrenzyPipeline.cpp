@@ -0,0 +1,151 @@
+// ============================================================
+//  FrenzyPipeline.cpp — Frenzy target acquisition (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Filter is a stream compaction: each candidate is copied to
+//  slot `write` unconditionally, and `write` only advances if
+//  it passed. No branch on the predicate, so it doesn't matter
+//  how unpredictable the dead/alive mix is.
+//
+//  Rank uses the batched distance kernel (GeometryKernels) for
+//  both distance terms, then one sqrt + multiply-add per ped.
+// ============================================================
+
+#include "FrenzyPipeline.h"
+#include "GeometryKernels.h"
+#include "SpatialGrid.h"
+#include <cmath>
+
+void FrenzyPipeline::Reset()
+{
+    m_count = 0;
+    m_target = 0;
+    m_targetSinceTick = 0;
+    m_targetCost = 0.0f;
+    m_stats = {};
+}
+
+// --------------------------------------------------------
+//  Stage 1: Gather
+// --------------------------------------------------------
+uint32_t FrenzyPipeline::Gather(const SpatialGrid& grid, const Vec3& center)
+{
+    uint32_t idx[kMaxCandidates];
+    uint32_t n = grid.QueryRadius(center, config.searchRadius, EntityKind_Ped, idx, kMaxCandidates);
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        uint32_t e = idx[i];
+        Vec3 p = grid.Position(e);
+        m_handle[i] = grid.Handle(e);
+        m_x[i] = p.x;
+        m_y[i] = p.y;
+        m_z[i] = p.z;
+        m_flags[i] = grid.Flags(e);
+    }
+
+    m_count = n;
+    m_stats.gathered = n;
+    return n;
+}
+
+// --------------------------------------------------------
+//  Stage 2: Filter (branch-free compaction)
+// --------------------------------------------------------
+uint32_t FrenzyPipeline::Filter()
+{
+    const uint8_t exclude = config.excludeFlags;
+
+    uint32_t write = 0;
+    for (uint32_t i = 0; i < m_count; ++i)
+    {
+        m_handle[write] = m_handle[i];
+        m_x[write] = m_x[i];
+        m_y[write] = m_y[i];
+        m_z[write] = m_z[i];
+        m_flags[write] = m_flags[i];
+
+        write += ((m_flags[i] & exclude) == 0) ? 1u : 0u;
+    }
+
+    m_count = write;
+    m_stats.filtered = write;
+    return write;
+}
+
+// --------------------------------------------------------
+//  Stage 3: Rank
+// --------------------------------------------------------
+void FrenzyPipeline::Rank(const Vec3& companionPos, const Vec3& playerPos)
+{
+    PositionsSoA pts;
+    pts.x = m_x;
+    pts.y = m_y;
+    pts.z = m_z;
+    pts.count = m_count;
+
+    Geometry::DistSqBatch(companionPos, pts, m_cost);
+    Geometry::DistSqBatch(playerPos, pts, m_scratch);
+
+    const float wc = config.wCompanionDistance;
+    const float wp = config.wPlayerDistance;
+
+    for (uint32_t i = 0; i < m_count; ++i)
+        m_cost[i] = wc * sqrtf(m_cost[i]) + wp * sqrtf(m_scratch[i]);
+}
+
+// --------------------------------------------------------
+//  Evaluate = stages + hysteresis
+// --------------------------------------------------------
+int FrenzyPipeline::Evaluate(const SpatialGrid& grid, const Vec3& companionPos, const Vec3& playerPos, uint32_t tickCount)
+{
+    Gather(grid, companionPos);
+    Filter();
+    Rank(companionPos, playerPos);
+
+    // Best candidate + where the current target ended up
+    int best = -1;
+    int current = -1;
+    for (uint32_t i = 0; i < m_count; ++i)
+    {
+        if (best < 0 || m_cost[i] < m_cost[best])
+            best = (int)i;
+        if (m_handle[i] == m_target)
+            current = (int)i;
+    }
+
+    if (best < 0)
+    {
+        m_target = 0;
+        m_targetCost = 0.0f;
+        return 0;
+    }
+
+    bool switchTo = false;
+
+    if (current < 0)
+    {
+        // No target, or it died / left / became mission-critical
+        switchTo = true;
+    }
+    else if (best != current)
+    {
+        bool held = (tickCount - m_targetSinceTick) >= config.minHoldTicks;
+        bool muchBetter = m_cost[best] < m_cost[current] * (1.0f - config.switchMargin);
+        switchTo = held && muchBetter;
+    }
+
+    if (switchTo)
+    {
+        if (m_target != 0)
+            m_stats.switches++;
+
+        m_target = m_handle[best];
+        m_targetSinceTick = tickCount;
+    }
+
+    m_targetCost = m_cost[switchTo ? best : current];
+    return m_target;
+}
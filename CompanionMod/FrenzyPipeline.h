@@ -0,0 +1,99 @@
+// ============================================================
+//  FrenzyPipeline.h — Frenzy mode target acquisition
+// ============================================================
+//
+//  PURPOSE:
+//  In Frenzy mode the companion attacks whoever is around.
+//  Picking "whoever" is three stages, each a tight loop over
+//  arrays (no per-ped branching logic scattered around):
+//
+//    1. GATHER  — peds near the companion, from the spatial grid
+//    2. FILTER  — drop anything with a forbidden flag bit
+//                 (dead, mission ped) in one AND per candidate;
+//                 the scan already left out player + companion
+//    3. RANK    — cost = distance to companion + a bit of
+//                 distance to player (cheaper = better)
+//
+//  HYSTERESIS:
+//  Re-tasking a ped (TASK_COMBAT_PED) every time a slightly
+//  closer victim walks by makes it twitch between targets and
+//  spams natives. The current target is kept unless:
+//    - it is gone / filtered out, or
+//    - it has been held for minHoldTicks AND the best candidate
+//      is at least switchMargin cheaper
+//
+//  Engine-agnostic: runs on grid data only.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+#include "CompanionCore.h"
+
+class SpatialGrid;
+
+struct FrenzyConfig
+{
+    float searchRadius = 35.0f;        // around the companion
+    uint8_t excludeFlags = 0x03;       // EntityFlag_Dead | EntityFlag_Mission
+
+    // Cost weights (per meter)
+    float wCompanionDistance = 1.0f;
+    float wPlayerDistance = 0.5f;      // prefer victims near the player
+
+    // Hysteresis
+    float switchMargin = 0.25f;        // new target must be 25% cheaper
+    uint32_t minHoldTicks = 90;        // ~1.5s @60fps before we even consider switching
+};
+
+struct FrenzyStats
+{
+    uint32_t gathered = 0;
+    uint32_t filtered = 0;             // survivors of stage 2
+    uint32_t switches = 0;             // running total
+};
+
+class FrenzyPipeline
+{
+public:
+    static constexpr uint32_t kMaxCandidates = 256;
+
+    FrenzyConfig config{};
+
+    void Reset();
+
+    // Runs all three stages and applies hysteresis.
+    // Returns the target to attack (0 = none).
+    int Evaluate(const SpatialGrid& grid, const Vec3& companionPos, const Vec3& playerPos, uint32_t tickCount);
+
+    int CurrentTarget() const { return m_target; }
+    float CurrentCost() const { return m_targetCost; }     // its cost at the last Evaluate (0 = none)
+    const FrenzyStats& Stats() const { return m_stats; }
+
+    // Stages (public so each can be exercised on its own)
+    uint32_t Gather(const SpatialGrid& grid, const Vec3& center);
+    uint32_t Filter();
+    void Rank(const Vec3& companionPos, const Vec3& playerPos);
+
+    // After Rank(): candidate array access
+    uint32_t Count() const { return m_count; }
+    int Handle(uint32_t i) const { return m_handle[i]; }
+    float Cost(uint32_t i) const { return m_cost[i]; }
+
+private:
+    // Candidate SoA (scratch, rebuilt each Evaluate)
+    uint32_t m_count = 0;
+    int m_handle[kMaxCandidates];
+    float m_x[kMaxCandidates];
+    float m_y[kMaxCandidates];
+    float m_z[kMaxCandidates];
+    uint8_t m_flags[kMaxCandidates];
+    float m_cost[kMaxCandidates];
+    float m_scratch[kMaxCandidates];
+
+    // Selection
+    int m_target = 0;
+    uint32_t m_targetSinceTick = 0;
+    float m_targetCost = 0.0f;
+
+    FrenzyStats m_stats{};
+};
@@ -0,0 +1,326 @@
+// ============================================================
+//  GeometryKernels.cpp — Scalar / SSE / AVX2 implementations
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Each kernel exists three times. The SSE and AVX2 versions
+//  handle 4 / 8 points per loop iteration and fall back to the
+//  scalar code for the leftover tail (count not a multiple of
+//  the vector width).
+//
+//  The AVX2 functions are compiled with a per-function target
+//  attribute on GCC/Clang (MSVC allows the intrinsics anywhere),
+//  so the rest of the mod does NOT require an AVX2 CPU. They are
+//  only ever called after CPUID says the CPU (and OS) support it.
+//
+//  Non-x86 builds only get the scalar path.
+// ============================================================
+
+#include "GeometryKernels.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define GEOM_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define GEOM_TARGET_AVX2
+#else
+#define GEOM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define GEOM_X86 0
+#endif
+
+// --------------------------------------------------------
+//  Scalar (reference) kernels
+// --------------------------------------------------------
+
+static void DistSqScalar(const Vec3& o, const PositionsSoA& p, uint32_t begin, float* out)
+{
+    for (uint32_t i = begin; i < p.count; ++i)
+    {
+        float dx = p.x[i] - o.x;
+        float dy = p.y[i] - o.y;
+        float dz = p.z[i] - o.z;
+        out[i] = dx * dx + dy * dy + dz * dz;
+    }
+}
+
+static uint32_t RangeMaskScalar(const Vec3& o, const PositionsSoA& p, uint32_t begin, float r2, uint8_t* out)
+{
+    uint32_t hits = 0;
+    for (uint32_t i = begin; i < p.count; ++i)
+    {
+        float dx = p.x[i] - o.x;
+        float dy = p.y[i] - o.y;
+        float dz = p.z[i] - o.z;
+        uint8_t in = (dx * dx + dy * dy + dz * dz) <= r2 ? 1 : 0;
+        out[i] = in;
+        hits += in;
+    }
+    return hits;
+}
+
+#if GEOM_X86
+
+// --------------------------------------------------------
+//  SSE (4 points per iteration)
+// --------------------------------------------------------
+
+static inline __m128 DistSq4(const PositionsSoA& p, uint32_t i, __m128 ox, __m128 oy, __m128 oz)
+{
+    __m128 dx = _mm_sub_ps(_mm_loadu_ps(p.x + i), ox);
+    __m128 dy = _mm_sub_ps(_mm_loadu_ps(p.y + i), oy);
+    __m128 dz = _mm_sub_ps(_mm_loadu_ps(p.z + i), oz);
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+}
+
+static void DistSqSSE(const Vec3& o, const PositionsSoA& p, float* out)
+{
+    const __m128 ox = _mm_set1_ps(o.x);
+    const __m128 oy = _mm_set1_ps(o.y);
+    const __m128 oz = _mm_set1_ps(o.z);
+
+    uint32_t i = 0;
+    for (; i + 4 <= p.count; i += 4)
+        _mm_storeu_ps(out + i, DistSq4(p, i, ox, oy, oz));
+
+    DistSqScalar(o, p, i, out);
+}
+
+static uint32_t RangeMaskSSE(const Vec3& o, const PositionsSoA& p, float r2, uint8_t* out)
+{
+    const __m128 ox = _mm_set1_ps(o.x);
+    const __m128 oy = _mm_set1_ps(o.y);
+    const __m128 oz = _mm_set1_ps(o.z);
+    const __m128 vr2 = _mm_set1_ps(r2);
+
+    uint32_t hits = 0;
+    uint32_t i = 0;
+    for (; i + 4 <= p.count; i += 4)
+    {
+        int bits = _mm_movemask_ps(_mm_cmple_ps(DistSq4(p, i, ox, oy, oz), vr2));
+        for (int j = 0; j < 4; ++j)
+        {
+            uint8_t in = (uint8_t)((bits >> j) & 1);
+            out[i + j] = in;
+            hits += in;
+        }
+    }
+
+    return hits + RangeMaskScalar(o, p, i, r2, out);
+}
+
+// --------------------------------------------------------
+//  AVX2 (8 points per iteration)
+// --------------------------------------------------------
+
+GEOM_TARGET_AVX2
+static inline __m256 DistSq8(const PositionsSoA& p, uint32_t i, __m256 ox, __m256 oy, __m256 oz)
+{
+    __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(p.x + i), ox);
+    __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(p.y + i), oy);
+    __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(p.z + i), oz);
+    return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+}
+
+GEOM_TARGET_AVX2
+static void DistSqAVX2(const Vec3& o, const PositionsSoA& p, float* out)
+{
+    const __m256 ox = _mm256_set1_ps(o.x);
+    const __m256 oy = _mm256_set1_ps(o.y);
+    const __m256 oz = _mm256_set1_ps(o.z);
+
+    uint32_t i = 0;
+    for (; i + 8 <= p.count; i += 8)
+        _mm256_storeu_ps(out + i, DistSq8(p, i, ox, oy, oz));
+
+    DistSqScalar(o, p, i, out);
+}
+
+GEOM_TARGET_AVX2
+static uint32_t RangeMaskAVX2(const Vec3& o, const PositionsSoA& p, float r2, uint8_t* out)
+{
+    const __m256 ox = _mm256_set1_ps(o.x);
+    const __m256 oy = _mm256_set1_ps(o.y);
+    const __m256 oz = _mm256_set1_ps(o.z);
+    const __m256 vr2 = _mm256_set1_ps(r2);
+
+    uint32_t hits = 0;
+    uint32_t i = 0;
+    for (; i + 8 <= p.count; i += 8)
+    {
+        int bits = _mm256_movemask_ps(_mm256_cmp_ps(DistSq8(p, i, ox, oy, oz), vr2, _CMP_LE_OQ));
+        for (int j = 0; j < 8; ++j)
+        {
+            uint8_t in = (uint8_t)((bits >> j) & 1);
+            out[i + j] = in;
+            hits += in;
+        }
+    }
+
+    return hits + RangeMaskScalar(o, p, i, r2, out);
+}
+
+// --------------------------------------------------------
+//  CPU detection
+// --------------------------------------------------------
+//  AVX2 needs three things: the CPU has it (CPUID leaf 7),
+//  the CPU has AVX + OSXSAVE (leaf 1), and the OS saves the
+//  YMM registers on context switch (XGETBV bits 1 and 2).
+// --------------------------------------------------------
+static bool CpuHasAvx2()
+{
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7) return false;
+
+    __cpuid(r, 1);
+    bool osxsave = (r[2] & (1 << 27)) != 0;
+    bool avx = (r[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+
+    __cpuidex(r, 7, 0);
+    return (r[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+static SimdLevel DetectSimdLevel()
+{
+    // SSE2 is guaranteed on every x64 CPU
+    return CpuHasAvx2() ? SimdLevel::AVX2 : SimdLevel::SSE;
+}
+
+#else
+
+static SimdLevel DetectSimdLevel()
+{
+    return SimdLevel::Scalar;
+}
+
+#endif // GEOM_X86
+
+// --------------------------------------------------------
+//  Dispatch
+// --------------------------------------------------------
+//  Detected once; ForceSimdLevel can lower (never raise
+//  past) what the CPU supports.
+// --------------------------------------------------------
+static SimdLevel SupportedLevel()
+{
+    static const SimdLevel s_supported = DetectSimdLevel();
+    return s_supported;
+}
+
+static SimdLevel g_forcedLevel = SimdLevel::AVX2;
+
+namespace Geometry
+{
+    SimdLevel ActiveSimdLevel()
+    {
+        SimdLevel supported = SupportedLevel();
+        return (g_forcedLevel < supported) ? g_forcedLevel : supported;
+    }
+
+    void ForceSimdLevel(SimdLevel level)
+    {
+        g_forcedLevel = level;
+    }
+
+    const char* SimdLevelName(SimdLevel level)
+    {
+        switch (level)
+        {
+        case SimdLevel::Scalar: return "Scalar";
+        case SimdLevel::SSE:    return "SSE";
+        case SimdLevel::AVX2:   return "AVX2";
+        default:                return "?";
+        }
+    }
+
+    void DistSqBatch(const Vec3& origin, const PositionsSoA& pts, float* outDistSq)
+    {
+        switch (ActiveSimdLevel())
+        {
+#if GEOM_X86
+        case SimdLevel::AVX2: DistSqAVX2(origin, pts, outDistSq); return;
+        case SimdLevel::SSE:  DistSqSSE(origin, pts, outDistSq); return;
+#endif
+        default:              DistSqScalar(origin, pts, 0, outDistSq); return;
+        }
+    }
+
+    uint32_t RangeMask(const Vec3& origin, const PositionsSoA& pts, float radius, uint8_t* outMask)
+    {
+        const float r2 = radius * radius;
+
+        switch (ActiveSimdLevel())
+        {
+#if GEOM_X86
+        case SimdLevel::AVX2: return RangeMaskAVX2(origin, pts, r2, outMask);
+        case SimdLevel::SSE:  return RangeMaskSSE(origin, pts, r2, outMask);
+#endif
+        default:              return RangeMaskScalar(origin, pts, 0, r2, outMask);
+        }
+    }
+
+    // --------------------------------------------------------
+    //  NearestK
+    // --------------------------------------------------------
+    //  Distances are computed in fixed-size chunks on the stack
+    //  (vectorized), then each one that beats the current k-th
+    //  best is insertion-sorted into a tiny result list. k is
+    //  small, so that's cheaper than any heap.
+    // --------------------------------------------------------
+    uint32_t NearestK(const Vec3& origin, const PositionsSoA& pts, uint32_t k, float maxRadius,
+        uint32_t* outIndex, float* outDistSq)
+    {
+        if (k > kMaxNearestK) k = kMaxNearestK;
+        if (k == 0 || pts.count == 0) return 0;
+
+        const uint32_t kChunk = 256;
+        float dist[kChunk];
+
+        float worst = maxRadius * maxRadius; // anything farther can't make the list
+        uint32_t found = 0;
+
+        for (uint32_t base = 0; base < pts.count; base += kChunk)
+        {
+            PositionsSoA chunk;
+            chunk.x = pts.x + base;
+            chunk.y = pts.y + base;
+            chunk.z = pts.z + base;
+            chunk.count = (pts.count - base < kChunk) ? (pts.count - base) : kChunk;
+
+            DistSqBatch(origin, chunk, dist);
+
+            for (uint32_t j = 0; j < chunk.count; ++j)
+            {
+                float d = dist[j];
+                if (d > worst)
+                    continue;
+
+                // Insert (list stays sorted closest-first)
+                uint32_t pos = (found < k) ? found++ : (k - 1);
+                while (pos > 0 && outDistSq[pos - 1] > d)
+                {
+                    outDistSq[pos] = outDistSq[pos - 1];
+                    outIndex[pos] = outIndex[pos - 1];
+                    --pos;
+                }
+                outDistSq[pos] = d;
+                outIndex[pos] = base + j;
+
+                if (found == k)
+                    worst = outDistSq[k - 1];
+            }
+        }
+
+        return found;
+    }
+}
@@ -0,0 +1,77 @@
+// ============================================================
+//  GeometryKernels.h — Batched distance / range queries
+// ============================================================
+//
+//  PURPOSE:
+//  main.cpp used to do one DistSq(a, b) at a time. That's fine
+//  for one companion, but threat scoring, frenzy targeting and
+//  multiple companions all want "distance from X to every one
+//  of these N points" — the same math over an array.
+//
+//  These kernels work on positions stored as structure-of-arrays
+//  (separate x[], y[], z[] arrays) so 4 (SSE) or 8 (AVX2) points
+//  are processed per instruction.
+//
+//  DISPATCH:
+//  The best implementation for the running CPU is picked once,
+//  on first use (AVX2 -> SSE -> scalar). ForceSimdLevel() lets
+//  you pin a level to compare results or timings.
+//
+//  Engine-agnostic: no natives, no allocation.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+#include "CompanionCore.h"
+
+// Positions as separate coordinate arrays (caller-owned)
+struct PositionsSoA
+{
+    const float* x = nullptr;
+    const float* y = nullptr;
+    const float* z = nullptr;
+    uint32_t count = 0;
+};
+
+enum class SimdLevel : uint8_t
+{
+    Scalar,
+    SSE,
+    AVX2
+};
+
+namespace Geometry
+{
+    // Largest k accepted by NearestK (results are kept in a small sorted list)
+    static constexpr uint32_t kMaxNearestK = 16;
+
+    // Single pair (the old main.cpp helper)
+    inline float DistSq(const Vec3& a, const Vec3& b)
+    {
+        float dx = a.x - b.x;
+        float dy = a.y - b.y;
+        float dz = a.z - b.z;
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    // outDistSq[i] = |pts[i] - origin|²   (outDistSq must hold pts.count floats)
+    void DistSqBatch(const Vec3& origin, const PositionsSoA& pts, float* outDistSq);
+
+    // outMask[i] = 1 if pts[i] is within radius of origin, else 0.
+    // Returns how many points are in range.
+    uint32_t RangeMask(const Vec3& origin, const PositionsSoA& pts, float radius, uint8_t* outMask);
+
+    // Finds the k closest points (k <= kMaxNearestK), closest first.
+    // Only points within maxRadius are considered (pass a huge value for "any").
+    // Returns how many were found (<= k).
+    uint32_t NearestK(const Vec3& origin, const PositionsSoA& pts, uint32_t k, float maxRadius,
+        uint32_t* outIndex, float* outDistSq);
+
+    // Level chosen by runtime CPU detection (or the forced one).
+    SimdLevel ActiveSimdLevel();
+
+    // Pins a level (clamped to what the CPU supports). For testing/benchmarks.
+    void ForceSimdLevel(SimdLevel level);
+
+    const char* SimdLevelName(SimdLevel level);
+}
@@ -0,0 +1,173 @@
+// ============================================================
+//  HitchDetector.cpp — Frame hitch detection (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  A frame's wall time is only known once WAIT(0) returns, so the
+//  snapshot is recorded before WAIT(0) and its wallNs is filled
+//  in by the next FrameBoundary(). The profiler frame it points
+//  at is complete by then too.
+//
+//  The dump runs on the frame after the hitch and makes that frame
+//  slow as well; the cooldown keeps it from reporting itself.
+//
+//  The hitch file is opened in append mode per dump and closed
+//  again, so nothing is held open (or flushed) on normal frames.
+// ============================================================
+
+#include "HitchDetector.h"
+#include "CompanionLod.h"
+
+static const char* ModeName(uint8_t mode)
+{
+    switch ((CompanionMode)mode)
+    {
+    case CompanionMode::Protection: return "Protection";
+    case CompanionMode::Stay:       return "Stay";
+    case CompanionMode::Frenzy:     return "Frenzy";
+    default:                        return "?";
+    }
+}
+
+void HitchDetector::Record(const HitchSnapshot& snapshot)
+{
+    HitchSnapshot& s = m_ring[m_recorded % kHistoryFrames];
+    s = snapshot;
+    s.wallNs = 0;
+    m_recorded++;
+}
+
+bool HitchDetector::FrameBoundary(uint64_t nowNs)
+{
+    // First boundary (or nothing recorded since the last one): just start timing
+    if (!m_haveBoundary || m_closed == m_recorded)
+    {
+        m_lastBoundaryNs = nowNs;
+        m_haveBoundary = true;
+        return false;
+    }
+
+    uint64_t wall = nowNs - m_lastBoundaryNs;
+    m_lastBoundaryNs = nowNs;
+
+    HitchSnapshot& s = m_ring[(m_recorded - 1) % kHistoryFrames];
+    s.wallNs = (wall > 0xFFFFFFFFull) ? 0xFFFFFFFFu : (uint32_t)wall;
+    m_closed = m_recorded;
+
+    const uint64_t thresholdNs = (uint64_t)(m_config.thresholdMs * 1000000.0f);
+    const uint64_t ignoreNs = (uint64_t)(m_config.ignoreAboveMs * 1000000.0f);
+
+    if (wall <= thresholdNs)
+        return false;
+
+    if (wall > ignoreNs)
+    {
+        m_stats.pauses++;
+        return false;
+    }
+
+    m_stats.hitches++;
+    if (s.wallNs > m_stats.worstNs)
+        m_stats.worstNs = s.wallNs;
+
+    bool cooling = m_dumpedOnce && (m_recorded - m_lastDumpFrame) < m_config.cooldownFrames;
+    if (cooling || m_stats.dumped >= m_config.maxDumps)
+    {
+        m_stats.suppressed++;
+        return false;
+    }
+
+    return true;
+}
+
+const HitchSnapshot* HitchDetector::LastFrame() const
+{
+    if (m_closed == 0)
+        return nullptr;
+    return &m_ring[(m_closed - 1) % kHistoryFrames];
+}
+
+void HitchDetector::WriteFrameZones(FILE* f, const FrameProfiler& profiler, uint32_t profileFrame) const
+{
+    const ProfileFrame* frame = profiler.FrameByIndex(profileFrame);
+    if (frame == nullptr)
+    {
+        fputs("(not in profiler ring)\n", f);
+        return;
+    }
+
+    const ProfileEvent* events = profiler.Events(*frame);
+    for (uint32_t k = 0; k < frame->eventCount; ++k)
+    {
+        const ProfileEvent& e = events[k];
+        fprintf(f, "%s", k == 0 ? "" : " | ");
+        for (uint32_t d = 1; d < e.depth; ++d)
+            fputc('>', f);
+        fprintf(f, "%s %.3f", ProfZoneName((ProfZone)e.zone), e.durNs / 1000000.0);
+    }
+    if (frame->dropped > 0)
+        fprintf(f, " (+%u dropped)", (unsigned)frame->dropped);
+    fputc('\n', f);
+}
+
+bool HitchDetector::Dump(const char* path, const FrameProfiler& profiler)
+{
+    // Counts even if the file can't be opened: no retry storm
+    m_stats.dumped++;
+    m_lastDumpFrame = m_recorded;
+    m_dumpedOnce = true;
+
+    const HitchSnapshot* hitch = LastFrame();
+    if (hitch == nullptr)
+        return false;
+
+    FILE* f = fopen(path, "a");
+    if (f == nullptr)
+        return false;
+
+    fprintf(f, "=== Hitch #%u  tick=%u  frame=%.1f ms (threshold %.1f ms)  our loop=%.2f ms ===\n",
+        m_stats.dumped, hitch->tick, hitch->wallNs / 1000000.0, m_config.thresholdMs, hitch->bodyNs / 1000000.0);
+    fprintf(f, "hitches=%u suppressed=%u pauses=%u\n", m_stats.hitches, m_stats.suppressed, m_stats.pauses);
+
+    uint32_t available = (m_closed < kHistoryFrames) ? m_closed : kHistoryFrames;
+    uint32_t frames = (m_config.dumpFrames < available) ? m_config.dumpFrames : available;
+    uint32_t first = m_closed - frames;
+
+    fprintf(f, "%8s %8s %8s %4s %4s %4s %4s %4s  %-18s %-10s %-4s %7s flags\n",
+        "tick", "wall_ms", "loop_ms", "nat", "q", "m", "t", "d", "state", "mode", "lod", "dist_m");
+
+    for (uint32_t i = first; i < m_closed; ++i)
+    {
+        const HitchSnapshot& s = m_ring[i % kHistoryFrames];
+        char flags[6] = {
+            (s.flags & HitchFlag_Spawned) ? 'S' : '-',
+            (s.flags & HitchFlag_MissionActive) ? 'M' : '-',
+            (s.flags & HitchFlag_InVehicle) ? 'V' : '-',
+            (s.flags & HitchFlag_StayEnabled) ? 'Y' : '-',
+            (s.flags & HitchFlag_NearbyScan) ? 'N' : '-',
+            '\0'
+        };
+
+        fprintf(f, "%8u %8.2f %8.3f %4u %4u %4u %4u %4u  %-18s %-10s %-4s %7.1f %s%s\n",
+            s.tick, s.wallNs / 1000000.0, s.bodyNs / 1000000.0,
+            s.natives.Total(),
+            s.natives.Get(NativeCategory::Query), s.natives.Get(NativeCategory::Mutation),
+            s.natives.Get(NativeCategory::Task), s.natives.Get(NativeCategory::Draw),
+            CompanionFsm::Name((CompanionActivity)s.activity), ModeName(s.mode),
+            LodTierName((LodTier)s.lodTier), s.companionDist, flags,
+            (i == m_closed - 1) ? "  <-- hitch" : "");
+    }
+
+    fputs("zones (ms, '>' = nested):\n", f);
+    for (uint32_t i = first; i < m_closed; ++i)
+    {
+        const HitchSnapshot& s = m_ring[i % kHistoryFrames];
+        fprintf(f, "%8u  ", s.tick);
+        WriteFrameZones(f, profiler, s.profileFrame);
+    }
+
+    fputc('\n', f);
+    fclose(f);
+    return true;
+}
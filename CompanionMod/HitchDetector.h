@@ -0,0 +1,116 @@
+// ============================================================
+//  HitchDetector.h — Frame hitch detection + context capture
+// ============================================================
+//
+//  PURPOSE:
+//  A long frame (a native stalling on streaming, a log
+//  flush stalling on disk, a nearby scan over a huge pool) is
+//  only noticed when a player complains. The detector times
+//  every frame WAIT(0) to WAIT(0), and when one goes over the
+//  threshold it writes what the last frames looked like to a
+//  dedicated hitch file:
+//
+//    - per frame: wall time, our own loop time, natives by
+//      category, lifecycle state, mode, LOD tier, flags
+//    - the profiler zones of each of those frames
+//
+//  COST ON NORMAL FRAMES:
+//  One clock read after WAIT(0) and one ~40-byte snapshot copy
+//  into a ring. Everything else (formatting, file I/O) only runs
+//  on the hitch frame itself.
+//
+//  Frames longer than ignoreAboveMs are pauses (pause menu,
+//  loading screens, alt-tab — scripts don't run there) and are
+//  counted separately instead of being reported.
+//
+//  Engine-agnostic: no natives, builds on Linux.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include "CompanionCore.h"
+#include "NativeBudget.h"
+#include "FrameProfiler.h"
+
+enum HitchSnapshotFlag : uint8_t
+{
+    HitchFlag_Spawned       = 1 << 0,
+    HitchFlag_MissionActive = 1 << 1,
+    HitchFlag_InVehicle     = 1 << 2,
+    HitchFlag_StayEnabled   = 1 << 3,
+    HitchFlag_NearbyScan    = 1 << 4
+};
+
+// What one frame looked like (filled by main.cpp before WAIT(0))
+struct HitchSnapshot
+{
+    uint32_t tick = 0;
+    uint32_t profileFrame = 0;       // FrameProfiler frame index
+    uint32_t wallNs = 0;             // WAIT(0) to WAIT(0), filled by FrameBoundary
+    uint32_t bodyNs = 0;             // our loop body (profiler Frame zone)
+    NativeFrameCounts natives;
+    uint8_t  activity = 0;           // CompanionActivity
+    uint8_t  mode = 0;               // CompanionMode
+    uint8_t  lodTier = 0;            // LodTier
+    uint8_t  flags = 0;              // HitchSnapshotFlag
+    float    companionDist = 0.0f;   // meters, last LOD sample
+};
+
+struct HitchConfig
+{
+    float thresholdMs = 50.0f;       // 3 frames @60fps
+    float ignoreAboveMs = 5000.0f;   // longer = pause / loading screen
+    uint32_t cooldownFrames = 300;   // no second dump within ~5s
+    uint32_t maxDumps = 20;          // per session
+    uint32_t dumpFrames = 30;        // frames of context per dump
+};
+
+struct HitchStats
+{
+    uint32_t hitches = 0;            // frames over threshold
+    uint32_t dumped = 0;
+    uint32_t suppressed = 0;         // over threshold but in cooldown / over maxDumps
+    uint32_t pauses = 0;             // over ignoreAboveMs
+    uint32_t worstNs = 0;            // worst hitch (pauses excluded)
+};
+
+class HitchDetector
+{
+public:
+    static constexpr uint32_t kHistoryFrames = 120;      // ~2s @60fps
+
+    explicit HitchDetector(const HitchConfig& config = HitchConfig{}) : m_config(config) {}
+
+    // End of the loop body, right before WAIT(0)
+    void Record(const HitchSnapshot& snapshot);
+
+    // Right after WAIT(0) returns. Closes the wall time of the last
+    // recorded frame; true if that frame should be dumped now.
+    bool FrameBoundary(uint64_t nowNs);
+
+    // The frame FrameBoundary just judged (null before the first)
+    const HitchSnapshot* LastFrame() const;
+
+    // Appends a report of the last dumpFrames frames to path
+    bool Dump(const char* path, const FrameProfiler& profiler);
+
+    const HitchConfig& Config() const { return m_config; }
+    void SetConfig(const HitchConfig& config) { m_config = config; }
+    const HitchStats& Stats() const { return m_stats; }
+
+private:
+    void WriteFrameZones(FILE* f, const FrameProfiler& profiler, uint32_t profileFrame) const;
+
+    HitchConfig m_config;
+    HitchStats m_stats{};
+
+    HitchSnapshot m_ring[kHistoryFrames];
+    uint32_t m_recorded = 0;         // snapshots written
+    uint32_t m_closed = 0;           // snapshots with wallNs filled in
+
+    uint64_t m_lastBoundaryNs = 0;
+    bool m_haveBoundary = false;
+    uint32_t m_lastDumpFrame = 0;
+    bool m_dumpedOnce = false;
+};
@@ -0,0 +1,393 @@
+// ============================================================
+//  JobSystem.cpp — Work-stealing jobs (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  The deque is the C11 formulation of Chase-Lev (Le, Pop, Cohen,
+//  Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak
+//  Memory Models"), with a fixed buffer instead of a growable
+//  one: a full deque makes Run() execute the job immediately.
+//
+//  Job rings: each thread hands out jobs from its own ring, so
+//  Create() is an increment with no sharing. A slot is reused
+//  after kJobsPerThread more jobs from the same thread; since
+//  every frame joins what it submits, that only requires fewer
+//  than kJobsPerThread jobs in flight per thread.
+//
+//  Idle workers spin briefly (yield), then sleep on a condition
+//  variable with no timeout. Spinning forever would take a core
+//  away from the game. No wake-up is lost: a worker going to
+//  sleep announces itself (m_sleepers) and then looks at every
+//  deque once more; Run() pushes and then looks at m_sleepers.
+//  A seq_cst fence on each side makes at least one of the two
+//  see the other. Run() bumps m_wakeEpoch under the mutex, so a
+//  worker between its last look and wait() can't miss it.
+//
+//  Shutdown mirrors TuningWatcher: DllMain never joins. On
+//  FreeLibrary it asks the workers to stop, waits for
+//  m_liveWorkers to reach 0 and detaches; at process exit the
+//  workers are already gone. The ThreadStates are only freed
+//  once no worker is left in its loop, so a worker ended
+//  mid-job (process exit) leaks them instead.
+// ============================================================
+
+#include "JobSystem.h"
+#include <cassert>
+#include <chrono>
+
+static thread_local const JobSystem* t_jobSystem = nullptr;
+static thread_local uint32_t t_jobThread = 0;
+
+static constexpr uint32_t kSpinsBeforeSleep = 64;
+
+// --------------------------------------------------------
+//  JobDeque
+// --------------------------------------------------------
+
+bool JobDeque::Push(Job* job)
+{
+    int64_t b = m_bottom.load(std::memory_order_relaxed);
+    int64_t t = m_top.load(std::memory_order_acquire);
+    if (b - t >= (int64_t)kCapacity)
+        return false;
+
+    m_jobs[b & (kCapacity - 1)].store(job, std::memory_order_relaxed);
+    m_bottom.store(b + 1, std::memory_order_release);   // publishes the job's payload to thieves
+    return true;
+}
+
+Job* JobDeque::Pop()
+{
+    int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = m_top.load(std::memory_order_relaxed);
+
+    if (t > b)
+    {
+        // Empty
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = m_jobs[b & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (t == b)
+    {
+        // Last one: race any thief for it
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = nullptr;
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+bool JobDeque::Empty() const
+{
+    return m_bottom.load(std::memory_order_acquire) <= m_top.load(std::memory_order_acquire);
+}
+
+Job* JobDeque::Steal()
+{
+    int64_t t = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = m_bottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+        return nullptr;
+
+    Job* job = m_jobs[t & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;             // lost to the owner or another thief
+    return job;
+}
+
+// --------------------------------------------------------
+//  JobSystem
+// --------------------------------------------------------
+
+JobSystem::~JobSystem()
+{
+    Detach();
+    if (m_liveWorkers.load(std::memory_order_acquire) != 0)
+        return;
+
+    for (uint32_t i = 0; m_threads != nullptr && i < kMaxThreads; ++i)
+        delete[] m_threads[i].jobs;
+    delete[] m_threads;
+}
+
+void JobSystem::Start(uint32_t workers)
+{
+    assert(m_threads == nullptr && "JobSystem::Start called twice");
+
+    if (workers > kMaxWorkers)
+        workers = kMaxWorkers;
+
+    m_threads = new ThreadState[kMaxThreads];
+    m_workerCount = workers;
+    m_threadCount = workers + 1;
+    for (uint32_t i = 0; i < m_threadCount; ++i)
+        m_threads[i].jobs = new Job[kJobsPerThread]();
+
+    t_jobSystem = this;
+    t_jobThread = 0;
+
+    m_stop = false;
+    m_liveWorkers = workers;
+    for (uint32_t i = 0; i < workers; ++i)
+        m_workers[i] = std::thread(&JobSystem::WorkerMain, this, i + 1);
+}
+
+void JobSystem::RequestStop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+}
+
+bool JobSystem::WaitStopped(uint32_t timeoutMs) const
+{
+    for (uint32_t waited = 0; m_liveWorkers.load(std::memory_order_acquire) != 0; ++waited)
+    {
+        if (waited >= timeoutMs)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void JobSystem::Stop()
+{
+    RequestStop();
+    for (uint32_t i = 0; i < m_workerCount; ++i)
+    {
+        if (m_workers[i].joinable())
+            m_workers[i].join();
+    }
+}
+
+void JobSystem::Detach()
+{
+    for (uint32_t i = 0; i < m_workerCount; ++i)
+    {
+        if (m_workers[i].joinable())
+            m_workers[i].detach();
+    }
+}
+
+uint32_t JobSystem::ThisThread() const
+{
+    assert(t_jobSystem == this && "jobs can only be created / waited on by thread 0 or a worker");
+    return t_jobThread;
+}
+
+Job* JobSystem::Create(JobFunction function)
+{
+    return CreateChild(nullptr, function);
+}
+
+Job* JobSystem::CreateChild(Job* parent, JobFunction function)
+{
+    ThreadState& ts = m_threads[ThisThread()];
+    Job* job = &ts.jobs[ts.nextJob++ & (kJobsPerThread - 1)];
+    assert(job->unfinished.load(std::memory_order_relaxed) <= 0 && "job ring wrapped onto a live job");
+
+    if (parent != nullptr)
+        parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+
+    job->function = function;
+    job->parent = parent;
+    job->unfinished.store(1, std::memory_order_relaxed);
+    return job;
+}
+
+void JobSystem::Run(Job* job)
+{
+    ThreadState& ts = m_threads[ThisThread()];
+    if (!ts.deque.Push(job))
+    {
+        ts.inlined.fetch_add(1, std::memory_order_relaxed);
+        Execute(job);
+        return;
+    }
+
+    // Pairs with the fence in WorkerMain (see the notes above)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleepers.load(std::memory_order_relaxed) > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_wakeEpoch++;
+        }
+        m_wake.notify_one();
+    }
+}
+
+void JobSystem::Wait(const Job* job)
+{
+    if (job == nullptr)
+        return;
+
+    uint32_t self = ThisThread();
+    while (!IsDone(job))
+    {
+        if (Job* next = FindJob(self))
+            Execute(next);
+        else
+            std::this_thread::yield();
+    }
+}
+
+Job* JobSystem::FindJob(uint32_t self)
+{
+    ThreadState& ts = m_threads[self];
+    if (Job* job = ts.deque.Pop())
+        return job;
+
+    for (uint32_t k = 1; k < m_threadCount; ++k)
+    {
+        uint32_t victim = (self + k) % m_threadCount;
+        if (Job* job = m_threads[victim].deque.Steal())
+        {
+            ts.stolen.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+bool JobSystem::AnyQueued() const
+{
+    for (uint32_t i = 0; i < m_threadCount; ++i)
+    {
+        if (!m_threads[i].deque.Empty())
+            return true;
+    }
+    return false;
+}
+
+void JobSystem::Execute(Job* job)
+{
+    job->function(*job, job->data);
+    m_threads[t_jobThread].executed.fetch_add(1, std::memory_order_relaxed);
+    Finish(job);
+}
+
+void JobSystem::Finish(Job* job)
+{
+    while (job != nullptr)
+    {
+        // Read parent before the counter hits zero: the slot can be
+        // reused by its owner as soon as it does
+        Job* parent = job->parent;
+        if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        job = parent;
+    }
+}
+
+void JobSystem::WorkerMain(uint32_t index)
+{
+    t_jobSystem = this;
+    t_jobThread = index;
+
+    uint32_t idle = 0;
+    while (!m_stop.load(std::memory_order_relaxed))
+    {
+        if (Job* job = FindJob(index))
+        {
+            Execute(job);
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < kSpinsBeforeSleep)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // A Run() that missed us asleep left its job in a deque
+        if (!AnyQueued())
+        {
+            const uint64_t epoch = m_wakeEpoch;
+            m_wake.wait(lock, [&] { return m_wakeEpoch != epoch || m_stop.load(std::memory_order_relaxed); });
+        }
+        m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+        idle = 0;
+    }
+
+    m_liveWorkers.fetch_sub(1, std::memory_order_release);
+}
+
+// --------------------------------------------------------
+//  ParallelFor
+// --------------------------------------------------------
+
+struct RangeJobData
+{
+    JobSystem::RangeFunction fn;
+    void* user;
+    uint32_t begin;
+    uint32_t end;
+};
+
+static void RunRange(Job&, const void* data)
+{
+    const RangeJobData& r = JobSystem::Data<RangeJobData>(data);
+    r.fn(r.begin, r.end, r.user);
+}
+
+static void RunNothing(Job&, const void*)
+{
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t batch, RangeFunction fn, void* user)
+{
+    if (count == 0)
+        return;
+    if (batch == 0)
+        batch = 1;
+
+    // Small or no workers: don't pay for jobs at all
+    if (count <= batch || m_workerCount == 0)
+    {
+        fn(0, count, user);
+        return;
+    }
+
+    Job* root = Create(RunNothing);
+    for (uint32_t begin = 0; begin < count; begin += batch)
+    {
+        RangeJobData r;
+        r.fn = fn;
+        r.user = user;
+        r.begin = begin;
+        r.end = (count - begin > batch) ? begin + batch : count;
+        Run(CreateChild(root, RunRange, r));
+    }
+
+    Run(root);
+    Wait(root);
+}
+
+JobStats JobSystem::Stats() const
+{
+    JobStats s;
+    for (uint32_t i = 0; i < m_threadCount; ++i)
+    {
+        s.executed += m_threads[i].executed.load(std::memory_order_relaxed);
+        s.stolen += m_threads[i].stolen.load(std::memory_order_relaxed);
+        s.inlined += m_threads[i].inlined.load(std::memory_order_relaxed);
+    }
+    if (m_threadCount > 0)
+        s.onCaller = m_threads[0].executed.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,200 @@
+// ============================================================
+//  JobSystem.h — Work-stealing jobs for engine-free computation
+// ============================================================
+//
+//  PURPOSE:
+//  Everything in this mod runs on the ScriptHookV script fiber,
+//  which shares its time with the game's frame. Work that doesn't
+//  touch natives (threat ranking, target scoring, spatial queries,
+//  prediction) can run on worker threads instead:
+//
+//      take the snapshot (natives)  ->  Run() jobs over it
+//                                   ->  Wait() before the natives
+//                                       that need the results
+//
+//  RULES FOR JOBS:
+//    - Never call natives (EngineAdapter) from a job. Natives are
+//      only valid on the script fiber.
+//    - Never log from a job (Logger is not thread-safe).
+//    - Read the snapshot, write only your own output. Two jobs
+//      in flight must not write the same data.
+//    - Everything a frame submits is joined in that frame.
+//
+//  MODEL:
+//    - Fixed threads: the thread that calls Start() (the script
+//      fiber) is thread 0, plus N workers. Each has a lock-free
+//      work-stealing deque (Chase-Lev): the owner pushes and pops
+//      at the bottom, idle threads steal from the top.
+//    - A job has a parent and an unfinished counter (itself + its
+//      children). A parent is done when all its children are, so
+//      waiting on one root job waits on the whole tree.
+//    - Wait() doesn't block: the waiting thread runs jobs (its
+//      own or stolen ones) until the job is done. With zero
+//      workers everything runs inline inside Wait(). So a job
+//      only moves off the script fiber if the fiber has other
+//      work to do between Run() and Wait(): a job still queued
+//      when Wait() is reached runs right there, which is the
+//      quickest way to finish it at that point.
+//    - Jobs come from per-thread rings allocated once in Start();
+//      creating and running a job never touches the heap.
+//
+//  Engine-agnostic (std::thread, <atomic>); builds on Linux.
+// ============================================================
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+struct Job;
+using JobFunction = void (*)(Job& job, const void* data);
+
+// One cache line: function, parent, counter, inline payload
+struct alignas(64) Job
+{
+    static constexpr size_t kDataBytes = 40;
+
+    JobFunction function;
+    Job* parent;
+    std::atomic<int32_t> unfinished;     // this job + unfinished children
+    unsigned char data[kDataBytes];
+};
+
+static_assert(sizeof(Job) == 64, "Job should fill exactly one cache line");
+
+// Chase-Lev deque of job pointers, fixed capacity.
+// Push/Pop: owning thread only. Steal: any thread.
+class JobDeque
+{
+public:
+    static constexpr uint32_t kCapacity = 1024;      // power of two
+
+    bool Push(Job* job);        // false if full
+    Job* Pop();
+    Job* Steal();
+    bool Empty() const;         // any thread; a hint, may be stale
+
+private:
+    std::atomic<int64_t> m_top{ 0 };
+    std::atomic<int64_t> m_bottom{ 0 };
+    std::atomic<Job*> m_jobs[kCapacity] = {};
+};
+
+struct JobStats
+{
+    uint64_t executed = 0;      // jobs run (all threads)
+    uint64_t stolen = 0;        // ...of which taken from another thread's deque
+    uint64_t inlined = 0;       // deque full: run immediately by the submitter
+    uint64_t onCaller = 0;      // ...run by thread 0 (in Wait() or inlined), not a worker
+};
+
+class JobSystem
+{
+public:
+    static constexpr uint32_t kMaxWorkers = 7;
+    static constexpr uint32_t kMaxThreads = kMaxWorkers + 1;
+    static constexpr uint32_t kJobsPerThread = 1024;    // live jobs per submitting thread
+
+    ~JobSystem();
+
+    // The calling thread becomes thread 0 (the only non-worker
+    // thread allowed to create jobs). workers is clamped to
+    // kMaxWorkers; 0 = everything runs inline in Wait().
+    void Start(uint32_t workers);
+
+    // Asks workers to exit without waiting
+    void RequestStop();
+
+    // Waits up to timeoutMs for every worker to leave its loop,
+    // without joining (a thread exiting needs the loader lock, so
+    // this is what DllMain uses). True if they all have.
+    bool WaitStopped(uint32_t timeoutMs) const;
+
+    // RequestStop + join. Not from DllMain.
+    void Stop();
+
+    // Lets go of the workers without waiting for them: after
+    // WaitStopped, or at process exit when they're already gone.
+    void Detach();
+
+    // Job with no parent. The payload is copied into the job.
+    Job* Create(JobFunction function);
+
+    template <typename T>
+    Job* Create(JobFunction function, const T& data)
+    {
+        return CreateChild(nullptr, function, data);
+    }
+
+    // Job counted against `parent`: parent isn't done until this is
+    Job* CreateChild(Job* parent, JobFunction function);
+
+    template <typename T>
+    Job* CreateChild(Job* parent, JobFunction function, const T& data)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "job payloads are memcpy'd");
+        static_assert(sizeof(T) <= Job::kDataBytes, "job payload too large");
+        Job* job = CreateChild(parent, function);
+        memcpy(job->data, &data, sizeof(T));
+        return job;
+    }
+
+    template <typename T>
+    static const T& Data(const void* data) { return *static_cast<const T*>(data); }
+
+    // Queues the job on the calling thread's deque
+    void Run(Job* job);
+
+    // Runs jobs on this thread until `job` (and its children) are done.
+    // null is allowed and returns immediately.
+    void Wait(const Job* job);
+
+    bool IsDone(const Job* job) const
+    {
+        return job->unfinished.load(std::memory_order_acquire) <= 0;
+    }
+
+    // Splits [0, count) into batches of `batch` and runs
+    // fn(begin, end, user) over them in parallel; returns when
+    // all are done.
+    using RangeFunction = void (*)(uint32_t begin, uint32_t end, void* user);
+    void ParallelFor(uint32_t count, uint32_t batch, RangeFunction fn, void* user);
+
+    uint32_t Workers() const { return m_workerCount; }
+    JobStats Stats() const;
+
+private:
+    struct alignas(64) ThreadState
+    {
+        JobDeque deque;
+        Job* jobs = nullptr;                    // ring of kJobsPerThread
+        uint32_t nextJob = 0;                   // owner only
+        std::atomic<uint64_t> executed{ 0 };
+        std::atomic<uint64_t> stolen{ 0 };
+        std::atomic<uint64_t> inlined{ 0 };
+    };
+
+    uint32_t ThisThread() const;
+    Job* FindJob(uint32_t self);
+    bool AnyQueued() const;
+    void Execute(Job* job);
+    void Finish(Job* job);
+    void WorkerMain(uint32_t index);
+
+    ThreadState* m_threads = nullptr;           // kMaxThreads, allocated in Start()
+    uint32_t m_threadCount = 0;                 // 1 + workers
+    uint32_t m_workerCount = 0;
+    std::thread m_workers[kMaxWorkers];
+
+    std::atomic<bool> m_stop{ false };
+    std::atomic<uint32_t> m_liveWorkers{ 0 };   // each worker's last step takes itself off
+    std::atomic<uint32_t> m_sleepers{ 0 };
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    uint64_t m_wakeEpoch = 0;                   // under m_wakeMutex, +1 per wake-up
+};
@@ -0,0 +1,298 @@
+// ============================================================
+//  MotionPredictor.h — Player motion prediction + lead-follow
+// ============================================================
+//
+//  PURPOSE:
+//  Follow used to aim at where the player IS: a follow task at a
+//  fixed offset behind them, and a teleport once the gap passed
+//  teleport_dist_meters. A player who sprints off is several
+//  meters further along by the time the companion reacts, so the
+//  gap just grows until the teleport fires.
+//
+//  This file keeps a small motion model of the player (smoothed
+//  position + velocity) and plans follow against where the player
+//  WILL be:
+//
+//    predicted = position + velocity * lead     lead 0.5..2 s,
+//                                               longer when faster
+//
+//    Trail    the companion keeps up (predicted gap small): the
+//             normal follow task behind the player, refreshed
+//             less often since it is doing its job
+//    CatchUp  the predicted gap is too big: move the follow point
+//             ahead by the predicted travel (the companion heads
+//             for its slot around where the player will be) at
+//             catch-up speed, before the real gap has grown;
+//             back to Trail once close again
+//
+//  The follow task takes its offset in the player's own frame,
+//  so the lead is applied along the player's facing. On foot
+//  that is the direction of travel.
+//
+//  ALPHA-BETA FILTER (per axis, x/y):
+//    predict   p' = p + v*dt
+//    residual  r  = measured - p'
+//    correct   p  = p' + alpha*r        v = v + (beta/dt)*r
+//  Positions from the game are exact but the ped sways as it
+//  walks, so alpha is moderate and beta small: velocity follows a
+//  change of pace within about half a second without picking up
+//  the sway (~0.2 m/s error while walking / sprinting). A
+//  residual over resetJumpMeters is a teleport / respawn, not
+//  motion, and a long dt is a pause: the filter restarts.
+//
+//  Cost: ~20 flops and 24 bytes per tracked entity. Every
+//  companion plans against the same player state, so running it
+//  every frame costs the same with one companion or many.
+//
+//  Engine-agnostic; builds on Linux.
+// ============================================================
+
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include "CompanionCore.h"
+
+struct MotionFilterConfig
+{
+    float alpha = 0.5f;
+    float beta = 0.05f;
+    float resetJumpMeters = 10.0f;      // residual bigger than this = teleport, restart
+    float maxDtSeconds = 0.25f;         // longer frame gap (pause, load) = restart
+    float maxSpeed = 80.0f;             // m/s, clamp (bad frames can't fling the estimate)
+};
+
+// One tracked entity
+struct MotionState
+{
+    Vec3 position{};                    // filtered (z = last measured)
+    float velX = 0.0f;
+    float velY = 0.0f;
+    bool valid = false;                 // false => next Update() restarts at the measurement
+};
+
+struct MotionStats
+{
+    uint32_t updates = 0;
+    uint32_t resets = 0;                // restarts after a jump / pause
+};
+
+class MotionPredictor
+{
+public:
+    MotionFilterConfig config{};
+
+    // Feed this frame's measured position; dt = seconds since the
+    // previous Update of the same state.
+    void Update(MotionState& s, const Vec3& measured, float dt)
+    {
+        m_stats.updates++;
+
+        if (!s.valid || dt <= 0.0f || dt > config.maxDtSeconds)
+        {
+            Restart(s, measured);
+            return;
+        }
+
+        float px = s.position.x + s.velX * dt;
+        float py = s.position.y + s.velY * dt;
+        float rx = measured.x - px;
+        float ry = measured.y - py;
+
+        if (rx * rx + ry * ry > config.resetJumpMeters * config.resetJumpMeters)
+        {
+            Restart(s, measured);
+            return;
+        }
+
+        float gain = config.beta / dt;
+        s.position.x = px + config.alpha * rx;
+        s.position.y = py + config.alpha * ry;
+        s.position.z = measured.z;
+        s.velX += gain * rx;
+        s.velY += gain * ry;
+
+        float speedSq = s.velX * s.velX + s.velY * s.velY;
+        if (speedSq > config.maxSpeed * config.maxSpeed)
+        {
+            float k = config.maxSpeed / sqrtf(speedSq);
+            s.velX *= k;
+            s.velY *= k;
+        }
+    }
+
+    // Where the entity will be in `seconds`, at its current velocity
+    static Vec3 Predict(const MotionState& s, float seconds)
+    {
+        Vec3 p = s.position;
+        p.x += s.velX * seconds;
+        p.y += s.velY * seconds;
+        return p;
+    }
+
+    static float Speed(const MotionState& s)
+    {
+        return sqrtf(s.velX * s.velX + s.velY * s.velY);
+    }
+
+    const MotionStats& Stats() const { return m_stats; }
+    void ResetTotals() { m_stats = {}; }
+
+private:
+    void Restart(MotionState& s, const Vec3& measured)
+    {
+        if (s.valid)
+            m_stats.resets++;
+
+        s.position = measured;
+        s.velX = 0.0f;
+        s.velY = 0.0f;
+        s.valid = true;
+    }
+
+    MotionStats m_stats{};
+};
+
+// --------------------------------------------------------
+//  Lead-follow planning
+// --------------------------------------------------------
+enum class FollowMode : uint8_t
+{
+    Trail,
+    CatchUp
+};
+
+inline const char* FollowModeName(FollowMode m)
+{
+    return (m == FollowMode::CatchUp) ? "CatchUp" : "Trail";
+}
+
+struct LeadFollowConfig
+{
+    float minLeadSeconds = 0.5f;
+    float maxLeadSeconds = 2.0f;
+    float fullLeadSpeed = 7.0f;         // m/s (sprint) at which the lead reaches max
+    float movingSpeed = 0.8f;           // below this the player is standing: no lead
+
+    float catchUpStartMeters = 10.0f;   // predicted gap that starts a catch-up
+    float catchUpStopMeters = 4.0f;     // predicted gap that ends it
+    float catchUpSpeed = 4.0f;          // move speed while catching up (3 = run)
+    float maxLeadMeters = 12.0f;        // never aim further ahead than this
+    float reissueLeadMeters = 2.0f;     // catch-up: re-issue when the lead moved this much...
+    float reissueLeadFraction = 0.5f;   // ...plus this fraction of the issued lead
+
+    float keepUpSlackMeters = 3.0f;     // within followDist + this of the prediction = keeping up
+};
+
+// Per companion
+struct LeadFollowState
+{
+    FollowMode mode = FollowMode::Trail;
+    float issuedLead = 0.0f;            // lead (m ahead of the player) of the last issued task
+};
+
+struct FollowPlan
+{
+    FollowMode mode = FollowMode::Trail;
+    bool reissue = false;               // mode changed / catch-up target moved: issue now
+    bool keepingUp = false;             // Trail and close to the prediction: refresh can wait
+    float leadMeters = 0.0f;            // move the follow point this far ahead (0 = plain follow)
+    float speed = 0.0f;
+    float leadSeconds = 0.0f;
+    float predictedGap = 0.0f;          // companion to predicted player position (m)
+};
+
+struct LeadFollowStats
+{
+    uint32_t catchUps = 0;              // Trail -> CatchUp switches
+    uint32_t catchUpFrames = 0;
+    uint32_t keepingUpFrames = 0;
+    uint32_t plannedFrames = 0;
+};
+
+class LeadFollow
+{
+public:
+    LeadFollowConfig config{};
+
+    // Decides how this companion follows the player this frame.
+    // companionPos may be a few frames old (LOD sample).
+    FollowPlan Plan(LeadFollowState& s, const MotionState& player, const Vec3& companionPos,
+        float followDistance, float followSpeed)
+    {
+        FollowPlan plan;
+        m_stats.plannedFrames++;
+
+        float speed = MotionPredictor::Speed(player);
+        bool moving = player.valid && speed >= config.movingSpeed;
+
+        float lead = 0.0f;
+        if (moving)
+        {
+            float t = speed / config.fullLeadSpeed;
+            if (t > 1.0f) t = 1.0f;
+            lead = config.minLeadSeconds + (config.maxLeadSeconds - config.minLeadSeconds) * t;
+        }
+
+        Vec3 predicted = MotionPredictor::Predict(player, lead);
+        float dx = predicted.x - companionPos.x;
+        float dy = predicted.y - companionPos.y;
+        float gap = sqrtf(dx * dx + dy * dy);
+
+        // Hysteresis: start far out, stop close in
+        FollowMode mode = s.mode;
+        if (mode == FollowMode::Trail && moving && gap > config.catchUpStartMeters)
+        {
+            mode = FollowMode::CatchUp;
+            m_stats.catchUps++;
+        }
+        else if (mode == FollowMode::CatchUp && (!moving || gap < config.catchUpStopMeters))
+        {
+            mode = FollowMode::Trail;
+        }
+
+        plan.mode = mode;
+        plan.leadSeconds = lead;
+        plan.predictedGap = gap;
+
+        if (mode == FollowMode::CatchUp)
+        {
+            // Aim at the predicted position
+            float leadMeters = speed * lead;
+            if (leadMeters > config.maxLeadMeters)
+                leadMeters = config.maxLeadMeters;
+
+            plan.leadMeters = leadMeters;
+            plan.speed = (followSpeed > config.catchUpSpeed) ? followSpeed : config.catchUpSpeed;
+            // Proportional threshold: a lead ramping up or down as
+            // the player speeds up / stops costs two or three
+            // re-issues, not one every couple of meters
+            float reissueAt = config.reissueLeadMeters + config.reissueLeadFraction * s.issuedLead;
+            plan.reissue = (s.mode != mode) || fabsf(plan.leadMeters - s.issuedLead) > reissueAt;
+            m_stats.catchUpFrames++;
+        }
+        else
+        {
+            plan.leadMeters = 0.0f;
+            plan.speed = followSpeed;
+            plan.reissue = (s.mode != mode);
+            plan.keepingUp = gap <= followDistance + config.keepUpSlackMeters;
+            if (plan.keepingUp)
+                m_stats.keepingUpFrames++;
+        }
+
+        s.mode = mode;
+        return plan;
+    }
+
+    // The host issued the plan's task
+    static void NoteIssued(LeadFollowState& s, const FollowPlan& plan)
+    {
+        s.issuedLead = plan.leadMeters;
+    }
+
+    const LeadFollowStats& Stats() const { return m_stats; }
+    void ResetTotals() { m_stats = {}; }
+
+private:
+    LeadFollowStats m_stats{};
+};
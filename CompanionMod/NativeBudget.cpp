@@ -0,0 +1,110 @@
+// ============================================================
+//  NativeBudget.cpp — Per-frame native call counters (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  The window is a ring of per-frame counts plus a histogram of
+//  frame totals that is updated on insert/evict, so EndFrame is
+//  O(1) and a report is one pass over ~1K buckets with no sort
+//  and no allocation. Percentiles are nearest-rank.
+// ============================================================
+
+#include "NativeBudget.h"
+
+const char* NativeCategoryName(NativeCategory c)
+{
+    switch (c)
+    {
+    case NativeCategory::Query:    return "query";
+    case NativeCategory::Mutation: return "mutation";
+    case NativeCategory::Task:     return "task";
+    case NativeCategory::Draw:     return "draw";
+    default:                       return "?";
+    }
+}
+
+static uint32_t Bucket(uint32_t total)
+{
+    return total > NativeBudget::kHistogramMax ? NativeBudget::kHistogramMax : total;
+}
+
+void NativeBudget::EndFrame(const NativeFrameCounts& frame)
+{
+    // Evict the oldest frame once the window is full
+    if (m_filled == kWindowFrames)
+    {
+        const NativeFrameCounts& old = m_window[m_next];
+        uint32_t oldTotal = old.Total();
+
+        m_histogram[Bucket(oldTotal)]--;
+        for (int c = 0; c < (int)NativeCategory::Count; ++c)
+            m_categorySums[c] -= old.counts[c];
+        if (oldTotal > m_budget)
+            m_windowOver--;
+    }
+    else
+    {
+        m_filled++;
+    }
+
+    uint32_t total = frame.Total();
+    m_window[m_next] = frame;
+    m_next = (m_next + 1) % kWindowFrames;
+
+    m_histogram[Bucket(total)]++;
+    for (int c = 0; c < (int)NativeCategory::Count; ++c)
+        m_categorySums[c] += frame.counts[c];
+    if (total > m_budget)
+    {
+        m_windowOver++;
+        m_totalOver++;
+    }
+
+    m_last = frame;
+}
+
+NativeBudgetReport NativeBudget::Report() const
+{
+    NativeBudgetReport r;
+    r.frames = m_filled;
+    r.overBudget = m_windowOver;
+    if (m_filled == 0)
+        return r;
+
+    for (int c = 0; c < (int)NativeCategory::Count; ++c)
+        r.avgPerCategory[c] = (float)m_categorySums[c] / (float)m_filled;
+
+    // Nearest-rank: smallest value with at least ceil(p * n) frames at or below it
+    const uint32_t rank50 = (m_filled * 50 + 99) / 100;
+    const uint32_t rank95 = (m_filled * 95 + 99) / 100;
+    const uint32_t rank99 = (m_filled * 99 + 99) / 100;
+
+    uint32_t seen = 0;
+    bool got50 = false, got95 = false, got99 = false;
+    for (uint32_t v = 0; v <= kHistogramMax; ++v)
+    {
+        if (m_histogram[v] == 0)
+            continue;
+
+        seen += m_histogram[v];
+        r.max = v;
+        if (!got50 && seen >= rank50) { r.p50 = v; got50 = true; }
+        if (!got95 && seen >= rank95) { r.p95 = v; got95 = true; }
+        if (!got99 && seen >= rank99) { r.p99 = v; got99 = true; }
+    }
+
+    return r;
+}
+
+void NativeBudget::SetBudget(uint32_t budgetPerFrame)
+{
+    m_budget = budgetPerFrame;
+
+    m_windowOver = 0;
+    for (uint32_t i = 0; i < m_filled; ++i)
+    {
+        if (m_window[i].Total() > m_budget)
+            m_windowOver++;
+    }
+}
@@ -0,0 +1,103 @@
+// ============================================================
+//  NativeBudget.h — Per-frame native call counters + report
+// ============================================================
+//
+//  PURPOSE:
+//  Every native is a trip into the game's script VM, and the
+//  number of them per frame is the real cost of this mod. The
+//  adapter counts every invoke<>() it makes (EngineAdapter.cpp)
+//  by category:
+//
+//    Query    : reads (exists, coords, flags, relationships)
+//    Mutation : writes (coords, velocity, freeze, create/delete)
+//    Task     : AI tasks (follow, combat, clear tasks)
+//    Draw     : text / debug drawing
+//
+//  main.cpp hands each frame's counts to NativeBudget, which
+//  keeps the last kWindowFrames totals and reports p50/p95/p99
+//  and how many frames went over a budget. That answers "did
+//  this change to main.cpp make the mod more expensive?"
+//
+//  Engine-agnostic: no natives, builds on Linux.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+
+enum class NativeCategory : uint8_t
+{
+    Query,
+    Mutation,
+    Task,
+    Draw,
+    Count
+};
+
+const char* NativeCategoryName(NativeCategory c);
+
+struct NativeFrameCounts
+{
+    uint16_t counts[(int)NativeCategory::Count] = {};
+
+    void Add(NativeCategory c, uint16_t n = 1) { counts[(int)c] += n; }
+    uint16_t Get(NativeCategory c) const { return counts[(int)c]; }
+
+    uint32_t Total() const
+    {
+        uint32_t t = 0;
+        for (uint16_t n : counts)
+            t += n;
+        return t;
+    }
+};
+
+struct NativeBudgetReport
+{
+    uint32_t frames = 0;             // frames in the window
+    uint32_t p50 = 0;
+    uint32_t p95 = 0;
+    uint32_t p99 = 0;
+    uint32_t max = 0;
+    uint32_t overBudget = 0;         // frames in the window over budget
+    float avgPerCategory[(int)NativeCategory::Count] = {};
+};
+
+class NativeBudget
+{
+public:
+    static constexpr uint32_t kWindowFrames = 600;      // ~10s @60fps
+    static constexpr uint32_t kHistogramMax = 1023;     // totals above this land in the last bucket
+
+    explicit NativeBudget(uint32_t budgetPerFrame = 64) : m_budget(budgetPerFrame) {}
+
+    // Call once per frame with that frame's counts (O(1))
+    void EndFrame(const NativeFrameCounts& frame);
+
+    // Percentiles over the window (walks the histogram; call for
+    // the overlay / log, not per native)
+    NativeBudgetReport Report() const;
+
+    // Changing the budget re-counts the window
+    void SetBudget(uint32_t budgetPerFrame);
+    uint32_t Budget() const { return m_budget; }
+
+    const NativeFrameCounts& LastFrame() const { return m_last; }
+
+    // Frames over budget since start (not windowed)
+    uint32_t TotalOverBudget() const { return m_totalOver; }
+
+private:
+    uint32_t m_budget;
+
+    NativeFrameCounts m_window[kWindowFrames];
+    uint32_t m_next = 0;
+    uint32_t m_filled = 0;
+
+    // Window totals, kept incrementally
+    uint16_t m_histogram[kHistogramMax + 1] = {};
+    uint32_t m_categorySums[(int)NativeCategory::Count] = {};
+    uint32_t m_windowOver = 0;
+    uint32_t m_totalOver = 0;
+
+    NativeFrameCounts m_last{};
+};
@@ -0,0 +1,230 @@
+// ============================================================
+//  SpatialGrid.cpp — Uniform spatial hash (Implementation)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Rebuild = counting sort by bucket:
+//    1. count how many entities land in each bucket
+//    2. prefix-sum the counts into start offsets
+//    3. scatter each entity to its slot
+//  After that, every bucket's entities are contiguous in the
+//  m_x/m_y/m_z arrays, which is what makes queries cache-friendly.
+//
+//  Hashing ignores Z: GTA is mostly flat at the scale we care
+//  about, and distance checks are still full 3D.
+// ============================================================
+
+#include "SpatialGrid.h"
+#include <cmath>
+
+SpatialGrid::SpatialGrid(float cellSize)
+{
+    SetCellSize(cellSize);
+    BeginRebuild();
+    FinishRebuild();
+}
+
+void SpatialGrid::SetCellSize(float cellSize)
+{
+    if (cellSize < 0.5f) cellSize = 0.5f;
+    m_cellSize = cellSize;
+    m_invCellSize = 1.0f / cellSize;
+}
+
+int32_t SpatialGrid::CellCoord(float v) const
+{
+    return (int32_t)floorf(v * m_invCellSize);
+}
+
+uint32_t SpatialGrid::BucketOf(int32_t cx, int32_t cy)
+{
+    // Two large primes (classic spatial-hash constants)
+    uint32_t h = ((uint32_t)cx * 73856093u) ^ ((uint32_t)cy * 19349663u);
+    return h & (kBucketCount - 1);
+}
+
+void SpatialGrid::BeginRebuild()
+{
+    m_stagedCount = 0;
+    m_dropped = 0;
+}
+
+bool SpatialGrid::Insert(int handle, uint8_t kind, const Vec3& pos, uint8_t flags)
+{
+    if (m_stagedCount >= kMaxEntities)
+    {
+        m_dropped++;
+        return false;
+    }
+
+    uint32_t i = m_stagedCount++;
+    m_sx[i] = pos.x;
+    m_sy[i] = pos.y;
+    m_sz[i] = pos.z;
+    m_shandle[i] = handle;
+    m_skind[i] = kind;
+    m_sflags[i] = flags;
+    m_scx[i] = CellCoord(pos.x);
+    m_scy[i] = CellCoord(pos.y);
+    m_sbucket[i] = BucketOf(m_scx[i], m_scy[i]);
+    return true;
+}
+
+void SpatialGrid::FinishRebuild()
+{
+    // 1. Count
+    for (uint32_t b = 0; b <= kBucketCount; ++b)
+        m_bucketStart[b] = 0;
+
+    for (uint32_t i = 0; i < m_stagedCount; ++i)
+        m_bucketStart[m_sbucket[i] + 1]++;
+
+    // 2. Prefix sum -> start offsets
+    for (uint32_t b = 0; b < kBucketCount; ++b)
+        m_bucketStart[b + 1] += m_bucketStart[b];
+
+    // 3. Scatter (m_bucketStart[b] is used as the write cursor,
+    //    then restored by shifting back one bucket)
+    for (uint32_t i = 0; i < m_stagedCount; ++i)
+    {
+        uint32_t dst = m_bucketStart[m_sbucket[i]]++;
+        m_x[dst] = m_sx[i];
+        m_y[dst] = m_sy[i];
+        m_z[dst] = m_sz[i];
+        m_handle[dst] = m_shandle[i];
+        m_kind[dst] = m_skind[i];
+        m_flags[dst] = m_sflags[i];
+        m_cx[dst] = m_scx[i];
+        m_cy[dst] = m_scy[i];
+    }
+
+    for (uint32_t b = kBucketCount; b > 0; --b)
+        m_bucketStart[b] = m_bucketStart[b - 1];
+    m_bucketStart[0] = 0;
+
+    m_count = m_stagedCount;
+}
+
+uint32_t SpatialGrid::QueryRadius(const Vec3& center, float radius, uint8_t kindMask,
+    uint32_t* outIndex, uint32_t maxOut) const
+{
+    const float r2 = radius * radius;
+
+    const int32_t x0 = CellCoord(center.x - radius);
+    const int32_t x1 = CellCoord(center.x + radius);
+    const int32_t y0 = CellCoord(center.y - radius);
+    const int32_t y1 = CellCoord(center.y + radius);
+
+    uint32_t found = 0;
+
+    for (int32_t cy = y0; cy <= y1; ++cy)
+    {
+        for (int32_t cx = x0; cx <= x1; ++cx)
+        {
+            uint32_t b = BucketOf(cx, cy);
+            for (uint32_t i = m_bucketStart[b]; i < m_bucketStart[b + 1]; ++i)
+            {
+                if (m_cx[i] != cx || m_cy[i] != cy) continue;   // hash neighbour, not this cell
+                if ((m_kind[i] & kindMask) == 0) continue;
+
+                float dx = m_x[i] - center.x;
+                float dy = m_y[i] - center.y;
+                float dz = m_z[i] - center.z;
+                if (dx * dx + dy * dy + dz * dz > r2) continue;
+
+                if (found >= maxOut)
+                    return found;
+                outIndex[found++] = i;
+            }
+        }
+    }
+
+    return found;
+}
+
+// --------------------------------------------------------
+//  QueryNearest — expanding rings
+// --------------------------------------------------------
+//  Visit the center cell, then the ring of cells around it,
+//  then the next ring, keeping a small sorted best-k list.
+//  Once rings 0..R are done, anything unvisited is at least
+//  R * cellSize away, so we can stop as soon as the k-th best
+//  is closer than that.
+// --------------------------------------------------------
+uint32_t SpatialGrid::QueryNearest(const Vec3& center, uint32_t k, float maxRadius, uint8_t kindMask,
+    uint32_t* outIndex, float* outDistSq) const
+{
+    if (k > kMaxQueryK) k = kMaxQueryK;
+    if (k == 0 || m_count == 0) return 0;
+
+    const int32_t ccx = CellCoord(center.x);
+    const int32_t ccy = CellCoord(center.y);
+    float rings = maxRadius * m_invCellSize;
+    if (rings > (float)kMaxRings) rings = (float)kMaxRings;
+    const int32_t maxRing = (int32_t)rings + 1;
+
+    float worst = maxRadius * maxRadius;
+    uint32_t found = 0;
+    uint32_t seen = 0;   // entities visited so far (stop once we've seen all of them)
+
+    for (int32_t ring = 0; ring <= maxRing; ++ring)
+    {
+        for (int32_t cy = ccy - ring; cy <= ccy + ring; ++cy)
+        {
+            // Only the outline of the ring (the inside was done already)
+            bool edgeRow = (cy == ccy - ring) || (cy == ccy + ring);
+            int32_t step = edgeRow ? 1 : (ring * 2);
+            if (step == 0) step = 1;
+
+            for (int32_t cx = ccx - ring; cx <= ccx + ring; cx += step)
+            {
+                uint32_t b = BucketOf(cx, cy);
+                for (uint32_t i = m_bucketStart[b]; i < m_bucketStart[b + 1]; ++i)
+                {
+                    if (m_cx[i] != cx || m_cy[i] != cy) continue;
+                    seen++;
+                    if ((m_kind[i] & kindMask) == 0) continue;
+
+                    float dx = m_x[i] - center.x;
+                    float dy = m_y[i] - center.y;
+                    float dz = m_z[i] - center.z;
+                    float d = dx * dx + dy * dy + dz * dz;
+                    if (d > worst) continue;
+
+                    uint32_t pos = (found < k) ? found++ : (k - 1);
+                    while (pos > 0 && outDistSq[pos - 1] > d)
+                    {
+                        outDistSq[pos] = outDistSq[pos - 1];
+                        outIndex[pos] = outIndex[pos - 1];
+                        --pos;
+                    }
+                    outDistSq[pos] = d;
+                    outIndex[pos] = i;
+
+                    if (found == k)
+                        worst = outDistSq[k - 1];
+                }
+            }
+        }
+
+        // Everything not yet visited is at least ring * cellSize away
+        float reach = (float)ring * m_cellSize;
+        if (found == k && worst <= reach * reach)
+            break;
+        if (seen == m_count)
+            break;
+    }
+
+    return found;
+}
+
+int SpatialGrid::Find(int handle) const
+{
+    for (uint32_t i = 0; i < m_count; ++i)
+    {
+        if (m_handle[i] == handle)
+            return (int)i;
+    }
+    return -1;
+}
@@ -0,0 +1,131 @@
+// ============================================================
+//  SpatialGrid.h — Uniform spatial hash for nearby entities
+// ============================================================
+//
+//  PURPOSE:
+//  Protection and Frenzy modes both ask "what's near X?" —
+//  nearest hostile to the player, every ped within 20 m of
+//  the companion, and so on. Scanning every sampled entity for
+//  every question is O(N) per query.
+//
+//  This grid buckets entities by which cell (cellSize x cellSize
+//  meters, on the ground plane) they stand in. A query only
+//  looks at the handful of cells it overlaps, so cost depends
+//  on how crowded the area is — not on the total entity count.
+//
+//  HOW IT'S BUILT:
+//  Rebuilt from scratch each scan (entities move every frame,
+//  so incremental updates would touch most of them anyway):
+//      grid.BeginRebuild();
+//      grid.Insert(handle, EntityKind::Ped, pos);   // xN
+//      grid.FinishRebuild();
+//  FinishRebuild() is a counting sort — two passes over the
+//  entities, no allocation. Everything lives in fixed arrays.
+//
+//  Cells are hashed into a fixed bucket table, so the world
+//  can be any size. Each stored entity remembers its real cell
+//  so hash collisions never produce false hits or duplicates.
+//
+//  Engine-agnostic: main.cpp samples positions through
+//  EngineAdapter and feeds them in.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+#include "CompanionCore.h"
+
+enum EntityKind : uint8_t
+{
+    EntityKind_Ped     = 1 << 0,
+    EntityKind_Vehicle = 1 << 1,
+    EntityKind_Any     = 0xFF
+};
+
+// Per-entity state bits sampled alongside the position (optional;
+// 0 when the scan didn't ask for them). Used for cheap filtering.
+// The player and the companion never get here: the adapter's
+// nearby scan leaves them out.
+enum EntityFlag : uint8_t
+{
+    EntityFlag_Dead      = 1 << 0,
+    EntityFlag_Mission   = 1 << 1    // mission-critical entity: never touch
+};
+
+class SpatialGrid
+{
+public:
+    static constexpr uint32_t kMaxEntities = 4096;
+    static constexpr uint32_t kBucketCount = 4096;   // power of two
+    static constexpr uint32_t kMaxQueryK = 32;
+    static constexpr uint32_t kMaxRings = 64;        // QueryNearest search limit (rings of cells)
+
+    explicit SpatialGrid(float cellSize = 10.0f);
+
+    void SetCellSize(float cellSize);
+    float CellSize() const { return m_cellSize; }
+
+    // --- Rebuild ---
+    void BeginRebuild();
+    bool Insert(int handle, uint8_t kind, const Vec3& pos, uint8_t flags = 0);   // false when full
+    void FinishRebuild();
+
+    // --- Queries ---
+    // Results are entity indices; read them back with Handle()/Position()/Kind().
+
+    // All entities matching kindMask within radius of center.
+    // Returns how many were written (<= maxOut).
+    uint32_t QueryRadius(const Vec3& center, float radius, uint8_t kindMask,
+        uint32_t* outIndex, uint32_t maxOut) const;
+
+    // k closest entities matching kindMask within maxRadius, closest first.
+    uint32_t QueryNearest(const Vec3& center, uint32_t k, float maxRadius, uint8_t kindMask,
+        uint32_t* outIndex, float* outDistSq) const;
+
+    // --- Entity access (valid until the next rebuild) ---
+    uint32_t Count() const { return m_count; }
+    int Handle(uint32_t i) const { return m_handle[i]; }
+    uint8_t Kind(uint32_t i) const { return m_kind[i]; }
+    uint8_t Flags(uint32_t i) const { return m_flags[i]; }
+    Vec3 Position(uint32_t i) const { return Vec3{ m_x[i], m_y[i], m_z[i] }; }
+
+    // Index of an entity by handle, or -1 (linear; for occasional lookups only)
+    int Find(int handle) const;
+
+    // Stats
+    uint32_t DroppedLastRebuild() const { return m_dropped; }
+
+private:
+    int32_t CellCoord(float v) const;
+    static uint32_t BucketOf(int32_t cx, int32_t cy);
+
+    float m_cellSize;
+    float m_invCellSize;
+
+    uint32_t m_count = 0;
+    uint32_t m_dropped = 0;
+
+    // Staging (insert order)
+    uint32_t m_stagedCount = 0;
+    float m_sx[kMaxEntities];
+    float m_sy[kMaxEntities];
+    float m_sz[kMaxEntities];
+    int m_shandle[kMaxEntities];
+    uint8_t m_skind[kMaxEntities];
+    uint8_t m_sflags[kMaxEntities];
+    int32_t m_scx[kMaxEntities];
+    int32_t m_scy[kMaxEntities];
+    uint32_t m_sbucket[kMaxEntities];
+
+    // Sorted by bucket (what queries read)
+    float m_x[kMaxEntities];
+    float m_y[kMaxEntities];
+    float m_z[kMaxEntities];
+    int m_handle[kMaxEntities];
+    uint8_t m_kind[kMaxEntities];
+    uint8_t m_flags[kMaxEntities];
+    int32_t m_cx[kMaxEntities];
+    int32_t m_cy[kMaxEntities];
+
+    // m_bucketStart[b] .. m_bucketStart[b + 1] = entities in bucket b
+    uint32_t m_bucketStart[kBucketCount + 1];
+};
@@ -0,0 +1,212 @@
+// ============================================================
+//  StayDrift.cpp — Adaptive stay-anchor drift correction (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Tick arithmetic is unsigned and wraps: "due" is
+//  (int32_t)(tick - m_nextCheck) >= 0, never tick >= m_nextCheck.
+//
+//  A slide ends on the anchor itself (the last step is clamped),
+//  so the confirming check compares against exactly where the
+//  ped was put. If the ped is still off then, something is still
+//  pushing it: it slides again and the interval stays at base.
+// ============================================================
+
+#include "StayDrift.h"
+#include "GeometryKernels.h"
+#include <cmath>
+
+void StayDrift::Begin(uint32_t baseTicks, uint32_t tick)
+{
+    m_active = true;
+    m_base = (baseTicks > 0) ? baseTicks : 1;
+    m_interval = m_base;
+    m_sliding = false;
+    m_contacts = 0;
+    m_lastProbe = tick;
+    ScheduleCheck(tick, m_interval);
+}
+
+void StayDrift::End()
+{
+    m_active = false;
+    m_sliding = false;
+}
+
+void StayDrift::ScheduleCheck(uint32_t tick, uint32_t delay)
+{
+    m_nextCheck = tick + delay;
+}
+
+StayDriftStep StayDrift::Step(const Vec3& anchor, uint32_t tick, float dtSeconds)
+{
+    StayDriftStep step;
+    if (!m_active)
+        return step;
+
+    m_stats.stayTicks++;
+
+    if (m_sliding)
+    {
+        float dx = anchor.x - m_at.x, dy = anchor.y - m_at.y, dz = anchor.z - m_at.z;
+        float dist = sqrtf(dx * dx + dy * dy + dz * dz);
+        float stepMeters = config.slideSpeed * dtSeconds;
+
+        if (dist <= stepMeters || dist < 1e-4f)
+        {
+            m_at = anchor;
+            m_sliding = false;
+            ScheduleCheck(tick, config.minCheckTicks);
+        }
+        else
+        {
+            float t = stepMeters / dist;
+            m_at = Vec3{ m_at.x + dx * t, m_at.y + dy * t, m_at.z + dz * t };
+        }
+
+        step.move = true;
+        step.to = m_at;
+        m_stats.moves++;
+        return step;
+    }
+
+    if ((int32_t)(tick - m_nextCheck) >= 0)
+    {
+        step.check = true;
+        return step;
+    }
+
+    // Only worth a native if the next check is further off than
+    // the probe would bring it
+    if (tick - m_lastProbe >= config.explosionProbeTicks
+        && (int32_t)(m_nextCheck - tick) > (int32_t)config.minCheckTicks)
+    {
+        step.probe = true;
+        m_lastProbe = tick;
+        m_stats.probes++;
+    }
+    return step;
+}
+
+void StayDrift::Observe(const Vec3& pos, const Vec3& anchor, uint32_t tick)
+{
+    m_stats.checks++;
+
+    float distSq = Geometry::DistSq(pos, anchor);
+    if (distSq <= config.driftMeters * config.driftMeters)
+    {
+        // Still: look less often (a base above the ceiling stays)
+        uint32_t ceiling = (config.maxCheckTicks > m_base) ? config.maxCheckTicks : m_base;
+        uint32_t next = m_interval * 2;
+        m_interval = (next > ceiling) ? ceiling : next;
+        ScheduleCheck(tick, m_interval);
+        return;
+    }
+
+    m_stats.corrections++;
+    m_interval = m_base;
+
+    if (distSq > config.snapMeters * config.snapMeters)
+    {
+        // Thrown: one move (a long slide would look worse)
+        m_stats.snaps++;
+        m_at = anchor;
+        m_sliding = true;
+        return;
+    }
+
+    m_at = pos;
+    m_sliding = true;
+}
+
+void StayDrift::Disturb(StayDisturbance why, uint32_t tick)
+{
+    if (!m_active)
+        return;
+
+    m_stats.disturbances[(int)why]++;
+    m_interval = m_base;
+
+    // Sooner, never later than already planned
+    if (!m_sliding && (int32_t)(m_nextCheck - tick) > (int32_t)config.minCheckTicks)
+        ScheduleCheck(tick, config.minCheckTicks);
+}
+
+void StayDrift::NoteContacts(const Vec3& anchor, const Vec3* positions, uint32_t count, uint32_t tick)
+{
+    if (!m_active)
+        return;
+
+    const float moveSq = config.contactMoveMeters * config.contactMoveMeters;
+    const uint32_t before = (m_contacts < kMaxContacts) ? m_contacts : kMaxContacts;
+    const uint32_t now = (count < kMaxContacts) ? count : kMaxContacts;
+
+    bool moved = false;
+    bool passed = false;
+    ContactTrack next[kMaxContacts];
+
+    for (uint32_t i = 0; i < now; ++i)
+    {
+        ContactTrack& c = next[i];
+        c.position = positions[i];
+        c.anchorDistSq = Geometry::DistSq(positions[i], anchor);
+        c.closing = false;
+
+        // Same contact as last scan = the nearest one it could have
+        // walked from; none = it just arrived
+        int match = -1;
+        float matchSq = kMatchMeters * kMatchMeters;
+        for (uint32_t j = 0; j < before; ++j)
+        {
+            float d = Geometry::DistSq(positions[i], m_tracks[j].position);
+            if (d <= matchSq)
+            {
+                match = (int)j;
+                matchSq = d;
+            }
+        }
+
+        if (match < 0 || matchSq > moveSq)
+            moved = true;
+        if (match >= 0)
+        {
+            const ContactTrack& was = m_tracks[match];
+            c.closing = c.anchorDistSq < was.anchorDistSq;
+            if (was.closing && c.anchorDistSq > was.anchorDistSq)
+                passed = true;
+        }
+    }
+
+    if (count > m_contacts || passed)
+    {
+        // Someone arrived, or one was as close as it gets on the
+        // last scan (where a bump would happen)
+        Disturb(StayDisturbance::Contact, tick);
+    }
+    else if (moved)
+    {
+        // Someone is moving about next to it: no backing off
+        // until they stop or leave
+        m_stats.busyScans++;
+        m_interval = m_base;
+        if (!m_sliding && (int32_t)(m_nextCheck - tick) > (int32_t)m_base)
+            ScheduleCheck(tick, m_base);
+    }
+
+    m_contacts = count;
+    for (uint32_t i = 0; i < now; ++i)
+        m_tracks[i] = next[i];
+}
+
+float StayDrift::ChecksPerMinute() const
+{
+    if (m_stats.stayTicks == 0)
+        return 0.0f;
+    return (float)m_stats.checks * kTicksPerMinute / m_stats.stayTicks;
+}
+
+float StayDrift::FixedChecksPerMinute() const
+{
+    return (float)kTicksPerMinute / m_base;
+}
@@ -0,0 +1,173 @@
+// ============================================================
+//  StayDrift.h — Adaptive stay-anchor drift correction
+// ============================================================
+//
+//  PURPOSE:
+//  Stay freezes the companion where it stands, but physics still
+//  nudges a frozen ped now and then (someone walks into it, a car
+//  clips it, an explosion goes off). Stay used to read the ped's
+//  position every stay_snap_ticks (~1 s) and teleport it back to
+//  the anchor if it had moved more than 10 cm: a native read every
+//  second while nothing happens, and a visible pop when something
+//  does.
+//
+//  This file decides WHEN to look and HOW to put it back:
+//
+//    interval   starts at stay_snap_ticks; every check that finds
+//               the ped where it should be doubles it (up to
+//               maxCheckTicks, 1.5 s). A ped that nothing touches
+//               is read about 48 times a minute (40 checks and
+//               7.5 explosion probes), not 60.
+//    disturbed  something came within contactMeters of the anchor,
+//               or one of those passed its nearest point to it
+//               (from the nearby scan, no natives), or an
+//               explosion went off within explosionMeters: the
+//               next check is minCheckTicks away and the interval
+//               starts over. The explosion probe is one native
+//               every explosionProbeTicks, skipped while a check
+//               is due sooner anyway.
+//    busy       a contact moved since the last scan: the interval
+//               stays at stay_snap_ticks until it stops or
+//               leaves. A parked car doesn't count.
+//    drifted    a check found it more than driftMeters off: it
+//               slides back at slideSpeed, one small move per
+//               frame (positions come from the last move, not
+//               read back), then a check confirms it held. Only a
+//               ped thrown further than snapMeters is put back in
+//               one move.
+//
+//  The bench's stay_drift hour (passers, explosions, the odd
+//  nudge) reads 52 times a minute against 60 and leaves the
+//  companion off the anchor 52 s against 41 s; about 5 s of
+//  that is the slide back, which the fixed snap doesn't have.
+//  A nudge with nothing near to explain it is only found by
+//  the next check, so maxCheckTicks is what trades reads
+//  against time off the anchor.
+//
+//  FLOW (main.cpp StayAnchorLoop, every frame while staying):
+//      step = drift.Step(anchor, tick, dt);
+//      if (step.move)  set the ped's position to step.to
+//      if (step.probe && explosion near anchor) drift.Disturb(...)
+//      if (step.check) drift.Observe(ped position, anchor, tick)
+//  and after each nearby scan: drift.NoteContacts(anchor,
+//  contact positions, count, tick).
+//
+//  Engine-agnostic; builds on Linux. Nothing allocated.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+#include "CompanionCore.h"
+
+struct StayDriftConfig
+{
+    float driftMeters = 0.10f;          // further off than this gets corrected
+    float snapMeters = 2.0f;            // further than this: one move back, not a slide
+    float slideSpeed = 6.0f;            // m/s back towards the anchor (10 cm a frame)
+
+    uint32_t minCheckTicks = 10;        // after a disturbance / a correction
+    uint32_t maxCheckTicks = 90;        // backed-off ceiling (1.5s @60fps)
+
+    float contactMeters = 2.5f;         // ped / vehicle / player this close = disturbance
+    float contactMoveMeters = 0.1f;     // a contact that moved this far since the last scan is moving
+    float explosionMeters = 30.0f;
+    uint32_t explosionProbeTicks = 480; // 8s @60fps
+};
+
+enum class StayDisturbance : uint8_t
+{
+    Contact,
+    Explosion,
+    Count
+};
+
+// What the host does this frame (any combination)
+struct StayDriftStep
+{
+    bool move = false;                  // put the ped at `to`
+    Vec3 to{};
+    bool probe = false;                 // look for explosions near the anchor
+    bool check = false;                 // read the ped's position, then Observe()
+};
+
+struct StayDriftStats
+{
+    uint32_t stayTicks = 0;             // frames spent staying
+    uint32_t checks = 0;                // position reads
+    uint32_t probes = 0;                // explosion probes
+    uint32_t corrections = 0;           // drifts found
+    uint32_t snaps = 0;                 // ...put back in one move
+    uint32_t moves = 0;                 // position sets (slide steps + snaps)
+    uint32_t busyScans = 0;             // scans with a contact moving (interval held at base)
+    uint32_t disturbances[(int)StayDisturbance::Count] = {};
+};
+
+class StayDrift
+{
+public:
+    static constexpr uint32_t kTicksPerMinute = 3600;   // @60fps
+    static constexpr uint32_t kMaxContacts = 16;        // positions kept between scans
+
+    StayDriftConfig config{};
+
+    // Stay began (or the anchor moved). baseTicks = the fixed
+    // interval stay used to check at (stay_snap_ticks).
+    void Begin(uint32_t baseTicks, uint32_t tick);
+    void End();
+    bool Active() const { return m_active; }
+
+    // Once per frame while staying
+    StayDriftStep Step(const Vec3& anchor, uint32_t tick, float dtSeconds);
+
+    // Result of a check: where the ped is
+    void Observe(const Vec3& pos, const Vec3& anchor, uint32_t tick);
+
+    // Something may have moved the ped: look soon
+    void Disturb(StayDisturbance why, uint32_t tick);
+
+    // Entities within contactMeters of the anchor (positions),
+    // after each nearby scan. A rising count, or a contact that
+    // was closing in and now moves away, is a disturbance; one
+    // that just moved holds the interval at base. A car parked
+    // next to the anchor does none of these, so checks still
+    // back off around it.
+    void NoteContacts(const Vec3& anchor, const Vec3* positions, uint32_t count, uint32_t tick);
+
+    uint32_t IntervalTicks() const { return m_interval; }
+    bool Sliding() const { return m_sliding; }
+
+    // Checks per minute while staying, and what the fixed
+    // interval would have cost
+    float ChecksPerMinute() const;
+    float FixedChecksPerMinute() const;
+
+    const StayDriftStats& Stats() const { return m_stats; }
+    void ResetTotals() { m_stats = {}; }
+
+private:
+    void ScheduleCheck(uint32_t tick, uint32_t delay);
+
+    bool m_active = false;
+    uint32_t m_base = 60;
+    uint32_t m_interval = 60;
+    uint32_t m_nextCheck = 0;
+    uint32_t m_lastProbe = 0;
+    uint32_t m_contacts = 0;
+
+    // Contacts on the last scan (the first kMaxContacts), to tell
+    // moving from parked and spot one passing the anchor
+    struct ContactTrack
+    {
+        Vec3 position{};
+        float anchorDistSq = 0.0f;
+        bool closing = false;           // nearer than on the scan before
+    };
+    static constexpr float kMatchMeters = 2.0f;     // furthest a contact moves between scans
+    ContactTrack m_tracks[kMaxContacts];
+
+    // Sliding back: where the last move put the ped
+    bool m_sliding = false;
+    Vec3 m_at{};
+
+    StayDriftStats m_stats{};
+};
@@ -0,0 +1,336 @@
+// ============================================================
+//  TeleportSearch.cpp — Safe teleport destination search (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Candidates are laid out once per search in the player's frame
+//  (every other ring turned by half a step, so the rings don't
+//  line up behind one wall) and sorted by their preference score.
+//  Ground results only ever add to a score, so the first spots
+//  that pass are usually the best ones; the search still takes
+//  enoughAccepted of them and keeps the lowest total.
+//
+//  "Feet" is the entity Z minus pedRootHeight; heights and grades
+//  are measured feet to ground, and the chosen spot is returned
+//  as entity coords again (ground + pedRootHeight).
+//
+//  A search that ends with probes still in flight just drops
+//  them: the game discards shape test results nobody reads.
+// ============================================================
+
+#include "TeleportSearch.h"
+#include <cmath>
+
+float TeleportSearch::PreferenceScore(float dx, float dy) const
+{
+    float dist = sqrtf(dx * dx + dy * dy);
+    if (dist < 0.001f)
+        return 0.0f;
+
+    // +1 straight ahead of the player, -1 straight behind
+    float ahead = (dx * m_forwardX + dy * m_forwardY) / dist;
+
+    return fabsf(dist - config.preferredRadius) * config.radiusWeight
+        + (1.0f + ahead) * config.frontWeight;
+}
+
+TeleportSearchStatus TeleportSearch::Begin(const Vec3& playerPos, float forwardX, float forwardY, double nowSeconds)
+{
+    m_stats.searches++;
+
+    m_player = playerPos;
+    m_playerFeetZ = playerPos.z - config.pedRootHeight;
+    m_forwardX = forwardX;
+    m_forwardY = forwardY;
+    m_frames = 0;
+    m_nextUnchecked = 0;
+    m_inFlight = 0;
+    m_accepted = 0;
+
+    if (LookUpCache(nowSeconds))
+    {
+        m_stats.cacheHits++;
+        m_status = TeleportSearchStatus::FoundCached;
+        return m_status;
+    }
+
+    // Player frame -> world: right = forward turned 90° clockwise
+    const float rightX = forwardY;
+    const float rightY = -forwardX;
+    const float step = 6.2831853f / (float)kDirections;
+
+    uint32_t n = 0;
+    for (uint32_t ring = 0; ring < kRings; ++ring)
+    {
+        float r = config.ringRadius[ring];
+        float turn = (ring & 1) ? step * 0.5f : 0.0f;
+
+        for (uint32_t dir = 0; dir < kDirections; ++dir)
+        {
+            // Direction 0 = straight behind, then round via the right
+            float a = step * (float)dir + turn;
+            float side = r * sinf(a);
+            float ahead = -r * cosf(a);
+
+            Candidate c;
+            c.x = playerPos.x + rightX * side + forwardX * ahead;
+            c.y = playerPos.y + rightY * side + forwardY * ahead;
+            c.score = PreferenceScore(c.x - playerPos.x, c.y - playerPos.y);
+
+            // Insertion sort by score (24 entries, once per search)
+            uint32_t i = n++;
+            while (i > 0 && m_candidates[i - 1].score > c.score)
+            {
+                m_candidates[i] = m_candidates[i - 1];
+                --i;
+            }
+            m_candidates[i] = c;
+        }
+    }
+
+    m_status = TeleportSearchStatus::Running;
+    return m_status;
+}
+
+TeleportSearchStatus TeleportSearch::Step(const TeleportProbes& probes, double nowSeconds)
+{
+    if (m_status != TeleportSearchStatus::Running)
+        return m_status;
+
+    m_frames++;
+    m_stats.frames++;
+
+    // 1. Probes started on earlier frames
+    uint32_t grounded = 0;
+    for (uint32_t i = 0; i < kCandidates; ++i)
+    {
+        Candidate& c = m_candidates[i];
+        if (c.state == CandidateState::Grounded)
+            grounded++;
+        if (c.state != CandidateState::Probing)
+            continue;
+
+        m_stats.probePolls++;
+        switch (probes.pollProbe(probes.user, c.probe))
+        {
+        case ProbeStatus::Pending:
+            continue;
+        case ProbeStatus::Clear:
+            c.state = CandidateState::Accepted;
+            m_accepted++;
+            break;
+        case ProbeStatus::Blocked:
+            Reject(c, TeleportReject::Blocked);
+            break;
+        case ProbeStatus::Failed:
+        default:
+            Reject(c, TeleportReject::ProbeFailed);
+            break;
+        }
+        m_inFlight--;
+    }
+
+    if (m_accepted >= config.enoughAccepted)
+        return Finish(nowSeconds);
+
+    // 2. Spots that passed the ground check while every probe slot was busy
+    for (uint32_t i = 0; i < kCandidates && grounded > 0; ++i)
+    {
+        Candidate& c = m_candidates[i];
+        if (c.state != CandidateState::Grounded)
+            continue;
+        if (m_inFlight >= config.maxProbesInFlight || m_accepted + m_inFlight >= config.enoughAccepted)
+            break;
+
+        StartProbe(c, probes);
+        grounded--;
+    }
+
+    // 3. Ground checks for the next candidates, only as many as
+    //    could still be needed
+    const float zTop = m_playerFeetZ + config.maxStepMeters + config.pedRootHeight;
+    uint32_t budget = config.groundPerFrame;
+
+    while (budget > 0 && m_nextUnchecked < kCandidates
+        && m_accepted + m_inFlight + grounded < config.enoughAccepted)
+    {
+        Candidate& c = m_candidates[m_nextUnchecked++];
+        budget--;
+
+        m_stats.groundChecks++;
+        if (!CheckGround(c, probes.ground(probes.user, c.x, c.y, zTop)))
+            continue;
+
+        if (m_inFlight < config.maxProbesInFlight)
+            StartProbe(c, probes);
+        else
+            grounded++;
+    }
+
+    bool exhausted = m_nextUnchecked >= kCandidates && m_inFlight == 0 && grounded == 0;
+    if (exhausted || m_frames >= config.maxFrames)
+        return Finish(nowSeconds);
+
+    return m_status;
+}
+
+bool TeleportSearch::CheckGround(Candidate& c, const GroundSample& g)
+{
+    if (!g.found)
+    {
+        Reject(c, TeleportReject::NoGround);
+        return false;
+    }
+    if (g.water && g.waterZ - g.groundZ > config.waterMargin)
+    {
+        Reject(c, TeleportReject::Water);
+        return false;
+    }
+
+    float rise = fabsf(g.groundZ - m_playerFeetZ);
+    if (rise > config.maxStepMeters)
+    {
+        Reject(c, TeleportReject::Height);
+        return false;
+    }
+
+    float dx = c.x - m_player.x;
+    float dy = c.y - m_player.y;
+    float grade = rise / sqrtf(dx * dx + dy * dy);
+    if (grade > config.maxGrade)
+    {
+        Reject(c, TeleportReject::Steep);
+        return false;
+    }
+
+    c.groundZ = g.groundZ;
+    c.score += rise * config.heightWeight + grade * config.gradeWeight;
+    c.state = CandidateState::Grounded;
+    return true;
+}
+
+void TeleportSearch::StartProbe(Candidate& c, const TeleportProbes& probes)
+{
+    Vec3 from{ m_player.x, m_player.y, m_playerFeetZ + config.probeHeight };
+    Vec3 to{ c.x, c.y, c.groundZ + config.probeHeight };
+
+    m_stats.probesStarted++;
+    c.probe = probes.startProbe(probes.user, from, to, config.probeRadius);
+    if (c.probe == 0)
+    {
+        Reject(c, TeleportReject::ProbeFailed);
+        return;
+    }
+
+    c.state = CandidateState::Probing;
+    m_inFlight++;
+}
+
+void TeleportSearch::Reject(Candidate& c, TeleportReject why)
+{
+    c.state = CandidateState::Rejected;
+    m_stats.rejected[(int)why]++;
+}
+
+TeleportSearchStatus TeleportSearch::Finish(double nowSeconds)
+{
+    const Candidate* best = nullptr;
+    for (uint32_t i = 0; i < kCandidates; ++i)
+    {
+        const Candidate& c = m_candidates[i];
+        if (c.state != CandidateState::Accepted)
+            continue;
+
+        Remember(Vec3{ c.x, c.y, c.groundZ + config.pedRootHeight }, nowSeconds);
+        if (best == nullptr || c.score < best->score)
+            best = &c;
+    }
+
+    if (best == nullptr)
+    {
+        m_stats.failed++;
+        m_status = TeleportSearchStatus::Failed;
+        return m_status;
+    }
+
+    m_result = Vec3{ best->x, best->y, best->groundZ + config.pedRootHeight };
+    m_stats.found++;
+    m_status = TeleportSearchStatus::Found;
+    return m_status;
+}
+
+bool TeleportSearch::LookUpCache(double nowSeconds)
+{
+    const float minSq = config.cacheMinDistance * config.cacheMinDistance;
+    const float maxSq = config.cacheMaxDistance * config.cacheMaxDistance;
+
+    int best = -1;
+    float bestScore = 0.0f;
+
+    for (uint32_t i = 0; i < m_cacheCount; ++i)
+    {
+        const CachedSpot& spot = m_cache[i];
+        if (nowSeconds - spot.seconds > config.cacheMaxAgeSeconds)
+            continue;
+
+        float dx = spot.position.x - m_player.x;
+        float dy = spot.position.y - m_player.y;
+        float distSq = dx * dx + dy * dy;
+        if (distSq < minSq || distSq > maxSq)
+            continue;
+
+        // Same height rules as a fresh candidate
+        float rise = fabsf(spot.position.z - config.pedRootHeight - m_playerFeetZ);
+        float grade = rise / sqrtf(distSq);
+        if (rise > config.maxStepMeters || grade > config.maxGrade)
+            continue;
+
+        float score = PreferenceScore(dx, dy) + rise * config.heightWeight + grade * config.gradeWeight;
+        if (best < 0 || score < bestScore)
+        {
+            best = (int)i;
+            bestScore = score;
+        }
+    }
+
+    if (best < 0)
+        return false;
+
+    m_result = m_cache[best].position;
+    return true;
+}
+
+void TeleportSearch::Remember(const Vec3& position, double nowSeconds)
+{
+    // Already known (within a meter): just refresh its time
+    for (uint32_t i = 0; i < m_cacheCount; ++i)
+    {
+        float dx = m_cache[i].position.x - position.x;
+        float dy = m_cache[i].position.y - position.y;
+        float dz = m_cache[i].position.z - position.z;
+        if (dx * dx + dy * dy + dz * dz < 1.0f)
+        {
+            m_cache[i].seconds = nowSeconds;
+            return;
+        }
+    }
+
+    uint32_t slot = m_cacheCount;
+    if (m_cacheCount < kCacheSlots)
+    {
+        m_cacheCount++;
+    }
+    else
+    {
+        slot = 0;
+        for (uint32_t i = 1; i < kCacheSlots; ++i)
+        {
+            if (m_cache[i].seconds < m_cache[slot].seconds)
+                slot = i;
+        }
+    }
+
+    m_cache[slot].position = position;
+    m_cache[slot].seconds = nowSeconds;
+}
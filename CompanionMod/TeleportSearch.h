@@ -0,0 +1,249 @@
+// ============================================================
+//  TeleportSearch.h — Safe teleport destination search
+// ============================================================
+//
+//  PURPOSE:
+//  Teleports (auto catch-up, F5 recall, release from a vehicle)
+//  used to drop the companion at player + (1.2, 0.8, 0) with the
+//  player's Z. Next to a wall that is inside the wall; on a slope
+//  it is in the hill or in the air; at a pier it is in the water.
+//  A ped stuck in geometry doesn't move, so the gap grows and the
+//  next check teleports it into the same spot again.
+//
+//  The search looks at a ring of candidate spots around the
+//  player and picks a good one that has been checked:
+//
+//            . . .          3 rings x 8 directions, tried in
+//          .   .   .        order of preference: near the
+//         . .  P  . .       preferred distance, beside / behind
+//          .   .   .        the player rather than in front
+//            . . .          (P = player, facing up)
+//
+//  Each candidate goes through:
+//    1. ground   ground Z under the spot + water height.
+//                Rejected: no ground (collision not loaded, off
+//                the map), under water, too far above / below
+//                the player, too steep from the player's feet.
+//    2. probe    an async capsule test from the player to the
+//                spot at body height: anything solid on the way
+//                or at the spot (wall, fence, parked car) rejects
+//                it. Started one frame, read on a later one.
+//  The search stops once enoughAccepted spots passed (or all
+//  were tried, or maxFrames ran out) and returns the best-scored
+//  one. It costs a few natives per frame for a few frames; the
+//  host drives it from a coroutine (main.cpp TeleportCompanion).
+//
+//  CACHE:
+//  Every spot that passed is remembered (kCacheSlots, oldest
+//  replaced) with the time. A new search first looks there: a
+//  recent spot near the player at about its height is used as
+//  is, with no natives and no frames. Recalls in one area (a
+//  companion that keeps falling behind in the same streets)
+//  mostly hit the cache. A cached spot isn't probed again: it is
+//  safe to stand on, but may be round a corner from the player
+//  (it's at most cacheMaxDistance away, and follow sorts that).
+//
+//  The probes are callbacks (TeleportProbes): EngineAdapter in
+//  the game, simulated heightfields in Tools/Bench and Tools/Tests.
+//
+//  Engine-agnostic; builds on Linux. Nothing allocated.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+#include "CompanionCore.h"
+
+// Ground under a candidate (one host call = ground + water)
+struct GroundSample
+{
+    bool found = false;             // false = no ground under the spot
+    float groundZ = 0.0f;
+    bool water = false;             // water surface at the spot...
+    float waterZ = 0.0f;            // ...at this height
+};
+
+enum class ProbeStatus : uint8_t
+{
+    Pending,        // not ready yet, poll again next frame
+    Clear,          // nothing hit
+    Blocked,        // something solid in the way / at the spot
+    Failed          // lost / invalid handle
+};
+
+// Host side of the search. All calls happen inside Step().
+struct TeleportProbes
+{
+    // Ground + water at (x, y), searching down from zTop
+    GroundSample (*ground)(void* user, float x, float y, float zTop) = nullptr;
+
+    // Starts a clearance probe (capsule of `radius` from -> to).
+    // Returns a handle, 0 if it couldn't be started.
+    int (*startProbe)(void* user, const Vec3& from, const Vec3& to, float radius) = nullptr;
+
+    ProbeStatus (*pollProbe)(void* user, int handle) = nullptr;
+
+    void* user = nullptr;
+};
+
+struct TeleportSearchConfig
+{
+    float ringRadius[3] = { 2.0f, 3.5f, 5.5f };
+    float preferredRadius = 2.0f;
+
+    float pedRootHeight = 1.0f;     // entity coords are this far above the feet
+    float maxStepMeters = 2.5f;     // spot ground vs player's feet, up or down
+    float maxGrade = 0.7f;          // rise / run from the player's feet (~35°)
+    float waterMargin = 0.3f;       // water deeper than this = rejected
+
+    float probeHeight = 1.0f;       // capsule runs at feet + this...
+    float probeRadius = 0.35f;      // ...this thick (about a ped's shoulders)
+
+    uint32_t groundPerFrame = 4;    // ground checks started per Step
+    uint32_t maxProbesInFlight = 4;
+    uint32_t enoughAccepted = 3;    // stop once this many spots passed
+    uint32_t maxFrames = 8;         // give up after this many Steps
+
+    // Cache
+    float cacheMinDistance = 1.0f;  // not on top of the player
+    float cacheMaxDistance = 6.0f;
+    double cacheMaxAgeSeconds = 30.0;
+
+    // Score weights (lower score = better)
+    float radiusWeight = 1.0f;      // per meter from preferredRadius
+    float frontWeight = 1.5f;       // 0 behind .. 2x this straight ahead
+    float heightWeight = 1.0f;      // per meter above / below the player
+    float gradeWeight = 2.0f;
+};
+
+enum class TeleportSearchStatus : uint8_t
+{
+    Idle,
+    Running,        // call Step() again next frame
+    Found,          // position() is a checked spot
+    FoundCached,    // ...from the cache, no natives spent
+    Failed          // nothing passed; caller decides what to do
+};
+
+inline const char* TeleportSearchStatusName(TeleportSearchStatus s)
+{
+    switch (s)
+    {
+    case TeleportSearchStatus::Idle:        return "Idle";
+    case TeleportSearchStatus::Running:     return "Running";
+    case TeleportSearchStatus::Found:       return "Found";
+    case TeleportSearchStatus::FoundCached: return "FoundCached";
+    case TeleportSearchStatus::Failed:      return "Failed";
+    default:                                return "?";
+    }
+}
+
+// Why candidates were turned down (totals, for the heartbeat log)
+enum class TeleportReject : uint8_t
+{
+    NoGround,
+    Water,
+    Height,
+    Steep,
+    Blocked,
+    ProbeFailed,
+    Count
+};
+
+struct TeleportSearchStats
+{
+    uint32_t searches = 0;
+    uint32_t found = 0;
+    uint32_t cacheHits = 0;
+    uint32_t failed = 0;
+    uint32_t frames = 0;            // Steps spent, all searches
+    uint32_t groundChecks = 0;
+    uint32_t probesStarted = 0;
+    uint32_t probePolls = 0;
+    uint32_t rejected[(int)TeleportReject::Count] = {};
+};
+
+class TeleportSearch
+{
+public:
+    static constexpr uint32_t kRings = 3;
+    static constexpr uint32_t kDirections = 8;
+    static constexpr uint32_t kCandidates = kRings * kDirections;
+    static constexpr uint32_t kCacheSlots = 8;
+
+    TeleportSearchConfig config{};
+
+    // Starts a search around the player. playerPos = entity
+    // coords; forwardX/Y = facing (unit vector). Answers from the
+    // cache right away if it can (status FoundCached).
+    TeleportSearchStatus Begin(const Vec3& playerPos, float forwardX, float forwardY, double nowSeconds);
+
+    // One frame of work: reads finished probes, then starts ground
+    // checks / probes within the per-frame budget.
+    TeleportSearchStatus Step(const TeleportProbes& probes, double nowSeconds);
+
+    TeleportSearchStatus Status() const { return m_status; }
+
+    // The chosen spot (entity coords: feet + pedRootHeight).
+    // Valid when Status() is Found / FoundCached.
+    const Vec3& Position() const { return m_result; }
+
+    // Steps the current / last search took
+    uint32_t Frames() const { return m_frames; }
+
+    // Forget every cached spot (world changed: new session, interior)
+    void ClearCache() { m_cacheCount = 0; }
+    uint32_t CacheCount() const { return m_cacheCount; }
+
+    const TeleportSearchStats& Stats() const { return m_stats; }
+    void ResetTotals() { m_stats = {}; }
+
+private:
+    enum class CandidateState : uint8_t
+    {
+        Unchecked,
+        Grounded,       // ground OK, probe not started yet
+        Probing,
+        Accepted,
+        Rejected
+    };
+
+    struct Candidate
+    {
+        float x = 0.0f, y = 0.0f;
+        float groundZ = 0.0f;
+        float score = 0.0f;         // preference first, + ground terms once known
+        int probe = 0;
+        CandidateState state = CandidateState::Unchecked;
+    };
+
+    struct CachedSpot
+    {
+        Vec3 position{};            // entity coords
+        double seconds = 0.0;       // when it was checked
+    };
+
+    float PreferenceScore(float dx, float dy) const;
+    bool CheckGround(Candidate& c, const GroundSample& g);
+    void StartProbe(Candidate& c, const TeleportProbes& probes);
+    void Reject(Candidate& c, TeleportReject why);
+    TeleportSearchStatus Finish(double nowSeconds);
+    bool LookUpCache(double nowSeconds);
+    void Remember(const Vec3& position, double nowSeconds);
+
+    Candidate m_candidates[kCandidates];    // in preference order
+    uint32_t m_nextUnchecked = 0;
+    uint32_t m_inFlight = 0;
+    uint32_t m_accepted = 0;
+
+    Vec3 m_player{};
+    float m_playerFeetZ = 0.0f;
+    float m_forwardX = 0.0f, m_forwardY = 1.0f;
+    uint32_t m_frames = 0;
+    TeleportSearchStatus m_status = TeleportSearchStatus::Idle;
+    Vec3 m_result{};
+
+    CachedSpot m_cache[kCacheSlots];
+    uint32_t m_cacheCount = 0;
+
+    TeleportSearchStats m_stats{};
+};
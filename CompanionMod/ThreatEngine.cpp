@@ -0,0 +1,328 @@
+// ============================================================
+//  ThreatEngine.cpp — Protection mode threat scoring (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  A candidate's score has two kinds of input:
+//    sampled  = everything that needs natives (hostility, combat,
+//               aiming, weapon, damage) — cached, only updated
+//               when the ped is sampled
+//    distance = pure math from the grid position — on each grid
+//               sync every candidate is re-scored from its cached
+//               sample and new distance (no natives)
+//
+//  A ped only counts as a threat at all if it is hostile, in
+//  combat with the player, or recently hurt the player. An armed
+//  cop walking past is not a threat.
+//
+//  The top-K list stores slot indices. Sync compacts the slot
+//  array, so after a sync the list is rebuilt from the cached
+//  scores (a compare per candidate, no rescoring).
+// ============================================================
+
+#include "ThreatEngine.h"
+#include "SpatialGrid.h"
+#include <cmath>
+
+ThreatEngine::ThreatEngine()
+{
+    Reset();
+}
+
+void ThreatEngine::Reset()
+{
+    m_count = 0;
+    m_topCount = 0;
+    m_cursor = 0;
+    m_stats = {};
+    RebuildMap();
+}
+
+// --------------------------------------------------------
+//  Scoring
+// --------------------------------------------------------
+
+float ThreatEngine::Score(const PedThreatInfo& info, float distSq, uint32_t ticksSinceDamage) const
+{
+    if (!info.exists || info.dead)
+        return 0.0f;
+
+    bool recentDamage = ticksSinceDamage < config.damageMemoryTicks;
+    if (!info.hostile && !info.inCombatWithPlayer && !recentDamage)
+        return 0.0f;
+
+    float score = 0.0f;
+
+    if (info.hostile) score += config.wHostile;
+    if (info.inCombatWithPlayer) score += config.wInCombat;
+    if (info.aimingAtPlayer) score += config.wAiming;
+
+    if (info.weapon == WeaponClass::Gun) score += config.wGun;
+    else if (info.weapon == WeaponClass::Melee) score += config.wMelee;
+
+    if (recentDamage)
+    {
+        float fade = 1.0f - (float)ticksSinceDamage / (float)config.damageMemoryTicks;
+        score += config.wRecentDamage * fade;
+    }
+
+    float dist = sqrtf(distSq);
+    if (dist < config.candidateRadius)
+        score += config.wDistance * (1.0f - dist / config.candidateRadius);
+
+    return score;
+}
+
+// --------------------------------------------------------
+//  handle -> slot map
+// --------------------------------------------------------
+
+static uint32_t HashHandle(int handle)
+{
+    return (uint32_t)handle * 2654435761u;
+}
+
+int ThreatEngine::FindSlot(int handle) const
+{
+    uint32_t h = HashHandle(handle) & (kMapSize - 1);
+    for (uint32_t probe = 0; probe < kMapSize; ++probe)
+    {
+        int16_t slot = m_map[h];
+        if (slot < 0) return -1;
+        if (m_candidates[slot].handle == handle) return slot;
+        h = (h + 1) & (kMapSize - 1);
+    }
+    return -1;
+}
+
+void ThreatEngine::RebuildMap()
+{
+    for (uint32_t i = 0; i < kMapSize; ++i)
+        m_map[i] = -1;
+
+    for (uint32_t slot = 0; slot < m_count; ++slot)
+    {
+        uint32_t h = HashHandle(m_candidates[slot].handle) & (kMapSize - 1);
+        while (m_map[h] >= 0)
+            h = (h + 1) & (kMapSize - 1);
+        m_map[h] = (int16_t)slot;
+    }
+}
+
+// --------------------------------------------------------
+//  Top-K list
+// --------------------------------------------------------
+
+bool ThreatEngine::IsInTop(uint32_t slot) const
+{
+    for (uint32_t i = 0; i < m_topCount; ++i)
+    {
+        if (m_top[i] == slot) return true;
+    }
+    return false;
+}
+
+void ThreatEngine::RemoveFromTop(uint32_t slot)
+{
+    for (uint32_t i = 0; i < m_topCount; ++i)
+    {
+        if (m_top[i] != slot) continue;
+
+        for (uint32_t j = i + 1; j < m_topCount; ++j)
+            m_top[j - 1] = m_top[j];
+        m_topCount--;
+        return;
+    }
+}
+
+void ThreatEngine::InsertIntoTop(uint32_t slot)
+{
+    float score = m_candidates[slot].score;
+    if (score < config.minScore)
+        return;
+
+    if (m_topCount == kTopK && score <= m_candidates[m_top[kTopK - 1]].score)
+        return;
+
+    uint32_t pos = (m_topCount < kTopK) ? m_topCount++ : (kTopK - 1);
+    while (pos > 0 && m_candidates[m_top[pos - 1]].score < score)
+    {
+        m_top[pos] = m_top[pos - 1];
+        --pos;
+    }
+    m_top[pos] = slot;
+}
+
+// Fills free top-K places from cached scores (no rescoring)
+void ThreatEngine::RefillTop()
+{
+    for (uint32_t slot = 0; slot < m_count && m_topCount < kTopK; ++slot)
+    {
+        if (!IsInTop(slot))
+            InsertIntoTop(slot);
+    }
+
+    // If the list filled up part-way through, a later candidate
+    // may still beat the current last place.
+    for (uint32_t slot = 0; slot < m_count; ++slot)
+    {
+        if (m_topCount == kTopK && !IsInTop(slot))
+            InsertIntoTop(slot);
+    }
+}
+
+// --------------------------------------------------------
+//  SyncCandidates
+// --------------------------------------------------------
+
+void ThreatEngine::SyncCandidates(const SpatialGrid& grid, const Vec3& playerPos, uint32_t tickCount)
+{
+    m_gen++;
+    m_stats.droppedCandidates = 0;
+
+    uint32_t n = grid.QueryRadius(playerPos, config.candidateRadius, EntityKind_Ped, m_found, kMaxCandidates);
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        int handle = grid.Handle(m_found[i]);
+        int slot = FindSlot(handle);
+
+        if (slot < 0)
+        {
+            if (m_count >= kMaxCandidates)
+            {
+                m_stats.droppedCandidates++;
+                continue;
+            }
+
+            slot = (int)m_count++;
+            Candidate& c = m_candidates[slot];
+            c = Candidate{};
+            c.handle = handle;
+
+            uint32_t h = HashHandle(handle) & (kMapSize - 1);
+            while (m_map[h] >= 0)
+                h = (h + 1) & (kMapSize - 1);
+            m_map[h] = (int16_t)slot;
+        }
+
+        Candidate& c = m_candidates[slot];
+        c.pos = grid.Position(m_found[i]);
+        c.seenGen = m_gen;
+
+        float dx = c.pos.x - playerPos.x;
+        float dy = c.pos.y - playerPos.y;
+        float dz = c.pos.z - playerPos.z;
+        c.distSq = dx * dx + dy * dy + dz * dz;
+    }
+
+    // Drop candidates that left the radius (compacting in place) and
+    // refresh the distance part of everyone else's score.
+    uint32_t write = 0;
+    for (uint32_t read = 0; read < m_count; ++read)
+    {
+        Candidate& c = m_candidates[read];
+        if (c.seenGen != m_gen)
+            continue;
+
+        if (c.sampled && c.score > 0.0f)
+        {
+            uint32_t since = c.everDamaged ? (tickCount - c.lastDamageTick) : 0xFFFFFFFFu;
+            c.score = Score(c.info, c.distSq, since);
+        }
+
+        if (write != read)
+            m_candidates[write] = c;
+        write++;
+    }
+    m_count = write;
+
+    if (m_cursor >= m_count)
+        m_cursor = 0;
+
+    RebuildMap();
+
+    m_topCount = 0;
+    RefillTop();
+
+    m_stats.candidates = m_count;
+    m_stats.topCount = m_topCount;
+}
+
+// --------------------------------------------------------
+//  Sampling
+// --------------------------------------------------------
+
+uint32_t ThreatEngine::PickForSampling(int* outHandles, uint32_t maxOut)
+{
+    uint32_t budget = (config.budgetPerFrame < maxOut) ? config.budgetPerFrame : maxOut;
+    uint32_t picked = 0;
+
+    // New candidates first — they have no score at all yet
+    for (uint32_t slot = 0; slot < m_count && picked < budget; ++slot)
+    {
+        if (!m_candidates[slot].sampled)
+            outHandles[picked++] = m_candidates[slot].handle;
+    }
+
+    // Then round-robin over the rest
+    for (uint32_t visited = 0; visited < m_count && picked < budget; ++visited)
+    {
+        const Candidate& c = m_candidates[m_cursor];
+        if (c.sampled)
+            outHandles[picked++] = c.handle;
+
+        m_cursor = (m_cursor + 1 < m_count) ? (m_cursor + 1) : 0;
+    }
+
+    m_stats.sampledThisFrame = picked;
+    return picked;
+}
+
+void ThreatEngine::ApplySample(int handle, const PedThreatInfo& info, uint32_t tickCount)
+{
+    int slot = FindSlot(handle);
+    if (slot < 0)
+        return;
+
+    Candidate& c = m_candidates[slot];
+    const float before = c.score;
+    c.info = info;
+    c.sampled = true;
+
+    if (info.damagedPlayer)
+    {
+        c.lastDamageTick = tickCount;
+        c.everDamaged = true;
+    }
+
+    uint32_t since = c.everDamaged ? (tickCount - c.lastDamageTick) : 0xFFFFFFFFu;
+    c.score = Score(info, c.distSq, since);
+
+    // Patch the top-K list for just this candidate. A member that
+    // scored lower may now rank below someone outside the list,
+    // so its place is refilled from every candidate (itself
+    // included) instead of handed straight back to it.
+    bool wasInTop = IsInTop((uint32_t)slot);
+    if (wasInTop)
+        RemoveFromTop((uint32_t)slot);
+
+    if (wasInTop && c.score < before)
+        RefillTop();
+    else
+        InsertIntoTop((uint32_t)slot);
+
+    m_stats.topCount = m_topCount;
+}
+
+uint32_t ThreatEngine::TopThreats(ThreatEntry* out, uint32_t maxOut) const
+{
+    uint32_t n = (m_topCount < maxOut) ? m_topCount : maxOut;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        out[i].handle = m_candidates[m_top[i]].handle;
+        out[i].score = m_candidates[m_top[i]].score;
+    }
+    return n;
+}
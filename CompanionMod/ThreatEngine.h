@@ -0,0 +1,147 @@
+// ============================================================
+//  ThreatEngine.h — Protection mode threat scoring
+// ============================================================
+//
+//  PURPOSE:
+//  In Protection mode the companion should go after whoever is
+//  the biggest danger to the player. This file decides who that
+//  is.
+//
+//  Each candidate ped near the player gets a score from:
+//    - distance to the player (closer = worse)
+//    - hostile relationship / in combat with the player
+//    - aiming at the player
+//    - weapon (gun > melee > nothing)
+//    - recently damaged the player (fades over a few seconds)
+//
+//  WHY INCREMENTAL:
+//  Scoring a ped needs several natives (relationship, combat,
+//  weapon, damage). With 200 peds around, rescoring everyone
+//  every frame would blow the frame budget. Instead:
+//    - membership comes for free from the spatial grid scan
+//    - only `budgetPerFrame` peds are sampled + rescored per
+//      frame (new peds first, then round-robin)
+//    - a small top-K list is patched as individual scores change
+//  So the per-frame cost is fixed no matter how crowded it gets.
+//
+//  FLOW (main.cpp):
+//      threats.SyncCandidates(grid, playerPos, tick);   // after each grid scan
+//      n = threats.PickForSampling(handles, max);
+//      for each: threats.ApplySample(h, Adapter::QueryPedThreat(h), tick);
+//      ctx.topThreatHandle = threats.TopThreat();
+//
+//  Engine-agnostic: no natives here.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+#include "CompanionCore.h"
+
+class SpatialGrid;
+
+struct ThreatConfig
+{
+    float candidateRadius = 40.0f;     // only peds this close to the player are candidates
+    uint32_t budgetPerFrame = 8;       // peds sampled + rescored per frame
+    float minScore = 30.0f;            // below this, a ped is not a threat
+
+    // Score weights
+    float wDistance = 30.0f;           // full weight at 0 m, fades to 0 at candidateRadius
+    float wHostile = 15.0f;
+    float wInCombat = 25.0f;
+    float wAiming = 35.0f;
+    float wMelee = 10.0f;
+    float wGun = 25.0f;
+    float wRecentDamage = 50.0f;
+    uint32_t damageMemoryTicks = 600;  // ~10s @60fps for the damage bonus to fade out
+};
+
+struct ThreatEntry
+{
+    int handle = 0;
+    float score = 0.0f;
+};
+
+struct ThreatStats
+{
+    uint32_t candidates = 0;
+    uint32_t sampledThisFrame = 0;
+    uint32_t topCount = 0;
+    uint32_t droppedCandidates = 0;    // grid had more peds in range than we can track
+};
+
+class ThreatEngine
+{
+public:
+    static constexpr uint32_t kMaxCandidates = 512;
+    static constexpr uint32_t kTopK = 8;
+
+    ThreatConfig config{};
+
+    ThreatEngine();
+
+    // Forget everything (despawn, mission start, mode change)
+    void Reset();
+
+    // Refresh candidate membership + positions from the latest grid
+    // scan. Peds that left the radius are dropped. No scoring here.
+    void SyncCandidates(const SpatialGrid& grid, const Vec3& playerPos, uint32_t tickCount);
+
+    // Handles to sample this frame (<= min(maxOut, budgetPerFrame)).
+    uint32_t PickForSampling(int* outHandles, uint32_t maxOut);
+
+    // Feed one adapter sample back in; rescored and top-K patched.
+    void ApplySample(int handle, const PedThreatInfo& info, uint32_t tickCount);
+
+    // Highest-ranked threat (0 = none)
+    int TopThreat() const { return (m_topCount > 0) ? m_candidates[m_top[0]].handle : 0; }
+    float TopScore() const { return (m_topCount > 0) ? m_candidates[m_top[0]].score : 0.0f; }
+
+    // Current top-K, best first. Returns count.
+    uint32_t TopThreats(ThreatEntry* out, uint32_t maxOut) const;
+
+    const ThreatStats& Stats() const { return m_stats; }
+
+    // Pure scoring function (exposed so it can be checked in isolation)
+    float Score(const PedThreatInfo& info, float distSq, uint32_t ticksSinceDamage) const;
+
+private:
+    struct Candidate
+    {
+        int handle = 0;
+        Vec3 pos{};
+        float distSq = 0.0f;
+        float score = 0.0f;
+        PedThreatInfo info{};          // last adapter sample
+        uint32_t lastDamageTick = 0;
+        bool everDamaged = false;
+        bool sampled = false;
+        uint32_t seenGen = 0;
+    };
+
+    int FindSlot(int handle) const;
+    void RebuildMap();
+    void RemoveFromTop(uint32_t slot);
+    void InsertIntoTop(uint32_t slot);
+    void RefillTop();
+    bool IsInTop(uint32_t slot) const;
+
+    Candidate m_candidates[kMaxCandidates];
+    uint32_t m_count = 0;
+
+    // handle -> slot (open addressing, rebuilt after each sync)
+    static constexpr uint32_t kMapSize = kMaxCandidates * 2;   // power of two
+    int16_t m_map[kMapSize];
+
+    // SyncCandidates' query results. Per engine, not a local
+    // static: syncs run on job workers, possibly two at once.
+    uint32_t m_found[kMaxCandidates];
+
+    uint32_t m_top[kTopK];     // slots, best first
+    uint32_t m_topCount = 0;
+
+    uint32_t m_cursor = 0;     // round-robin position
+    uint32_t m_gen = 0;
+
+    ThreatStats m_stats{};
+};
@@ -0,0 +1,391 @@
+// ============================================================
+//  TickTrace.cpp — Tick recording + deterministic replay (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Records are written in the host's native layout (x86/x64,
+//  little-endian). Traces are a debugging aid, not a save
+//  format, so there is no byte swapping.
+//
+//  The replay is deterministic because CompanionCore only
+//  depends on: bus events (derived from WorldSample), the
+//  context, the mode, and host-dispatched lifecycle events —
+//  all of which are in the record (follow tuning is taken from
+//  the recorded follow commands). Natives, timing and the
+//  LOD side effects in main.cpp are not replayed; their effect
+//  on Core shows up in the next tick's inputs.
+//
+//  VehicleRide is replayed the same way: it only depends on
+//  its RideInput, the tick, the cooldown and the native results
+//  RideLoop fed back, all recorded. A replayed step that asks
+//  for a native the recording didn't do gets 0 for the result;
+//  the rideSteps diff on that tick points at it.
+// ============================================================
+
+#include "TickTrace.h"
+#include <cstring>
+
+namespace TickTrace
+{
+    void Begin(TickRecord& rec, uint32_t tickCount)
+    {
+        memset(&rec, 0, sizeof(rec));
+        rec.tick = tickCount;
+        memset(rec.hostEvents, kNoHostEvent, sizeof(rec.hostEvents));
+    }
+
+    void CaptureInputs(TickRecord& rec, const WorldSample& world, const CompanionContext& ctx, CompanionMode mode)
+    {
+        uint16_t f = 0;
+        if (world.missionActive)   f |= TraceWorld_MissionActive;
+        if (world.playerExists)    f |= TraceWorld_PlayerExists;
+        if (world.playerDead)      f |= TraceWorld_PlayerDead;
+        if (world.playerInVehicle) f |= TraceWorld_PlayerInVehicle;
+        if (world.companionExists) f |= TraceWorld_CompanionExists;
+        if (world.companionDead)   f |= TraceWorld_CompanionDead;
+        if (world.stayEnabled)     f |= TraceWorld_StayEnabled;
+
+        rec.world = f;
+        rec.mode = (uint8_t)mode;
+        rec.playerVehicle = world.playerVehicle;
+        rec.playerPos[0] = ctx.playerPos.x;
+        rec.playerPos[1] = ctx.playerPos.y;
+        rec.playerPos[2] = ctx.playerPos.z;
+        rec.topThreatHandle = ctx.topThreatHandle;
+        rec.topThreatScore = ctx.topThreatScore;
+        rec.frenzyTargetHandle = ctx.frenzyTargetHandle;
+    }
+
+    void CaptureCommands(TickRecord& rec, const CompanionCommands& cmd, CompanionActivity activity)
+    {
+        uint8_t f = 0;
+        if (cmd.requestLog)     f |= TraceCmd_Log;
+        if (cmd.requestFollow)  f |= TraceCmd_Follow;
+        if (cmd.requestStay)    f |= TraceCmd_Stay;
+        if (cmd.requestSpawn)   f |= TraceCmd_Spawn;
+        if (cmd.requestDespawn) f |= TraceCmd_Despawn;
+
+        rec.cmdFlags = f;
+        rec.actions = cmd.actions;
+        rec.threatTarget = cmd.threatTarget;
+        rec.followDistance = cmd.followDistance;
+        rec.followSpeed = cmd.followSpeed;
+        rec.followRefreshTicks = cmd.followRefreshTicks;
+        rec.activityAfterTick = (uint8_t)activity;
+        rec.activityEnd = (uint8_t)activity;
+    }
+
+    void AddHostEvent(TickRecord& rec, CompanionEvent event)
+    {
+        for (uint8_t& slot : rec.hostEvents)
+        {
+            if (slot == kNoHostEvent)
+            {
+                slot = (uint8_t)event;
+                return;
+            }
+        }
+        // More than 4 in one tick doesn't happen today; the replay
+        // will report the resulting state mismatch if it ever does.
+    }
+
+    void CaptureRideStep(TickRecord& rec, const RideInput& in, uint32_t cooldownTicks, const RideStep& step)
+    {
+        uint16_t f = TraceRide_Stepped;
+        if (in.canRide)         f |= TraceRide_CanRide;
+        if (in.playerInVehicle) f |= TraceRide_PlayerInVehicle;
+        if (in.vehicleNear)     f |= TraceRide_VehicleNear;
+        if (in.releasing)       f |= TraceRide_Releasing;
+
+        uint8_t s = 0;
+        if (step.pollIntent) s |= TraceStep_PollIntent;
+        if (step.pickSeat)   s |= TraceStep_PickSeat;
+        if (step.board)      s |= TraceStep_Board;
+        if (step.confirm)    s |= TraceStep_Confirm;
+        if (step.pollSeats)  s |= TraceStep_PollSeats;
+
+        rec.rideFlags = f;
+        rec.rideSteps = s;
+        rec.rideCooldown = cooldownTicks;
+        rec.ridePlayerVehicle = in.playerVehicle;
+        rec.rideStepVehicle = step.vehicle;
+        rec.rideStepSeat = (int16_t)step.seat;
+    }
+
+    RideInput UnpackRideInput(const TickRecord& rec)
+    {
+        RideInput in;
+        in.canRide         = (rec.rideFlags & TraceRide_CanRide) != 0;
+        in.playerInVehicle = (rec.rideFlags & TraceRide_PlayerInVehicle) != 0;
+        in.playerVehicle   = rec.ridePlayerVehicle;
+        in.vehicleNear     = (rec.rideFlags & TraceRide_VehicleNear) != 0;
+        in.releasing       = (rec.rideFlags & TraceRide_Releasing) != 0;
+        return in;
+    }
+
+    WorldSample UnpackWorld(const TickRecord& rec)
+    {
+        WorldSample w;
+        w.missionActive   = (rec.world & TraceWorld_MissionActive) != 0;
+        w.playerExists    = (rec.world & TraceWorld_PlayerExists) != 0;
+        w.playerDead      = (rec.world & TraceWorld_PlayerDead) != 0;
+        w.playerInVehicle = (rec.world & TraceWorld_PlayerInVehicle) != 0;
+        w.playerVehicle   = rec.playerVehicle;
+        w.companionExists = (rec.world & TraceWorld_CompanionExists) != 0;
+        w.companionDead   = (rec.world & TraceWorld_CompanionDead) != 0;
+        w.stayEnabled     = (rec.world & TraceWorld_StayEnabled) != 0;
+        return w;
+    }
+
+    CompanionContext UnpackContext(const TickRecord& rec)
+    {
+        CompanionContext ctx;
+        ctx.tickCount = rec.tick;
+        ctx.deltaSeconds = 1.0f / 60.0f;
+        ctx.playerExists = (rec.world & TraceWorld_PlayerExists) != 0;
+        ctx.playerDead = (rec.world & TraceWorld_PlayerDead) != 0;
+        ctx.playerInVehicle = (rec.world & TraceWorld_PlayerInVehicle) != 0;
+        ctx.playerPos = { rec.playerPos[0], rec.playerPos[1], rec.playerPos[2] };
+        ctx.topThreatHandle = rec.topThreatHandle;
+        ctx.topThreatScore = rec.topThreatScore;
+        ctx.frenzyTargetHandle = rec.frenzyTargetHandle;
+        return ctx;
+    }
+}
+
+// --------------------------------------------------------
+//  TickRecorder
+// --------------------------------------------------------
+
+bool TickRecorder::Open(const char* path)
+{
+    Close();
+
+    m_file = fopen(path, "wb");
+    if (m_file == nullptr)
+        return false;
+
+    TickTraceHeader h{};
+    h.magic = kTraceMagic;
+    h.version = kTraceVersion;
+    h.recordSize = (uint16_t)sizeof(TickRecord);
+    fwrite(&h, sizeof(h), 1, m_file);
+
+    m_buffered = 0;
+    m_written = 0;
+    return true;
+}
+
+void TickRecorder::Write(const TickRecord& rec)
+{
+    if (m_file == nullptr)
+        return;
+
+    m_buffer[m_buffered++] = rec;
+    m_written++;
+
+    if (m_buffered == kBufferRecords)
+        Flush();
+}
+
+void TickRecorder::Flush()
+{
+    if (m_file == nullptr || m_buffered == 0)
+        return;
+
+    fwrite(m_buffer, sizeof(TickRecord), m_buffered, m_file);
+    fflush(m_file);
+    m_buffered = 0;
+}
+
+void TickRecorder::Close()
+{
+    if (m_file == nullptr)
+        return;
+
+    Flush();
+    fclose(m_file);
+    m_file = nullptr;
+}
+
+// --------------------------------------------------------
+//  TickTraceReader
+// --------------------------------------------------------
+
+bool TickTraceReader::Open(const char* path)
+{
+    Close();
+
+    m_file = fopen(path, "rb");
+    if (m_file == nullptr)
+        return false;
+
+    if (fread(&m_header, sizeof(m_header), 1, m_file) != 1
+        || m_header.magic != kTraceMagic
+        || m_header.version > kTraceVersion
+        || m_header.recordSize == 0)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool TickTraceReader::Next(TickRecord& out)
+{
+    if (m_file == nullptr)
+        return false;
+
+    // Older writers: zero-fill the tail. Newer writers: skip it.
+    unsigned char raw[1024];
+    uint32_t size = m_header.recordSize;
+    if (size > sizeof(raw))
+        return false;
+
+    if (fread(raw, size, 1, m_file) != 1)
+        return false;
+
+    memset(&out, 0, sizeof(out));
+    memcpy(&out, raw, size < sizeof(out) ? size : sizeof(out));
+    return true;
+}
+
+void TickTraceReader::Close()
+{
+    if (m_file != nullptr)
+    {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+// --------------------------------------------------------
+//  ReplayTrace
+// --------------------------------------------------------
+
+ReplayReport ReplayTrace(TickTraceReader& reader, FILE* diffOut, uint32_t maxDiffLines)
+{
+    ReplayReport report;
+
+    // Same wiring as ScriptMain (minus natives)
+    CompanionCore core;
+    EventBus bus;
+    core.Subscribe(bus);
+
+    EdgeSampler edges;
+    CompanionState state;
+    VehicleRide ride;
+    uint32_t diffLines = 0;
+
+    TickRecord rec;
+    while (reader.Next(rec))
+    {
+        WorldSample world = TickTrace::UnpackWorld(rec);
+        if (edges.Update(world, rec.tick, bus) > 0)
+            bus.Dispatch();
+
+        CompanionContext ctx = TickTrace::UnpackContext(rec);
+        state.mode = (CompanionMode)rec.mode;
+        state.spawned = world.companionExists;
+        state.stayEnabled = world.stayEnabled;
+
+        // Follow distance/speed/refresh come from CompanionMod.ini and
+        // can change mid-session: take them from the recording
+        if (rec.cmdFlags & TraceCmd_Follow)
+        {
+            CompanionCoreTuning tuning;
+            tuning.followDistance = rec.followDistance;
+            tuning.followSpeed = rec.followSpeed;
+            tuning.followRefreshTicks = rec.followRefreshTicks;
+            core.SetTuning(tuning);
+        }
+
+        CompanionCommands cmd;
+        core.Tick(ctx, state, cmd);
+
+        TickRecord got;
+        TickTrace::Begin(got, rec.tick);
+        TickTrace::CaptureCommands(got, cmd, state.activity);
+
+        for (uint8_t e : rec.hostEvents)
+        {
+            if (e == TickTrace::kNoHostEvent)
+                break;
+            uint16_t ignored = 0;
+            core.Dispatch(state, (CompanionEvent)e, ignored);
+        }
+        got.activityEnd = (uint8_t)state.activity;
+
+        // Same calls as RideLoop, with the recorded native results
+        if (rec.rideFlags & TraceRide_Stepped)
+        {
+            const RideInput in = TickTrace::UnpackRideInput(rec);
+            const RidePhase before = ride.Phase();
+            RideStep step = ride.Step(in, rec.tick, rec.rideCooldown);
+            TickTrace::CaptureRideStep(got, in, rec.rideCooldown, step);
+
+            if (step.pollIntent)
+                ride.NoteEntering(rec.rideEntering);
+            if (step.pickSeat)
+                ride.SeatPicked(step.vehicle, rec.ridePickedSeat);
+            if (step.board)
+                ride.Boarded((rec.rideFlags & TraceRide_BoardOk) != 0, rec.rideBoardSeat, rec.tick);
+            if (step.confirm)
+                ride.Confirm(rec.rideCompanionVehicle, rec.tick);
+            if (step.pollSeats)
+                ride.NoteOccupancy(rec.ridePassengers, rec.tick);
+
+            report.rideSteps++;
+            if (ride.Phase() == RidePhase::Evicted && before != RidePhase::Evicted)
+                report.rideEvictions++;
+        }
+        else if (rec.rideFlags & TraceRide_Reset)
+        {
+            ride.Reset();
+        }
+        got.ridePhase = (uint8_t)ride.Phase();
+
+        bool mismatch = false;
+        auto diff = [&](const char* field, long long expected, long long actual)
+        {
+            if (expected == actual)
+                return;
+            mismatch = true;
+            if (diffOut != nullptr && diffLines < maxDiffLines)
+            {
+                fprintf(diffOut, "tick %u: %s expected %lld got %lld\n", rec.tick, field, expected, actual);
+                diffLines++;
+            }
+        };
+
+        diff("activityAfterTick", rec.activityAfterTick, got.activityAfterTick);
+        diff("activityEnd", rec.activityEnd, got.activityEnd);
+        diff("actions", rec.actions, got.actions);
+        diff("cmdFlags", rec.cmdFlags, got.cmdFlags);
+        diff("threatTarget", rec.threatTarget, got.threatTarget);
+        diff("followRefreshTicks", rec.followRefreshTicks, got.followRefreshTicks);
+        diff("followDistance(mm)", (long long)(rec.followDistance * 1000.0f), (long long)(got.followDistance * 1000.0f));
+        diff("followSpeed(mm/s)", (long long)(rec.followSpeed * 1000.0f), (long long)(got.followSpeed * 1000.0f));
+
+        if (rec.rideFlags & (TraceRide_Stepped | TraceRide_Reset))
+        {
+            diff("ridePhase", rec.ridePhase, got.ridePhase);
+            diff("rideSteps", rec.rideSteps, got.rideSteps);
+            diff("rideStepVehicle", rec.rideStepVehicle, got.rideStepVehicle);
+            diff("rideStepSeat", rec.rideStepSeat, got.rideStepSeat);
+        }
+
+        if (mismatch)
+        {
+            if (report.mismatchedTicks == 0)
+                report.firstMismatchTick = rec.tick;
+            report.mismatchedTicks++;
+        }
+
+        report.ticks++;
+    }
+
+    return report;
+}
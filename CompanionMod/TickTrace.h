@@ -0,0 +1,241 @@
+// ============================================================
+//  TickTrace.h — Tick recording + deterministic replay
+// ============================================================
+//
+//  PURPOSE:
+//  Bugs like "[VehicleRideV2] Desync detected" only happen in
+//  game, at some random moment. A trace captures, per tick,
+//  everything the decision logic consumed and what it decided,
+//  so the same session can be re-run outside the game (Linux,
+//  headless, thousands of times faster than real time).
+//
+//  WHAT IS RECORDED (one fixed 96-byte TickRecord per tick):
+//    inputs   — the WorldSample (adapter reads), player position,
+//               threat / frenzy picks, mode, F-key presses
+//    host     — lifecycle events main.cpp dispatched itself after
+//               Core::Tick (Boarded, RideDesync, F7 despawn, F5)
+//    outputs  — Core's commands + lifecycle state (the baseline)
+//    ride     — RideLoop's step: its RideInput, what Step asked
+//               for and the phase it ended in (baseline), and the
+//               native results fed back (entering vehicle, seat
+//               picked, put in + seat, companion's vehicle,
+//               passenger count)
+//
+//  REPLAY:
+//  ReplayTrace() feeds the inputs through the same pipeline as
+//  main.cpp (EdgeSampler -> EventBus -> CompanionCore::Tick ->
+//  host events) and compares every output with the recording.
+//  VehicleRide is stepped with the recorded RideInput and fed
+//  the recorded native results, so a Desync (Evicted) can be
+//  walked through tick by tick. A change to Core / FSM / events
+//  / ride phases that alters behaviour shows up as a list of
+//  "tick N: field expected X got Y".
+//
+//  Recording is off unless CompanionMod.ini has
+//  trace_recording = 1 (read at startup: the replay starts from
+//  a fresh session, so the trace has to as well).
+//
+//  FILE FORMAT:
+//    TickTraceHeader (16 bytes), then TickRecord * N.
+//    recordSize is stored in the header: newer writers may
+//    append fields to TickRecord, older readers just skip them.
+//
+//  Engine-agnostic: builds on Linux (see Tools/TraceReplay).
+// ============================================================
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include "CompanionCore.h"
+#include "EventBus.h"
+#include "VehicleRide.h"
+
+struct TickTraceHeader
+{
+    uint32_t magic;          // kTraceMagic
+    uint16_t version;
+    uint16_t recordSize;     // sizeof(TickRecord) of the writer
+    uint32_t flags;          // reserved, 0
+    uint32_t reserved;
+};
+
+static constexpr uint32_t kTraceMagic = 0x52544D43;   // "CMTR"
+static constexpr uint16_t kTraceVersion = 1;
+
+// WorldSample packed into bits
+enum TraceWorldFlag : uint16_t
+{
+    TraceWorld_MissionActive   = 1 << 0,
+    TraceWorld_PlayerExists    = 1 << 1,
+    TraceWorld_PlayerDead      = 1 << 2,
+    TraceWorld_PlayerInVehicle = 1 << 3,
+    TraceWorld_CompanionExists = 1 << 4,
+    TraceWorld_CompanionDead   = 1 << 5,
+    TraceWorld_StayEnabled     = 1 << 6
+};
+
+// Hotkeys that were "just pressed" this tick
+enum TraceKey : uint8_t
+{
+    TraceKey_F5  = 1 << 0,
+    TraceKey_F6  = 1 << 1,
+    TraceKey_F7  = 1 << 2,
+    TraceKey_F8  = 1 << 3,
+    TraceKey_F10 = 1 << 4
+};
+
+enum TraceCmdFlag : uint8_t
+{
+    TraceCmd_Log    = 1 << 0,
+    TraceCmd_Follow = 1 << 1,
+    TraceCmd_Stay   = 1 << 2,
+    TraceCmd_Spawn  = 1 << 3,
+    TraceCmd_Despawn = 1 << 4
+};
+
+// RideLoop's frame: inputs, requests, and which results are set
+enum TraceRideFlag : uint16_t
+{
+    TraceRide_Stepped         = 1 << 0,     // RideLoop ran Step this tick
+    TraceRide_Reset           = 1 << 1,     // ... or ended (despawned): Reset
+    TraceRide_CanRide         = 1 << 2,     // RideInput
+    TraceRide_PlayerInVehicle = 1 << 3,
+    TraceRide_VehicleNear     = 1 << 4,
+    TraceRide_Releasing       = 1 << 5,
+    TraceRide_BoardOk         = 1 << 6      // Boarded(ok, ...)
+};
+
+// RideStep requests (baseline)
+enum TraceRideStep : uint8_t
+{
+    TraceStep_PollIntent = 1 << 0,
+    TraceStep_PickSeat   = 1 << 1,
+    TraceStep_Board      = 1 << 2,
+    TraceStep_Confirm    = 1 << 3,
+    TraceStep_PollSeats  = 1 << 4
+};
+
+struct TickRecord
+{
+    // --- Inputs ---
+    uint32_t tick;
+    uint16_t world;                  // TraceWorldFlag
+    uint8_t  mode;                   // CompanionMode
+    uint8_t  keys;                   // TraceKey
+    int32_t  playerVehicle;
+    float    playerPos[3];
+    int32_t  topThreatHandle;
+    float    topThreatScore;
+    int32_t  frenzyTargetHandle;
+
+    // Lifecycle events main.cpp dispatched after Tick, in order
+    // (CompanionEvent, 0xFF = unused)
+    uint8_t  hostEvents[4];
+
+    // --- Outputs (baseline) ---
+    uint8_t  activityAfterTick;      // CompanionActivity after Core::Tick
+    uint8_t  activityEnd;            // ... after host events
+    uint16_t actions;                // CompanionCommands::actions
+    uint8_t  cmdFlags;               // TraceCmdFlag
+    uint8_t  pad[3];
+    int32_t  threatTarget;
+    float    followDistance;
+    float    followSpeed;
+    uint32_t followRefreshTicks;
+
+    // --- Vehicle ride (appended; 0 in 64-byte traces) ---
+    uint16_t rideFlags;              // TraceRideFlag
+    uint8_t  rideSteps;              // TraceRideStep (baseline)
+    uint8_t  ridePhase;              // RidePhase after the results (baseline)
+    uint32_t rideCooldown;           // cooldownTicks passed to Step
+    int32_t  ridePlayerVehicle;      // RideInput::playerVehicle (task frame)
+    int32_t  rideStepVehicle;        // RideStep::vehicle (baseline)
+    int32_t  rideEntering;           // NoteEntering(), if PollIntent
+    int32_t  rideCompanionVehicle;   // Confirm(), if Confirm
+    int16_t  rideStepSeat;           // RideStep::seat (baseline)
+    int16_t  ridePickedSeat;         // SeatPicked(), if PickSeat
+    int16_t  rideBoardSeat;          // Boarded(), if Board
+    int16_t  ridePassengers;         // NoteOccupancy(), if PollSeats
+};
+
+static_assert(sizeof(TickRecord) == 96, "TickRecord is a fixed 96-byte on-disk record");
+
+namespace TickTrace
+{
+    static constexpr uint8_t kNoHostEvent = 0xFF;
+
+    // Clears the record for a new tick
+    void Begin(TickRecord& rec, uint32_t tickCount);
+
+    void CaptureInputs(TickRecord& rec, const WorldSample& world, const CompanionContext& ctx, CompanionMode mode);
+    void CaptureCommands(TickRecord& rec, const CompanionCommands& cmd, CompanionActivity activity);
+    void AddHostEvent(TickRecord& rec, CompanionEvent event);
+
+    // RideLoop, right after VehicleRide::Step. The results are
+    // stored in the record's ride fields as they come in.
+    void CaptureRideStep(TickRecord& rec, const RideInput& in, uint32_t cooldownTicks, const RideStep& step);
+    RideInput UnpackRideInput(const TickRecord& rec);
+
+    WorldSample UnpackWorld(const TickRecord& rec);
+    CompanionContext UnpackContext(const TickRecord& rec);
+}
+
+// --------------------------------------------------------
+//  Writer: buffers records, one fwrite per kBufferRecords
+// --------------------------------------------------------
+class TickRecorder
+{
+public:
+    static constexpr uint32_t kBufferRecords = 256;    // 24 KB, ~4s @60fps
+
+    ~TickRecorder() { Close(); }
+
+    bool Open(const char* path);
+    void Write(const TickRecord& rec);
+    void Flush();
+    void Close();
+
+    bool IsOpen() const { return m_file != nullptr; }
+    uint32_t Written() const { return m_written; }
+
+private:
+    FILE* m_file = nullptr;
+    TickRecord m_buffer[kBufferRecords];
+    uint32_t m_buffered = 0;
+    uint32_t m_written = 0;
+};
+
+// --------------------------------------------------------
+//  Reader
+// --------------------------------------------------------
+class TickTraceReader
+{
+public:
+    ~TickTraceReader() { Close(); }
+
+    bool Open(const char* path);
+    bool Next(TickRecord& out);
+    void Close();
+
+    const TickTraceHeader& Header() const { return m_header; }
+
+private:
+    FILE* m_file = nullptr;
+    TickTraceHeader m_header{};
+};
+
+// --------------------------------------------------------
+//  Replay
+// --------------------------------------------------------
+struct ReplayReport
+{
+    uint32_t ticks = 0;
+    uint32_t mismatchedTicks = 0;
+    uint32_t firstMismatchTick = 0;  // valid if mismatchedTicks > 0
+    uint32_t rideSteps = 0;          // ticks VehicleRide was stepped
+    uint32_t rideEvictions = 0;      // drops to Evicted (Desync) in the replay
+};
+
+// Re-runs the decision pipeline over the whole trace. Diffs are
+// printed to diffOut (may be null), at most maxDiffLines lines.
+ReplayReport ReplayTrace(TickTraceReader& reader, FILE* diffOut, uint32_t maxDiffLines);
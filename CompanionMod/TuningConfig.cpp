@@ -0,0 +1,424 @@
+// ============================================================
+//  TuningConfig.cpp — Hot-reloadable tuning (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Keys are a table of { name, type, offset, range }, so adding a
+//  tunable is one struct field + one table row; the parser and
+//  WriteDefaults() pick it up.
+//
+//  Ownership of snapshots: the watcher allocates, publishes with
+//  exchange() and deletes whatever unconsumed snapshot it
+//  replaced (the main thread never saw that one). The main
+//  thread takes with exchange(nullptr) and deletes the snapshot
+//  it retires. Neither side ever touches the other's pointer.
+//
+//  Change detection compares the write time at the file
+//  system's own resolution (100 ns on NTFS, ns on Linux), not
+//  whole seconds, plus the size: two saves within one second
+//  that keep the size (20 -> 30) are both picked up.
+//
+//  Shutdown: nothing joins from DllMain. On FreeLibrary the
+//  watcher is still running and can't exit while the loader
+//  lock is held, so DllMain asks it to stop, waits for
+//  m_running to drop (its last store) and detaches. At process
+//  exit Windows has already ended it, possibly mid-loop; the
+//  destructor then leaks the snapshots rather than free memory
+//  a live watcher might still use.
+// ============================================================
+
+#include "TuningConfig.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// --------------------------------------------------------
+//  Key table
+// --------------------------------------------------------
+enum class TuningType : uint8_t
+{
+    Float,
+    Uint
+};
+
+struct TuningKey
+{
+    const char* name;
+    TuningType type;
+    size_t offset;
+    double minValue;
+    double maxValue;
+    const char* help;
+};
+
+static const TuningKey kTuningKeys[] =
+{
+    { "follow_distance",              TuningType::Float, offsetof(CompanionTuning, followDistance),           0.5,  20.0,   "meters behind the player" },
+    { "follow_speed",                 TuningType::Float, offsetof(CompanionTuning, followSpeed),              0.5,  10.0,   "1 = walk, 2 = jog, 3 = run" },
+    { "follow_refresh_ticks",         TuningType::Uint,  offsetof(CompanionTuning, followRefreshTicks),       1,    3600,   "re-issue follow task every N frames" },
+    { "teleport_dist_meters",         TuningType::Float, offsetof(CompanionTuning, teleportDistMeters),       5.0,  1000.0, "auto-teleport when farther than this" },
+    { "teleport_cooldown_ticks",      TuningType::Uint,  offsetof(CompanionTuning, teleportCooldownTicks),    0,    36000,  "frames between auto-teleports" },
+    { "stay_snap_ticks",              TuningType::Uint,  offsetof(CompanionTuning, staySnapTicks),            1,    3600,   "frames between stay anchor checks at first (backs off while still)" },
+    { "ride_attempt_cooldown_ticks",  TuningType::Uint,  offsetof(CompanionTuning, rideAttemptCooldownTicks), 1,    3600,   "first seat retry delay while the car is full (backs off)" },
+    { "formation_shape",              TuningType::Uint,  offsetof(CompanionTuning, formationShape),           0,    3,      "0 = wedge, 1 = column, 2 = line, 3 = circle" },
+    { "formation_spacing",            TuningType::Float, offsetof(CompanionTuning, formationSpacing),         0.5,  10.0,   "meters between companions in the formation" },
+    { "trace_recording",              TuningType::Uint,  offsetof(CompanionTuning, traceRecording),           0,    1,      "1 = record CompanionMod.trace for Tools/TraceReplay (startup only)" },
+};
+
+static const int kTuningKeyCount = (int)(sizeof(kTuningKeys) / sizeof(kTuningKeys[0]));
+
+static bool KeyEquals(const char* a, size_t aLen, const char* b)
+{
+    size_t bLen = strlen(b);
+    if (aLen != bLen)
+        return false;
+
+    for (size_t i = 0; i < aLen; ++i)
+    {
+        char c = a[i];
+        if (c >= 'A' && c <= 'Z')
+            c = (char)(c - 'A' + 'a');
+        if (c != b[i])
+            return false;
+    }
+    return true;
+}
+
+static void AddMessage(TuningSnapshot& out, uint32_t line, const char* what, const char* key, size_t keyLen)
+{
+    size_t used = strlen(out.messages);
+    if (used + 1 >= TuningSnapshot::kMessageBytes)
+        return;
+
+    snprintf(out.messages + used, TuningSnapshot::kMessageBytes - used, "line %u: %s '%.*s'\n",
+        line, what, (int)keyLen, key);
+}
+
+namespace TuningConfig
+{
+    void Parse(const char* text, size_t length, TuningSnapshot& out)
+    {
+        out.values = CompanionTuning{};
+        out.errors = 0;
+        out.messages[0] = '\0';
+
+        const char* p = text;
+        const char* end = text + length;
+        uint32_t line = 0;
+
+        while (p < end)
+        {
+            const char* lineEnd = p;
+            while (lineEnd < end && *lineEnd != '\n')
+                ++lineEnd;
+            line++;
+
+            const char* s = p;
+            const char* e = lineEnd;
+            p = (lineEnd < end) ? lineEnd + 1 : end;
+
+            while (s < e && (*s == ' ' || *s == '\t'))
+                ++s;
+            while (e > s && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '\r'))
+                --e;
+
+            // Blank, comment, or [section] (sections are allowed but ignored)
+            if (s == e || *s == '#' || *s == ';' || *s == '[')
+                continue;
+
+            const char* eq = s;
+            while (eq < e && *eq != '=')
+                ++eq;
+
+            if (eq == e)
+            {
+                AddMessage(out, line, "expected key = value, got", s, (size_t)(e - s));
+                out.errors++;
+                continue;
+            }
+
+            const char* keyEnd = eq;
+            while (keyEnd > s && (keyEnd[-1] == ' ' || keyEnd[-1] == '\t'))
+                --keyEnd;
+
+            const char* v = eq + 1;
+            while (v < e && (*v == ' ' || *v == '\t'))
+                ++v;
+
+            // Trailing comment after the value
+            const char* vEnd = v;
+            while (vEnd < e && *vEnd != '#' && *vEnd != ';')
+                ++vEnd;
+            while (vEnd > v && (vEnd[-1] == ' ' || vEnd[-1] == '\t'))
+                --vEnd;
+
+            const TuningKey* key = nullptr;
+            for (int k = 0; k < kTuningKeyCount; ++k)
+            {
+                if (KeyEquals(s, (size_t)(keyEnd - s), kTuningKeys[k].name))
+                {
+                    key = &kTuningKeys[k];
+                    break;
+                }
+            }
+
+            if (key == nullptr)
+            {
+                AddMessage(out, line, "unknown key", s, (size_t)(keyEnd - s));
+                out.errors++;
+                continue;
+            }
+
+            char number[64];
+            size_t n = (size_t)(vEnd - v);
+            if (n == 0 || n >= sizeof(number))
+            {
+                AddMessage(out, line, "bad value for", s, (size_t)(keyEnd - s));
+                out.errors++;
+                continue;
+            }
+            memcpy(number, v, n);
+            number[n] = '\0';
+
+            char* parsedEnd = nullptr;
+            double value = strtod(number, &parsedEnd);
+            if (parsedEnd == number || *parsedEnd != '\0'
+                || value < key->minValue || value > key->maxValue
+                || (key->type == TuningType::Uint && value != (double)(uint32_t)value))
+            {
+                AddMessage(out, line, "bad or out-of-range value for", s, (size_t)(keyEnd - s));
+                out.errors++;
+                continue;
+            }
+
+            unsigned char* field = (unsigned char*)&out.values + key->offset;
+            if (key->type == TuningType::Float)
+            {
+                float f = (float)value;
+                memcpy(field, &f, sizeof(f));
+            }
+            else
+            {
+                uint32_t u = (uint32_t)value;
+                memcpy(field, &u, sizeof(u));
+            }
+        }
+
+        out.values.teleportDistSq = out.values.teleportDistMeters * out.values.teleportDistMeters;
+    }
+
+    bool Load(const char* path, TuningSnapshot& out)
+    {
+        FILE* f = fopen(path, "rb");
+        if (f == nullptr)
+            return false;
+
+        // Tuning files are a few hundred bytes
+        char text[16384];
+        size_t length = fread(text, 1, sizeof(text), f);
+        bool truncated = !feof(f);
+        fclose(f);
+
+        Parse(text, length, out);
+
+        if (truncated)
+        {
+            static const char kTooLong[] = "file";
+            AddMessage(out, 0, "over 16 KB, rest ignored:", kTooLong, sizeof(kTooLong) - 1);
+            out.errors++;
+        }
+        return true;
+    }
+
+    bool WriteDefaults(const char* path)
+    {
+        FILE* f = fopen(path, "w");
+        if (f == nullptr)
+            return false;
+
+        const CompanionTuning defaults{};
+
+        fputs("# CompanionMod tuning. Saved changes apply in game within ~1 second.\n", f);
+        fputs("# Delete this file to get the defaults back.\n\n", f);
+
+        for (int k = 0; k < kTuningKeyCount; ++k)
+        {
+            const TuningKey& key = kTuningKeys[k];
+            const unsigned char* field = (const unsigned char*)&defaults + key.offset;
+
+            fprintf(f, "# %s (%g .. %g)\n", key.help, key.minValue, key.maxValue);
+            if (key.type == TuningType::Float)
+            {
+                float v;
+                memcpy(&v, field, sizeof(v));
+                fprintf(f, "%s = %g\n\n", key.name, v);
+            }
+            else
+            {
+                uint32_t v;
+                memcpy(&v, field, sizeof(v));
+                fprintf(f, "%s = %u\n\n", key.name, v);
+            }
+        }
+
+        fclose(f);
+        return true;
+    }
+}
+
+// --------------------------------------------------------
+//  TuningWatcher
+// --------------------------------------------------------
+
+// mtime in the file system's units (only compared for equality)
+static bool StatFile(const char* path, long long& mtime, long long& size)
+{
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data))
+        return false;
+
+    mtime = (long long)(((unsigned long long)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime);
+    size = (long long)(((unsigned long long)data.nFileSizeHigh << 32) | data.nFileSizeLow);
+    return true;
+#else
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return false;
+
+    mtime = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    size = (long long)st.st_size;
+    return true;
+#endif
+}
+
+TuningWatcher::~TuningWatcher()
+{
+    Detach();
+    if (m_running.load(std::memory_order_acquire))
+        return;
+
+    delete m_pending.exchange(nullptr);
+    delete m_owned;
+}
+
+void TuningWatcher::Start(const char* path)
+{
+    snprintf(m_path, sizeof(m_path), "%s", path);
+
+    m_defaults.values = CompanionTuning{};
+
+    if (!StatFile(m_path, m_lastMtime, m_lastSize))
+    {
+        // First run: leave a template to edit
+        TuningConfig::WriteDefaults(m_path);
+        StatFile(m_path, m_lastMtime, m_lastSize);
+    }
+    else
+    {
+        TuningSnapshot* loaded = new TuningSnapshot();
+        if (TuningConfig::Load(m_path, *loaded))
+        {
+            loaded->version = ++m_version;
+            m_owned = loaded;
+            m_current = loaded;
+        }
+        else
+        {
+            delete loaded;
+        }
+    }
+
+    m_stop = false;
+    m_running = true;
+    m_thread = std::thread(&TuningWatcher::Run, this);
+}
+
+void TuningWatcher::RequestStop()
+{
+    m_stop = true;
+}
+
+bool TuningWatcher::WaitStopped(uint32_t timeoutMs) const
+{
+    for (uint32_t waited = 0; m_running.load(std::memory_order_acquire); ++waited)
+    {
+        if (waited >= timeoutMs)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void TuningWatcher::Stop()
+{
+    RequestStop();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void TuningWatcher::Detach()
+{
+    if (m_thread.joinable())
+        m_thread.detach();
+}
+
+const TuningSnapshot* TuningWatcher::Apply()
+{
+    TuningSnapshot* next = m_pending.exchange(nullptr, std::memory_order_acq_rel);
+    if (next == nullptr)
+        return nullptr;
+
+    delete m_owned;
+    m_owned = next;
+    m_current = next;
+    return next;
+}
+
+void TuningWatcher::Run()
+{
+    const uint32_t kSliceMs = 50;   // how quickly RequestStop is noticed
+
+    while (!m_stop)
+    {
+        for (uint32_t waited = 0; waited < kPollMs && !m_stop; waited += kSliceMs)
+            std::this_thread::sleep_for(std::chrono::milliseconds(kSliceMs));
+
+        if (m_stop)
+            break;
+
+        long long mtime = 0, size = 0;
+        if (!StatFile(m_path, mtime, size))
+            continue;                       // deleted / being replaced: keep current
+
+        if (mtime == m_lastMtime && size == m_lastSize)
+            continue;
+
+        m_lastMtime = mtime;
+        m_lastSize = size;
+
+        TuningSnapshot* loaded = new TuningSnapshot();
+        if (!TuningConfig::Load(m_path, *loaded))
+        {
+            delete loaded;
+            continue;
+        }
+        loaded->version = ++m_version;
+
+        // Replace anything the main thread hasn't picked up yet
+        TuningSnapshot* stale = m_pending.exchange(loaded, std::memory_order_acq_rel);
+        delete stale;
+    }
+
+    m_running.store(false, std::memory_order_release);
+}
@@ -0,0 +1,147 @@
+// ============================================================
+//  TuningConfig.h — Hot-reloadable tuning (CompanionMod.ini)
+// ============================================================
+//
+//  PURPOSE:
+//  Teleport distance, cooldowns, follow distance/speed... used
+//  to be constexpr values, so every tuning pass was a rebuild
+//  and a game restart. They now live in CompanionMod.ini next
+//  to the .asi:
+//
+//      # comment
+//      teleport_dist_meters = 50
+//      follow_speed = 3.0
+//
+//  The file is parsed into CompanionTuning, a flat struct the
+//  main loop reads directly. Edit and save the file in game:
+//  the change is live within about a second.
+//
+//  HOW THE RELOAD WORKS:
+//    watcher thread   stat the file every kPollMs; when the write
+//                     time (sub-second) or size changes, read +
+//                     parse into a new snapshot
+//                     and publish it (one atomic pointer exchange)
+//    main loop        Apply() once per frame, before anything reads
+//                     tuning: takes the published snapshot, if any,
+//                     and makes it current
+//
+//  So the per-frame cost is one atomic exchange, and tuning never
+//  changes halfway through a frame. A bad line is skipped (that
+//  key stays at its default) and reported; the main thread logs
+//  the report, since Logger is not thread-safe.
+//
+//  Parsing is engine-agnostic (no natives) and builds on Linux.
+// ============================================================
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include "CompanionCore.h"
+
+// Everything tunable, flat. Defaults are the shipped values.
+struct CompanionTuning
+{
+    // Core follow command (CompanionCoreTuning)
+    float    followDistance = 2.0f;
+    float    followSpeed = 3.0f;
+    uint32_t followRefreshTicks = 60;
+
+    // Host (main.cpp)
+    float    teleportDistMeters = 50.0f;
+    uint32_t teleportCooldownTicks = 300;        // ~5s @60fps
+    uint32_t staySnapTicks = 60;                 // ~1s @60fps, first stay check interval (StayDrift.h)
+    uint32_t rideAttemptCooldownTicks = 60;      // ~1s @60fps, first retry into a full car (VehicleRide.h)
+    uint32_t formationShape = 0;                 // FormationShape (0 = wedge)
+    float    formationSpacing = 1.5f;
+    uint32_t traceRecording = 0;                 // 1 = record CompanionMod.trace (read at startup only)
+
+    // Derived when parsed (not in the file)
+    float    teleportDistSq = 50.0f * 50.0f;
+
+    CompanionCoreTuning Core() const
+    {
+        CompanionCoreTuning t;
+        t.followDistance = followDistance;
+        t.followSpeed = followSpeed;
+        t.followRefreshTicks = followRefreshTicks;
+        return t;
+    }
+};
+
+// A parsed file plus what the parser had to say about it
+struct TuningSnapshot
+{
+    static constexpr uint32_t kMessageBytes = 512;
+
+    CompanionTuning values;
+    uint32_t version = 0;            // 1 = first load, +1 per reload
+    uint32_t errors = 0;             // lines rejected (bad value / unknown key)
+    char messages[kMessageBytes] = {};   // one line per problem, '\n'-separated
+};
+
+namespace TuningConfig
+{
+    // Parses `text` on top of the defaults. Unknown keys and bad
+    // values are skipped and described in out.messages.
+    void Parse(const char* text, size_t length, TuningSnapshot& out);
+
+    // Reads + parses a file; false if it can't be read
+    bool Load(const char* path, TuningSnapshot& out);
+
+    // Writes a commented file with the current defaults
+    bool WriteDefaults(const char* path);
+}
+
+class TuningWatcher
+{
+public:
+    static constexpr uint32_t kPollMs = 500;
+
+    ~TuningWatcher();
+
+    // Loads the file now (or keeps defaults if it doesn't exist)
+    // and starts the watcher thread. Main thread, once.
+    void Start(const char* path);
+
+    // Asks the watcher thread to exit; does not wait for it.
+    void RequestStop();
+
+    // Waits up to timeoutMs for the watcher to leave its loop,
+    // without joining (a thread exiting needs the loader lock, so
+    // this is what DllMain uses). True if it has, or never started.
+    bool WaitStopped(uint32_t timeoutMs) const;
+
+    // RequestStop + join. Not from DllMain.
+    void Stop();
+
+    // Lets go of the thread without waiting for it: after
+    // WaitStopped, or at process exit when it's already gone.
+    void Detach();
+
+    // Main thread, once per frame. Returns the newly applied
+    // snapshot if one arrived this frame (to log), else null.
+    const TuningSnapshot* Apply();
+
+    const CompanionTuning& Current() const { return m_current->values; }
+    const TuningSnapshot& CurrentSnapshot() const { return *m_current; }
+
+private:
+    void Run();
+
+    char m_path[260] = {};
+    TuningSnapshot m_defaults{};
+    const TuningSnapshot* m_current = &m_defaults;
+    TuningSnapshot* m_owned = nullptr;          // current, if heap-allocated
+
+    std::atomic<TuningSnapshot*> m_pending{ nullptr };
+    std::atomic<bool> m_stop{ false };
+    std::atomic<bool> m_running{ false };       // cleared as the watcher's last step
+    std::thread m_thread;
+
+    // Watcher thread only
+    long long m_lastMtime = 0;                  // file system units (StatFile)
+    long long m_lastSize = -1;
+    uint32_t m_version = 0;
+};
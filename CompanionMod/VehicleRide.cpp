@@ -0,0 +1,289 @@
+// ============================================================
+//  VehicleRide.cpp — Vehicle riding phases (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Step() first follows what the task frame already shows (the
+//  player got in, switched cars, got out), then says what the
+//  phase wants looked at. Boarding never lasts past its frame:
+//  Boarded() moves it to Seated or Evicted.
+//
+//  A retry from Evicted boards without leaving Evicted, so a
+//  failed one only backs off; a failed Boarding (or a failed
+//  confirm) is a fresh eviction and starts the backoff over.
+//
+//  Tick arithmetic is unsigned and wraps: "due" is
+//  (int32_t)(tick - at) >= 0, never tick >= at.
+// ============================================================
+
+#include "VehicleRide.h"
+
+static bool Due(uint32_t tick, uint32_t at)
+{
+    return (int32_t)(tick - at) >= 0;
+}
+
+void VehicleRide::Enter(RidePhase phase)
+{
+    m_phase = phase;
+    if (phase == RidePhase::OnFoot)
+    {
+        m_vehicle = 0;
+        m_seat = kNoSeat;
+        m_seatPicked = false;
+        m_predicting = false;
+    }
+}
+
+void VehicleRide::Reset()
+{
+    Enter(RidePhase::OnFoot);
+}
+
+void VehicleRide::BeginBoarding(int vehicle, int keptSeat)
+{
+    m_phase = RidePhase::Boarding;
+    m_vehicle = vehicle;
+    m_seat = keptSeat;
+    m_predicting = (keptSeat != kNoSeat);
+}
+
+void VehicleRide::Evict(uint32_t tick, bool fresh)
+{
+    if (fresh)
+    {
+        m_retryDelay = m_cooldown;
+        m_passengers = -1;
+        m_nextOccupancyPoll = tick;
+    }
+    else
+    {
+        uint32_t ceiling = m_cooldown * config.retryMaxScale;
+        m_retryDelay = (m_retryDelay * 2 > ceiling) ? ceiling : m_retryDelay * 2;
+    }
+
+    m_nextRetry = tick + m_retryDelay;
+    m_seat = kNoSeat;
+    m_phase = RidePhase::Evicted;
+}
+
+RideStep VehicleRide::Step(const RideInput& in, uint32_t tick, uint32_t cooldownTicks)
+{
+    RideStep step;
+    m_cooldown = (cooldownTicks > 0) ? cooldownTicks : 1;
+
+    if (!in.canRide)
+    {
+        // Staying / despawned / suspended: the FSM has already
+        // released the companion (or it never got in)
+        if (m_phase != RidePhase::OnFoot)
+            Reset();
+        return step;
+    }
+
+    if (in.playerInVehicle)
+    {
+        switch (m_phase)
+        {
+        case RidePhase::OnFoot:
+        case RidePhase::Exiting:
+            // Got in without us seeing the approach (warped,
+            // entered between polls, straight back in)
+            BeginBoarding(in.playerVehicle, kNoSeat);
+            break;
+
+        case RidePhase::Approaching:
+            BeginBoarding(in.playerVehicle,
+                (m_seatPicked && m_vehicle == in.playerVehicle) ? m_seat : kNoSeat);
+            break;
+
+        default:
+            // Switched cars: the old seat means nothing here
+            if (in.playerVehicle != m_vehicle)
+                BeginBoarding(in.playerVehicle, kNoSeat);
+            break;
+        }
+    }
+    else
+    {
+        switch (m_phase)
+        {
+        case RidePhase::Seated:
+            Enter(RidePhase::Exiting);
+            break;
+
+        case RidePhase::Boarding:
+        case RidePhase::Evicted:
+            Enter(RidePhase::OnFoot);
+            break;
+
+        case RidePhase::Exiting:
+            if (!in.releasing)
+                Enter(RidePhase::OnFoot);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    switch (m_phase)
+    {
+    case RidePhase::OnFoot:
+    case RidePhase::Approaching:
+        if ((in.vehicleNear || m_phase == RidePhase::Approaching)
+            && tick - m_lastIntentPoll >= config.intentPollTicks)
+        {
+            step.pollIntent = true;
+            m_lastIntentPoll = tick;
+            m_stats.intentPolls++;
+        }
+        if (m_phase == RidePhase::Approaching && !m_seatPicked)
+        {
+            step.pickSeat = true;
+            step.vehicle = m_vehicle;
+        }
+        break;
+
+    case RidePhase::Boarding:
+        step.board = true;
+        step.vehicle = m_vehicle;
+        step.seat = m_seat;
+        break;
+
+    case RidePhase::Seated:
+        if (tick - m_lastConfirm >= config.confirmTicks)
+        {
+            step.confirm = true;
+            step.vehicle = m_vehicle;
+            m_lastConfirm = tick;
+            m_stats.confirms++;
+        }
+        break;
+
+    case RidePhase::Evicted:
+        if (Due(tick, m_nextRetry))
+        {
+            step.board = true;
+            step.vehicle = m_vehicle;
+            m_stats.retries++;
+        }
+        else if (Due(tick, m_nextOccupancyPoll))
+        {
+            step.pollSeats = true;
+            step.vehicle = m_vehicle;
+            m_nextOccupancyPoll = tick + config.occupancyPollTicks;
+            m_stats.occupancyPolls++;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return step;
+}
+
+void VehicleRide::NoteEntering(int vehicle)
+{
+    if (m_phase == RidePhase::OnFoot)
+    {
+        if (vehicle == 0)
+            return;
+    }
+    else if (m_phase == RidePhase::Approaching)
+    {
+        if (vehicle == m_vehicle)
+            return;
+
+        if (vehicle == 0)
+        {
+            // Walked away / got pulled out of the enter task
+            m_stats.cancelled++;
+            Enter(RidePhase::OnFoot);
+            return;
+        }
+    }
+    else
+    {
+        return;
+    }
+
+    m_stats.approaches++;
+    m_phase = RidePhase::Approaching;
+    m_vehicle = vehicle;
+    m_seat = kNoSeat;
+    m_seatPicked = false;
+}
+
+void VehicleRide::SeatPicked(int vehicle, int seat)
+{
+    if (m_phase != RidePhase::Approaching || vehicle != m_vehicle)
+        return;
+
+    // kNoSeat is kept too: a full car isn't checked again
+    // until the player sits
+    m_seat = seat;
+    m_seatPicked = true;
+}
+
+void VehicleRide::Boarded(bool ok, int seat, uint32_t tick)
+{
+    if (m_phase != RidePhase::Boarding && m_phase != RidePhase::Evicted)
+        return;
+
+    if (!ok)
+    {
+        m_stats.failedBoards++;
+        Evict(tick, m_phase == RidePhase::Boarding);
+        return;
+    }
+
+    m_stats.boards++;
+    if (m_predicting && seat == m_seat)
+        m_stats.predicted++;
+
+    m_phase = RidePhase::Seated;
+    m_seat = seat;
+    m_predicting = false;
+    m_lastConfirm = tick;
+}
+
+void VehicleRide::Confirm(int companionVehicle, uint32_t tick)
+{
+    if (m_phase != RidePhase::Seated || companionVehicle == m_vehicle)
+        return;
+
+    m_stats.evictions++;
+    Evict(tick, true);
+}
+
+bool VehicleRide::NoteOccupancy(int passengers, uint32_t tick)
+{
+    if (m_phase != RidePhase::Evicted)
+        return false;
+
+    bool freed = (m_passengers >= 0 && passengers < m_passengers);
+    m_passengers = passengers;
+
+    if (freed)
+    {
+        // Try now, and back off from the start if it's taken again
+        m_stats.seatsFreed++;
+        m_retryDelay = m_cooldown;
+        m_nextRetry = tick;
+    }
+    return freed;
+}
+
+uint32_t VehicleRide::IdleTicks(uint32_t tick) const
+{
+    if (m_phase != RidePhase::Evicted)
+        return 1;
+
+    int32_t retry = (int32_t)(m_nextRetry - tick);
+    int32_t poll = (int32_t)(m_nextOccupancyPoll - tick);
+    int32_t idle = (retry < poll) ? retry : poll;
+    return (idle > 1) ? (uint32_t)idle : 1;
+}
@@ -0,0 +1,183 @@
+// ============================================================
+//  VehicleRide.h — Vehicle riding phases + predictive boarding
+// ============================================================
+//
+//  PURPOSE:
+//  Riding used to wait until the player was sitting in a car,
+//  then check every passenger seat and warp the companion into
+//  the first free one. A full car was checked again, every seat,
+//  every ride_attempt_cooldown_ticks for as long as the player
+//  drove it; a seated companion had its vehicle read every frame.
+//
+//  This file tracks one ride as explicit phases and tells the
+//  host what to look at and when:
+//
+//    OnFoot       player on foot. While the last nearby scan has
+//                 a vehicle within intentMeters of the player (no
+//                 natives), the host asks every intentPollTicks
+//                 which vehicle the player is trying to enter.
+//    Approaching  the player is entering `vehicle`: its seats are
+//                 checked once, now, and the free one is kept.
+//    Boarding     the player sits: the companion is put in the
+//                 kept seat (one check that it's still free) the
+//                 same frame. No kept seat (warped in, switched
+//                 cars, seat taken meanwhile): every seat.
+//    Seated       the companion's vehicle is re-read every
+//                 confirmTicks, not every frame.
+//    Evicted      the player is in, the companion isn't (car
+//                 full, pulled out). The passenger count is read
+//                 every occupancyPollTicks (one native); a seat
+//                 freed or a vehicle change retries at once. The
+//                 full retry otherwise backs off from the ride
+//                 cooldown, doubling up to retryMaxScale times it.
+//    Exiting      the player got out of the car the companion
+//                 rode in: the release teleport (lifecycle FSM,
+//                 Riding -> Following) runs, then OnFoot.
+//
+//  The lifecycle FSM (CompanionStateMachine.h) still owns
+//  "riding or not": the host dispatches Boarded when a boarding
+//  works and RideDesync when the phase drops to Evicted.
+//
+//  FLOW (main.cpp RideLoop, every frame the task is awake):
+//      step = ride.Step(input, tick, ride cooldown);
+//      if (step.pollIntent) ride.NoteEntering(entering vehicle)
+//      if (step.pickSeat)   ride.SeatPicked(vehicle, free seat)
+//      if (step.board)      ride.Boarded(put in?, seat)
+//      if (step.confirm)    ride.Confirm(companion's vehicle)
+//      if (step.pollSeats)  ride.NoteOccupancy(passengers)
+//      sleep ride.IdleTicks(tick) frames (events wake it early)
+//
+//  Engine-agnostic; builds on Linux. Nothing allocated.
+// ============================================================
+
+#pragma once
+#include <cstdint>
+
+enum class RidePhase : uint8_t
+{
+    OnFoot,
+    Approaching,
+    Boarding,
+    Seated,
+    Evicted,
+    Exiting,
+    Count
+};
+
+inline const char* RidePhaseName(RidePhase p)
+{
+    switch (p)
+    {
+    case RidePhase::OnFoot:      return "OnFoot";
+    case RidePhase::Approaching: return "Approaching";
+    case RidePhase::Boarding:    return "Boarding";
+    case RidePhase::Seated:      return "Seated";
+    case RidePhase::Evicted:     return "Evicted";
+    case RidePhase::Exiting:     return "Exiting";
+    default:                     return "?";
+    }
+}
+
+struct VehicleRideConfig
+{
+    float intentMeters = 6.0f;          // a vehicle this close to the player: watch for entering
+    uint32_t intentPollTicks = 6;       // ~10 Hz; getting in takes a second or more
+    uint32_t confirmTicks = 30;         // seated: companion's vehicle re-read (~0.5s @60fps)
+    uint32_t occupancyPollTicks = 30;   // evicted: passenger count read
+    uint32_t retryMaxScale = 8;         // evicted: retry backs off to cooldown x this
+};
+
+// What the host sees this frame (no natives: task frame + FSM)
+struct RideInput
+{
+    bool canRide = false;               // spawned and Following / Riding
+    bool playerInVehicle = false;
+    int playerVehicle = 0;
+    bool vehicleNear = false;           // a vehicle within intentMeters (last nearby scan)
+    bool releasing = false;             // the release teleport is still running
+};
+
+// What the host does this frame (any combination)
+struct RideStep
+{
+    bool pollIntent = false;            // which vehicle is the player entering? -> NoteEntering
+    bool pickSeat = false;              // find a free seat in `vehicle` -> SeatPicked
+    bool board = false;                 // put the companion in `vehicle`, `seat` first -> Boarded
+    bool confirm = false;               // which vehicle is the companion in? -> Confirm
+    bool pollSeats = false;             // passengers in `vehicle` -> NoteOccupancy
+    int vehicle = 0;
+    int seat = -999;                    // kNoSeat = any
+};
+
+struct VehicleRideStats
+{
+    uint32_t approaches = 0;            // player seen entering a vehicle
+    uint32_t cancelled = 0;             // ...and then didn't
+    uint32_t boards = 0;                // companion put in
+    uint32_t predicted = 0;             // ...into the seat picked while approaching
+    uint32_t failedBoards = 0;          // no free seat
+    uint32_t evictions = 0;             // seated companion found outside
+    uint32_t seatsFreed = 0;            // passenger count went down while evicted
+    uint32_t retries = 0;               // boards tried from Evicted
+    uint32_t intentPolls = 0;
+    uint32_t confirms = 0;
+    uint32_t occupancyPolls = 0;
+};
+
+class VehicleRide
+{
+public:
+    static constexpr int kNoSeat = -999;
+
+    VehicleRideConfig config{};
+
+    // Once per awake frame. cooldownTicks = the first retry
+    // delay while evicted (ride_attempt_cooldown_ticks).
+    RideStep Step(const RideInput& in, uint32_t tick, uint32_t cooldownTicks);
+
+    // Results of this frame's step
+    void NoteEntering(int vehicle);            // 0 = not entering any
+    void SeatPicked(int vehicle, int seat);
+    void Boarded(bool ok, int seat, uint32_t tick);
+    void Confirm(int companionVehicle, uint32_t tick);
+
+    // true if a seat was freed since the last count
+    bool NoteOccupancy(int passengers, uint32_t tick);
+
+    // Frames until the next step has anything to do (1 = next
+    // frame). Only Evicted sleeps; events wake the host early.
+    uint32_t IdleTicks(uint32_t tick) const;
+
+    // Despawned / no longer riding-capable: back to OnFoot
+    void Reset();
+
+    RidePhase Phase() const { return m_phase; }
+    int Vehicle() const { return m_vehicle; }
+    int Seat() const { return m_seat; }
+
+    const VehicleRideStats& Stats() const { return m_stats; }
+    void ResetTotals() { m_stats = {}; }
+
+private:
+    void Enter(RidePhase phase);
+    void BeginBoarding(int vehicle, int keptSeat);
+    void Evict(uint32_t tick, bool fresh);
+
+    RidePhase m_phase = RidePhase::OnFoot;
+    int m_vehicle = 0;                  // approaching / riding / evicted from
+    int m_seat = kNoSeat;               // picked while approaching, then the seat ridden
+    bool m_seatPicked = false;
+    bool m_predicting = false;          // boarding into the seat picked while approaching
+    uint32_t m_cooldown = 60;           // this step's cooldownTicks
+
+    uint32_t m_lastIntentPoll = 0;
+    uint32_t m_lastConfirm = 0;
+
+    // Evicted
+    uint32_t m_retryDelay = 0;
+    uint32_t m_nextRetry = 0;
+    uint32_t m_nextOccupancyPoll = 0;
+    int m_passengers = -1;              // last count, -1 = not read yet
+
+    VehicleRideStats m_stats{};
+};
@@ -0,0 +1,85 @@
+// ============================================================
+//  WorldSnapshot.cpp — Published per-frame world state (Impl)
+// ============================================================
+//
+//  TECHNICAL NOTES:
+//
+//  Per-buffer sequence lock:
+//    writer   seq = s+1 (odd) .. write .. seq = s+2, latest = index
+//    reader   s1 = seq (must be even, non-zero) .. copy .. s2 = seq
+//             consistent if s1 == s2
+//
+//  The fences order the payload accesses against the sequence.
+//  Readers copy with memcpy while the writer may (rarely) be
+//  writing the same bytes; a torn copy is always detected by the
+//  sequence check and thrown away. This is the usual seqlock
+//  trade-off, and it's why WorldSnapshot must stay trivially
+//  copyable (no owning members; the one pointer, to the host's
+//  nearby grid, is only followed under the rules in the header).
+// ============================================================
+
+#include "WorldSnapshot.h"
+#include <cstring>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<WorldSnapshot>::value, "snapshots are copied with memcpy");
+
+WorldSnapshot& WorldSnapshotBuffer::BeginWrite()
+{
+    m_writing = (m_latest.load(std::memory_order_relaxed) + 1) % kBuffers;
+
+    Slot& slot = m_slots[m_writing];
+    uint32_t seq = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return slot.data;
+}
+
+void WorldSnapshotBuffer::Publish()
+{
+    Slot& slot = m_slots[m_writing];
+    slot.data.sequence = (uint32_t)(m_published.fetch_add(1, std::memory_order_relaxed) + 1);
+
+    uint32_t seq = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(seq + 1, std::memory_order_release);
+    m_latest.store(m_writing, std::memory_order_release);
+}
+
+bool WorldSnapshotBuffer::Read(WorldSnapshot& out) const
+{
+    m_reads.fetch_add(1, std::memory_order_relaxed);
+
+    for (uint32_t attempt = 0; attempt < kMaxReadAttempts; ++attempt)
+    {
+        const Slot& slot = m_slots[m_latest.load(std::memory_order_acquire)];
+
+        uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before == 0)
+            return false;                   // nothing published yet
+
+        if ((before & 1) == 0)
+        {
+            memcpy(&out, &slot.data, sizeof(WorldSnapshot));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) == before)
+                return true;
+        }
+
+        m_retries.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    m_failures.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+WorldSnapshotStats WorldSnapshotBuffer::Stats() const
+{
+    WorldSnapshotStats s;
+    s.published = m_published.load(std::memory_order_relaxed);
+    s.reads = m_reads.load(std::memory_order_relaxed);
+    s.retries = m_retries.load(std::memory_order_relaxed);
+    s.failures = m_failures.load(std::memory_order_relaxed);
+    return s;
+}
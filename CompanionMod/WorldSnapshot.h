@@ -0,0 +1,151 @@
+// ============================================================
+//  WorldSnapshot.h — Published per-frame world state
+// ============================================================
+//
+//  PURPOSE:
+//  Natives only work on the script fiber, so anything running on
+//  another thread (jobs, a future log/telemetry thread) can't ask
+//  the game where the player is. Instead, once per frame the main
+//  loop copies what it already knows into a WorldSnapshot and
+//  publishes it; other threads read the latest published copy.
+//
+//      script thread:   WorldSnapshot& s = buffer.BeginWrite();
+//                       ... fill s ...
+//                       buffer.Publish();
+//
+//      any thread:      WorldSnapshot s;
+//                       if (buffer.Read(s)) { ... }
+//
+//  WHAT'S IN IT:
+//  Player, companions, which nearby scan is current and what the
+//  host knows about vehicle seats. No natives are called to fill
+//  it: it's the frame's existing data, copied. main.cpp publishes
+//  right after the nearby scan, and the post-scan jobs (threat
+//  ranking, Frenzy targeting) take the scan from here.
+//
+//  The scan itself isn't copied: the snapshot points at the
+//  host's grid, which stays as it is until the next scan. A
+//  reader that can still be running when that scan starts (the
+//  post-scan jobs can't: they're joined first) must not follow
+//  the pointer, or must check nearbyTick afterwards.
+//
+//  HOW IT STAYS LOCK-FREE:
+//    - Three buffers. The writer always fills the one that is
+//      neither the latest nor the one before it, then publishes
+//      its index with one atomic store. Publish cost is fixed:
+//      a few hundred bytes, whatever the size of the scan.
+//    - Every buffer has a sequence number (odd while being
+//      written). A reader copies the latest buffer and checks the
+//      sequence didn't move; if it did (the reader was lapped by
+//      two publishes mid-copy) it retries with the new latest.
+//    - The writer never waits for readers and readers never take
+//      a lock. A reader that keeps getting lapped gives up and
+//      Read() returns false.
+//
+//  Engine-agnostic; builds on Linux.
+// ============================================================
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include "CompanionCore.h"
+
+class SpatialGrid;
+
+struct SnapshotCompanion
+{
+    Vec3 position{};             // last sampled (LOD cadence), not per frame
+    uint32_t positionTick = 0;
+    uint8_t activity = 0;        // CompanionActivity
+    uint8_t mode = 0;            // CompanionMode
+    uint8_t lodTier = 0;         // LodTier
+    uint8_t stayEnabled = 0;
+    int vehicle = 0;             // vehicle it's riding, 0 = on foot
+    int seat = -999;
+};
+
+// Seats of one vehicle as of the host's last seat check
+struct SnapshotSeats
+{
+    int vehicle = 0;             // 0 = no check yet
+    uint32_t checkedTick = 0;
+    uint8_t checkedMask = 0;     // bit = seat index + 1 (bit 0 = driver)
+    uint8_t freeMask = 0;        // of the checked seats, which were free
+};
+
+struct WorldSnapshot
+{
+    static constexpr uint32_t kMaxCompanions = 4;
+
+    uint32_t tick = 0;
+    uint32_t sequence = 0;       // publish count, for readers to spot a new frame
+
+    // Player
+    bool playerExists = false;
+    bool playerDead = false;
+    bool playerInVehicle = false;
+    bool missionActive = false;
+    int playerVehicle = 0;
+    Vec3 playerPosition{};
+
+    // Companions
+    uint32_t companionCount = 0;
+    SnapshotCompanion companions[kMaxCompanions];
+
+    // Nearby entities: the host's grid from the last scan, valid
+    // until the next one (see above). Null before the first scan.
+    const SpatialGrid* nearby = nullptr;
+    uint32_t nearbyTick = 0;     // tick of that scan
+    uint32_t nearbyCount = 0;
+
+    // Vehicle seats
+    SnapshotSeats seats;
+};
+
+struct WorldSnapshotStats
+{
+    uint64_t published = 0;
+    uint64_t reads = 0;
+    uint64_t retries = 0;        // reader was lapped and tried again
+    uint64_t failures = 0;       // reader gave up
+};
+
+class WorldSnapshotBuffer
+{
+public:
+    static constexpr uint32_t kBuffers = 3;
+    static constexpr uint32_t kMaxReadAttempts = 4;
+
+    // Script thread: the buffer to fill for this frame. It still
+    // holds the snapshot from two publishes before the latest:
+    // overwrite every field.
+    WorldSnapshot& BeginWrite();
+
+    // Script thread: makes the buffer from BeginWrite() the latest
+    void Publish();
+
+    // Any thread: copies the latest snapshot. false if nothing has
+    // been published yet or the copy kept getting overwritten.
+    bool Read(WorldSnapshot& out) const;
+
+    // Script thread only: the latest snapshot, in place
+    const WorldSnapshot& Latest() const { return m_slots[m_latest.load(std::memory_order_relaxed)].data; }
+
+    WorldSnapshotStats Stats() const;
+
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence{ 0 };    // odd = being written
+        WorldSnapshot data;
+    };
+
+    Slot m_slots[kBuffers];
+    std::atomic<uint32_t> m_latest{ 0 };
+    uint32_t m_writing = 0;
+    std::atomic<uint64_t> m_published{ 0 };
+
+    mutable std::atomic<uint64_t> m_reads{ 0 };
+    mutable std::atomic<uint64_t> m_retries{ 0 };
+    mutable std::atomic<uint64_t> m_failures{ 0 };
+};
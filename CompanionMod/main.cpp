@@ -34,32 +34,101 @@
 #include "EngineAdapter.h"
 
 #include "CompanionCore.h"
+#include "EventBus.h"
+#include "CompanionLod.h"
+#include "GeometryKernels.h"
+#include "SpatialGrid.h"
+#include "ThreatEngine.h"
+#include "FrenzyPipeline.h"
+#include "TickTrace.h"
+#include "NativeBudget.h"
+#include "FrameProfiler.h"
+#include "HitchDetector.h"
+#include "TuningConfig.h"
+#include "AllocTracker.h"
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "WorldSnapshot.h"
+#include "CoTask.h"
+#include "MotionPredictor.h"
+#include "Formation.h"
+#include "TeleportSearch.h"
+#include "BreadcrumbTrail.h"
+#include "StayDrift.h"
+#include "VehicleRide.h"
+#include "CompanionSave.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// Seats seen by the last seat check (published in the world
+// snapshot; costs no extra natives)
+static SnapshotSeats g_lastSeatCheck;
+
+static const int kSeatOrder[] = { 0, 1, 2 }; // passenger, rear left, rear right
+
+// Seats to try: `preferred` first (the one picked while the
+// player walked up), then the rest in kSeatOrder
+static int SeatsToTry(int preferred, int* out)
+{
+    int n = 0;
+    if (preferred != VehicleRide::kNoSeat)
+        out[n++] = preferred;
+    for (int seat : kSeatOrder)
+    {
+        if (seat != preferred)
+            out[n++] = seat;
+    }
+    return n;
+}
 
-static float DistSq(const Vec3& a, const Vec3& b)
+static void BeginSeatCheck(int veh, uint32_t tick)
 {
-    float dx = a.x - b.x;
-    float dy = a.y - b.y;
-    float dz = a.z - b.z;
-    return dx * dx + dy * dy + dz * dz;
+    g_lastSeatCheck.vehicle = veh;
+    g_lastSeatCheck.checkedTick = tick;
+    g_lastSeatCheck.checkedMask = 0;
+    g_lastSeatCheck.freeMask = 0;
 }
 
-static bool TryWarpCompanionIntoAnySeat(int veh, int& outSeat)
+static bool CheckSeat(int veh, int seat)
 {
-    static const int kSeatOrder[] = { 0, 1, 2 }; // passenger, rear left, rear right
+    g_lastSeatCheck.checkedMask |= (uint8_t)(1u << (seat + 1));
+    if (!EngineAdapter::IsVehicleSeatFree(veh, seat))
+        return false;
 
+    g_lastSeatCheck.freeMask |= (uint8_t)(1u << (seat + 1));
+    return true;
+}
+
+// First free passenger seat, VehicleRide::kNoSeat if full
+static int FindFreeSeat(int veh, uint32_t tick)
+{
+    BeginSeatCheck(veh, tick);
     for (int seat : kSeatOrder)
     {
-        if (EngineAdapter::IsVehicleSeatFree(veh, seat))
+        if (CheckSeat(veh, seat))
+            return seat;
+    }
+    return VehicleRide::kNoSeat;
+}
+
+static bool TryWarpCompanionIntoAnySeat(int veh, int preferred, int& outSeat, uint32_t tick)
+{
+    int order[4];
+    int count = SeatsToTry(preferred, order);
+
+    BeginSeatCheck(veh, tick);
+    for (int i = 0; i < count; ++i)
+    {
+        if (CheckSeat(veh, order[i]) && EngineAdapter::PutTestPedIntoVehicle(veh, order[i]))
         {
-            if (EngineAdapter::PutTestPedIntoVehicle(veh, seat))
-            {
-                outSeat = seat;
-                return true;
-            }
+            outSeat = order[i];
+            return true;
         }
     }
 
-    outSeat = -999;
+    outSeat = VehicleRide::kNoSeat;
     return false;
 }
 
@@ -73,35 +142,975 @@ static uint32_t g_lastTeleportTick = 0;
 
 // Stay
 static bool g_stayToggle = false;     // local input state
-static bool g_isStayingActive = false; // tracks whether we already applied stay actions
-static uint32_t g_lastStaySnapTick = 0;
-
-// Tuning constants
-static constexpr uint32_t FOLLOW_REFRESH_TICKS = 60;   // ~1s @60fps
-static constexpr float    TELEPORT_DIST_METERS = 50.0f;
-static constexpr float    TELEPORT_DIST_SQ = TELEPORT_DIST_METERS * TELEPORT_DIST_METERS;
-static constexpr uint32_t TELEPORT_COOLDOWN_TICKS = 300;  // ~5s @60fps
-static constexpr uint32_t STAY_SNAP_TICKS = 60; // ~1s @60fps; re-snap to anchor while staying
-
-// Mission gate state
-static bool g_wasMissionActive = false;
-static bool g_companionWasSpawnedBeforeMission = false;
+
+// Tuning: teleport / stay / ride / follow values come from
+// CompanionMod.ini and reload while the game runs (TuningConfig.h)
+static TuningWatcher g_tuning;
+static const char* TUNING_FILE = "CompanionMod.ini";
+
+static constexpr uint32_t FOLLOW_REFRESH_TICKS = 60;   // ~1s @60fps; fallback if Core sends 0
+
+// Mission gate state (suspend/resume itself is in the lifecycle FSM)
 static bool g_stayToggleBeforeMission = false;
 
+// Companion state across sessions (CompanionSave.h): offered to
+// the saver every frame, written when it changes, read once at
+// startup. A restored "spawned" waits for the player; a restored
+// anchor is used by the first Stay instead of where the ped lands.
+static CompanionSaver g_saver;
+static const char* SAVE_FILE = "CompanionMod.save";
+static bool g_restoreSpawn = false;
+static bool g_restoreAnchor = false;
+static Vec3 g_savedAnchor{};
+
 // DEBUG: Mission Gate Toggle (Learning Tool)
 static bool g_debugForceMissionGate = false;
 
-// Vehicle Riding V1
-static bool g_isRiding = false;
-static int  g_ridingVehicleHandle = 0;
-static bool g_wasPlayerInVehicle = false;
+// Vehicle Riding V1 (riding itself = CompanionActivity::Riding)
+static int  g_ridingVehicleHandle = 0;
+
+// Vehicle Riding V2
+static int  g_ridingSeat = -999;
+
+// Ride phases (VehicleRide.h): the seat is picked while the
+// player walks up to a car, boarding happens the frame they sit,
+// a full car is retried on a freed seat instead of on a timer
+static VehicleRide g_ride;
+
+// AI level-of-detail (distance + visibility tiers)
+static CompanionLod g_lod;
+static LodState g_lodState;
+
+// Nearby entities (spatial hash, rebuilt on a cadence)
+static SpatialGrid g_nearbyGrid(10.0f);
+static uint32_t g_lastNearbyScanTick = 0;
+
+static constexpr uint32_t NEARBY_SCAN_TICKS = 10;        // ~6 Hz @60fps
+static constexpr float    NEARBY_SCAN_RADIUS = 80.0f;
+static constexpr int      NEARBY_MAX_PEDS = 512;
+static constexpr int      NEARBY_MAX_VEHICLES = 256;
+
+// Protection threat ranking
+static ThreatEngine g_threats;
+static int g_engagedThreat = 0;                 // ped we last tasked the companion to fight
+
+static constexpr uint32_t THREAT_SAMPLE_MAX = 16;
+
+// Frenzy target acquisition
+static FrenzyPipeline g_frenzy;
+
+// Tick trace for offline replay (TickTrace.h, Tools/TraceReplay).
+// Off unless trace_recording = 1 in CompanionMod.ini (read at
+// startup). 96 bytes per tick = ~21 MB per hour; overwritten
+// every session.
+static TickRecorder g_recorder;
+static TickRecord g_traceRec;           // this tick's record, filled as the loop runs
+
+// Native call budget (counted in EngineAdapter, reported here).
+// A normal frame is ~20-30 natives; nearby scans (every
+// NEARBY_SCAN_TICKS) read one coordinate per pool entity and
+// are expected to go over.
+static constexpr uint32_t NATIVE_BUDGET_PER_FRAME = 100;
+static NativeBudget g_nativeBudget(NATIVE_BUDGET_PER_FRAME);
+
+// Per-phase timing of the main loop (FrameProfiler.h). Stats go
+// to the heartbeat log; PROFILE_CAPTURE streams every frame to a
+// Chrome trace file (~5 MB per minute, off by default).
+static FrameProfiler g_profiler;
+static constexpr bool PROFILE_CAPTURE = false;
+
+// Long frames (WAIT(0) to WAIT(0), HitchDetector.h) dump the last
+// ~30 frames of state, natives and zones to a file.
+static HitchDetector g_hitches;
+static const char* HITCH_FILE = "CompanionMod.hitches.log";
+static const char* HITCH_TRACE_FILE = "CompanionMod.hitch.json";   // latest hitch, Chrome trace
+
+// Heap allocations per tick (AllocTracker.h). Counted in Debug
+// builds only; any allocation in the loop is logged as a violation.
+static AllocScope g_tickAllocs("tick");
+static constexpr uint32_t ALLOC_LOG_MAX = 20;          // violations logged, then quiet
+
+// Per-frame scratch memory (FrameArena.h), reset at frame start.
+// A full-radius scan is the largest user: 512 x (4 + 12) bytes.
+static FrameArena g_frameArena(64 * 1024);
+
+// Worker threads for native-free work (JobSystem.h). Kept small:
+// the game's own threads want the rest of the cores.
+static constexpr uint32_t JOB_WORKERS = 2;
+static JobSystem g_jobs;
+
+// How long DllMain waits for each background thread (tuning
+// watcher, saver, job workers) to leave its loop on FreeLibrary.
+// The saver's last write is inside this.
+static constexpr uint32_t THREAD_STOP_WAIT_MS = 1000;
+
+// What this frame knew, for threads that can't call natives
+// (WorldSnapshot.h). Published every frame after the nearby scan.
+static WorldSnapshotBuffer g_snapshots;
+static Vec3 g_companionPos{};               // from the LOD sample
+static uint32_t g_companionPosTick = 0;
+
+// Multi-frame behaviours (CoTask.h): spawning, boarding retries,
+// stay anchor upkeep and teleports. Ticked once per frame in the
+// Tasks zone.
+static CoScheduler g_tasks;
+static CoTaskId g_spawnTask = 0;
+static CoTaskId g_rideTask = 0;
+static CoTaskId g_stayTask = 0;
+
+static constexpr double SPAWN_MODEL_TIMEOUT_SECONDS = 2.0;
+
+// Companion killed: the body is cleared at once and a new one
+// spawned this long after (once the player is up, no mission)
+static constexpr uint32_t DEATH_RESPAWN_TICKS = 300;     // ~5s @60fps
+static uint32_t g_deathRespawnTick = 0;                  // 0 = none pending
+
+// Player motion model + lead-follow (MotionPredictor.h): follow
+// aims at where the player is heading and starts catching up
+// before the gap opens, instead of after a teleport-sized one.
+static MotionPredictor g_motion;
+static MotionState g_playerMotion;
+static LeadFollow g_leadFollow;
+static LeadFollowState g_followPlan;
+static double g_lastFrameSeconds = 0.0;
+
+static constexpr uint32_t KEEPING_UP_REFRESH_SCALE = 4;   // follow refresh x4 while the companion keeps up
+
+// Formation slots (Formation.h): where each companion follows,
+// re-assigned when the shape / squad size / spacing changes
+static FormationSolver g_formation;
+
+// Player breadcrumbs (BreadcrumbTrail.h): a companion that fell
+// behind and stalls walks the player's own path (through the
+// door, round the building) instead of the follow task's
+// straight line
+static BreadcrumbTrail g_trail;
+static TrailFollow g_trailFollow;
+static TrailFollowState g_trailState;
+
+// Teleport destinations (TeleportSearch.h): a checked spot near
+// the player instead of a fixed offset, found over a few frames
+// by g_teleportTask
+static TeleportSearch g_teleportSearch;
+static CoTaskId g_teleportTask = 0;
+
+// Stay anchor upkeep (StayDrift.h): adaptive checks + smooth
+// corrections instead of a fixed-rate read and snap
+static StayDrift g_stayDrift;
+static constexpr float STAY_MAX_DT_SECONDS = 0.1f;        // slide step cap after a long frame
+static constexpr uint32_t STAY_MAX_CONTACTS = 16;
+
+// What the tasks read from the current frame
+struct TaskFrame
+{
+    bool playerInVehicle = false;
+    int playerVehicle = 0;
+    bool vehicleNear = false;           // on foot, a vehicle within g_ride.config.intentMeters
+    bool requestStay = false;
+    uint32_t staySnapTicks = 1;
+    uint32_t rideCooldownTicks = 1;
+};
+static TaskFrame g_taskFrame;
+
+static void OnTickAllocation(const char* scope, uint64_t allocations, uint64_t bytes, void*)
+{
+    if (g_tickAllocs.Violations() <= ALLOC_LOG_MAX)
+        Logger::Log("[Alloc] tick=%u %s scope allocated %llu times (%llu bytes)%s",
+            g_tickCount, scope, (unsigned long long)allocations, (unsigned long long)bytes,
+            g_tickAllocs.Violations() == ALLOC_LOG_MAX ? " - further violations not logged" : "");
+}
+
+// Values + any problems the parser found, one log line each
+static void LogTuning(const TuningSnapshot& t, const char* what)
+{
+    const CompanionTuning& v = t.values;
+    Logger::Log("[Tuning] %s v%u: follow dist=%.2f speed=%.2f refresh=%u teleport dist=%.1f cooldown=%u stay_snap=%u ride_cooldown=%u formation=%s spacing=%.1f trace=%u",
+        what, t.version, v.followDistance, v.followSpeed, v.followRefreshTicks,
+        v.teleportDistMeters, v.teleportCooldownTicks, v.staySnapTicks, v.rideAttemptCooldownTicks,
+        FormationShapeName((FormationShape)v.formationShape), v.formationSpacing, v.traceRecording);
+
+    const char* line = t.messages;
+    while (*line != '\0')
+    {
+        const char* end = strchr(line, '\n');
+        int len = end ? (int)(end - line) : (int)strlen(line);
+        Logger::Log("[Tuning]   %.*s", len, line);
+        line += len + (end ? 1 : 0);
+    }
+}
+
+// IsKeyJustPressed + note the press in the trace
+static bool KeyPressed(int vk, uint8_t traceKey)
+{
+    if (!EngineAdapter::IsKeyJustPressed(vk))
+        return false;
+
+    g_traceRec.keys |= traceKey;
+    return true;
+}
+
+// Samples nearby peds + vehicles through the adapter and
+// rebuilds g_nearbyGrid from them. withPedFlags also reads the
+// dead / mission-entity bits (2 extra natives per ped), which
+// only Frenzy targeting needs.
+static void ScanNearbyEntities(bool withPedFlags)
+{
+    ProfileScope zone(g_profiler, ProfZone::NearbyScan);
+
+    // Scratch for this scan only. If the arena is full, keep last
+    // scan's grid rather than clearing it.
+    int* handles = g_frameArena.AllocArray<int>(NEARBY_MAX_PEDS);
+    Vec3* positions = g_frameArena.AllocArray<Vec3>(NEARBY_MAX_PEDS);
+    if (handles == nullptr || positions == nullptr)
+        return;
+
+    g_nearbyGrid.BeginRebuild();
+
+    int peds = EngineAdapter::GetNearbyPeds(NEARBY_SCAN_RADIUS, handles, positions, NEARBY_MAX_PEDS);
+    for (int i = 0; i < peds; ++i)
+    {
+        uint8_t flags = 0;
+        if (withPedFlags)
+        {
+            if (EngineAdapter::IsPedDead(handles[i])) flags |= EntityFlag_Dead;
+            if (EngineAdapter::IsMissionEntity(handles[i])) flags |= EntityFlag_Mission;
+        }
+        g_nearbyGrid.Insert(handles[i], EntityKind_Ped, positions[i], flags);
+    }
+
+    int vehs = EngineAdapter::GetNearbyVehicles(NEARBY_SCAN_RADIUS, handles, positions, NEARBY_MAX_VEHICLES);
+    for (int i = 0; i < vehs; ++i)
+        g_nearbyGrid.Insert(handles[i], EntityKind_Vehicle, positions[i]);
+
+    g_nearbyGrid.FinishRebuild();
+}
+
+// Post-scan jobs: rank / target over the scan the published
+// snapshot points at (g_nearbyGrid). Pure CPU, they run on a
+// worker while the script fiber carries on. They're joined the
+// frame they start, before the next scan can rebuild the grid,
+// so reading it in place is safe; the script fiber only queries
+// it meanwhile. false from Read() means the snapshot kept getting
+// lapped: the job skips this scan (the [Snapshot] heartbeat
+// counts it).
+struct ThreatSyncJob
+{
+    uint32_t tick;
+};
+
+static void RunThreatSync(Job&, const void* data)
+{
+    const ThreatSyncJob& d = JobSystem::Data<ThreatSyncJob>(data);
+    WorldSnapshot s;
+    if (g_snapshots.Read(s) && s.nearby != nullptr)
+        g_threats.SyncCandidates(*s.nearby, s.playerPosition, d.tick);
+}
+
+struct FrenzyEvalJob
+{
+    Vec3 companionPos;           // read this frame; the snapshot's is LOD-paced
+    uint32_t tick;
+};
+
+static void RunFrenzyEval(Job&, const void* data)
+{
+    const FrenzyEvalJob& d = JobSystem::Data<FrenzyEvalJob>(data);
+    WorldSnapshot s;
+    if (g_snapshots.Read(s) && s.nearby != nullptr)
+        g_frenzy.Evaluate(*s.nearby, d.companionPos, s.playerPosition, d.tick);
+}
+
+// Copies this frame's state into the next snapshot buffer. No
+// natives, and a fixed cost: the nearby scan is published as a
+// pointer to g_nearbyGrid, not copied.
+// Published right after the nearby scan, before the decision
+// logic: the companion fields are as of the end of last frame.
+static void PublishSnapshot(const WorldSample& world, const CompanionContext& ctx)
+{
+    WorldSnapshot& s = g_snapshots.BeginWrite();
+
+    s.tick = g_tickCount;
+    s.playerExists = world.playerExists;
+    s.playerDead = world.playerDead;
+    s.playerInVehicle = world.playerInVehicle;
+    s.missionActive = world.missionActive;
+    s.playerVehicle = world.playerVehicle;
+    s.playerPosition = ctx.playerPos;
+
+    s.companionCount = g_state.spawned ? 1 : 0;
+    SnapshotCompanion& c = s.companions[0];
+    c.position = g_companionPos;
+    c.positionTick = g_companionPosTick;
+    c.activity = (uint8_t)g_state.activity;
+    c.mode = (uint8_t)g_state.mode;
+    c.lodTier = (uint8_t)g_lodState.tier;
+    c.stayEnabled = g_stayToggle ? 1 : 0;
+    c.vehicle = g_ridingVehicleHandle;
+    c.seat = g_ridingSeat;
+
+    s.nearby = &g_nearbyGrid;
+    s.nearbyTick = g_lastNearbyScanTick;
+    s.nearbyCount = g_nearbyGrid.Count();
+
+    s.seats = g_lastSeatCheck;
+
+    g_snapshots.Publish();
+}
+
+// ------------------------------------------------------------
+// Tasks (CoTask.h)
+// ------------------------------------------------------------
+// Each of these used to be a tick counter (or a WAIT loop) in
+// the main loop. They run from g_tasks.Tick() in the Tasks zone,
+// except for the part up to the first co_await, which runs
+// wherever the task is started.
+static void DispatchCompanionEvent(CompanionEvent event);
+
+// Model request held by a task; released however the task ends
+// (including Cancel)
+struct ModelRequest
+{
+    uint32_t model;
+
+    explicit ModelRequest(uint32_t m) : model(m) {}
+    ~ModelRequest() { EngineAdapter::ReleaseModel(model); }
+};
+
+static bool IsModelLoaded(void* model)
+{
+    return EngineAdapter::IsModelLoaded((uint32_t)(uintptr_t)model);
+}
+
+// Creates the ped once its model is loaded. `what` prefixes the
+// OK / FAILED log line.
+static void CreateCompanion(const char* what, uint32_t model)
+{
+    if (EngineAdapter::CreateTestPed(model))
+    {
+        g_state.spawned = true;
+        Logger::Log("%s OK", what);
+    }
+    else
+    {
+        Logger::Log("%s FAILED", what);
+    }
+}
+
+// Request the model, poll it once per frame, then create the ped.
+static CoTask SpawnCompanion(const char* what)
+{
+    ModelRequest request(EngineAdapter::RequestCompanionModel());
+
+    if (!co_await Until(IsModelLoaded, (void*)(uintptr_t)request.model, SPAWN_MODEL_TIMEOUT_SECONDS))
+    {
+        Logger::Log("%s FAILED (model not loaded after %.1fs)", what, SPAWN_MODEL_TIMEOUT_SECONDS);
+        co_return;
+    }
+
+    CreateCompanion(what, request.model);
+}
+
+// The same steps without a task, for when Start() fails (task
+// table or frame pool full, or a build whose frame outgrew
+// kBlockBytes): spawning must not depend on a free slot.
+// Polled by PollFallbackSpawn() next to g_tasks.Tick().
+struct FallbackSpawn
+{
+    const char* what = nullptr;  // null = none pending
+    uint32_t model = 0;
+    double deadline = 0.0;
+};
+static FallbackSpawn g_fallbackSpawn;
+
+static bool IsSpawnPending()
+{
+    return g_tasks.IsRunning(g_spawnTask) || g_fallbackSpawn.what != nullptr;
+}
+
+static void CancelSpawn()
+{
+    g_tasks.Cancel(g_spawnTask);
+    if (g_fallbackSpawn.what != nullptr)
+    {
+        EngineAdapter::ReleaseModel(g_fallbackSpawn.model);
+        g_fallbackSpawn = FallbackSpawn{};
+    }
+}
+
+static void PollFallbackSpawn()
+{
+    FallbackSpawn& f = g_fallbackSpawn;
+    if (f.what == nullptr)
+        return;
+
+    if (EngineAdapter::IsModelLoaded(f.model))
+        CreateCompanion(f.what, f.model);
+    else if (g_tasks.CurrentSeconds() < f.deadline)
+        return;
+    else
+        Logger::Log("%s FAILED (model not loaded after %.1fs)", f.what, SPAWN_MODEL_TIMEOUT_SECONDS);
+
+    EngineAdapter::ReleaseModel(f.model);
+    f = FallbackSpawn{};
+}
+
+// One spawn at a time; asking again while the model loads is a no-op
+static void StartSpawn(const char* what)
+{
+    if (IsSpawnPending())
+        return;
+
+    g_spawnTask = g_tasks.Start(SpawnCompanion(what));
+    if (g_spawnTask != 0)
+        return;
+
+    Logger::Log("%s: no task slot, spawning from the main loop", what);
+    g_fallbackSpawn.what = what;
+    g_fallbackSpawn.model = EngineAdapter::RequestCompanionModel();
+    g_fallbackSpawn.deadline = g_tasks.CurrentSeconds() + SPAWN_MODEL_TIMEOUT_SECONDS;
+}
+
+// Teleport probes -> natives (TeleportSearch calls these from Step)
+static GroundSample ProbeGround(void*, float x, float y, float zTop)
+{
+    return EngineAdapter::SampleGround(x, y, zTop);
+}
+
+static int ProbeStart(void*, const Vec3& from, const Vec3& to, float radius)
+{
+    return EngineAdapter::StartClearanceProbe(from, to, radius);
+}
+
+static ProbeStatus ProbePoll(void*, int handle)
+{
+    return EngineAdapter::PollClearanceProbe(handle);
+}
+
+static const TeleportProbes g_teleportProbes{ ProbeGround, ProbeStart, ProbePoll, nullptr };
+
+// Find a safe spot next to the player (a few frames, or none if
+// the cache has one), then move the companion there. If nothing
+// passes, `fallback` teleports to the old fixed offset anyway
+// (recall / release: the companion has to come back); otherwise
+// the teleport is skipped and the caller's cooldown retries it.
+static CoTask TeleportCompanion(const char* why, bool fallback)
+{
+    Vec3 player = EngineAdapter::GetPlayerPosition();
+    Vec3 forward = EngineAdapter::GetPlayerForwardVector();
+
+    TeleportSearchStatus status = g_teleportSearch.Begin(player, forward.x, forward.y, g_tasks.CurrentSeconds());
+    while (status == TeleportSearchStatus::Running)
+    {
+        status = g_teleportSearch.Step(g_teleportProbes, g_tasks.CurrentSeconds());
+        if (status == TeleportSearchStatus::Running)
+            co_await NextFrame();
+    }
+
+    if (!g_state.spawned)
+        co_return;
+
+    if (status == TeleportSearchStatus::Failed)
+    {
+        if (!fallback)
+        {
+            Logger::Log("%s: no safe spot near the player (%u frames), will retry", why, g_teleportSearch.Frames());
+            co_return;
+        }
+
+        EngineAdapter::TeleportTestPedNearPlayer(1.2f, 0.8f, 0.0f);
+        Logger::Log("%s: no safe spot near the player (%u frames) -> fixed offset", why, g_teleportSearch.Frames());
+    }
+    else
+    {
+        const Vec3& dest = g_teleportSearch.Position();
+        EngineAdapter::TeleportTestPedTo(dest);
+        Logger::Log("%s -> (%.1f, %.1f, %.1f) %s, %u frames", why, dest.x, dest.y, dest.z,
+            status == TeleportSearchStatus::FoundCached ? "cached" : "checked", g_teleportSearch.Frames());
+    }
+
+    // Stay began while searching (stay inside a vehicle releases
+    // first): anchor where the companion landed and re-freeze
+    if (g_state.hasStayAnchor)
+    {
+        g_state.stayAnchor = EngineAdapter::GetTestPedPosition();
+        EngineAdapter::FreezeTestPed(true);
+        g_stayDrift.Begin(g_taskFrame.staySnapTicks, g_tickCount);
+    }
+
+    // Force follow to re-issue immediately; re-tier next tick
+    g_lastFollowTick = 0;
+    g_lodState.hasSample = false;
+    g_lastTeleportTick = g_tickCount;
+}
+
+// One teleport at a time; asking again while one searches is a no-op
+static void StartTeleport(const char* why, bool fallback)
+{
+    if (g_tasks.IsRunning(g_teleportTask))
+        return;
+
+    g_teleportTask = g_tasks.Start(TeleportCompanion(why, fallback));
+    if (g_teleportTask == 0)
+    {
+        Logger::Log("%s: no task slot -> fixed offset", why);
+        EngineAdapter::TeleportTestPedNearPlayer(1.2f, 0.8f, 0.0f);
+        g_lastFollowTick = 0;
+        g_lodState.hasSample = false;
+    }
+}
+
+// Stay: keep the frozen ped on its anchor (StayDrift.h). Looks
+// less often while nothing happens, sooner after something came
+// close or blew up, and slides a drifted ped back instead of
+// popping it. Started by EnterStay, cancelled by ExitStay.
+static CoTask StayAnchorLoop()
+{
+    double last = g_tasks.CurrentSeconds();
+
+    for (;;)
+    {
+        co_await NextFrame();
+
+        double now = g_tasks.CurrentSeconds();
+        float dt = (float)(now - last);
+        last = now;
+        if (dt > STAY_MAX_DT_SECONDS)
+            dt = STAY_MAX_DT_SECONDS;
+
+        if (!g_taskFrame.requestStay || !g_state.spawned || !g_state.hasStayAnchor)
+            continue;
+
+        const Vec3 anchor = g_state.stayAnchor;
+        StayDriftStep step = g_stayDrift.Step(anchor, g_tickCount, dt);
+
+        if (step.move)
+            EngineAdapter::SetTestPedPosition(step.to);
+
+        if (step.probe && EngineAdapter::IsExplosionNear(anchor, g_stayDrift.config.explosionMeters))
+        {
+            g_stayDrift.Disturb(StayDisturbance::Explosion, g_tickCount);
+            Logger::Log("[Stay] Explosion near the anchor, checking sooner");
+        }
+
+        if (step.check)
+        {
+            Vec3 cur = EngineAdapter::GetTestPedPosition();
+            g_companionPos = cur;
+            g_companionPosTick = g_tickCount;
+            g_stayDrift.Observe(cur, anchor, g_tickCount);
+
+            if (g_stayDrift.Sliding())
+            {
+                float drift = sqrtf(Geometry::DistSq(cur, anchor));
+                Logger::Log("[Stay] Drifted %.2fm, %s", drift,
+                    drift > g_stayDrift.config.snapMeters ? "snapping back" : "sliding back");
+            }
+        }
+    }
+}
+
+// Entities that came within reach of the stay anchor since the
+// last scan (player included) tighten the drift checks
+static void NoteStayContacts(const Vec3& playerPos)
+{
+    if (!g_stayDrift.Active() || !g_state.hasStayAnchor)
+        return;
+
+    const float radius = g_stayDrift.config.contactMeters;
+    uint32_t hits[STAY_MAX_CONTACTS];
+    uint32_t count = g_nearbyGrid.QueryRadius(g_state.stayAnchor, radius,
+        EntityKind_Ped | EntityKind_Vehicle, hits, STAY_MAX_CONTACTS);
+
+    Vec3 positions[STAY_MAX_CONTACTS + 1];
+    for (uint32_t i = 0; i < count; ++i)
+        positions[i] = g_nearbyGrid.Position(hits[i]);
+    if (Geometry::DistSq(playerPos, g_state.stayAnchor) <= radius * radius)
+        positions[count++] = playerPos;
+
+    g_stayDrift.NoteContacts(g_state.stayAnchor, positions, count, g_tickCount);
+}
+
+// Vehicle riding V2: the ride phases (VehicleRide.h) say what to
+// look at, this does the natives and keeps the lifecycle FSM in
+// step (Boarded / RideDesync). Runs while the companion is out;
+// sleeps while waiting on a full car, woken by vehicle events
+// (OnPlayerVehicleEvent). Stay-while-riding and the player-exit
+// release are FSM transitions out of Riding (Core::Tick).
+static CoTask RideLoop()
+{
+    while (g_state.spawned)
+    {
+        RideInput in;
+        in.canRide = g_state.activity == CompanionActivity::Following
+            || g_state.activity == CompanionActivity::Riding;
+        in.playerInVehicle = g_taskFrame.playerInVehicle;
+        in.playerVehicle = g_taskFrame.playerVehicle;
+        in.vehicleNear = g_taskFrame.vehicleNear;
+        in.releasing = g_tasks.IsRunning(g_teleportTask);
+
+        const RidePhase before = g_ride.Phase();
+        RideStep step = g_ride.Step(in, g_tickCount, g_taskFrame.rideCooldownTicks);
+        TickTrace::CaptureRideStep(g_traceRec, in, g_taskFrame.rideCooldownTicks, step);
+
+        if (step.pollIntent)
+        {
+            g_traceRec.rideEntering = EngineAdapter::GetVehiclePlayerIsEntering();
+            g_ride.NoteEntering(g_traceRec.rideEntering);
+        }
+
+        if (step.pickSeat)
+        {
+            int seat = FindFreeSeat(step.vehicle, g_tickCount);
+            g_traceRec.ridePickedSeat = (int16_t)seat;
+            g_ride.SeatPicked(step.vehicle, seat);
+        }
+
+        if (step.board)
+        {
+            int seat = VehicleRide::kNoSeat;
+            bool ok = TryWarpCompanionIntoAnySeat(step.vehicle, step.seat, seat, g_tickCount);
+            g_ride.Boarded(ok, seat, g_tickCount);
+
+            g_traceRec.rideBoardSeat = (int16_t)seat;
+
+            if (ok)
+            {
+                g_traceRec.rideFlags |= TraceRide_BoardOk;
+                DispatchCompanionEvent(CompanionEvent::Boarded);
+                g_ridingVehicleHandle = step.vehicle;
+                g_ridingSeat = seat;
+
+                // While riding, suppress follow spam
+                g_lastFollowTick = g_tickCount;
+
+                Logger::Log("[VehicleRideV2] Warped companion into vehicle=%d seat=%d%s", step.vehicle, seat,
+                    (step.seat != VehicleRide::kNoSeat && seat == step.seat) ? " (picked while approaching)" : "");
+            }
+        }
+
+        if (step.confirm)
+        {
+            int pedVeh = EngineAdapter::GetTestPedVehicleHandle();
+            g_traceRec.rideCompanionVehicle = pedVeh;
+            g_ride.Confirm(pedVeh, g_tickCount);
+
+            if (g_ride.Phase() == RidePhase::Evicted)
+                Logger::Log("[VehicleRideV2] Desync detected. pedVeh=%d latchedVeh=%d", pedVeh, g_ridingVehicleHandle);
+        }
+
+        if (step.pollSeats)
+        {
+            int passengers = EngineAdapter::GetVehiclePassengerCount(step.vehicle);
+            g_traceRec.ridePassengers = (int16_t)passengers;
+            if (g_ride.NoteOccupancy(passengers, g_tickCount))
+                Logger::Log("[Ride] Seat freed in vehicle=%d (%d passengers), retrying", step.vehicle, passengers);
+        }
+
+        g_traceRec.ridePhase = (uint8_t)g_ride.Phase();
+
+        if (g_ride.Phase() != before)
+        {
+            Logger::Log("[Ride] %s -> %s vehicle=%d seat=%d", RidePhaseName(before), RidePhaseName(g_ride.Phase()),
+                g_ride.Vehicle(), g_ride.Seat());
+
+            // Not in the car we think: keep the FSM honest
+            if (g_ride.Phase() == RidePhase::Evicted && g_state.activity == CompanionActivity::Riding)
+                DispatchCompanionEvent(CompanionEvent::RideDesync);
+        }
+
+        uint32_t idle = g_ride.IdleTicks(g_tickCount);
+        if (idle > 1)
+            co_await Frames(idle);
+        else
+            co_await NextFrame();
+    }
+
+    g_ride.Reset();
+    g_traceRec.rideFlags |= TraceRide_Reset;
+    g_traceRec.ridePhase = (uint8_t)g_ride.Phase();
+}
+
+// ------------------------------------------------------------
+// Lifecycle actions
+// ------------------------------------------------------------
+// The FSM in CompanionCore decides WHEN; this does the natives.
+// Runs the bits in the order CompanionAction lists them, so e.g.
+// the ped is unfrozen before it is despawned, and the stay anchor
+// is captured after it has been pulled out of a vehicle.
+static void ExecuteCompanionActions(uint16_t actions)
+{
+    if (actions & CompanionAction_ExitStay)
+    {
+        EngineAdapter::FreezeTestPed(false);
+
+        g_state.hasStayAnchor = false;
+        g_tasks.Cancel(g_stayTask);
+        g_stayTask = 0;
+        g_stayDrift.End();
+
+        // Force follow to re-issue immediately after leaving stay
+        g_lastFollowTick = 0;
+
+        Logger::Log("[Main] Stay OFF");
+    }
+
+    if (actions & CompanionAction_ClearRiding)
+    {
+        g_ridingVehicleHandle = 0;
+        g_ridingSeat = -999;
+    }
+
+    if ((actions & CompanionAction_ReleaseFromVehicle) && g_state.spawned)
+    {
+        StartTeleport("[VehicleRide] Released companion from vehicle", true);
+    }
+
+    if (actions & CompanionAction_MissionSuspend)
+    {
+        g_stayToggleBeforeMission = g_stayToggle;
+
+        Logger::Log("[MissionGate] Mission START — suspending companion. spawnedBefore=%d stayBefore=%d",
+            (int)(g_state.activity == CompanionActivity::SuspendedWasActive),
+            (int)g_stayToggleBeforeMission);
+    }
+
+    // Despawn for maximum stability (recommended)
+    if (actions & CompanionAction_Despawn)
+    {
+        // A spawn still waiting on its model must not finish mid-mission
+        CancelSpawn();
+        g_tasks.Cancel(g_teleportTask);
+
+        if (g_state.spawned)
+        {
+            EngineAdapter::DespawnTestPed();
+            g_state.spawned = false;
+        }
+    }
+
+    if (actions & CompanionAction_MissionResume)
+    {
+        Logger::Log("[MissionGate] Mission END — resuming companion. respawn=%d stayRestore=%d",
+            (int)((actions & CompanionAction_Respawn) != 0),
+            (int)g_stayToggleBeforeMission);
+
+        // Restore stay toggle (whether you want it ON or OFF after missions)
+        g_stayToggle = g_stayToggleBeforeMission;
+
+        // Clear mission gate
+        g_debugForceMissionGate = false;
+        Logger::Log("[DEBUG] ForceMissionGate auto-cleared on mission end");
+    }
+
+    // Respawn only if it existed before mission
+    if ((actions & CompanionAction_Respawn) && !g_state.spawned)
+    {
+        StartSpawn("[MissionGate] Respawn");
+    }
+
+    if ((actions & CompanionAction_EnterStay) && g_state.spawned)
+    {
+        // Capture anchor at the moment Stay begins (or put the ped
+        // back on the one from the last session)
+        g_state.stayAnchor = EngineAdapter::GetTestPedPosition();
+        g_state.hasStayAnchor = true;
+
+        if (g_restoreAnchor)
+        {
+            g_restoreAnchor = false;
+            if (Geometry::DistSq(g_savedAnchor, EngineAdapter::GetPlayerPosition()) <= g_tuning.Current().teleportDistSq)
+            {
+                EngineAdapter::SetTestPedPosition(g_savedAnchor);
+                g_state.stayAnchor = g_savedAnchor;
+                Logger::Log("[Save] Stay anchor restored");
+            }
+            else
+            {
+                Logger::Log("[Save] Saved stay anchor too far from the player, anchoring here");
+            }
+        }
+
+        g_tasks.Cancel(g_stayTask);
+        g_stayTask = g_tasks.Start(StayAnchorLoop());
+        g_stayDrift.Begin(g_taskFrame.staySnapTicks, g_tickCount);
+
+        EngineAdapter::ClearTestPedTasks();
+        EngineAdapter::FreezeTestPed(true);
+
+        // Ensure follow restarts cleanly when we exit stay
+        g_lastFollowTick = 0;
+
+        Logger::Log("[Main] Stay ACTIVE anchor=(%.2f,%.2f,%.2f)",
+            g_state.stayAnchor.x, g_state.stayAnchor.y, g_state.stayAnchor.z);
+    }
+
+    if (actions & CompanionAction_ResetTimers)
+    {
+        g_lastFollowTick = 0;
+        g_lastTeleportTick = 0;
+
+        // Boarding retries right away instead of after its cooldown
+        g_tasks.Wake(g_rideTask);
+    }
+}
+
+// Feeds one event the main loop observed (outside Core::Tick)
+// into the FSM and carries out whatever it emits.
+static void DispatchCompanionEvent(CompanionEvent event)
+{
+    CompanionActivity before = g_state.activity;
+    uint16_t actions = 0;
+
+    TickTrace::AddHostEvent(g_traceRec, event);
+
+    if (g_core.Dispatch(g_state, event, actions))
+    {
+        Logger::Log("[FSM] %s -> %s", CompanionFsm::Name(before), CompanionFsm::Name(g_state.activity));
+        ExecuteCompanionActions(actions);
+    }
+}
+
+// ------------------------------------------------------------
+// Edge events (EventBus.h)
+// ------------------------------------------------------------
+static EventBus g_events;
+static EdgeSampler g_edges;
+
+static void OnLogGameEvent(const GameEvent& e, void*)
+{
+    Logger::Log("[Event] %s a=%d b=%d", GameEventTypeName(e.type), e.a, e.b);
+}
+
+// Companion killed: despawn the body (the FSM leaves Active the
+// same way F7 does) and schedule a fresh one
+static void OnCompanionDied(const GameEvent&, void*)
+{
+    if (!g_state.spawned)
+        return;
+
+    g_tasks.Cancel(g_teleportTask);
+    EngineAdapter::DespawnTestPed();
+    g_state.spawned = false;
+    g_engagedThreat = 0;
+    DispatchCompanionEvent(CompanionEvent::Despawned);
+
+    g_deathRespawnTick = (g_tickCount + DEATH_RESPAWN_TICKS) | 1;
+    Logger::Log("[Main] Companion died -> despawned, respawning in ~%us", DEATH_RESPAWN_TICKS / 60);
+}
+
+// Player down: a teleport searching around the body would put
+// the companion where the player no longer is
+static void OnPlayerDied(const GameEvent&, void*)
+{
+    g_tasks.Cancel(g_teleportTask);
+}
+
+// Player back (usually at a hospital, far away): restart the
+// motion filter instead of reading the jump as velocity, re-issue
+// follow now, and bring a following companion over
+static void OnPlayerRespawned(const GameEvent&, void*)
+{
+    g_playerMotion.valid = false;
+    g_trail.Clear();
+    g_lastFollowTick = 0;
+    g_lastTeleportTick = 0;
+    g_lodState.hasSample = false;
+
+    if (g_state.spawned && g_state.activity == CompanionActivity::Following)
+        StartTeleport("[Main] Player respawned, companion brought over", true);
+}
+
+static void OnPlayerVehicleEvent(const GameEvent&, void*)
+{
+    // Entered, switched or got out: a RideLoop sleeping on a full
+    // car looks again now instead of at its next poll
+    g_tasks.Wake(g_rideTask);
+}
+
+static void SubscribeEventHandlers()
+{
+    for (int t = 0; t < (int)GameEventType::Count; ++t)
+        g_events.Subscribe((GameEventType)t, &OnLogGameEvent, nullptr);
+
+    g_core.Subscribe(g_events);
+
+    g_events.Subscribe(GameEventType::PlayerEnteredVehicle, &OnPlayerVehicleEvent, nullptr);
+    g_events.Subscribe(GameEventType::VehicleChanged, &OnPlayerVehicleEvent, nullptr);
+    g_events.Subscribe(GameEventType::PlayerExitedVehicle, &OnPlayerVehicleEvent, nullptr);
+
+    g_events.Subscribe(GameEventType::CompanionDied, &OnCompanionDied, nullptr);
+    g_events.Subscribe(GameEventType::PlayerDied, &OnPlayerDied, nullptr);
+    g_events.Subscribe(GameEventType::PlayerRespawned, &OnPlayerRespawned, nullptr);
+}
+
+// ------------------------------------------------------------
+// Companion save (CompanionSave.h)
+// ------------------------------------------------------------
+
+// Startup, once: takes mode / stay from the last session and
+// arms the spawn + anchor restore
+static void RestoreCompanion()
+{
+    uint64_t start = ProfileNowNs();
+    CompanionSaveRecord rec;
+    SaveLoadResult result = CompanionSave::Load(SAVE_FILE, rec);
+    double us = (double)(ProfileNowNs() - start) / 1e3;
+
+    if (result != SaveLoadResult::Loaded)
+    {
+        Logger::Log("[Save] %s: %s (%.0f us), starting fresh", SAVE_FILE, SaveLoadResultName(result), us);
+        return;
+    }
+
+    g_state.mode = (rec.mode == (uint8_t)CompanionMode::Frenzy) ? CompanionMode::Frenzy : CompanionMode::Protection;
+    g_stayToggle = (rec.flags & SaveFlag_Stay) != 0;
+    g_restoreSpawn = (rec.flags & SaveFlag_Spawned) != 0;
+    g_restoreAnchor = g_stayToggle && (rec.flags & SaveFlag_HasAnchor) != 0;
+    g_savedAnchor = { rec.stayAnchor[0], rec.stayAnchor[1], rec.stayAnchor[2] };
+
+    Logger::Log("[Save] Restored (%.0f us): mode=%s spawned=%d stay=%d anchor=%d riding=%d (was %s)",
+        us, g_state.mode == CompanionMode::Frenzy ? "Frenzy" : "Protection",
+        (int)g_restoreSpawn, (int)g_stayToggle, (int)g_restoreAnchor,
+        (int)((rec.flags & SaveFlag_Riding) != 0),
+        rec.activity < CompanionFsm::kStateCount ? CompanionFsm::Name((CompanionActivity)rec.activity) : "?");
+}
 
-// Vehicle Riding V2
-static int  g_ridingSeat = -999;
-static uint32_t g_lastRideAttemptTick = 0;
-static int  g_lastPlayerVehicleHandle = 0;
+// Every frame, after spawn/despawn. The saver only writes when
+// the record differs from the last one.
+static void OfferSave()
+{
+    // Until the restored companion is on its way back, this
+    // would save it as despawned
+    if (g_restoreSpawn)
+        return;
+
+    const bool suspendedOut = g_state.activity == CompanionActivity::SuspendedWasActive;
+    const bool suspended = suspendedOut || g_state.activity == CompanionActivity::SuspendedWasIdle;
+
+    CompanionSaveRecord rec{};
+    rec.mode = (uint8_t)g_state.mode;
+    rec.activity = (uint8_t)g_state.activity;
+    rec.rideSeat = VehicleRide::kNoSeat;
+
+    if (g_state.spawned || suspendedOut || IsSpawnPending() || g_deathRespawnTick != 0)
+        rec.flags |= SaveFlag_Spawned;
+    if (suspended ? g_stayToggleBeforeMission : g_stayToggle)
+        rec.flags |= SaveFlag_Stay;
+    if (g_state.hasStayAnchor)
+    {
+        rec.flags |= SaveFlag_HasAnchor;
+        rec.stayAnchor[0] = g_state.stayAnchor.x;
+        rec.stayAnchor[1] = g_state.stayAnchor.y;
+        rec.stayAnchor[2] = g_state.stayAnchor.z;
+    }
+    if (g_state.activity == CompanionActivity::Riding)
+    {
+        rec.flags |= SaveFlag_Riding;
+        rec.rideSeat = g_ridingSeat;
+    }
 
-static constexpr uint32_t RIDE_ATTEMPT_COOLDOWN_TICKS = 60; // ~1 second
+    g_saver.Offer(rec);
+}
 
 // Store our DLL module handle (needed later for file paths, etc.)
 HMODULE g_ModuleHandle = NULL;
@@ -122,18 +1131,75 @@ void ScriptMain()
     Logger::Log("=== CompanionMod ASI Loaded ===");
     Logger::Log("Phase 1 — Skeleton active. No gameplay systems yet.");
 
+    // Lifecycle table, so the log shows exactly what this build does
+    {
+        const char* from;
+        const char* event;
+        const char* to;
+        uint16_t action;
+
+        Logger::Log("[FSM] %d states, %d transitions", CompanionFsm::kStateCount - 1, CompanionFsm::kTransitionCount);
+        for (int i = 0; CompanionFsm::DescribeTransition(i, from, event, to, action); ++i)
+            Logger::Log("[FSM]   %-20s --%-14s--> %-20s actions=0x%03X", from, event, to, action);
+    }
+
+    SubscribeEventHandlers();
+
+    g_tuning.Start(TUNING_FILE);
+    g_core.SetTuning(g_tuning.Current().Core());
+    LogTuning(g_tuning.CurrentSnapshot(), g_tuning.CurrentSnapshot().version > 0 ? "Loaded" : "Defaults");
+
+    RestoreCompanion();
+    g_saver.Start(SAVE_FILE);
+
+    if (g_tuning.Current().traceRecording != 0 && g_recorder.Open("CompanionMod.trace"))
+        Logger::Log("[Trace] Recording ticks to CompanionMod.trace");
+
+    if (PROFILE_CAPTURE && g_profiler.StartCapture("CompanionMod.profile.json"))
+        Logger::Log("[Prof] Capturing frames to CompanionMod.profile.json");
+
     // Simple frame counter for periodic logging
     int frameCount = 0;
 
+    AllocTracker::SetViolationHandler(OnTickAllocation, nullptr);
+
+    g_jobs.Start(JOB_WORKERS);
+    Logger::Log("[Jobs] %u worker threads", g_jobs.Workers());
+
+    // Start hitch timing from here (first frame has no previous WAIT)
+    g_hitches.FrameBoundary(ProfileNowNs());
+
     // --- MAIN LOOP (runs every frame) ---
     while (true)
     {
+        g_profiler.BeginFrame();
+        g_tickAllocs.Begin();
+        g_frameArena.Reset();
+
         g_tickCount++;
+        TickTrace::Begin(g_traceRec, g_tickCount);
+
+        double frameSeconds = ProfileNowNs() / 1e9;
+        float frameDt = (float)(frameSeconds - g_lastFrameSeconds);
+        g_lastFrameSeconds = frameSeconds;
+        g_tasks.BeginFrame(g_tickCount, frameSeconds);
+
+        // Pick up an edited CompanionMod.ini (between frames only)
+        if (const TuningSnapshot* reloaded = g_tuning.Apply())
+        {
+            g_core.SetTuning(reloaded->values.Core());
+            LogTuning(*reloaded, "Reloaded");
+        }
+        const CompanionTuning& tuning = g_tuning.Current();
+        g_taskFrame.staySnapTicks = tuning.staySnapTicks;
+        g_taskFrame.rideCooldownTicks = tuning.rideAttemptCooldownTicks;
+
+        g_profiler.Begin(ProfZone::Input);
 
         // ------------------------------------------------
         // DEBUG: Toggle Mission Gate (F9)
         // ------------------------------------------------
-        if (EngineAdapter::IsKeyJustPressed(VK_F10))
+        if (KeyPressed(VK_F10, TraceKey_F10))
         {
             g_debugForceMissionGate = !g_debugForceMissionGate;
 
@@ -141,97 +1207,18 @@ void ScriptMain()
                 (int)g_debugForceMissionGate);
         }
 
-        // ------------------------------------------------
-        // MISSION GATE (V1)
-        // ------------------------------------------------
-        bool isMissionActive = EngineAdapter::IsMissionActive();
-        isMissionActive = isMissionActive || g_debugForceMissionGate;
-
-        // Mission started edge
-        if (isMissionActive && !g_wasMissionActive)
-        {
-            g_companionWasSpawnedBeforeMission = g_state.spawned;
-            g_stayToggleBeforeMission = g_stayToggle;
-
-            Logger::Log("[MissionGate] Mission START — suspending companion. spawnedBefore=%d stayBefore=%d",
-                (int)g_companionWasSpawnedBeforeMission,
-                (int)g_stayToggleBeforeMission);
-
-            // Despawn for maximum stability (recommended)
-            if (g_state.spawned)
-            {
-                EngineAdapter::DespawnTestPed();
-                g_state.spawned = false;
-            }
-
-            // Clear vehicle state
-            g_isRiding = false;
-            g_ridingVehicleHandle = 0;
-            g_wasPlayerInVehicle = false;
-
-            // Clear Vehicle Riding V2 state
-            g_ridingSeat = -999;
-            g_lastRideAttemptTick = 0;
-            g_lastPlayerVehicleHandle = 0;
-
-            // Reset timers so we resume cleanly
-            g_lastFollowTick = 0;
-            g_lastTeleportTick = 0;
-
-            // Clear local stay runtime flags
-            g_isStayingActive = false;
-        }
-
-        // Mission ended edge
-        if (!isMissionActive && g_wasMissionActive)
+        // F8 switches Protection <-> Frenzy
+        if (KeyPressed(VK_F8, TraceKey_F8))
         {
-            Logger::Log("[MissionGate] Mission END — resuming companion. respawn=%d stayRestore=%d",
-                (int)g_companionWasSpawnedBeforeMission,
-                (int)g_stayToggleBeforeMission);
-
-            // Restore stay toggle (whether you want it ON or OFF after missions)
-            g_stayToggle = g_stayToggleBeforeMission;
-
-            // Respawn only if it existed before mission
-            if (g_companionWasSpawnedBeforeMission)
-            {
-                if (EngineAdapter::SpawnTestPed())
-                {
-                    g_state.spawned = true;
-                    Logger::Log("[MissionGate] Respawn OK");
-                }
-                else
-                {
-                    Logger::Log("[MissionGate] Respawn FAILED");
-                }
-            }
-
-            // Clear vehicle state
-            g_isRiding = false;
-            g_ridingVehicleHandle = 0;
-            g_wasPlayerInVehicle = false;
+            g_state.mode = (g_state.mode == CompanionMode::Frenzy) ? CompanionMode::Protection : CompanionMode::Frenzy;
+            Logger::Log("[Main] Mode: %s (F8)", g_state.mode == CompanionMode::Frenzy ? "Frenzy" : "Protection");
 
-            // Clear Vehicle Riding V2 state
-            g_ridingSeat = -999;
-            g_lastRideAttemptTick = 0;
-            g_lastPlayerVehicleHandle = 0;
-
-            // Reset timers so follow re-issues immediately
-            g_lastFollowTick = 0;
-            g_lastTeleportTick = 0;
-
-            // Clear mission-memory
-            g_companionWasSpawnedBeforeMission = false;
-
-            // Clear mission gate
-            g_debugForceMissionGate = false;
-            Logger::Log("[DEBUG] ForceMissionGate auto-cleared on mission end");
+            // Force a fresh scan so the new mode has data right away
+            g_lastNearbyScanTick = g_tickCount - NEARBY_SCAN_TICKS;
         }
 
-        g_wasMissionActive = isMissionActive;
-
         // F6 toggles Stay on/off
-        if (EngineAdapter::IsKeyJustPressed(VK_F6))
+        if (KeyPressed(VK_F6, TraceKey_F6))
         {
             g_stayToggle = !g_stayToggle;
             Logger::Log("[Main] Stay toggled: %s", g_stayToggle ? "ON" : "OFF");
@@ -241,201 +1228,398 @@ void ScriptMain()
                 g_lastFollowTick = 0;
         }
 
+        g_profiler.End(ProfZone::Input);
+
+        // ------------------------------------------------
+        // WORLD SAMPLE -> EDGE EVENTS (incl. MISSION GATE V1)
+        // ------------------------------------------------
+        // One adapter read per frame; the edge sampler turns
+        // changes into events and subscribers (Core's lifecycle
+        // FSM, vehicle boarding, the log) react right here.
+        // Mission suspend/resume is the FSM's Suspended state.
+        // ------------------------------------------------
+        g_profiler.Begin(ProfZone::WorldSample);
+
+        WorldSample world{};
+        EngineAdapter::SampleWorld(world);
+        world.missionActive = world.missionActive || g_debugForceMissionGate;
+        world.stayEnabled = g_stayToggle;
+
+        g_edges.Update(world, g_tickCount, g_events);
+        if (g_events.Pending() > 0)
+            g_events.Dispatch();
+
+        g_profiler.End(ProfZone::WorldSample);
+
+        bool isMissionActive = world.missionActive;
+
+        g_profiler.Begin(ProfZone::Context);
+
         CompanionContext ctx{};
         ctx.tickCount = g_tickCount;
         ctx.deltaSeconds = 1.0f / 60.0f; // ok for now
 
-        ctx.playerExists = EngineAdapter::PlayerExists();
-        ctx.playerDead = EngineAdapter::IsPlayerDead();
-        ctx.playerInVehicle = EngineAdapter::IsPlayerInVehicle();
+        ctx.playerExists = world.playerExists;
+        ctx.playerDead = world.playerDead;
+        ctx.playerInVehicle = world.playerInVehicle;
         ctx.playerPos = EngineAdapter::GetPlayerPosition();
 
+        // Every frame: the filter needs consecutive samples
+        if (ctx.playerExists)
+            g_motion.Update(g_playerMotion, ctx.playerPos, frameDt);
+        else
+            g_playerMotion.valid = false;
+
+        // Breadcrumbs only where the companion could walk them
+        if (ctx.playerExists && !ctx.playerDead && !ctx.playerInVehicle)
+            g_trail.Offer(ctx.playerPos);
+        else if (!g_trail.Empty())
+            g_trail.Clear();
+
         // Keep runtime state honest (prevents desync if ped disappears)
-        g_state.spawned = EngineAdapter::DoesTestPedExist();
+        g_state.spawned = world.companionExists;
 
         // Feed input state into the Core-owned state
         g_state.stayEnabled = g_stayToggle;
 
-        CompanionCommands cmd{};
-        g_core.Tick(ctx, g_state, cmd);
-
         // ------------------------------------------------
-        // VEHICLE RIDING V1 (simple + stable)
+        // NEARBY ENTITY SCAN (spatial grid)
         // ------------------------------------------------
+        // Only while a companion is out. Protection candidates
+        // are re-synced from each fresh scan.
+        // ------------------------------------------------
+        bool engagedModeOk = g_state.spawned && !isMissionActive
+            && ctx.playerExists && !ctx.playerDead && !ctx.playerInVehicle;
+        bool protecting = engagedModeOk && g_state.mode == CompanionMode::Protection;
+        bool frenzying = engagedModeOk && g_state.mode == CompanionMode::Frenzy;
+
+        // Grid work handed to a worker this frame; joined before
+        // anything reads g_threats / g_frenzy
+        Job* postScanJob = nullptr;
+
+        // Companion position / visibility read while that job runs,
+        // for the LOD sample further down
+        Vec3 companionPos{};
+        bool companionPosRead = false;
+        bool companionOnScreen = false;
+        bool companionSampled = false;
+
+        bool scanned = false;
+        if (g_state.spawned && !isMissionActive)
         {
-            bool playerInVehicle = ctx.playerInVehicle;
-
-            // Safety: if Stay was requested while riding, release first.
-            if (cmd.requestStay && g_isRiding && g_state.spawned)
+            if ((g_tickCount - g_lastNearbyScanTick) >= NEARBY_SCAN_TICKS)
             {
-                EngineAdapter::TeleportTestPedNearPlayer(1.2f, 0.8f, 0.0f);
-                g_isRiding = false;
-                g_ridingVehicleHandle = 0;
-                g_lastFollowTick = 0;
-                Logger::Log("[VehicleRide] Stay requested while riding -> released companion before Stay");
+                ScanNearbyEntities(frenzying);
+                g_lastNearbyScanTick = g_tickCount;
+                scanned = true;
             }
+        }
+        else if (g_nearbyGrid.Count() > 0)
+        {
+            g_nearbyGrid.BeginRebuild();
+            g_nearbyGrid.FinishRebuild();
+        }
 
-            // Detect the edge: player just exited their vehicle
-            if (g_wasPlayerInVehicle && !playerInVehicle)
-            {
-                if (g_isRiding && g_state.spawned)
-                {
-                    EngineAdapter::TeleportTestPedNearPlayer(1.2f, 0.8f, 0.0f);
-                    g_lastFollowTick = 0;
-                    Logger::Log("[VehicleRide] Player EXIT vehicle -> teleport companion + resume follow");
-                }
-
-                g_isRiding = false;
-                g_ridingVehicleHandle = 0;
+        // With this frame's scan in it: the jobs below read it
+        g_profiler.Begin(ProfZone::Snapshot);
+        PublishSnapshot(world, ctx);
+        g_profiler.End(ProfZone::Snapshot);
 
-                g_ridingSeat = -999;
-                g_lastRideAttemptTick = 0;
-                g_lastPlayerVehicleHandle = 0;
+        if (scanned)
+        {
+            if (protecting)
+            {
+                ThreatSyncJob job{ g_tickCount };
+                postScanJob = g_jobs.Create(RunThreatSync, job);
+                g_jobs.Run(postScanJob);
             }
 
-            // While player is in vehicle, try to ride (unless Stay)
-            if (playerInVehicle && g_state.spawned && !cmd.requestStay)
+            // Frenzy re-picks only when the world snapshot changes;
+            // hysteresis inside keeps the target stable
+            if (frenzying)
             {
-                int veh = EngineAdapter::GetPlayerVehicleHandle();
+                companionPos = EngineAdapter::GetTestPedPosition();
+                companionPosRead = true;
 
-                // Detect vehicle change
-                bool vehicleChanged = (veh != 0 && veh != g_lastPlayerVehicleHandle);
+                FrenzyEvalJob job{ companionPos, g_tickCount };
+                postScanJob = g_jobs.Create(RunFrenzyEval, job);
+                g_jobs.Run(postScanJob);
+            }
 
-                // Keep riding state honest:
-                // If we think we're riding, confirm the ped is actually in that same vehicle.
-                if (g_isRiding)
-                {
-                    int pedVeh = EngineAdapter::GetTestPedVehicleHandle();
-                    if (pedVeh != g_ridingVehicleHandle || pedVeh == 0)
-                    {
-                        Logger::Log("[VehicleRideV2] Desync detected. Clearing riding state. pedVeh=%d latchedVeh=%d",
-                            pedVeh, g_ridingVehicleHandle);
-                        g_isRiding = false;
-                        g_ridingVehicleHandle = 0;
-                        g_ridingSeat = -999;
-                    }
-                }
+            // From here to the Wait() the job runs on a worker:
+            // only work that doesn't need its result
+            NoteStayContacts(ctx.playerPos);
+
+            // Boarding intent is only polled with a car in reach
+            uint32_t nearVehicle;
+            g_taskFrame.vehicleNear = !ctx.playerInVehicle && g_nearbyGrid.QueryRadius(ctx.playerPos,
+                g_ride.config.intentMeters, EntityKind_Vehicle, &nearVehicle, 1) > 0;
+        }
 
-                // Attempt conditions:
-                // - If vehicle changed: try immediately
-                // - If not riding: try again on cooldown (seat might free up)
-                bool canAttempt = (g_tickCount - g_lastRideAttemptTick) >= RIDE_ATTEMPT_COOLDOWN_TICKS;
+        // The LOD sample's natives don't need the ranking: if one is
+        // due this frame, do them now, while the job runs. (Skipped
+        // in stay, where the LOD block doesn't sample.)
+        if (postScanJob != nullptr && !ctx.playerInVehicle && !g_state.stayEnabled
+            && g_lod.IsSampleDue(g_lodState, g_tickCount))
+        {
+            if (!companionPosRead)
+                companionPos = EngineAdapter::GetTestPedPosition();
+            companionOnScreen = EngineAdapter::IsTestPedOnScreen();
+            companionSampled = true;
+        }
 
-                if (veh != 0 && (vehicleChanged || (!g_isRiding && canAttempt)))
-                {
-                    g_lastRideAttemptTick = g_tickCount;
-                    g_lastPlayerVehicleHandle = veh;
+        // Join here: the protection sampling natives below need
+        // the ranking
+        if (postScanJob != nullptr)
+        {
+            ProfileScope wait(g_profiler, ProfZone::JobWait);
+            g_jobs.Wait(postScanJob);
+        }
 
-                    int chosenSeat = -999;
+        // ------------------------------------------------
+        // PROTECTION: sample a few candidates, rank threats
+        // ------------------------------------------------
+        // ThreatEngine caps how many peds are sampled per
+        // frame, so this costs the same with 5 or 500 peds.
+        // ------------------------------------------------
+        if (protecting)
+        {
+            ProfileScope zone(g_profiler, ProfZone::Threat);
 
-                    if (TryWarpCompanionIntoAnySeat(veh, chosenSeat))
-                    {
-                        g_isRiding = true;
-                        g_ridingVehicleHandle = veh;
-                        g_ridingSeat = chosenSeat;
+            int sampleHandles[THREAT_SAMPLE_MAX];
+            uint32_t n = g_threats.PickForSampling(sampleHandles, THREAT_SAMPLE_MAX);
 
-                        // While riding, suppress follow spam
-                        g_lastFollowTick = g_tickCount;
+            for (uint32_t i = 0; i < n; ++i)
+                g_threats.ApplySample(sampleHandles[i], EngineAdapter::QueryPedThreat(sampleHandles[i]), g_tickCount);
 
-                        Logger::Log("[VehicleRideV2] Warped companion into vehicle=%d seat=%d", veh, chosenSeat);
-                    }
-                    else
-                    {
-                        // No seat free: remain not riding; we will retry later (cooldown)
-                        g_isRiding = false;
-                        g_ridingVehicleHandle = 0;
-                        g_ridingSeat = -999;
+            ctx.topThreatHandle = g_threats.TopThreat();
+            ctx.topThreatScore = g_threats.TopScore();
+        }
+        else if (g_threats.Stats().candidates > 0)
+        {
+            g_threats.Reset();
+        }
 
-                        Logger::Log("[VehicleRideV2] No seat free in vehicle=%d (will retry on cooldown)", veh);
-                    }
-                }
-            }
+        if (frenzying)
+            ctx.frenzyTargetHandle = g_frenzy.CurrentTarget();
+        else if (g_frenzy.CurrentTarget() != 0)
+            g_frenzy.Reset();
 
-            if (!playerInVehicle)
-                g_lastPlayerVehicleHandle = 0;
+        g_profiler.End(ProfZone::Context);
+        g_profiler.Begin(ProfZone::CoreTick);
 
-            g_wasPlayerInVehicle = playerInVehicle;
-        }
+        CompanionCommands cmd{};
+        CompanionActivity activityBefore = g_state.activity;
+        g_core.Tick(ctx, g_state, cmd);
 
-        // Keep state mirror up to date (useful for future Core logic)
-        g_state.ridingVehicle = g_isRiding;
+        TickTrace::CaptureInputs(g_traceRec, world, ctx, g_state.mode);
+        TickTrace::CaptureCommands(g_traceRec, cmd, g_state.activity);
 
-        // ---------------------------
-        // STAY EXECUTION (V2 - Anchor)
-        // ---------------------------
-        if (cmd.requestStay && g_state.spawned)
+        if (g_state.activity != activityBefore)
         {
-            // Enter stay once
-            if (!g_isStayingActive)
-            {
-                // Capture anchor at the moment Stay begins
-                g_state.stayAnchor = EngineAdapter::GetTestPedPosition();
-                g_state.hasStayAnchor = true;
-                g_lastStaySnapTick = g_tickCount;
-
-                EngineAdapter::ClearTestPedTasks();
-                EngineAdapter::FreezeTestPed(true);
+            Logger::Log("[FSM] %s -> %s", CompanionFsm::Name(activityBefore), CompanionFsm::Name(g_state.activity));
+        }
+        ExecuteCompanionActions(cmd.actions);
 
-                g_isStayingActive = true;
+        g_profiler.End(ProfZone::CoreTick);
 
-                // Ensure follow restarts cleanly when we exit stay
-                g_lastFollowTick = 0;
+        // ------------------------------------------------
+        // LOD: decide how much attention the companion gets
+        // ------------------------------------------------
+        // Position/visibility are only read when the tier's
+        // sample interval is up. The teleport check below
+        // reuses this sample instead of reading again.
+        // ------------------------------------------------
+        g_profiler.Begin(ProfZone::Lod);
 
-                Logger::Log("[Main] Stay ACTIVE anchor=(%.2f,%.2f,%.2f)",
-                    g_state.stayAnchor.x, g_state.stayAnchor.y, g_state.stayAnchor.z);
-            }
+        bool lodSampledThisTick = false;
+        g_lod.BeginFrame();
 
-            // Optional: re-snap to anchor occasionally to counter tiny nudges/physics drift
-            if (g_state.hasStayAnchor && (g_tickCount - g_lastStaySnapTick) >= STAY_SNAP_TICKS)
+        if (g_state.spawned)
+        {
+            if (!cmd.requestStay && !ctx.playerInVehicle)
             {
-                Vec3 cur = EngineAdapter::GetTestPedPosition();
+                if (g_lod.IsSampleDue(g_lodState, g_tickCount))
+                {
+                    // Read while the post-scan job ran, if it did
+                    Vec3 pedPos = companionSampled ? companionPos : EngineAdapter::GetTestPedPosition();
+                    bool onScreen = companionSampled ? companionOnScreen : EngineAdapter::IsTestPedOnScreen();
+                    g_companionPos = pedPos;
+                    g_companionPosTick = g_tickCount;
 
-                // only correct if drift is noticeable (10cm)
-                const float DRIFT_SQ = 0.10f * 0.10f;
+                    LodTier before = g_lodState.tier;
+                    g_lod.Sample(g_lodState, Geometry::DistSq(ctx.playerPos, pedPos), onScreen, g_tickCount);
+                    lodSampledThisTick = true;
 
-                if (DistSq(cur, g_state.stayAnchor) > DRIFT_SQ)
+                    if (g_lodState.tier != before)
+                    {
+                        Logger::Log("[LOD] Tier %s -> %s (dist=%.1fm onScreen=%d)",
+                            LodTierName(before), LodTierName(g_lodState.tier),
+                            sqrtf(g_lodState.distSq), (int)onScreen);
+                    }
+                }
+                else
                 {
-                    EngineAdapter::SetTestPedPosition(g_state.stayAnchor);
+                    g_lod.NoteSkipped();
                 }
 
-                g_lastStaySnapTick = g_tickCount;
+                g_lod.ApplyToCommands(g_lodState, cmd);
             }
+
+            g_lod.Account(g_lodState);
         }
         else
         {
-            // Exit stay once
-            if (g_isStayingActive)
-            {
-                EngineAdapter::FreezeTestPed(false);
+            g_lodState = {};
+        }
 
-                g_isStayingActive = false;
-                g_state.hasStayAnchor = false;
-                g_lastStaySnapTick = 0;
+        g_profiler.End(ProfZone::Lod);
 
-                // Force follow to re-issue immediately after leaving stay
-                g_lastFollowTick = 0;
+        // ------------------------------------------------
+        // TASKS: riding, stay anchor, spawning, teleports
+        // ------------------------------------------------
+        // The multi-frame behaviours (CoTask.h). Boarding runs
+        // as a task for as long as the companion is out.
+        // ------------------------------------------------
+        {
+            ProfileScope zone(g_profiler, ProfZone::Tasks);
+
+            g_taskFrame.playerInVehicle = ctx.playerInVehicle;
+            g_taskFrame.playerVehicle = world.playerVehicle;
+            g_taskFrame.requestStay = cmd.requestStay;
+
+            if (g_state.spawned && !g_tasks.IsRunning(g_rideTask))
+                g_rideTask = g_tasks.Start(RideLoop());
 
-                Logger::Log("[Main] Stay OFF");
+            g_tasks.Tick();
+            PollFallbackSpawn();
+        }
+
+        bool isRiding = g_state.activity == CompanionActivity::Riding;
+
+        // ---------------------------
+        // PROTECTION EXECUTION
+        // ---------------------------
+        // Re-task only when the target changes — TASK_COMBAT_PED
+        // persists on its own.
+        g_profiler.Begin(ProfZone::Protection);
+
+        if (cmd.threatTarget != 0 && g_state.spawned && !isRiding)
+        {
+            if (cmd.threatTarget != g_engagedThreat)
+            {
+                EngineAdapter::TaskCombatPed(cmd.threatTarget);
+                if (g_state.mode == CompanionMode::Frenzy)
+                    Logger::Log("[Frenzy] Engage ped=%d cost=%.1f (was %d)", cmd.threatTarget, g_frenzy.CurrentCost(), g_engagedThreat);
+                else
+                    Logger::Log("[Protection] Engage ped=%d score=%.1f (was %d)", cmd.threatTarget, ctx.topThreatScore, g_engagedThreat);
+                g_engagedThreat = cmd.threatTarget;
             }
         }
+        else if (g_engagedThreat != 0)
+        {
+            Logger::Log("[Engage] Target cleared (ped=%d) -> resume follow", g_engagedThreat);
+            g_engagedThreat = 0;
+
+            // Follow replaces the combat task on its next issue
+            g_lastFollowTick = 0;
+        }
+
+        g_profiler.End(ProfZone::Protection);
 
         // ---------------------------
         // FOLLOW EXECUTION (command-driven)
         // ---------------------------
-        if (!cmd.requestStay && cmd.requestFollow && g_state.spawned && !g_isRiding && !ctx.playerInVehicle)
+        g_profiler.Begin(ProfZone::Follow);
+
+        if (!cmd.requestStay && cmd.requestFollow && g_state.spawned && !isRiding && !ctx.playerInVehicle)
         {
+            // Plan against the predicted player position (plain
+            // follow until the companion's position was sampled)
+            FollowPlan plan;
+            plan.speed = cmd.followSpeed;
+            if (g_companionPosTick != 0)
+            {
+                FollowMode before = g_followPlan.mode;
+                plan = g_leadFollow.Plan(g_followPlan, g_playerMotion, g_companionPos, cmd.followDistance, cmd.followSpeed);
+
+                if (plan.mode != before)
+                {
+                    Logger::Log("[Follow] %s -> %s (predicted gap=%.1fm lead=%.1fs/%.1fm speed=%.1f)",
+                        FollowModeName(before), FollowModeName(plan.mode), plan.predictedGap,
+                        plan.leadSeconds, plan.leadMeters, MotionPredictor::Speed(g_playerMotion));
+                }
+            }
+
+            // Keeping up: the persistent follow task is doing its job
             uint32_t refresh = (cmd.followRefreshTicks > 0) ? cmd.followRefreshTicks : FOLLOW_REFRESH_TICKS;
+            if (plan.keepingUp)
+                refresh *= KEEPING_UP_REFRESH_SCALE;
+
             bool timeRefresh = (g_tickCount - g_lastFollowTick) > refresh;
 
-            if (timeRefresh)
+            // Slots are re-assigned only when the layout changes;
+            // the player's facing is read just for that
+            FormationLayout layout;
+            layout.shape = (FormationShape)tuning.formationShape;
+            layout.count = 1;
+            layout.followDistance = cmd.followDistance;
+            layout.spacing = tuning.formationSpacing;
+
+            if (g_formation.NeedsAssign(layout))
+            {
+                Vec3 forward = EngineAdapter::GetPlayerForwardVector();
+                g_formation.Assign(layout, ctx.playerPos, forward.x, forward.y, &g_companionPos);
+                timeRefresh = true;
+
+                Logger::Log("[Formation] %s x%u spacing=%.1f -> slot (%.1f, %.1f)",
+                    FormationShapeName(layout.shape), layout.count, layout.spacing,
+                    g_formation.SlotFor(0).x, g_formation.SlotFor(0).y);
+            }
+
+            // Stalled far behind: walk the breadcrumbs (re-planned
+            // whenever LOD sampled the companion's position)
+            TrailPlan trail;
+            if (g_companionPosTick != 0)
+                trail = g_trailFollow.Plan(g_trailState, g_trail, g_companionPos, ctx.playerPos, lodSampledThisTick, g_tickCount);
+
+            if (trail.changed)
+            {
+                Logger::Log("[Trail] %s (gap=%.1fm crumbs=%u cursor=%u)",
+                    trail.onTrail ? "Stalled -> following breadcrumbs" : "Back to follow",
+                    sqrtf(g_lodState.distSq), g_trail.Count(), g_trailState.cursor.id);
+
+                if (!trail.onTrail)
+                    timeRefresh = true;
+            }
+
+            if (trail.onTrail)
             {
-                EngineAdapter::TaskFollowPlayer(cmd.followDistance, cmd.followSpeed);
+                if (trail.issueRoute)
+                {
+                    Vec3 route[EngineAdapter::kMaxRoutePoints];
+                    uint32_t n = g_trail.Route(g_trailState.cursor.id, route, EngineAdapter::kMaxRoutePoints);
+                    float speed = (plan.speed > g_leadFollow.config.catchUpSpeed) ? plan.speed : g_leadFollow.config.catchUpSpeed;
+
+                    EngineAdapter::TaskFollowRoute(route, n, speed);
+                    g_trailFollow.NoteIssued(g_trailState, n, g_tickCount);
+                    g_lastFollowTick = g_tickCount;
+                }
+            }
+            else if (timeRefresh || plan.reissue)
+            {
+                // Own slot, moved ahead by the lead while catching up
+                const FormationSlot& slot = g_formation.SlotFor(0);
+                EngineAdapter::TaskFollowPlayer(slot.x, slot.y + plan.leadMeters, g_formation.StoppingRange(), plan.speed);
+                LeadFollow::NoteIssued(g_followPlan, plan);
                 g_lastFollowTick = g_tickCount;
             }
         }
         else
         {
             g_lastFollowTick = 0;
+            g_followPlan = {};
+            g_trailState = {};
         }
 
         if (cmd.requestLog)
@@ -449,27 +1633,26 @@ void ScriptMain()
             );
         }
 
+        g_profiler.End(ProfZone::Follow);
+
         // ---------------------------
         // AUTO-TELEPORT IF TOO FAR
         // ---------------------------
+        // Runs at the LOD sample rate (every frame when Near,
+        // coarse when Far) using the distance sampled above.
+        g_profiler.Begin(ProfZone::Teleport);
+
         if (!cmd.requestStay && g_state.spawned && !ctx.playerInVehicle)
         {
-            Vec3 playerPos = EngineAdapter::GetPlayerPosition();
-            Vec3 pedPos = EngineAdapter::GetTestPedPosition();
-
-            bool tooFar = (DistSq(playerPos, pedPos) > TELEPORT_DIST_SQ);
-            bool canTeleport = (g_tickCount - g_lastTeleportTick) >= TELEPORT_COOLDOWN_TICKS;
+            bool tooFar = lodSampledThisTick && (g_lodState.distSq > tuning.teleportDistSq);
+            bool canTeleport = (g_tickCount - g_lastTeleportTick) >= tuning.teleportCooldownTicks;
 
             if (tooFar && canTeleport)
             {
-                EngineAdapter::TeleportTestPedNearPlayer(1.2f, 0.8f, 0.0f);
+                // The task re-issues follow and re-tiers once the
+                // companion is next to the player ("Option 2")
                 g_lastTeleportTick = g_tickCount;
-
-                // This is the whole point of "Option 2":
-                // force follow to re-issue immediately next tick.
-                g_lastFollowTick = 0;
-
-                Logger::Log("[Main] Auto-teleport: too far (>%.1fm).", TELEPORT_DIST_METERS);
+                StartTeleport("[Main] Auto-teleport (too far)", false);
             }
         }
         else
@@ -477,20 +1660,18 @@ void ScriptMain()
             g_lastTeleportTick = 0;
         }
 
+        g_profiler.End(ProfZone::Teleport);
+
         // F7 toggles spawn/despawn
-        if (EngineAdapter::IsKeyJustPressed(VK_F7))
+        g_profiler.Begin(ProfZone::SpawnDespawn);
+
+        if (KeyPressed(VK_F7, TraceKey_F7))
         {
+            g_deathRespawnTick = 0;            // F7 decides from here
+
             if (!g_state.spawned)
             {
-                if (EngineAdapter::SpawnTestPed())
-                {
-                    Logger::Log("[Main] F7 spawn OK");
-                    g_state.spawned = true;
-                }
-                else
-                {
-                    Logger::Log("[Main] F7 spawn FAILED");
-                }
+                StartSpawn("[Main] F7 spawn");
             }
             else
             {
@@ -498,28 +1679,14 @@ void ScriptMain()
                 Logger::Log("[Main] F7 despawn OK");
                 g_state.spawned = false;
 
-                // Clear vehicle/riding state on despawn
-                g_isRiding = false;
-                g_ridingVehicleHandle = 0;
-                g_wasPlayerInVehicle = false;
-
-                g_ridingSeat = -999;
-                g_lastRideAttemptTick = 0;
-                g_lastPlayerVehicleHandle = 0;
+                // Leaving Active clears vehicle/riding + stay state
+                DispatchCompanionEvent(CompanionEvent::Despawned);
             }
         }
 
         if (cmd.requestSpawn && !g_state.spawned)
         {
-            if (EngineAdapter::SpawnTestPed())
-            {
-                Logger::Log("[Core] SpawnTestPed OK");
-                g_state.spawned = true;
-            }
-            else
-            {
-                Logger::Log("[Core] SpawnTestPed FAILED");
-            }
+            StartSpawn("[Core] Spawn");
         }
 
         if (cmd.requestDespawn && g_state.spawned)
@@ -528,16 +1695,32 @@ void ScriptMain()
             Logger::Log("[Core] DespawnTestPed OK");
             g_state.spawned = false;
 
-            // Clear vehicle/riding state on despawn
-            g_isRiding = false;
-            g_ridingVehicleHandle = 0;
-            g_wasPlayerInVehicle = false;
+            // Leaving Active clears vehicle/riding + stay state
+            DispatchCompanionEvent(CompanionEvent::Despawned);
+        }
+
+        // Killed companion: a new one once the wait is over
+        if (g_deathRespawnTick != 0 && (int32_t)(g_tickCount - g_deathRespawnTick) >= 0
+            && ctx.playerExists && !ctx.playerDead && !isMissionActive)
+        {
+            g_deathRespawnTick = 0;
+            if (!g_state.spawned)
+                StartSpawn("[Main] Respawn after death");
+        }
 
-            g_ridingSeat = -999;
-            g_lastRideAttemptTick = 0;
-            g_lastPlayerVehicleHandle = 0;
+        // Companion from the last session: back once there's a
+        // player to put it next to and no mission
+        if (g_restoreSpawn && ctx.playerExists && !ctx.playerDead && !isMissionActive)
+        {
+            g_restoreSpawn = false;
+            if (!g_state.spawned)
+                StartSpawn("[Save] Restore spawn");
         }
 
+        OfferSave();
+
+        g_profiler.End(ProfZone::SpawnDespawn);
+
         // ------------------------------------------------
         // ON-SCREEN DEBUG TEXT
         // ------------------------------------------------
@@ -545,13 +1728,45 @@ void ScriptMain()
         // running without needing to check the log file.
         // This uses GTA's native text drawing system.
         // ------------------------------------------------
+        g_profiler.Begin(ProfZone::DebugDraw);
+
         EngineAdapter::DrawDebugText("CompanionMod v0.1 — Skeleton Active", 0.01f, 0.01f);
 
+        if (g_state.spawned)
+        {
+            const LodStats& lod = g_lod.Stats();
+            char lodLine[128];
+            snprintf(lodLine, sizeof(lodLine), "LOD %s  near=%u mid=%u far=%u  nearby=%u",
+                LodTierName(g_lodState.tier),
+                lod.tierCounts[(int)LodTier::Near],
+                lod.tierCounts[(int)LodTier::Mid],
+                lod.tierCounts[(int)LodTier::Far],
+                g_nearbyGrid.Count());
+            EngineAdapter::DrawDebugText(lodLine, 0.01f, 0.04f);
+        }
+
+        // Last frame's native cost + the rolling percentiles
+        {
+            const NativeFrameCounts& last = g_nativeBudget.LastFrame();
+            NativeBudgetReport budget = g_nativeBudget.Report();
+            char nativeLine[160];
+            snprintf(nativeLine, sizeof(nativeLine), "Natives %u (q%u m%u t%u d%u)  p50 %u p95 %u p99 %u  over %u/%u",
+                last.Total(),
+                last.Get(NativeCategory::Query), last.Get(NativeCategory::Mutation),
+                last.Get(NativeCategory::Task), last.Get(NativeCategory::Draw),
+                budget.p50, budget.p95, budget.p99, budget.overBudget, budget.frames);
+            EngineAdapter::DrawDebugText(nativeLine, 0.01f, 0.07f);
+        }
+
+        g_profiler.End(ProfZone::DebugDraw);
+
         // ------------------------------------------------
         // MANUAL RECALL / TELEPORT (F5)
         // - If in Stay: switch to Follow automatically
         // ------------------------------------------------
-        if (!isMissionActive && EngineAdapter::IsKeyJustPressed(VK_F5))
+        g_profiler.Begin(ProfZone::Input);
+
+        if (!isMissionActive && KeyPressed(VK_F5, TraceKey_F5))
         {
             if (!g_state.spawned)
             {
@@ -560,36 +1775,27 @@ void ScriptMain()
             else
             {
                 // If staying, force exit Stay -> Follow
-                if (g_stayToggle || g_isStayingActive)
+                if (g_stayToggle || g_state.activity == CompanionActivity::Staying)
                 {
                     g_stayToggle = false;          // input toggle off (Core will emit follow)
-                    g_state.stayEnabled = false;   // safety: ensure Core sees it immediately this tick
-
-                    if (g_isStayingActive)
-                    {
-                        EngineAdapter::FreezeTestPed(false);
-                        g_isStayingActive = false;
-                    }
+                    g_state.stayEnabled = false;
 
-                    // Optional: clear anchor since we're leaving stay
-                    g_state.hasStayAnchor = false;
+                    // Unfreeze + drop anchor now (Stay exit action), not next tick
+                    DispatchCompanionEvent(CompanionEvent::StayOff);
 
                     Logger::Log("[Recall] Exiting Stay -> Follow");
                 }
 
-                // Teleport near player
-                EngineAdapter::TeleportTestPedNearPlayer(1.2f, 0.8f, 0.0f);
-
-                // Force follow to re-issue immediately
-                g_lastFollowTick = 0;
+                // Teleport near player (re-issues follow when it lands)
+                StartTeleport("[Recall] Teleport companion to player", true);
 
                 // Prevent auto-teleport from immediately re-triggering cooldown logic
                 g_lastTeleportTick = g_tickCount;
-
-                Logger::Log("[Recall] Teleported companion to player.");
             }
         }
 
+        g_profiler.End(ProfZone::Input);
+
         // ------------------------------------------------
         // PERIODIC HEARTBEAT LOG
         // ------------------------------------------------
@@ -600,9 +1806,182 @@ void ScriptMain()
         frameCount++;
         if (frameCount % 600 == 0)
         {
+            ProfileScope zone(g_profiler, ProfZone::Heartbeat);
+
             Logger::Log("Heartbeat — frame %d", frameCount);
+
+            const LodStats& lod = g_lod.Stats();
+            Logger::Log("[LOD] near=%u mid=%u far=%u samples=%u skipped=%u tierChanges=%u",
+                lod.tierCounts[(int)LodTier::Near],
+                lod.tierCounts[(int)LodTier::Mid],
+                lod.tierCounts[(int)LodTier::Far],
+                lod.samplesTaken, lod.samplesSkipped, lod.tierChanges);
+            g_lod.ResetTotals();
+
+            const ThreatStats& threats = g_threats.Stats();
+            Logger::Log("[Threat] candidates=%u top=%u best=%d score=%.1f dropped=%u",
+                threats.candidates, threats.topCount,
+                g_threats.TopThreat(), g_threats.TopScore(), threats.droppedCandidates);
+
+            const FrenzyStats& frenzy = g_frenzy.Stats();
+            Logger::Log("[Frenzy] gathered=%u filtered=%u target=%d switches=%u",
+                frenzy.gathered, frenzy.filtered, g_frenzy.CurrentTarget(), frenzy.switches);
+
+            const HitchStats& hitches = g_hitches.Stats();
+            Logger::Log("[Hitch] hitches=%u dumped=%u suppressed=%u pauses=%u worst=%.1fms",
+                hitches.hitches, hitches.dumped, hitches.suppressed, hitches.pauses, hitches.worstNs / 1000000.0f);
+
+            if (AllocTracker::kEnabled)
+                Logger::Log("[Alloc] tick allocs last=%llu total=%llu violations=%u arena high=%u/%u failed=%u",
+                    (unsigned long long)g_tickAllocs.Last(), (unsigned long long)g_tickAllocs.Total(),
+                    g_tickAllocs.Violations(), (unsigned)g_frameArena.HighWater(),
+                    (unsigned)g_frameArena.Capacity(), g_frameArena.Failures());
+            else
+                Logger::Log("[Alloc] arena high=%u/%u failed=%u",
+                    (unsigned)g_frameArena.HighWater(), (unsigned)g_frameArena.Capacity(), g_frameArena.Failures());
+
+            JobStats jobs = g_jobs.Stats();
+            Logger::Log("[Jobs] workers=%u executed=%llu stolen=%llu inlined=%llu onScriptThread=%llu",
+                g_jobs.Workers(), (unsigned long long)jobs.executed,
+                (unsigned long long)jobs.stolen, (unsigned long long)jobs.inlined,
+                (unsigned long long)jobs.onCaller);
+
+            const LeadFollowStats& follow = g_leadFollow.Stats();
+            Logger::Log("[Follow] mode=%s catchUps=%u catchUpFrames=%u keepingUp=%u/%u playerSpeed=%.1f filterResets=%u",
+                FollowModeName(g_followPlan.mode), follow.catchUps, follow.catchUpFrames,
+                follow.keepingUpFrames, follow.plannedFrames,
+                MotionPredictor::Speed(g_playerMotion), g_motion.Stats().resets);
+            g_leadFollow.ResetTotals();
+            g_motion.ResetTotals();
+
+            const BreadcrumbStats& trail = g_trail.Stats();
+            const TrailFollowStats& trailFollow = g_trailFollow.Stats();
+            Logger::Log("[Trail] crumbs=%u/%u stored=%u merged=%u breaks=%u onTrail=%d stalls=%u routes=%u backUps=%u fullSearches=%u",
+                g_trail.Count(), BreadcrumbTrail::kCapacity, trail.stored, trail.merged, trail.breaks,
+                (int)g_trailState.onTrail, trailFollow.engaged, trailFollow.routes, trailFollow.backUps, trail.fullSearches);
+
+            const VehicleRideStats& ride = g_ride.Stats();
+            Logger::Log("[Ride] phase=%s approaches=%u cancelled=%u boards=%u predicted=%u failed=%u evictions=%u seatsFreed=%u retries=%u polls: intent=%u confirm=%u occupancy=%u",
+                RidePhaseName(g_ride.Phase()), ride.approaches, ride.cancelled, ride.boards, ride.predicted, ride.failedBoards,
+                ride.evictions, ride.seatsFreed, ride.retries, ride.intentPolls, ride.confirms, ride.occupancyPolls);
+            g_ride.ResetTotals();
+
+            const StayDriftStats& stay = g_stayDrift.Stats();
+            Logger::Log("[Stay] checks=%u (%.1f/min, fixed %.1f/min) interval=%u probes=%u corrections=%u snaps=%u moves=%u busy=%u disturbed: contact=%u explosion=%u",
+                stay.checks, g_stayDrift.ChecksPerMinute(), g_stayDrift.FixedChecksPerMinute(),
+                g_stayDrift.IntervalTicks(), stay.probes, stay.corrections, stay.snaps, stay.moves, stay.busyScans,
+                stay.disturbances[(int)StayDisturbance::Contact], stay.disturbances[(int)StayDisturbance::Explosion]);
+            g_stayDrift.ResetTotals();
+
+            Logger::Log("[Save] writes=%u failed=%u", g_saver.Writes(), g_saver.Failures());
+
+            const TeleportSearchStats& tp = g_teleportSearch.Stats();
+            Logger::Log("[Teleport] searches=%u found=%u cached=%u failed=%u frames=%u ground=%u probes=%u cache=%u/%u rejected: noGround=%u water=%u height=%u steep=%u blocked=%u probeFailed=%u",
+                tp.searches, tp.found, tp.cacheHits, tp.failed, tp.frames, tp.groundChecks, tp.probesStarted,
+                g_teleportSearch.CacheCount(), TeleportSearch::kCacheSlots,
+                tp.rejected[(int)TeleportReject::NoGround], tp.rejected[(int)TeleportReject::Water],
+                tp.rejected[(int)TeleportReject::Height], tp.rejected[(int)TeleportReject::Steep],
+                tp.rejected[(int)TeleportReject::Blocked], tp.rejected[(int)TeleportReject::ProbeFailed]);
+
+            CoSchedulerStats tasks = g_tasks.Stats();
+            Logger::Log("[Tasks] running=%u peak=%u started=%u finished=%u cancelled=%u startFailed=%u pool=%u/%u largestFrame=%uB",
+                tasks.running, tasks.peakRunning, tasks.started, tasks.finished, tasks.cancelled,
+                tasks.startFailures, tasks.poolBlocksUsed, CoScheduler::kPoolBlocks, tasks.largestFrame);
+
+            WorldSnapshotStats snaps = g_snapshots.Stats();
+            Logger::Log("[Snapshot] published=%llu reads=%llu retries=%llu failed=%llu nearby=%u",
+                (unsigned long long)snaps.published, (unsigned long long)snaps.reads,
+                (unsigned long long)snaps.retries, (unsigned long long)snaps.failures,
+                g_snapshots.Latest().nearbyCount);
+
+            const EventBusStats& events = g_events.Stats();
+            Logger::Log("[Events] published=%u delivered=%u dropped=%u state=%s",
+                events.published, events.delivered, events.dropped, CompanionFsm::Name(g_state.activity));
+
+            NativeBudgetReport budget = g_nativeBudget.Report();
+            Logger::Log("[Natives] p50=%u p95=%u p99=%u max=%u over=%u/%u (budget %u, %u total) avg q=%.1f m=%.2f t=%.2f d=%.1f",
+                budget.p50, budget.p95, budget.p99, budget.max, budget.overBudget, budget.frames,
+                g_nativeBudget.Budget(), g_nativeBudget.TotalOverBudget(),
+                budget.avgPerCategory[(int)NativeCategory::Query],
+                budget.avgPerCategory[(int)NativeCategory::Mutation],
+                budget.avgPerCategory[(int)NativeCategory::Task],
+                budget.avgPerCategory[(int)NativeCategory::Draw]);
+
+            // Whole frame, then the three most expensive phases (by p99)
+            ProfZoneStats prof[(int)ProfZone::Count];
+            g_profiler.ComputeStats(prof);
+
+            const ProfZoneStats& frame = prof[(int)ProfZone::Frame];
+            Logger::Log("[Prof] frame min=%.1fus avg=%.1fus p99=%.1fus max=%.1fus (%u frames, mismatches=%u)",
+                frame.minNs / 1000.0f, frame.avgNs / 1000.0f, frame.p99Ns / 1000.0f, frame.maxNs / 1000.0f,
+                frame.frames, g_profiler.Mismatches());
+
+            bool shown[(int)ProfZone::Count] = {};
+            shown[(int)ProfZone::Frame] = true;
+            for (int k = 0; k < 3; ++k)
+            {
+                int worst = -1;
+                for (int z = 0; z < (int)ProfZone::Count; ++z)
+                {
+                    if (!shown[z] && prof[z].frames > 0 && (worst < 0 || prof[z].p99Ns > prof[worst].p99Ns))
+                        worst = z;
+                }
+                if (worst < 0)
+                    break;
+
+                shown[worst] = true;
+                Logger::Log("[Prof]   %-12s min=%.1fus avg=%.1fus p99=%.1fus max=%.1fus",
+                    ProfZoneName((ProfZone)worst),
+                    prof[worst].minNs / 1000.0f, prof[worst].avgNs / 1000.0f,
+                    prof[worst].p99Ns / 1000.0f, prof[worst].maxNs / 1000.0f);
+            }
+        }
+
+        g_profiler.Begin(ProfZone::Trace);
+
+        if (g_recorder.IsOpen())
+        {
+            g_traceRec.activityEnd = (uint8_t)g_state.activity;
+            g_recorder.Write(g_traceRec);
+        }
+
+        g_profiler.End(ProfZone::Trace);
+
+        // Close this frame's native count (everything above, incl. drawing)
+        g_nativeBudget.EndFrame(EngineAdapter::TakeFrameNativeCounts());
+
+        g_profiler.EndFrame();
+
+        // Snapshot for the hitch detector (copied into its ring)
+        {
+            HitchSnapshot snap;
+            snap.tick = g_tickCount;
+            if (const ProfileFrame* pf = g_profiler.LastFrame())
+            {
+                snap.profileFrame = pf->index;
+                snap.bodyNs = pf->durNs;
+            }
+            snap.natives = g_nativeBudget.LastFrame();
+            snap.activity = (uint8_t)g_state.activity;
+            snap.mode = (uint8_t)g_state.mode;
+            snap.lodTier = (uint8_t)g_lodState.tier;
+            snap.companionDist = sqrtf(g_lodState.distSq);
+
+            uint8_t flags = 0;
+            if (g_state.spawned)                       flags |= HitchFlag_Spawned;
+            if (isMissionActive)                       flags |= HitchFlag_MissionActive;
+            if (ctx.playerInVehicle)                   flags |= HitchFlag_InVehicle;
+            if (g_stayToggle)                          flags |= HitchFlag_StayEnabled;
+            if (g_lastNearbyScanTick == g_tickCount)   flags |= HitchFlag_NearbyScan;
+            snap.flags = flags;
+
+            g_hitches.Record(snap);
         }
 
+        // Nothing above may allocate. The first tick is exempt: it
+        // runs the function-local statics' first-use initialisation.
+        g_tickAllocs.End(g_tickCount > 1);
+
         // ------------------------------------------------
         // YIELD TO GAME ENGINE
         // ------------------------------------------------
@@ -617,6 +1996,22 @@ void ScriptMain()
         // If you forget WAIT(0), the game freezes forever.
         // ------------------------------------------------
         WAIT(0);
+
+        // The frame that just ended ran long: write out its context
+        if (g_hitches.FrameBoundary(ProfileNowNs()))
+        {
+            const HitchSnapshot* hitch = g_hitches.LastFrame();
+            Logger::Log("[Hitch] tick=%u frame=%.1fms (our loop %.2fms) -> %s",
+                hitch->tick, hitch->wallNs / 1000000.0f, hitch->bodyNs / 1000000.0f, HITCH_FILE);
+
+            g_hitches.Dump(HITCH_FILE, g_profiler);
+
+            if (FILE* f = fopen(HITCH_TRACE_FILE, "w"))
+            {
+                g_profiler.WriteChromeTrace(f, g_hitches.Config().dumpFrames);
+                fclose(f);
+            }
+        }
     }
 }
 
@@ -631,8 +2026,9 @@ void ScriptMain()
 //     process. We store our module handle and tell ScriptHookV
 //     to call ScriptMain() when the game is ready.
 //
-//  2. DLL_PROCESS_DETACH: Our DLL is being unloaded (game
-//     closing). We clean up our logger.
+//  2. DLL_PROCESS_DETACH: Our DLL is being unloaded, either by
+//     FreeLibrary (lpReserved == NULL) or because the game is
+//     closing. We let go of our threads and clean up our logger.
 //
 //  scriptRegister() is a ScriptHookV function that says:
 //  "Hey SHV, here's my script entry point. Call it when ready."
@@ -647,6 +2043,28 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD reason, LPVOID lpReserved)
         break;
 
     case DLL_PROCESS_DETACH:
+        // Never join here: we hold the loader lock and a thread
+        // needs it to exit. On FreeLibrary our threads are still
+        // running, so ask them to stop (the saver writes what's
+        // pending on its way out) and wait, bounded, for each to
+        // leave its loop. At process exit Windows has already
+        // ended them, maybe holding a lock, so touch nothing.
+        if (lpReserved == NULL)
+        {
+            g_tuning.RequestStop();
+            g_saver.RequestStop();
+            g_jobs.RequestStop();
+            g_tuning.WaitStopped(THREAD_STOP_WAIT_MS);
+            if (!g_saver.WaitStopped(THREAD_STOP_WAIT_MS))
+                Logger::Log("[Save] Saver still writing at unload; left behind");
+            g_jobs.WaitStopped(THREAD_STOP_WAIT_MS);
+        }
+        g_tuning.Detach();
+        g_saver.Detach();
+        g_jobs.Detach();
+
+        g_recorder.Close();
+        g_profiler.StopCapture();
         Logger::Shutdown();
         scriptUnregister(hModule);
         break;
@@ -0,0 +1,2115 @@
+// ============================================================
+//  CompanionBench.cpp — Headless tick-throughput benchmarks
+// ============================================================
+//
+//  PURPOSE:
+//  Measures what one tick of the companion logic costs, without
+//  the game: a synthetic world (player path, vehicles, missions,
+//  crowds) drives the same engine-agnostic code main.cpp uses —
+//  EdgeSampler -> EventBus -> CompanionCore -> CompanionLod, the
+//  spatial grid and the threat engine — and a SimHost that
+//  mirrors main.cpp's scheduling rules (follow refresh, stay
+//  snap, auto-teleport, ride attempts, debug text).
+//
+//  REPORTED PER SCENARIO:
+//    ns/tick        wall time of the whole simulated tick
+//                   (decision logic + the trivial world step)
+//    allocs/tick    global operator new calls inside the loop
+//                   (AllocTracker.h); must be 0 — any allocation
+//                   is reported and the bench exits non-zero
+//    natives/tick   native-call EQUIVALENTS: every adapter call
+//                   the host makes is charged the number of
+//                   invoke<>() calls its EngineAdapter.cpp
+//                   implementation does (kCost table below),
+//                   split into query / mutation / task / draw
+//
+//  OUTPUT:
+//  One JSON object per scenario on stdout (JSON Lines), a
+//  readable table on stderr. Track regressions by diffing the
+//  JSON between commits.
+//
+//  BUILD (from the repo root, one command line):
+//      g++ -std=c++17 -O2 -DCOMPANION_TRACK_ALLOCS -ICompanionMod
+//          Tools/Bench/CompanionBench.cpp CompanionMod/AllocTracker.cpp
+//          CompanionMod/BreadcrumbTrail.cpp CompanionMod/EventBus.cpp
+//          CompanionMod/Formation.cpp CompanionMod/GeometryKernels.cpp
+//          CompanionMod/SpatialGrid.cpp CompanionMod/StayDrift.cpp
+//          CompanionMod/TeleportSearch.cpp
+//          CompanionMod/ThreatEngine.cpp CompanionMod/VehicleRide.cpp
+//          CompanionMod/JobSystem.cpp -pthread -o companion_bench
+//
+//  USAGE:
+//      companion_bench [ticksPerScenario]     (default 216000 = 1h @60fps)
+// ============================================================
+
+#include "AllocTracker.h"
+#include "BreadcrumbTrail.h"
+#include "CompanionCore.h"
+#include "CompanionLod.h"
+#include "EventBus.h"
+#include "Formation.h"
+#include "GeometryKernels.h"
+#include "JobSystem.h"
+#include "MotionPredictor.h"
+#include "SpatialGrid.h"
+#include "StayDrift.h"
+#include "TeleportSearch.h"
+#include "ThreatEngine.h"
+#include "TuningConfig.h"
+#include "VehicleRide.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// --------------------------------------------------------
+//  Allocation counting (AllocTracker, around each loop)
+// --------------------------------------------------------
+static_assert(AllocTracker::kEnabled, "build the bench with -DCOMPANION_TRACK_ALLOCS");
+
+static uint32_t g_allocViolations = 0;
+
+static void OnLoopAllocation(const char* scope, uint64_t allocations, uint64_t bytes, void*)
+{
+    g_allocViolations++;
+    fprintf(stderr, "ALLOCATION in %s loop: %llu allocations, %llu bytes\n",
+        scope, (unsigned long long)allocations, (unsigned long long)bytes);
+}
+
+// --------------------------------------------------------
+//  Native-call equivalents
+// --------------------------------------------------------
+struct NativeCost
+{
+    uint16_t query, mutation, task, draw;
+};
+
+struct NativeCounts
+{
+    uint64_t query = 0, mutation = 0, task = 0, draw = 0;
+
+    void Add(const NativeCost& c, uint32_t times = 1)
+    {
+        query += (uint64_t)c.query * times;
+        mutation += (uint64_t)c.mutation * times;
+        task += (uint64_t)c.task * times;
+        draw += (uint64_t)c.draw * times;
+    }
+
+    uint64_t Total() const { return query + mutation + task + draw; }
+};
+
+// invoke<>() counts per EngineAdapter function (see EngineAdapter.cpp)
+namespace kCost
+{
+    constexpr NativeCost SampleWorldBase     { 6, 0, 0, 0 };  // + PlayerVehicle, + CompanionDead
+    constexpr NativeCost SampleWorldExtra    { 1, 0, 0, 0 };
+    constexpr NativeCost GetPlayerPosition   { 2, 0, 0, 0 };
+    constexpr NativeCost GetPlayerForward    { 2, 0, 0, 0 };
+    constexpr NativeCost GetTestPedPosition  { 2, 0, 0, 0 };
+    constexpr NativeCost IsTestPedOnScreen   { 2, 0, 0, 0 };
+    constexpr NativeCost SetTestPedPosition  { 1, 2, 0, 0 };
+    constexpr NativeCost TaskFollowPlayer    { 2, 1, 1, 0 };
+    constexpr NativeCost TaskFollowRoute     { 1, 1, 2, 0 };  // + RoutePoint per point
+    constexpr NativeCost RoutePoint          { 0, 0, 1, 0 };
+    constexpr NativeCost TeleportNearPlayer  { 4, 3, 1, 0 };
+    constexpr NativeCost TeleportTestPedTo   { 1, 3, 1, 0 };
+    constexpr NativeCost SampleGround        { 2, 0, 0, 0 };
+    constexpr NativeCost StartProbe          { 2, 0, 0, 0 };
+    constexpr NativeCost PollProbe           { 1, 0, 0, 0 };
+    constexpr NativeCost IsExplosionNear     { 1, 0, 0, 0 };
+    constexpr NativeCost FreezeTestPed       { 1, 1, 0, 0 };
+    constexpr NativeCost ClearTestPedTasks   { 1, 0, 1, 0 };
+    constexpr NativeCost SpawnTestPed        { 5, 9, 0, 0 };
+    constexpr NativeCost DespawnTestPed      { 2, 2, 0, 0 };
+    constexpr NativeCost GetTestPedVehicle   { 2, 0, 0, 0 };
+    constexpr NativeCost IsVehicleSeatFree   { 1, 0, 0, 0 };
+    constexpr NativeCost PutPedIntoVehicle   { 1, 1, 0, 0 };
+    constexpr NativeCost GetVehicleEntering  { 2, 0, 0, 0 };
+    constexpr NativeCost GetPassengerCount   { 1, 0, 0, 0 };
+    constexpr NativeCost DrawDebugText       { 0, 0, 0, 6 };
+    constexpr NativeCost NearbyPerEntity     { 1, 0, 0, 0 };  // GET_ENTITY_COORDS
+    constexpr NativeCost QueryPedThreat      { 6, 0, 0, 0 };
+    constexpr NativeCost TaskCombatPed       { 1, 0, 1, 0 };
+}
+
+// --------------------------------------------------------
+//  Tiny deterministic RNG (no <random> allocations / state)
+// --------------------------------------------------------
+struct Rng
+{
+    uint32_t s;
+    explicit Rng(uint32_t seed) : s(seed ? seed : 1) {}
+    uint32_t Next() { s ^= s << 13; s ^= s >> 17; s ^= s << 5; return s; }
+    float Unit() { return (Next() & 0xFFFFFF) / 16777216.0f; }
+    bool OneIn(uint32_t n) { return (Next() % n) == 0; }
+};
+
+// --------------------------------------------------------
+//  Heightfield (teleport search + building scenarios)
+// --------------------------------------------------------
+// Rolling hills with steeper bumps, a 6 m cliff every 45 m
+// (along x), a lake every 120 m and a 12 x 12 m building in
+// every 40 m cell. For walking around, the buildings are hollow
+// with a door in the middle of each wall.
+namespace Terrain
+{
+    constexpr float kCliffPeriod = 45.0f;
+    constexpr float kCliffHeight = 6.0f;
+    constexpr float kLakePeriod = 120.0f;
+    constexpr float kLakeRadius = 15.0f;
+    constexpr float kLakeBedZ = -3.0f;          // water surface at 0
+    constexpr float kCell = 40.0f;
+    constexpr float kBuildingMin = 5.0f;        // within the cell
+    constexpr float kBuildingMax = 17.0f;
+    constexpr float kBuildingHeight = 10.0f;
+
+    static float Wrap(float v, float period)
+    {
+        float m = fmodf(v, period);
+        return (m < 0.0f) ? m + period : m;
+    }
+
+    static bool InLake(float x, float y)
+    {
+        float dx = Wrap(x, kLakePeriod) - kLakePeriod * 0.5f;
+        float dy = Wrap(y, kLakePeriod) - kLakePeriod * 0.5f;
+        return dx * dx + dy * dy < kLakeRadius * kLakeRadius;
+    }
+
+    // Footprint grown by `pad` (capsule radius)
+    static bool InBuilding(float x, float y, float pad = 0.0f)
+    {
+        float lx = Wrap(x, kCell);
+        float ly = Wrap(y, kCell);
+        return lx > kBuildingMin - pad && lx < kBuildingMax + pad
+            && ly > kBuildingMin - pad && ly < kBuildingMax + pad && !InLake(x, y);
+    }
+
+    constexpr float kWall = 0.4f;
+    constexpr float kDoorHalf = 1.5f;
+
+    static bool InWall(float l, float pad)
+    {
+        return (l > kBuildingMin - pad && l < kBuildingMin + kWall + pad)
+            || (l > kBuildingMax - kWall - pad && l < kBuildingMax + pad);
+    }
+
+    // Walls of the hollow buildings, grown by `pad` (flat ground only)
+    static bool InWalls(float x, float y, float pad = 0.0f)
+    {
+        if (!InBuilding(x, y, pad))
+            return false;
+
+        const float mid = (kBuildingMin + kBuildingMax) * 0.5f;
+        const float door = kDoorHalf - pad;
+        float lx = Wrap(x, kCell);
+        float ly = Wrap(y, kCell);
+        return (InWall(lx, pad) && fabsf(ly - mid) > door)
+            || (InWall(ly, pad) && fabsf(lx - mid) > door);
+    }
+
+    static float Ground(float x, float y)
+    {
+        if (InLake(x, y))
+            return kLakeBedZ;
+
+        float h = 1.5f * sinf(x * 0.07f) * cosf(y * 0.05f) + 2.0f * sinf(x * 0.35f) * sinf(y * 0.3f);
+        if (Wrap(x, 2.0f * kCliffPeriod) >= kCliffPeriod)
+            h += kCliffHeight;
+        return h;
+    }
+
+    // Capsule from -> to hits a building or the ground (sampled every 10 cm)
+    static bool SegmentBlocked(const Vec3& from, const Vec3& to, float radius)
+    {
+        float dx = to.x - from.x, dy = to.y - from.y, dz = to.z - from.z;
+        uint32_t steps = (uint32_t)(sqrtf(dx * dx + dy * dy) / 0.1f) + 1;
+        for (uint32_t i = 0; i <= steps; ++i)
+        {
+            float t = (float)i / (float)steps;
+            float x = from.x + dx * t, y = from.y + dy * t, z = from.z + dz * t;
+            if (InBuilding(x, y, radius) && z < Ground(x, y) + kBuildingHeight)
+                return true;
+            if (z - radius < Ground(x, y))
+                return true;
+        }
+        return false;
+    }
+}
+
+// --------------------------------------------------------
+//  Synthetic world
+// --------------------------------------------------------
+constexpr uint32_t kMaxRoutePoints = 8;            // EngineAdapter::kMaxRoutePoints
+
+struct SimWorld
+{
+    Vec3 player{};
+    float heading = 0.0f;
+    float playerSpeed = 1.5f;          // m/s
+
+    bool mission = false;
+    bool inVehicle = false;
+    int vehicle = 0;
+    uint8_t seatsTaken = 0;            // passenger seats 0..2 of the player's vehicle (bit = seat, companion included)
+    int entering = 0;                  // vehicle the player is getting into (enter task), 0 = none
+    uint32_t enterTicksLeft = 0;       // ...sitting down in this many ticks
+    bool vehicleNear = false;          // a vehicle within reach of the player (nearby scan)
+
+    bool companionExists = false;
+    Vec3 companion{};
+    bool companionFollowing = false;   // has an active follow task
+    float companionSpeed = 3.0f;
+    float companionOffsetX = 0.5f;     // follow task's offset, player frame (+x right, +y ahead)
+    float companionOffsetY = -2.0f;
+    float companionStop = 2.0f;        // ...and its stopping range
+    bool companionFrozen = false;
+    int companionVehicle = 0;
+
+    Vec3 companionRoute[kMaxRoutePoints];   // point route (breadcrumbs), when set
+    uint32_t routeCount = 0;
+    uint32_t routeNext = 0;
+    bool companionOnRoute = false;
+
+    bool buildings = false;            // Terrain buildings block the player and companion
+
+    // Stay disturbances (set by scenarios)
+    uint32_t explosionTicks = 0;       // an explosion is going off for this many more ticks...
+    Vec3 explosionAt{};                // ...here
+    bool passerActive = false;         // a ped walking past...
+    Vec3 passer{};                     // ...here
+};
+
+// --------------------------------------------------------
+//  SimHost — main.cpp's per-tick flow, natives replaced by
+//  SimWorld reads/writes + cost accounting
+// --------------------------------------------------------
+struct SimHost
+{
+    const CompanionTuning tuning{};     // shipped defaults (CompanionMod.ini absent)
+
+    SimWorld& w;
+    NativeCounts& natives;
+
+    CompanionCore core;
+    CompanionState state;
+    EventBus bus;
+    EdgeSampler edges;
+    CompanionLod lod;
+    LodState lodState;
+    MotionPredictor motion;
+    MotionState playerMotion;
+    LeadFollow leadFollow;
+    LeadFollowState followPlan;
+    FormationSolver formation;
+    BreadcrumbTrail trail;
+    TrailFollow trailFollow;
+    TrailFollowState trailState;
+    bool useTrail = true;
+    Vec3 companionPos{};               // last LOD sample
+
+    bool stayToggle = false;
+    uint32_t tick = 0;
+    uint32_t lastFollowTick = 0;
+    uint32_t lastTeleportTick = 0;
+    uint32_t lastStaySnapTick = 0;
+    StayDrift stayDrift;
+    bool adaptiveStay = true;          // false: the old fixed-interval snap
+
+    // Stay quality, both ways
+    uint32_t stayReads = 0;            // natives spent looking while staying (reads + probes)
+    uint32_t stayTicks = 0;
+    uint32_t stayOffTicks = 0;         // ticks spent more than driftMeters off the anchor
+    float stayLargestMove = 0.0f;      // biggest single correction (a pop)
+    uint32_t lastRideAttemptTick = 0;
+    int ridingVehicle = 0;
+    VehicleRide ride;
+    bool predictiveRide = true;        // false: the old warp-and-retry-on-cooldown loop
+    bool boardNow = false;             // old loop: entered / switched, skip the cooldown
+    bool rideVehicleNear = false;      // as of the last nearby scan
+    uint32_t rideSleepUntil = 0;       // RideLoop's Frames(idle)
+    int lastPlayerVehicle = 0;         // vehicle events wake the ride task
+
+    // Ride quality, both ways
+    uint64_t rideNatives = 0;          // native equivalents spent by the ride code
+    uint32_t rideSits = 0;             // player sat in a car (entered / switched)
+    uint32_t rideSameFrame = 0;        // ...and the companion was put in that same tick
+    uint32_t rideWaitTicks = 0;        // player in a car, companion (free to ride) not in it
+    uint32_t sitTick = 0;
+    uint32_t teleports = 0;
+
+    // Teleports search for a spot over a few ticks (main.cpp
+    // TeleportCompanion); the host world is flat open ground
+    TeleportSearch teleportSearch;
+    TeleportProbes flatProbes;
+    bool teleporting = false;
+    bool teleportFallback = false;
+    uint32_t teleportBeganTick = 0;
+
+    SimHost(SimWorld& world, NativeCounts& counts) : w(world), natives(counts)
+    {
+        core.Subscribe(bus);
+
+        flatProbes.ground = [](void* user, float, float, float) {
+            static_cast<SimHost*>(user)->natives.Add(kCost::SampleGround);
+            GroundSample g;
+            g.found = true;
+            return g;
+        };
+        flatProbes.startProbe = [](void* user, const Vec3&, const Vec3&, float) {
+            static_cast<SimHost*>(user)->natives.Add(kCost::StartProbe);
+            return 1;
+        };
+        flatProbes.pollProbe = [](void* user, int) {
+            static_cast<SimHost*>(user)->natives.Add(kCost::PollProbe);
+            return ProbeStatus::Clear;
+        };
+        flatProbes.user = this;
+    }
+
+    void Teleport(bool fallback)
+    {
+        if (teleporting)
+            return;
+
+        natives.Add(kCost::GetPlayerPosition);
+        natives.Add(kCost::GetPlayerForward);
+        Vec3 player = w.player;
+        player.z += teleportSearch.config.pedRootHeight;
+        teleportSearch.Begin(player, cosf(w.heading), sinf(w.heading), tick / 60.0);
+        teleporting = true;
+        teleportFallback = fallback;
+        teleportBeganTick = tick;
+        StepTeleport();
+    }
+
+    void StepTeleport()
+    {
+        if (!teleporting)
+            return;
+
+        TeleportSearchStatus status = teleportSearch.Step(flatProbes, tick / 60.0);
+        if (status == TeleportSearchStatus::Running)
+            return;
+
+        teleporting = false;
+        if (!w.companionExists)
+            return;
+
+        if (status == TeleportSearchStatus::Failed)
+        {
+            if (!teleportFallback)
+                return;
+            natives.Add(kCost::TeleportNearPlayer);
+            w.companion = { w.player.x + 1.2f, w.player.y + 0.8f, w.player.z };
+        }
+        else
+        {
+            natives.Add(kCost::TeleportTestPedTo);
+            const Vec3& p = teleportSearch.Position();
+            w.companion = { p.x, p.y, p.z - teleportSearch.config.pedRootHeight };
+        }
+
+        w.companionFollowing = false;
+        w.companionOnRoute = false;
+        w.companionFrozen = false;
+        w.companionVehicle = 0;
+        lastFollowTick = 0;
+        lodState.hasSample = false;
+        lastTeleportTick = tick;
+    }
+
+    void Execute(uint16_t a)
+    {
+        if (a & CompanionAction_ExitStay)
+        {
+            natives.Add(kCost::FreezeTestPed);
+            w.companionFrozen = false;
+            state.hasStayAnchor = false;
+            stayDrift.End();
+            lastFollowTick = 0;
+        }
+        if (a & CompanionAction_ClearRiding)
+            ridingVehicle = 0;
+        if ((a & CompanionAction_ReleaseFromVehicle) && w.companionExists)
+            Teleport(true);
+        if ((a & CompanionAction_Despawn) && w.companionExists)
+        {
+            natives.Add(kCost::DespawnTestPed);
+            w.companionExists = false;
+        }
+        if (a & CompanionAction_Respawn)
+        {
+            natives.Add(kCost::SpawnTestPed);
+            w.companionExists = true;
+            w.companion = { w.player.x + 1.2f, w.player.y + 0.8f, w.player.z };
+        }
+        if ((a & CompanionAction_EnterStay) && w.companionExists)
+        {
+            natives.Add(kCost::GetTestPedPosition);
+            natives.Add(kCost::ClearTestPedTasks);
+            natives.Add(kCost::FreezeTestPed);
+            state.stayAnchor = w.companion;
+            state.hasStayAnchor = true;
+            lastStaySnapTick = tick;
+            stayDrift.Begin(tuning.staySnapTicks, tick);
+            w.companionFrozen = true;
+            w.companionFollowing = false;
+        }
+        if (a & CompanionAction_ResetTimers)
+        {
+            lastFollowTick = 0;
+            lastTeleportTick = 0;
+            lastRideAttemptTick = 0;
+            rideSleepUntil = tick;
+        }
+    }
+
+    void RideNative(const NativeCost& c, uint32_t times = 1)
+    {
+        natives.Add(c, times);
+        rideNatives += (uint64_t)(c.query + c.mutation + c.task + c.draw) * times;
+    }
+
+    bool SeatFree(int seat)
+    {
+        RideNative(kCost::IsVehicleSeatFree);
+        return (w.seatsTaken & (1u << seat)) == 0;
+    }
+
+    // main.cpp FindFreeSeat / TryWarpCompanionIntoAnySeat
+    int FindFreeSeat()
+    {
+        for (int seat = 0; seat < 3; ++seat)
+        {
+            if (SeatFree(seat))
+                return seat;
+        }
+        return VehicleRide::kNoSeat;
+    }
+
+    bool Warp(int veh, int preferred, int& outSeat)
+    {
+        int order[4];
+        int count = 0;
+        if (preferred != VehicleRide::kNoSeat)
+            order[count++] = preferred;
+        for (int seat = 0; seat < 3; ++seat)
+        {
+            if (seat != preferred)
+                order[count++] = seat;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (SeatFree(order[i]))
+            {
+                RideNative(kCost::PutPedIntoVehicle);
+                w.seatsTaken |= (uint8_t)(1u << order[i]);
+                w.companionVehicle = veh;
+                outSeat = order[i];
+                if (tick == sitTick)
+                    rideSameFrame++;
+                return true;
+            }
+        }
+        outSeat = VehicleRide::kNoSeat;
+        return false;
+    }
+
+    // main.cpp RideLoop (the task runs while the companion exists)
+    void RidePhases(bool canRide)
+    {
+        if (!w.companionExists)
+        {
+            ride.Reset();
+            return;
+        }
+        if ((int32_t)(tick - rideSleepUntil) < 0)
+            return;
+
+        RideInput in;
+        in.canRide = canRide;
+        in.playerInVehicle = w.inVehicle;
+        in.playerVehicle = w.inVehicle ? w.vehicle : 0;
+        in.vehicleNear = rideVehicleNear;
+        in.releasing = teleporting;
+
+        const RidePhase before = ride.Phase();
+        RideStep step = ride.Step(in, tick, tuning.rideAttemptCooldownTicks);
+
+        if (step.pollIntent)
+        {
+            RideNative(kCost::GetVehicleEntering);
+            ride.NoteEntering(w.entering);
+        }
+        if (step.pickSeat)
+            ride.SeatPicked(step.vehicle, FindFreeSeat());
+        if (step.board)
+        {
+            int seat;
+            bool ok = Warp(step.vehicle, step.seat, seat);
+            ride.Boarded(ok, seat, tick);
+            if (ok)
+            {
+                Dispatch(CompanionEvent::Boarded);
+                ridingVehicle = step.vehicle;
+                lastFollowTick = tick;
+            }
+        }
+        if (step.confirm)
+        {
+            RideNative(kCost::GetTestPedVehicle);
+            ride.Confirm(w.companionVehicle, tick);
+        }
+        if (step.pollSeats)
+        {
+            RideNative(kCost::GetPassengerCount);
+            int passengers = ((w.seatsTaken >> 0) & 1) + ((w.seatsTaken >> 1) & 1) + ((w.seatsTaken >> 2) & 1);
+            ride.NoteOccupancy(passengers, tick);
+        }
+
+        if (ride.Phase() != before && ride.Phase() == RidePhase::Evicted && state.activity == CompanionActivity::Riding)
+            Dispatch(CompanionEvent::RideDesync);
+
+        rideSleepUntil = tick + ride.IdleTicks(tick);
+    }
+
+    // The RideLoop before VehicleRide: warp when the player is in,
+    // every seat again each cooldown while full, the companion's
+    // vehicle read every frame while riding
+    void RideFixed(bool canRide)
+    {
+        if (!(w.inVehicle && w.companionExists && canRide))
+            return;
+
+        if (state.activity == CompanionActivity::Riding)
+        {
+            RideNative(kCost::GetTestPedVehicle);
+            if (w.companionVehicle != ridingVehicle || w.companionVehicle == 0)
+                Dispatch(CompanionEvent::RideDesync);
+        }
+
+        bool riding = state.activity == CompanionActivity::Riding;
+        bool canAttempt = (tick - lastRideAttemptTick) >= tuning.rideAttemptCooldownTicks;
+
+        if (boardNow || (!riding && canAttempt))
+        {
+            boardNow = false;
+            lastRideAttemptTick = tick;
+
+            int seat;
+            if (Warp(w.vehicle, VehicleRide::kNoSeat, seat))
+            {
+                Dispatch(CompanionEvent::Boarded);
+                ridingVehicle = w.vehicle;
+                lastFollowTick = tick;
+            }
+            else if (riding)
+            {
+                Dispatch(CompanionEvent::RideDesync);
+            }
+        }
+    }
+
+    // main.cpp StayAnchorLoop + NoteStayContacts (the nearby scan
+    // runs every 10 ticks there)
+    void StayAdaptive()
+    {
+        const Vec3 anchor = state.stayAnchor;
+
+        if (tick % 10 == 0)
+        {
+            const float r = stayDrift.config.contactMeters;
+            Vec3 contacts[2];
+            uint32_t count = 0;
+            if (w.passerActive && Geometry::DistSq(w.passer, anchor) <= r * r) contacts[count++] = w.passer;
+            if (Geometry::DistSq(w.player, anchor) <= r * r) contacts[count++] = w.player;
+            stayDrift.NoteContacts(anchor, contacts, count, tick);
+        }
+
+        StayDriftStep step = stayDrift.Step(anchor, tick, 1.0f / 60.0f);
+        if (step.move)
+        {
+            natives.Add(kCost::SetTestPedPosition);
+            NoteStayMove(step.to);
+        }
+        if (step.probe)
+        {
+            natives.Add(kCost::IsExplosionNear);
+            stayReads++;
+            const float r = stayDrift.config.explosionMeters;
+            if (w.explosionTicks > 0 && Geometry::DistSq(w.explosionAt, anchor) <= r * r)
+                stayDrift.Disturb(StayDisturbance::Explosion, tick);
+        }
+        if (step.check)
+        {
+            natives.Add(kCost::GetTestPedPosition);
+            stayReads++;
+            stayDrift.Observe(w.companion, anchor, tick);
+        }
+    }
+
+    void NoteStayMove(const Vec3& to)
+    {
+        float d = sqrtf(Geometry::DistSq(w.companion, to));
+        if (d > stayLargestMove)
+            stayLargestMove = d;
+        w.companion = to;
+    }
+
+    void Dispatch(CompanionEvent e)
+    {
+        uint16_t a = 0;
+        if (core.Dispatch(state, e, a))
+            Execute(a);
+    }
+
+    void Tick()
+    {
+        tick++;
+
+        // World sample -> edge events
+        WorldSample ws;
+        natives.Add(kCost::SampleWorldBase);
+        ws.missionActive = w.mission;
+        ws.playerExists = true;
+        ws.playerInVehicle = w.inVehicle;
+        ws.playerVehicle = w.inVehicle ? w.vehicle : 0;
+        if (w.inVehicle) natives.Add(kCost::SampleWorldExtra);
+        ws.companionExists = w.companionExists;
+        if (w.companionExists) natives.Add(kCost::SampleWorldExtra);
+        ws.stayEnabled = stayToggle;
+
+        if (edges.Update(ws, tick, bus) > 0)
+            bus.Dispatch();
+
+        CompanionContext ctx;
+        ctx.tickCount = tick;
+        ctx.deltaSeconds = 1.0f / 60.0f;
+        ctx.playerExists = true;
+        ctx.playerInVehicle = w.inVehicle;
+        ctx.playerPos = w.player;
+        natives.Add(kCost::GetPlayerPosition);
+        motion.Update(playerMotion, w.player, ctx.deltaSeconds);
+
+        if (!w.inVehicle)
+            trail.Offer(w.player);
+        else if (!trail.Empty())
+            trail.Clear();
+
+        state.spawned = w.companionExists;
+        state.stayEnabled = stayToggle;
+
+        CompanionCommands cmd;
+        core.Tick(ctx, state, cmd);
+        Execute(cmd.actions);
+
+        // LOD
+        bool lodSampled = false;
+        lod.BeginFrame();
+        if (w.companionExists)
+        {
+            if (!cmd.requestStay && !w.inVehicle)
+            {
+                if (lod.IsSampleDue(lodState, tick))
+                {
+                    natives.Add(kCost::GetTestPedPosition);
+                    natives.Add(kCost::IsTestPedOnScreen);
+                    companionPos = w.companion;
+                    lod.Sample(lodState, Geometry::DistSq(w.player, w.companion), true, tick);
+                    lodSampled = true;
+                }
+                lod.ApplyToCommands(lodState, cmd);
+            }
+            lod.Account(lodState);
+        }
+        else
+        {
+            lodState = {};
+        }
+
+        // Tasks: a teleport search started on an earlier tick
+        if (teleporting && teleportBeganTick != tick)
+            StepTeleport();
+
+        // Riding
+        bool canRide = state.activity == CompanionActivity::Following || state.activity == CompanionActivity::Riding;
+        if (tick % 10 == 0)
+            rideVehicleNear = !w.inVehicle && w.vehicleNear;
+
+        int playerVehicle = w.inVehicle ? w.vehicle : 0;
+        if (playerVehicle != lastPlayerVehicle)
+        {
+            if (playerVehicle != 0)
+            {
+                rideSits++;
+                sitTick = tick;
+            }
+            boardNow = (playerVehicle != 0);
+            rideSleepUntil = tick;                 // OnPlayerVehicleEvent wakes the task
+            lastPlayerVehicle = playerVehicle;
+        }
+
+        if (predictiveRide)
+            RidePhases(canRide);
+        else
+            RideFixed(canRide);
+
+        if (w.inVehicle && w.companionExists && canRide && w.companionVehicle != w.vehicle)
+            rideWaitTicks++;
+
+        bool isRiding = state.activity == CompanionActivity::Riding;
+
+        // Stay anchor upkeep
+        if (cmd.requestStay && w.companionExists && state.hasStayAnchor)
+        {
+            if (adaptiveStay)
+                StayAdaptive();
+            else if ((tick - lastStaySnapTick) >= tuning.staySnapTicks)
+            {
+                natives.Add(kCost::GetTestPedPosition);
+                stayReads++;
+                if (Geometry::DistSq(w.companion, state.stayAnchor) > 0.01f)
+                {
+                    natives.Add(kCost::SetTestPedPosition);
+                    NoteStayMove(state.stayAnchor);
+                }
+                lastStaySnapTick = tick;
+            }
+
+            stayTicks++;
+            if (Geometry::DistSq(w.companion, state.stayAnchor) > 0.01f)
+                stayOffTicks++;
+        }
+
+        // Follow
+        if (!cmd.requestStay && cmd.requestFollow && w.companionExists && !isRiding && !w.inVehicle)
+        {
+            FollowPlan plan;
+            plan.speed = cmd.followSpeed;
+            if (lodState.hasSample)
+                plan = leadFollow.Plan(followPlan, playerMotion, companionPos, cmd.followDistance, cmd.followSpeed);
+
+            uint32_t refresh = cmd.followRefreshTicks;
+            if (plan.keepingUp)
+                refresh *= 4;       // KEEPING_UP_REFRESH_SCALE
+
+            FormationLayout layout;
+            layout.followDistance = cmd.followDistance;
+            layout.count = 1;
+            layout.spacing = tuning.formationSpacing;
+            if (formation.NeedsAssign(layout))
+            {
+                natives.Add(kCost::GetPlayerForward);
+                formation.Assign(layout, w.player, cosf(w.heading), sinf(w.heading), &companionPos);
+                lastFollowTick = 0;
+            }
+
+            bool timeRefresh = (tick - lastFollowTick) > refresh;
+
+            // Breadcrumbs
+            TrailPlan trailPlan;
+            if (useTrail && lodState.hasSample)
+                trailPlan = trailFollow.Plan(trailState, trail, companionPos, w.player, lodSampled, tick);
+            if (trailPlan.changed && !trailPlan.onTrail)
+                timeRefresh = true;
+
+            if (trailPlan.onTrail)
+            {
+                if (trailPlan.issueRoute)
+                {
+                    uint32_t n = trail.Route(trailState.cursor.id, w.companionRoute, kMaxRoutePoints);
+                    natives.Add(kCost::TaskFollowRoute);
+                    natives.Add(kCost::RoutePoint, n);
+                    w.routeCount = n;
+                    w.routeNext = 0;
+                    w.companionOnRoute = n > 0;
+                    w.companionFollowing = false;
+                    float catchUp = leadFollow.config.catchUpSpeed;
+                    w.companionSpeed = (plan.speed > catchUp) ? plan.speed : catchUp;
+                    trailFollow.NoteIssued(trailState, n, tick);
+                    lastFollowTick = tick;
+                }
+            }
+            else if (timeRefresh || plan.reissue)
+            {
+                natives.Add(kCost::TaskFollowPlayer);
+                w.companionOnRoute = false;
+                w.companionFollowing = true;
+                w.companionSpeed = plan.speed;
+                w.companionOffsetX = formation.SlotFor(0).x;
+                w.companionOffsetY = formation.SlotFor(0).y + plan.leadMeters;
+                w.companionStop = formation.StoppingRange();
+                LeadFollow::NoteIssued(followPlan, plan);
+                lastFollowTick = tick;
+            }
+        }
+        else
+        {
+            lastFollowTick = 0;
+            followPlan = {};
+            trailState = {};
+        }
+
+        // Auto-teleport
+        if (!cmd.requestStay && w.companionExists && !w.inVehicle)
+        {
+            bool tooFar = lodSampled && lodState.distSq > tuning.teleportDistSq;
+            if (tooFar && (tick - lastTeleportTick) >= tuning.teleportCooldownTicks)
+            {
+                teleports++;
+                lastTeleportTick = tick;
+                Teleport(false);
+            }
+        }
+        else
+        {
+            lastTeleportTick = 0;
+        }
+
+        // Debug text (status + natives lines, LOD line while spawned)
+        natives.Add(kCost::DrawDebugText, w.companionExists ? 3 : 2);
+    }
+};
+
+// Moves the companion along its route, or toward its follow
+// offset while it has a follow task. With buildings on, it walks
+// straight and slides along walls (no navmesh): a wall between
+// it and the player, away from the door, stops it.
+static void MoveCompanion(SimWorld& w, float tx, float ty, float stop, float dt)
+{
+    float dx = tx - w.companion.x;
+    float dy = ty - w.companion.y;
+    float d = sqrtf(dx * dx + dy * dy);
+    if (d < stop || d < 1e-4f)
+        return;
+
+    float step = w.companionSpeed * 1.6f * dt;     // speed 3 ~ jog
+    if (step > d) step = d;
+    float nx = w.companion.x + dx / d * step;
+    float ny = w.companion.y + dy / d * step;
+
+    if (w.buildings && Terrain::InWalls(nx, ny, 0.3f))
+    {
+        if (!Terrain::InWalls(nx, w.companion.y, 0.3f))
+            ny = w.companion.y;
+        else if (!Terrain::InWalls(w.companion.x, ny, 0.3f))
+            nx = w.companion.x;
+        else
+            return;
+    }
+    w.companion.x = nx;
+    w.companion.y = ny;
+}
+
+static void StepCompanion(SimWorld& w, float dt)
+{
+    if (!w.companionExists || w.companionFrozen || w.companionVehicle != 0)
+        return;
+
+    if (w.companionOnRoute)
+    {
+        const Vec3& p = w.companionRoute[w.routeNext];
+        float dx = p.x - w.companion.x, dy = p.y - w.companion.y;
+        if (dx * dx + dy * dy < 0.25f && ++w.routeNext >= w.routeCount)
+            w.companionOnRoute = false;
+        else
+            MoveCompanion(w, w.companionRoute[w.routeNext].x, w.companionRoute[w.routeNext].y, 0.0f, dt);
+        return;
+    }
+
+    if (!w.companionFollowing)
+        return;
+
+    // The follow task tracks its offset as the player moves
+    float fx = cosf(w.heading), fy = sinf(w.heading);
+    MoveCompanion(w,
+        w.player.x + fy * w.companionOffsetX + fx * w.companionOffsetY,
+        w.player.y - fx * w.companionOffsetX + fy * w.companionOffsetY,
+        w.companionStop, dt);
+}
+
+static void StepPlayer(SimWorld& w, Rng& rng, float dt)
+{
+    if (rng.OneIn(240))
+        w.heading += (rng.Unit() - 0.5f) * 2.0f;
+
+    float speed = w.inVehicle ? 20.0f : w.playerSpeed;
+    float nx = w.player.x + cosf(w.heading) * speed * dt;
+    float ny = w.player.y + sinf(w.heading) * speed * dt;
+    if (w.buildings && Terrain::InWalls(nx, ny, 0.4f))
+    {
+        w.heading += 1.5707963f + rng.Unit();
+        return;
+    }
+    w.player.x = nx;
+    w.player.y = ny;
+}
+
+// --------------------------------------------------------
+//  Scenarios
+// --------------------------------------------------------
+struct Result
+{
+    const char* name;
+    uint32_t companions;
+    uint32_t ticks;
+    double nsPerTick;
+    double allocsPerTick;
+    NativeCounts natives;
+    uint32_t teleports = 0;             // host scenarios: auto-teleports (companion fell behind)
+    float stayReadsPerMinute = 0.0f;    // host scenarios, while staying: reads + probes...
+    float stayOffSeconds = 0.0f;        // ...time spent off the anchor...
+    float stayLargestMove = 0.0f;       // ...and the biggest single correction
+    float rideNativesPerMinute = 0.0f;  // host scenarios: ride code natives...
+    float rideWaitSeconds = 0.0f;       // ...time the companion waited outside the player's car...
+    uint32_t rideSits = 0;              // ...times the player sat in a car...
+    uint32_t rideSameFrame = 0;         // ...and the companion was in that same frame
+};
+
+static void Report(const Result& r)
+{
+    double t = (double)r.ticks;
+    printf("{\"scenario\":\"%s\",\"companions\":%u,\"ticks\":%u,\"ns_per_tick\":%.1f,\"allocs_per_tick\":%.4f,"
+        "\"natives_per_tick\":%.3f,\"natives\":{\"query\":%.3f,\"mutation\":%.3f,\"task\":%.3f,\"draw\":%.3f},\"teleports\":%u}\n",
+        r.name, r.companions, r.ticks, r.nsPerTick, r.allocsPerTick, r.natives.Total() / t,
+        r.natives.query / t, r.natives.mutation / t, r.natives.task / t, r.natives.draw / t, r.teleports);
+
+    fprintf(stderr, "%-18s n=%-4u %10.1f ns/tick  %7.4f allocs/tick  %7.3f natives/tick (q %.2f m %.2f t %.3f d %.1f)\n",
+        r.name, r.companions, r.nsPerTick, r.allocsPerTick, r.natives.Total() / t,
+        r.natives.query / t, r.natives.mutation / t, r.natives.task / t, r.natives.draw / t);
+}
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Setup, typename PerTick>
+static Result RunHostScenario(const char* name, uint32_t ticks, uint32_t seed, Setup setup, PerTick perTick)
+{
+    SimWorld w;
+    NativeCounts natives;
+    SimHost host(w, natives);
+    Rng rng(seed);
+    const float dt = 1.0f / 60.0f;
+
+    w.companionExists = true;
+    w.companion = { 1.2f, 0.8f, 0.0f };
+    setup(w, host);
+
+    AllocScope allocs(name);
+    allocs.Begin();
+    auto t0 = Clock::now();
+
+    for (uint32_t i = 0; i < ticks; ++i)
+    {
+        perTick(w, host, rng, i);
+        StepPlayer(w, rng, dt);
+        StepCompanion(w, dt);
+        host.Tick();
+    }
+
+    auto t1 = Clock::now();
+    uint64_t allocated = allocs.End(true);
+
+    Result r;
+    r.name = name;
+    r.companions = 1;
+    r.ticks = ticks;
+    r.nsPerTick = std::chrono::duration<double, std::nano>(t1 - t0).count() / ticks;
+    r.allocsPerTick = (double)allocated / ticks;
+    r.natives = natives;
+    r.teleports = host.teleports;
+    if (host.stayTicks > 0)
+        r.stayReadsPerMinute = (float)host.stayReads * StayDrift::kTicksPerMinute / host.stayTicks;
+    r.stayOffSeconds = host.stayOffTicks / 60.0f;
+    r.stayLargestMove = host.stayLargestMove;
+    r.rideNativesPerMinute = (float)host.rideNatives * StayDrift::kTicksPerMinute / ticks;
+    r.rideWaitSeconds = host.rideWaitTicks / 60.0f;
+    r.rideSits = host.rideSits;
+    r.rideSameFrame = host.rideSameFrame;
+    return r;
+}
+
+// N companions: batch decisions + per-companion LOD and follow
+// scheduling (what a multi-companion main loop would run), each
+// heading for its formation slot; the shape changes every ~10 s
+static Result RunBatchScenario(uint32_t n, uint32_t ticks, uint32_t seed)
+{
+    static FormationSolver formation;
+    static uint8_t mode[1024], spawned[1024], stay[1024];
+    static uint8_t reqLog[1024], reqSpawn[1024], reqDespawn[1024], reqFollow[1024], reqStay[1024];
+    static int32_t threat[1024];
+    static float dist[1024], speed[1024];
+    static uint32_t refresh[1024], lastFollow[1024];
+    static Vec3 pos[1024];
+    static LodState lodStates[1024];
+
+    if (n > FormationSolver::kMaxMembers) n = FormationSolver::kMaxMembers;
+
+    CompanionCore core;
+    CompanionLod lod;
+    NativeCounts natives;
+    SimWorld w;
+    Rng rng(seed);
+    const float dt = 1.0f / 60.0f;
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        mode[i] = (uint8_t)CompanionMode::Protection;
+        spawned[i] = 1;
+        stay[i] = (i % 8 == 7) ? 1 : 0;
+        pos[i] = { (float)(i % 16) * 2.0f, (float)(i / 16) * 2.0f, 0.0f };
+        lodStates[i] = {};
+        lastFollow[i] = 0;
+    }
+
+    CompanionStateArrays states;
+    states.count = n;
+    states.mode = mode;
+    states.spawned = spawned;
+    states.stayEnabled = stay;
+
+    CompanionCommandArrays out;
+    out.requestLog = reqLog;
+    out.requestSpawn = reqSpawn;
+    out.requestDespawn = reqDespawn;
+    out.requestFollow = reqFollow;
+    out.followDistance = dist;
+    out.followSpeed = speed;
+    out.followRefreshTicks = refresh;
+    out.requestStay = reqStay;
+    out.threatTarget = threat;
+
+    AllocScope allocs("n_companions");
+    allocs.Begin();
+    auto t0 = Clock::now();
+
+    for (uint32_t t = 1; t <= ticks; ++t)
+    {
+        StepPlayer(w, rng, dt);
+
+        CompanionContext ctx;
+        ctx.tickCount = t;
+        ctx.playerExists = true;
+        ctx.playerPos = w.player;
+
+        core.TickBatch(ctx, states, out);
+
+        FormationLayout layout;
+        layout.shape = (FormationShape)((t / 600) % (uint32_t)FormationShape::Count);
+        layout.count = n;
+        if (formation.NeedsAssign(layout))
+        {
+            natives.Add(kCost::GetPlayerForward);
+            formation.Assign(layout, w.player, cosf(w.heading), sinf(w.heading), pos);
+        }
+        const float fx = cosf(w.heading), fy = sinf(w.heading);
+
+        lod.BeginFrame();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            if (!reqStay[i])
+            {
+                if (lod.IsSampleDue(lodStates[i], t))
+                {
+                    natives.Add(kCost::GetTestPedPosition);
+                    natives.Add(kCost::IsTestPedOnScreen);
+                    lod.Sample(lodStates[i], Geometry::DistSq(w.player, pos[i]), true, t);
+                }
+                CompanionCommands c;
+                c.requestFollow = reqFollow[i] != 0;
+                c.followRefreshTicks = refresh[i];
+                c.followSpeed = speed[i];
+                lod.ApplyToCommands(lodStates[i], c);
+
+                if (c.requestFollow && (t - lastFollow[i]) > c.followRefreshTicks)
+                {
+                    natives.Add(kCost::TaskFollowPlayer);
+                    lastFollow[i] = t;
+                }
+
+                // Crude follow motion towards the slot so tiers actually vary
+                const FormationSlot& slot = formation.SlotFor(i);
+                float dx = w.player.x + fy * slot.x + fx * slot.y - pos[i].x;
+                float dy = w.player.y - fx * slot.x + fy * slot.y - pos[i].y;
+                float d = sqrtf(dx * dx + dy * dy);
+                if (d > 0.75f)
+                {
+                    float step = (1.0f + (float)(i % 5) * 0.2f) * dt;
+                    pos[i].x += dx / d * step;
+                    pos[i].y += dy / d * step;
+                }
+            }
+            lod.Account(lodStates[i]);
+        }
+
+        natives.Add(kCost::SampleWorldBase);
+        natives.Add(kCost::GetPlayerPosition);
+    }
+
+    auto t1 = Clock::now();
+    uint64_t allocated = allocs.End(true);
+
+    Result r;
+    r.name = "n_companions";
+    r.companions = n;
+    r.ticks = ticks;
+    r.nsPerTick = std::chrono::duration<double, std::nano>(t1 - t0).count() / ticks;
+    r.allocsPerTick = (double)allocated / ticks;
+    r.natives = natives;
+    return r;
+}
+
+// Decisions only, N companions: TickBatch over the arrays vs
+// N x Tick over per-companion state, same inputs. Every tick's
+// commands are compared (a disagreement fails the run).
+static uint32_t g_batchMismatches = 0;
+
+static Result RunDecisionScenario(uint32_t n, bool batch, uint32_t ticks, uint32_t seed)
+{
+    static const uint32_t kMax = 4096;
+    static uint8_t mode[kMax], spawned[kMax], stay[kMax];
+    static uint8_t reqLog[kMax], reqSpawn[kMax], reqDespawn[kMax], reqFollow[kMax], reqStay[kMax];
+    static int32_t threat[kMax];
+    static float dist[kMax], speed[kMax];
+    static uint32_t refresh[kMax];
+    static CompanionState state[kMax];
+    static CompanionCommands cmd[kMax];
+
+    if (n > kMax) n = kMax;
+
+    CompanionCore core;
+    Rng rng(seed);
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        mode[i] = (uint8_t)((i % 3 == 2) ? CompanionMode::Frenzy : CompanionMode::Protection);
+        spawned[i] = 1;
+        stay[i] = (i % 8 == 7) ? 1 : 0;
+
+        state[i] = {};
+        state[i].mode = (CompanionMode)mode[i];
+        state[i].spawned = true;
+        state[i].stayEnabled = stay[i] != 0;
+        state[i].activity = stay[i] ? CompanionActivity::Staying : CompanionActivity::Following;
+    }
+
+    CompanionStateArrays states;
+    states.count = n;
+    states.mode = mode;
+    states.spawned = spawned;
+    states.stayEnabled = stay;
+
+    CompanionCommandArrays out;
+    out.requestLog = reqLog;
+    out.requestSpawn = reqSpawn;
+    out.requestDespawn = reqDespawn;
+    out.requestFollow = reqFollow;
+    out.followDistance = dist;
+    out.followSpeed = speed;
+    out.followRefreshTicks = refresh;
+    out.requestStay = reqStay;
+    out.threatTarget = threat;
+
+    const char* name = batch ? "tick_batch" : "tick_loop";
+    AllocScope allocs(name);
+    allocs.Begin();
+    double ns = 0.0;
+
+    for (uint32_t t = 1; t <= ticks; ++t)
+    {
+        CompanionContext ctx;
+        ctx.tickCount = t;
+        ctx.playerExists = true;
+        ctx.playerInVehicle = rng.OneIn(10);
+        ctx.topThreatHandle = rng.OneIn(3) ? 1000 + (int)(t % 7) : 0;
+        ctx.frenzyTargetHandle = rng.OneIn(3) ? 2000 + (int)(t % 5) : 0;
+
+        auto t0 = Clock::now();
+        if (batch)
+        {
+            core.TickBatch(ctx, states, out);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < n; ++i)
+                core.Tick(ctx, state[i], cmd[i]);
+        }
+        ns += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+        // Spot-check one companion per tick against the other path
+        const uint32_t i = t % n;
+        CompanionCommands ref;
+        if (batch)
+            core.Tick(ctx, state[i], ref);
+        else
+            core.TickBatch(ctx, states, out);
+
+        const CompanionCommands& single = batch ? ref : cmd[i];
+        if ((reqFollow[i] != 0) != single.requestFollow || (reqStay[i] != 0) != single.requestStay
+            || threat[i] != single.threatTarget)
+        {
+            g_batchMismatches++;
+        }
+    }
+
+    uint64_t allocated = allocs.End(true);
+
+    Result r;
+    r.name = name;
+    r.companions = n;
+    r.ticks = ticks;
+    r.nsPerTick = ns / ticks;
+    r.allocsPerTick = (double)allocated / ticks;
+    r.natives = NativeCounts{};
+    return r;
+}
+
+// Distances from the player to a crowd: the old one-pair
+// Geometry::DistSq loop over Vec3s vs DistSqBatch over SoA at a
+// pinned SIMD level. The sum is kept so neither loop is dropped.
+static float g_distSink = 0.0f;
+
+static Result RunDistSqScenario(const char* name, bool batch, SimdLevel level, uint32_t ticks, uint32_t seed)
+{
+    static const uint32_t kPoints = 2048;
+    static Vec3 aos[kPoints];
+    static float x[kPoints], y[kPoints], z[kPoints], dist[kPoints];
+
+    SimWorld w;
+    Rng rng(seed);
+    const float dt = 1.0f / 60.0f;
+
+    for (uint32_t i = 0; i < kPoints; ++i)
+    {
+        aos[i] = { (rng.Unit() - 0.5f) * 300.0f, (rng.Unit() - 0.5f) * 300.0f, rng.Unit() * 10.0f };
+        x[i] = aos[i].x;
+        y[i] = aos[i].y;
+        z[i] = aos[i].z;
+    }
+
+    PositionsSoA pts;
+    pts.x = x;
+    pts.y = y;
+    pts.z = z;
+    pts.count = kPoints;
+
+    Geometry::ForceSimdLevel(level);
+
+    AllocScope allocs(name);
+    allocs.Begin();
+    double ns = 0.0;
+
+    for (uint32_t t = 1; t <= ticks; ++t)
+    {
+        StepPlayer(w, rng, dt);
+
+        auto t0 = Clock::now();
+        if (batch)
+        {
+            Geometry::DistSqBatch(w.player, pts, dist);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < kPoints; ++i)
+                dist[i] = Geometry::DistSq(aos[i], w.player);
+        }
+        ns += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+
+        g_distSink += dist[t % kPoints];
+    }
+
+    uint64_t allocated = allocs.End(true);
+    Geometry::ForceSimdLevel(SimdLevel::AVX2);
+
+    Result r;
+    r.name = name;
+    r.companions = kPoints;
+    r.ticks = ticks;
+    r.nsPerTick = ns / ticks;
+    r.allocsPerTick = (double)allocated / ticks;
+    r.natives = NativeCounts{};
+    return r;
+}
+
+// SpatialGrid rebuild alone, synthetic crowd of peds + vehicles
+// spread over 400 x 400 m and drifting a little between
+// rebuilds. Timed: BeginRebuild + N Inserts + FinishRebuild,
+// reported per rebuild. Past kMaxEntities the rest is dropped.
+static uint32_t g_gridDropped = 0;
+
+static Result RunGridRebuildScenario(uint32_t entities, uint32_t rebuilds, uint32_t seed)
+{
+    static const uint32_t kMax = 8192;
+    static Vec3 pos[kMax];
+    static SpatialGrid grid(10.0f);
+    if (entities > kMax) entities = kMax;
+
+    Rng rng(seed);
+    for (uint32_t i = 0; i < entities; ++i)
+        pos[i] = { (rng.Unit() - 0.5f) * 400.0f, (rng.Unit() - 0.5f) * 400.0f, rng.Unit() * 20.0f };
+
+    AllocScope allocs("grid_rebuild");
+    allocs.Begin();
+    double ns = 0.0;
+
+    for (uint32_t r = 0; r < rebuilds; ++r)
+    {
+        for (uint32_t i = 0; i < entities; ++i)
+        {
+            pos[i].x += (rng.Unit() - 0.5f) * 0.5f;
+            pos[i].y += (rng.Unit() - 0.5f) * 0.5f;
+        }
+
+        auto t0 = Clock::now();
+        grid.BeginRebuild();
+        for (uint32_t i = 0; i < entities; ++i)
+            grid.Insert((int)i + 1, (i % 4 == 3) ? EntityKind_Vehicle : EntityKind_Ped, pos[i]);
+        grid.FinishRebuild();
+        ns += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    }
+
+    uint64_t allocated = allocs.End(true);
+    g_gridDropped = grid.DroppedLastRebuild();
+
+    Result res;
+    res.name = "grid_rebuild";
+    res.companions = entities;
+    res.ticks = rebuilds;
+    res.nsPerTick = ns / rebuilds;
+    res.allocsPerTick = (double)allocated / rebuilds;
+    res.natives = NativeCounts{};
+    return res;
+}
+
+// Protection with a crowd: grid rebuild every 10 ticks, threat
+// sync, budgeted sampling (the Protection half of main.cpp)
+static Result RunCrowdScenario(uint32_t peds, uint32_t ticks, uint32_t seed)
+{
+    static Vec3 pedPos[2048];
+    static uint8_t pedHostile[2048];
+    if (peds > 2048) peds = 2048;
+
+    static SpatialGrid grid(10.0f);
+    static ThreatEngine threats;
+    threats.Reset();
+
+    NativeCounts natives;
+    SimWorld w;
+    Rng rng(seed);
+    const float dt = 1.0f / 60.0f;
+
+    for (uint32_t i = 0; i < peds; ++i)
+    {
+        pedPos[i] = { (rng.Unit() - 0.5f) * 160.0f, (rng.Unit() - 0.5f) * 160.0f, 0.0f };
+        pedHostile[i] = rng.OneIn(20) ? 1 : 0;
+    }
+
+    AllocScope allocs("protection_crowd");
+    allocs.Begin();
+    auto t0 = Clock::now();
+
+    for (uint32_t t = 1; t <= ticks; ++t)
+    {
+        StepPlayer(w, rng, dt);
+
+        if (t % 10 == 0)
+        {
+            grid.BeginRebuild();
+            for (uint32_t i = 0; i < peds; ++i)
+            {
+                pedPos[i].x += (rng.Unit() - 0.5f) * 0.3f;
+                pedPos[i].y += (rng.Unit() - 0.5f) * 0.3f;
+
+                // Coordinates are read before the radius test
+                natives.Add(kCost::NearbyPerEntity);
+                if (Geometry::DistSq(pedPos[i], w.player) < 80.0f * 80.0f)
+                    grid.Insert((int)i + 1, EntityKind_Ped, pedPos[i]);
+            }
+            grid.FinishRebuild();
+            threats.SyncCandidates(grid, w.player, t);
+        }
+
+        int handles[16];
+        uint32_t n = threats.PickForSampling(handles, 16);
+        for (uint32_t k = 0; k < n; ++k)
+        {
+            uint32_t i = (uint32_t)handles[k] - 1;
+            PedThreatInfo info;
+            info.exists = true;
+            info.hostile = pedHostile[i] != 0;
+            info.inCombatWithPlayer = info.hostile && (i % 3 == 0);
+            info.weapon = info.hostile ? WeaponClass::Gun : WeaponClass::None;
+            natives.Add(kCost::QueryPedThreat);
+            threats.ApplySample(handles[k], info, t);
+        }
+
+        natives.Add(kCost::SampleWorldBase);
+        natives.Add(kCost::GetPlayerPosition);
+    }
+
+    auto t1 = Clock::now();
+    uint64_t allocated = allocs.End(true);
+
+    Result r;
+    r.name = "protection_crowd";
+    r.companions = 1;
+    r.ticks = ticks;
+    r.nsPerTick = std::chrono::duration<double, std::nano>(t1 - t0).count() / ticks;
+    r.allocsPerTick = (double)allocated / ticks;
+    r.natives = natives;
+    return r;
+}
+
+// Pure-CPU fan-out through the job system: per-ped distance
+// tests over a large crowd, split in batches, checked against a
+// serial pass every tick (a wrong sum fails the run)
+struct FanoutData
+{
+    const Vec3* positions;
+    Vec3 center;
+    float radiusSq;
+    uint32_t* counts;           // one per batch
+    uint32_t batch;
+};
+
+static void CountInRange(uint32_t begin, uint32_t end, void* user)
+{
+    FanoutData& d = *static_cast<FanoutData*>(user);
+    uint32_t n = 0;
+    for (uint32_t i = begin; i < end; ++i)
+        n += Geometry::DistSq(d.positions[i], d.center) < d.radiusSq ? 1 : 0;
+    d.counts[begin / d.batch] = n;
+}
+
+static uint32_t g_fanoutMismatches = 0;
+
+static Result RunFanoutScenario(JobSystem& jobs, const char* name, uint32_t ticks, uint32_t seed)
+{
+    const uint32_t kPeds = 4096;
+    const uint32_t kBatch = 512;
+    static Vec3 pos[kPeds];
+    static uint32_t counts[kPeds / kBatch];
+
+    SimWorld w;
+    Rng rng(seed);
+    const float dt = 1.0f / 60.0f;
+
+    for (uint32_t i = 0; i < kPeds; ++i)
+        pos[i] = { (rng.Unit() - 0.5f) * 300.0f, (rng.Unit() - 0.5f) * 300.0f, 0.0f };
+
+    FanoutData d;
+    d.positions = pos;
+    d.radiusSq = 80.0f * 80.0f;
+    d.counts = counts;
+    d.batch = kBatch;
+
+    AllocScope allocs(name);
+    allocs.Begin();
+    auto t0 = Clock::now();
+
+    for (uint32_t t = 1; t <= ticks; ++t)
+    {
+        StepPlayer(w, rng, dt);
+        d.center = w.player;
+
+        jobs.ParallelFor(kPeds, kBatch, CountInRange, &d);
+
+        uint32_t parallel = 0;
+        for (uint32_t b = 0; b < kPeds / kBatch; ++b)
+            parallel += counts[b];
+
+        CountInRange(0, kPeds, &d);         // serial check (writes counts[0])
+        if (counts[0] != parallel)
+            g_fanoutMismatches++;
+    }
+
+    auto t1 = Clock::now();
+    uint64_t allocated = allocs.End(true);
+
+    Result r;
+    r.name = name;
+    r.companions = 1;
+    r.ticks = ticks;
+    r.nsPerTick = std::chrono::duration<double, std::nano>(t1 - t0).count() / ticks;
+    r.allocsPerTick = (double)allocated / ticks;
+    r.natives = NativeCounts{};
+    return r;
+}
+
+// main.cpp's post-scan pattern: one job per nearby scan (every
+// 10th frame, so the workers have gone to sleep in between),
+// then some script-thread work, then Wait(). The work between
+// stands in for natives as a spin of kNativeNs each (an assumed
+// ScriptHookV invoke cost, not measured here). ns/tick = script
+// thread time from Run() to Wait() returning, per scan.
+static const uint64_t kNativeNs = 1000;
+
+static void CountInRangeJob(Job&, const void* data)
+{
+    FanoutData& d = *JobSystem::Data<FanoutData*>(data);
+    CountInRange(0, d.batch, &d);
+}
+
+static Result RunOverlapScenario(JobSystem& jobs, const char* name, uint32_t nativesBetween, uint32_t ticks, uint32_t seed)
+{
+    const uint32_t kPeds = 4096;
+    static Vec3 pos[kPeds];
+    static uint32_t counts[1];
+
+    Rng rng(seed);
+    for (uint32_t i = 0; i < kPeds; ++i)
+        pos[i] = { (rng.Unit() - 0.5f) * 300.0f, (rng.Unit() - 0.5f) * 300.0f, 0.0f };
+
+    FanoutData d;
+    d.positions = pos;
+    d.radiusSq = 80.0f * 80.0f;
+    d.counts = counts;
+    d.batch = kPeds;
+
+    const uint32_t scans = ticks / 10;
+    const JobStats before = jobs.Stats();
+    double scriptNs = 0.0;
+
+    AllocScope allocs(name);
+    allocs.Begin();
+
+    for (uint32_t i = 0; i < scans; ++i)
+    {
+        // The other 9 frames: long enough for idle workers to sleep
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+        d.center = { (rng.Unit() - 0.5f) * 100.0f, (rng.Unit() - 0.5f) * 100.0f, 0.0f };
+        FanoutData* payload = &d;
+
+        auto t0 = Clock::now();
+        Job* job = jobs.Create(CountInRangeJob, payload);
+        jobs.Run(job);
+
+        auto until = t0 + std::chrono::nanoseconds(kNativeNs * nativesBetween);
+        while (Clock::now() < until) {}
+
+        jobs.Wait(job);
+        scriptNs += std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    }
+
+    uint64_t allocated = allocs.End(true);
+    const JobStats after = jobs.Stats();
+
+    uint64_t executed = after.executed - before.executed;
+    uint64_t onWorkers = executed - (after.onCaller - before.onCaller);
+    fprintf(stderr, "  %u natives between Run and Wait: %.0f%% of jobs ran on a worker\n",
+        nativesBetween, executed > 0 ? 100.0 * (double)onWorkers / (double)executed : 0.0);
+
+    Result r;
+    r.name = name;
+    r.companions = 1;
+    r.ticks = scans;
+    r.nsPerTick = scans > 0 ? scriptNs / scans : 0.0;
+    r.allocsPerTick = scans > 0 ? (double)allocated / scans : 0.0;
+    r.natives = NativeCounts{};
+    return r;
+}
+
+// --------------------------------------------------------
+//  Teleport search against the heightfield
+// --------------------------------------------------------
+// The search runs through async probes exactly as in the game;
+// every spot it returns is checked again here (a bad spot fails
+// the run), and the old fixed offset is scored on the same
+// player positions for comparison.
+// Shape tests queue up and answer a tick later (sometimes two)
+struct SimProbes
+{
+    struct Pending
+    {
+        Vec3 from, to;
+        float radius;
+        uint32_t readyTick;
+        bool used;
+    };
+
+    static constexpr uint32_t kSlots = 32;
+    Pending slots[kSlots] = {};
+    uint32_t tick = 0;
+    Rng rng{ 11 };
+    NativeCounts* natives = nullptr;
+
+    static GroundSample Ground(void* user, float x, float y, float zTop)
+    {
+        static_cast<SimProbes*>(user)->natives->Add(kCost::SampleGround);
+
+        GroundSample g;
+        g.groundZ = Terrain::Ground(x, y);
+        if (Terrain::InBuilding(x, y))
+            g.groundZ += Terrain::kBuildingHeight;     // roof, if zTop is above it
+        g.found = g.groundZ <= zTop;
+        if (!g.found && Terrain::InBuilding(x, y))
+        {
+            g.groundZ = Terrain::Ground(x, y);         // under the roof: the floor inside
+            g.found = true;
+        }
+        g.water = Terrain::InLake(x, y);
+        return g;
+    }
+
+    static int Start(void* user, const Vec3& from, const Vec3& to, float radius)
+    {
+        SimProbes& p = *static_cast<SimProbes*>(user);
+        p.natives->Add(kCost::StartProbe);
+        for (uint32_t i = 0; i < kSlots; ++i)
+        {
+            if (p.slots[i].used)
+                continue;
+            p.slots[i] = { from, to, radius, p.tick + (p.rng.OneIn(50) ? 2u : 1u), true };
+            return (int)i + 1;
+        }
+        return 0;
+    }
+
+    static ProbeStatus Poll(void* user, int handle)
+    {
+        SimProbes& p = *static_cast<SimProbes*>(user);
+        p.natives->Add(kCost::PollProbe);
+        if (handle <= 0 || handle > (int)kSlots || !p.slots[handle - 1].used)
+            return ProbeStatus::Failed;
+
+        Pending& q = p.slots[handle - 1];
+        if (p.tick < q.readyTick)
+            return ProbeStatus::Pending;
+
+        q.used = false;
+        return Terrain::SegmentBlocked(q.from, q.to, q.radius) ? ProbeStatus::Blocked : ProbeStatus::Clear;
+    }
+};
+
+static uint32_t g_teleportBadSpots = 0;
+
+static Result RunTeleportScenario(uint32_t ticks, uint32_t seed)
+{
+    const char* name = "teleport_terrain";
+    const float dt = 1.0f / 60.0f;
+    const uint32_t kSearchEvery = 90;
+
+    static TeleportSearch search;
+    static SimProbes sim;
+    NativeCounts natives;
+    sim.natives = &natives;
+
+    TeleportProbes probes;
+    probes.ground = SimProbes::Ground;
+    probes.startProbe = SimProbes::Start;
+    probes.pollProbe = SimProbes::Poll;
+    probes.user = &sim;
+
+    const TeleportSearchConfig& cfg = search.config;
+
+    SimWorld w;
+    Rng rng(seed);
+    w.player = { 25.0f, 30.0f, 0.0f };          // open ground between buildings
+
+    bool running = false;
+    Vec3 from{};                                // player feet when the search began
+    uint32_t found = 0, cached = 0, failed = 0, oldUnsafe = 0, searchFrames = 0;
+
+    AllocScope allocs(name);
+    allocs.Begin();
+    auto t0 = Clock::now();
+
+    for (uint32_t t = 1; t <= ticks; ++t)
+    {
+        sim.tick = t;
+        double now = t * (double)dt;
+
+        // Walk, turning away from water, buildings and cliffs
+        if (rng.OneIn(600)) w.playerSpeed = (w.playerSpeed > 2.0f) ? 1.5f : 7.0f;
+        if (rng.OneIn(240)) w.heading += (rng.Unit() - 0.5f) * 2.0f;
+        float nx = w.player.x + cosf(w.heading) * w.playerSpeed * dt;
+        float ny = w.player.y + sinf(w.heading) * w.playerSpeed * dt;
+        if (Terrain::InLake(nx, ny) || Terrain::InBuilding(nx, ny, 0.5f)
+            || fabsf(Terrain::Ground(nx, ny) - Terrain::Ground(w.player.x, w.player.y)) > 0.5f)
+        {
+            w.heading += 1.5707963f + rng.Unit();
+        }
+        else
+        {
+            w.player = { nx, ny, Terrain::Ground(nx, ny) };
+        }
+
+        if (!running && t % kSearchEvery == 0)
+        {
+            from = w.player;
+            Vec3 entity{ from.x, from.y, from.z + cfg.pedRootHeight };
+            TeleportSearchStatus st = search.Begin(entity, cosf(w.heading), sinf(w.heading), now);
+            running = (st == TeleportSearchStatus::Running);
+            if (st == TeleportSearchStatus::FoundCached)
+                cached++;
+
+            // The old fixed offset, same moment: world +1.2/+0.8 at the player's height
+            float ox = from.x + 1.2f, oy = from.y + 0.8f;
+            if (Terrain::InLake(ox, oy) || Terrain::InBuilding(ox, oy, cfg.probeRadius)
+                || fabsf(Terrain::Ground(ox, oy) - from.z) > 0.5f)
+            {
+                oldUnsafe++;
+            }
+
+            if (st == TeleportSearchStatus::FoundCached)
+            {
+                // Cached: safe ground near the player (not re-probed)
+                const Vec3& p = search.Position();
+                float feet = p.z - cfg.pedRootHeight;
+                float dx = p.x - from.x, dy = p.y - from.y;
+                if (Terrain::InLake(p.x, p.y) || Terrain::InBuilding(p.x, p.y, cfg.probeRadius)
+                    || fabsf(feet - Terrain::Ground(p.x, p.y)) > 0.01f
+                    || fabsf(feet - from.z) > cfg.maxStepMeters
+                    || dx * dx + dy * dy > cfg.cacheMaxDistance * cfg.cacheMaxDistance)
+                {
+                    g_teleportBadSpots++;
+                }
+            }
+        }
+
+        if (running)
+        {
+            TeleportSearchStatus st = search.Step(probes, now);
+            if (st != TeleportSearchStatus::Running)
+            {
+                running = false;
+                searchFrames += search.Frames();
+
+                if (st == TeleportSearchStatus::Failed)
+                {
+                    failed++;
+                }
+                else
+                {
+                    found++;
+
+                    // Checked spot: dry, outside buildings, on the
+                    // ground, climbable, clear path from the player
+                    const Vec3& p = search.Position();
+                    float feet = p.z - cfg.pedRootHeight;
+                    float dx = p.x - from.x, dy = p.y - from.y;
+                    float rise = fabsf(feet - from.z);
+                    Vec3 a{ from.x, from.y, from.z + cfg.probeHeight };
+                    Vec3 b{ p.x, p.y, feet + cfg.probeHeight };
+                    if (Terrain::InLake(p.x, p.y) || Terrain::InBuilding(p.x, p.y, cfg.probeRadius)
+                        || fabsf(feet - Terrain::Ground(p.x, p.y)) > 0.01f
+                        || rise > cfg.maxStepMeters || rise / sqrtf(dx * dx + dy * dy) > cfg.maxGrade
+                        || Terrain::SegmentBlocked(a, b, cfg.probeRadius))
+                    {
+                        g_teleportBadSpots++;
+                    }
+                }
+            }
+        }
+    }
+
+    auto t1 = Clock::now();
+    uint64_t allocated = allocs.End(true);
+
+    const TeleportSearchStats& st = search.Stats();
+    fprintf(stderr, "  searches=%u checked=%u cached=%u failed=%u bad=%u | old offset unsafe=%u (%.0f%%) | "
+        "avg frames=%.2f natives/search=%.1f | rejected ground=%u water=%u height=%u steep=%u blocked=%u\n",
+        st.searches, found, cached, failed, g_teleportBadSpots, oldUnsafe,
+        st.searches ? 100.0 * oldUnsafe / st.searches : 0.0,
+        found + failed ? (double)searchFrames / (found + failed) : 0.0,
+        st.searches ? (double)natives.Total() / st.searches : 0.0,
+        st.rejected[(int)TeleportReject::NoGround], st.rejected[(int)TeleportReject::Water],
+        st.rejected[(int)TeleportReject::Height], st.rejected[(int)TeleportReject::Steep],
+        st.rejected[(int)TeleportReject::Blocked]);
+
+    Result r;
+    r.name = name;
+    r.companions = 1;
+    r.ticks = ticks;
+    r.nsPerTick = std::chrono::duration<double, std::nano>(t1 - t0).count() / ticks;
+    r.allocsPerTick = (double)allocated / ticks;
+    r.natives = natives;
+    r.teleports = st.searches;
+    return r;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t ticks = (argc >= 2) ? (uint32_t)strtoul(argv[1], nullptr, 10) : 216000;
+    if (ticks == 0) ticks = 1;
+
+    AllocTracker::SetViolationHandler(OnLoopAllocation, nullptr);
+
+    fprintf(stderr, "CompanionBench: %u ticks per scenario, SIMD=%s\n",
+        ticks, Geometry::SimdLevelName(Geometry::ActiveSimdLevel()));
+
+    // On foot, walking with occasional sprints
+    Report(RunHostScenario("onfoot_follow", ticks, 1,
+        [](SimWorld&, SimHost&) {},
+        [](SimWorld& w, SimHost&, Rng& rng, uint32_t) {
+            if (rng.OneIn(600)) w.playerSpeed = (w.playerSpeed > 2.0f) ? 1.5f : 7.0f;
+        }));
+
+    // On foot in and out of buildings through their doors,
+    // sprinting now and then; the companion walks straight (no
+    // navmesh), so without the breadcrumb trail a wall in between
+    // strands it until the teleport
+    uint32_t buildingTeleports[2] = {};
+    for (int useTrail = 0; useTrail < 2; ++useTrail)
+    {
+        Result r = RunHostScenario(useTrail ? "buildings_trail" : "buildings_direct", ticks, 9,
+            [useTrail](SimWorld& w, SimHost& h) {
+                w.buildings = true;
+                w.player = { 25.0f, 30.0f, 0.0f };
+                w.companion = { 26.2f, 30.8f, 0.0f };
+                h.useTrail = useTrail != 0;
+            },
+            [](SimWorld& w, SimHost&, Rng& rng, uint32_t) {
+                if (rng.OneIn(600)) w.playerSpeed = (w.playerSpeed > 2.0f) ? 1.5f : 7.0f;
+            });
+        buildingTeleports[useTrail] = r.teleports;
+        Report(r);
+    }
+    fprintf(stderr, "  teleports (fell behind): direct=%u trail=%u\n", buildingTeleports[0], buildingTeleports[1]);
+
+    // Staying while the world goes on: peds walking past (some
+    // brush the companion), the odd explosion, a rare physics
+    // nudge. Fixed-interval snap vs StayDrift on the same seed.
+    Result stay[2];
+    for (int adaptive = 0; adaptive < 2; ++adaptive)
+    {
+        stay[adaptive] = RunHostScenario(adaptive ? "stay_drift" : "stay_drift_fixed", ticks, 2,
+            [adaptive](SimWorld&, SimHost& h) {
+                h.stayToggle = true;
+                h.adaptiveStay = adaptive != 0;
+            },
+            [](SimWorld& w, SimHost& h, Rng& rng, uint32_t) {
+                w.playerSpeed = 1.0f;
+                const Vec3 anchor = h.state.hasStayAnchor ? h.state.stayAnchor : w.companion;
+
+                if (!w.passerActive && rng.OneIn(1200))
+                {
+                    w.passerActive = true;
+                    w.passer = { anchor.x - 8.0f, anchor.y + (rng.Unit() - 0.5f) * 3.0f, anchor.z };
+                }
+                if (w.passerActive)
+                {
+                    float before = w.passer.x - anchor.x;
+                    w.passer.x += 1.4f / 60.0f;
+                    float dy = w.passer.y - anchor.y;
+                    if (before < 0.0f && w.passer.x >= anchor.x && fabsf(dy) < 0.8f && rng.OneIn(2))
+                        w.companion.y -= (dy < 0.0f ? -1.0f : 1.0f) * (0.1f + rng.Unit() * 0.3f);
+                    if (w.passer.x > anchor.x + 8.0f)
+                        w.passerActive = false;
+                }
+
+                if (w.explosionTicks > 0)
+                    w.explosionTicks--;
+                else if (rng.OneIn(7200))
+                {
+                    float a = rng.Unit() * 6.2831853f, d = 5.0f + rng.Unit() * 20.0f;
+                    w.explosionAt = { anchor.x + cosf(a) * d, anchor.y + sinf(a) * d, anchor.z };
+                    w.explosionTicks = 60;
+                    if (d < 15.0f)
+                    {
+                        float shove = (15.0f - d) * 0.2f;
+                        w.companion.x -= cosf(a) * shove;
+                        w.companion.y -= sinf(a) * shove;
+                    }
+                }
+
+                if (rng.OneIn(3600))
+                {
+                    w.companion.x += (rng.Unit() - 0.5f) * 0.3f;
+                    w.companion.y += (rng.Unit() - 0.5f) * 0.3f;
+                }
+            });
+        Report(stay[adaptive]);
+    }
+    fprintf(stderr, "  stay reads/min: fixed=%.1f adaptive=%.1f; off the anchor: fixed=%.0fs adaptive=%.0fs; largest correction: fixed=%.2fm adaptive=%.2fm\n",
+        stay[0].stayReadsPerMinute, stay[1].stayReadsPerMinute, stay[0].stayOffSeconds, stay[1].stayOffSeconds,
+        stay[0].stayLargestMove, stay[1].stayLargestMove);
+
+    // Walking up to cars and getting in (sometimes changing their
+    // mind), switching cars, full cars emptying, the companion
+    // pulled out now and then. Old loop vs VehicleRide, same seed.
+    Result ride[2];
+    for (int predictive = 0; predictive < 2; ++predictive)
+    {
+        ride[predictive] = RunHostScenario(predictive ? "vehicle_hopping" : "vehicle_hopping_fixed", ticks, 3,
+            [predictive](SimWorld&, SimHost& h) { h.predictiveRide = predictive != 0; },
+            [](SimWorld& w, SimHost&, Rng& rng, uint32_t) {
+                // Same draws every tick whatever the host did, so
+                // both runs see the same world
+                const bool walkOff = rng.OneIn(400), walkUp = rng.OneIn(600), passCars = rng.OneIn(300);
+                const bool getOut = rng.OneIn(1200), switchCar = rng.OneIn(900);
+                const bool freeSeat = rng.OneIn(300), pulledOut = rng.OneIn(5000);
+                const bool full = rng.OneIn(4), oneTaken = rng.OneIn(3);
+                const uint32_t pick = rng.Next(), delay = rng.Next() % 60;
+
+                if (!w.inVehicle)
+                {
+                    if (w.entering != 0)
+                    {
+                        if (walkOff)
+                            w.entering = 0;                            // changed their mind
+                        else if (--w.enterTicksLeft == 0)
+                        {
+                            w.inVehicle = true;
+                            w.vehicle = w.entering;
+                            w.entering = 0;
+                        }
+                    }
+                    else if (walkUp)
+                    {
+                        // Walks up and gets in over 1-2 s
+                        w.entering = (int)(100 + pick % 8);
+                        w.enterTicksLeft = 60 + delay;
+                        w.seatsTaken = full ? 0x7 : (oneTaken ? 0x1 : 0);
+                        w.vehicleNear = true;
+                    }
+                    else if (passCars)
+                    {
+                        w.vehicleNear = !w.vehicleNear;                // walking past parked cars
+                    }
+                }
+                else
+                {
+                    if (getOut)
+                    {
+                        w.inVehicle = false;
+                        w.vehicle = 0;
+                        w.companionVehicle = 0;
+                    }
+                    else if (switchCar)
+                    {
+                        w.vehicle = 100 + (w.vehicle - 100 + 1 + (int)(pick % 7)) % 8;
+                        w.seatsTaken = full ? 0x7 : 0;
+                    }
+
+                    if (freeSeat && w.seatsTaken == 0x7 && w.companionVehicle != w.vehicle)
+                        w.seatsTaken &= (uint8_t)~(1u << (pick % 3));  // someone got out
+                    if (pulledOut && w.companionVehicle == w.vehicle)
+                        w.companionVehicle = 0;                        // pulled out, seat taken
+                }
+            });
+        Report(ride[predictive]);
+    }
+    fprintf(stderr, "  ride natives/min: fixed=%.1f phases=%.1f; in the frame the player sat: fixed=%u/%u phases=%u/%u; waited for a seat: fixed=%.0fs phases=%.0fs\n",
+        ride[0].rideNativesPerMinute, ride[1].rideNativesPerMinute, ride[0].rideSameFrame, ride[0].rideSits,
+        ride[1].rideSameFrame, ride[1].rideSits, ride[0].rideWaitSeconds, ride[1].rideWaitSeconds);
+
+    // Missions starting/ending every few seconds, stay toggling
+    Report(RunHostScenario("mission_churn", ticks, 4,
+        [](SimWorld&, SimHost&) {},
+        [](SimWorld& w, SimHost& h, Rng& rng, uint32_t) {
+            if (rng.OneIn(300)) w.mission = !w.mission;
+            if (rng.OneIn(500)) h.stayToggle = !h.stayToggle;
+        }));
+
+    // Host-side work per companion (formation slots cap it at 256)
+    static const uint32_t kCounts[] = { 1, 16, 256 };
+    for (uint32_t n : kCounts)
+        Report(RunBatchScenario(n, ticks, 5));
+
+    // Decisions alone: TickBatch vs N x Tick, up to 4096
+    static const uint32_t kDecisionCounts[] = { 1, 16, 256, 4096 };
+    for (uint32_t n : kDecisionCounts)
+    {
+        // Fewer ticks at 4096, or the N x Tick run dominates the bench
+        const uint32_t decisionTicks = (n >= 4096) ? ticks / 16 : ticks;
+        Result loop = RunDecisionScenario(n, false, decisionTicks, 10);
+        Result batch = RunDecisionScenario(n, true, decisionTicks, 10);
+        Report(loop);
+        Report(batch);
+        fprintf(stderr, "  decisions for %u companions: %.1f ns/tick N x Tick, %.1f ns/tick TickBatch (%.1fx)\n",
+            n, loop.nsPerTick, batch.nsPerTick, batch.nsPerTick > 0.0 ? loop.nsPerTick / batch.nsPerTick : 0.0);
+    }
+
+    Report(RunCrowdScenario(400, ticks, 6));
+
+    // Grid rebuilds for crowds of 1k-5k (n= is the entity count,
+    // ns/tick is per rebuild; in game it's one per NEARBY_SCAN_TICKS)
+    static const uint32_t kCrowds[] = { 1000, 2000, 3000, 4000, 5000 };
+    for (uint32_t n : kCrowds)
+    {
+        Result r = RunGridRebuildScenario(n, ticks / 10, 12);
+        Report(r);
+        fprintf(stderr, "  grid rebuild, %u entities: %.3f ms", n, r.nsPerTick / 1e6);
+        if (g_gridDropped > 0)
+            fprintf(stderr, " (%u dropped past kMaxEntities=%u)", g_gridDropped, SpatialGrid::kMaxEntities);
+        fputc('\n', stderr);
+    }
+
+    // 2048 distances per tick: n= is the point count here
+    {
+        Result pair = RunDistSqScenario("distsq_pairs", false, SimdLevel::Scalar, ticks, 11);
+        Report(pair);
+
+        static const SimdLevel kLevels[] = { SimdLevel::Scalar, SimdLevel::SSE, SimdLevel::AVX2 };
+        static const char* const kNames[] = { "distsq_batch_scalar", "distsq_batch_sse", "distsq_batch_avx2" };
+        for (int l = 0; l < 3; ++l)
+        {
+            Geometry::ForceSimdLevel(kLevels[l]);
+            if (Geometry::ActiveSimdLevel() != kLevels[l])
+                continue;                       // CPU doesn't have it
+
+            Result b = RunDistSqScenario(kNames[l], true, kLevels[l], ticks, 11);
+            Report(b);
+            fprintf(stderr, "  DistSqBatch %s: %.2fx the DistSq loop\n",
+                Geometry::SimdLevelName(kLevels[l]), b.nsPerTick > 0.0 ? pair.nsPerTick / b.nsPerTick : 0.0);
+        }
+        Geometry::ForceSimdLevel(SimdLevel::AVX2);
+    }
+
+    // Same work with and without workers (the serial check is
+    // included in both, so the difference is the fan-out)
+    {
+        static JobSystem inlineJobs;
+        inlineJobs.Start(0);
+        Report(RunFanoutScenario(inlineJobs, "job_fanout_w0", ticks, 7));
+    }
+    {
+        static JobSystem jobs;
+        jobs.Start(3);
+        Report(RunFanoutScenario(jobs, "job_fanout_w3", ticks, 7));
+        jobs.Stop();
+    }
+
+    // The post-scan job with nothing between Run and Wait (the
+    // fiber runs it itself) and with the LOD sample's 2 natives
+    {
+        static JobSystem jobs;
+        jobs.Start(2);
+        Report(RunOverlapScenario(jobs, "job_overlap_0", 0, ticks, 9));
+        Report(RunOverlapScenario(jobs, "job_overlap_2", 2, ticks, 9));
+        Report(RunOverlapScenario(jobs, "job_overlap_8", 8, ticks, 9));
+        jobs.Stop();
+    }
+
+    Report(RunTeleportScenario(ticks, 8));
+
+    if (g_teleportBadSpots > 0)
+    {
+        fprintf(stderr, "FAILED: %u teleport spots were not safe on the heightfield\n", g_teleportBadSpots);
+        return 1;
+    }
+
+    if (g_batchMismatches > 0)
+    {
+        fprintf(stderr, "FAILED: %u ticks where TickBatch and Tick disagreed\n", g_batchMismatches);
+        return 1;
+    }
+
+    if (g_fanoutMismatches > 0)
+    {
+        fprintf(stderr, "FAILED: %u job fan-out ticks disagreed with the serial pass\n", g_fanoutMismatches);
+        return 1;
+    }
+
+    if (g_allocViolations > 0)
+    {
+        fprintf(stderr, "FAILED: %u scenario loops allocated\n", g_allocViolations);
+        return 1;
+    }
+    return 0;
+}
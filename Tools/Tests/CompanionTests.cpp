@@ -0,0 +1,1070 @@
+// ============================================================
+//  CompanionTests.cpp — Headless checks for the engine-agnostic code
+// ============================================================
+//
+//  PURPOSE:
+//  The bench (Tools/Bench) measures; this checks. Each test
+//  exercises one engine-agnostic module against a reference and
+//  prints one line per failed expectation. No GTA, no framework:
+//  a plain console program, like the trace replay.
+//
+//  TESTS:
+//    geometry   DistSqBatch / RangeMask / NearestK at every SIMD
+//               level the CPU has, against the scalar reference
+//               (empty, odd, every tail length, chunk boundaries)
+//    threats    ThreatEngine's patched top-K list against a full
+//               sort of every candidate's score, after every
+//               sample (promotions, demotions, drop-outs)
+//    profiler   FrameProfiler nested past kMaxDepth: the extra
+//               zones are dropped, the recorded ones keep their
+//               own Begin/End and nothing reports a mismatch
+//    tuning     TuningWatcher picks up two saves of the same size
+//               within one second; after RequestStop() the thread
+//               leaves its loop (WaitStopped, what DllMain uses)
+//    jobs       a job Run() while every worker sleeps is picked
+//               up by a worker with nobody helping in Wait() (no
+//               lost wake-ups now that the sleep has no timeout);
+//               sleeping workers leave on RequestStop (WaitStopped)
+//    snapshot   WorldSnapshotBuffer with a publishing thread and
+//               two reading threads: every Read() that succeeds is
+//               one whole publish (no torn copies), in order
+//    tasks      CoScheduler: NextFrame / Frames / Seconds resume
+//               on the expected tick, Until returns true or times
+//               out, Wake ends a wait early, Cancel with a stale
+//               id leaves the slot's new task alone, and a full
+//               pool or oversized frame makes Start() return 0
+//    teleport   TeleportSearch on a simulated heightfield: spots
+//               are tried in preference order, walls / water /
+//               cliffs / steep banks are rejected, the cache is
+//               hit nearby and not once expired, and hung probes
+//               give up after maxFrames
+//    save       CompanionSave round trip; a shorter (older)
+//               record loads with a zero tail, a longer (newer)
+//               one is cut, a flipped byte or a cut file is
+//               Invalid and a higher version is TooNew; a saver
+//               stopped right after an Offer() writes it on its
+//               own thread before leaving its loop
+//
+//  BUILD (from the repo root, one command line):
+//      g++ -std=c++20 -O2 -ICompanionMod
+//          Tools/Tests/CompanionTests.cpp CompanionMod/CoTask.cpp
+//          CompanionMod/CompanionSave.cpp CompanionMod/GeometryKernels.cpp
+//          CompanionMod/SpatialGrid.cpp CompanionMod/TeleportSearch.cpp
+//          CompanionMod/ThreatEngine.cpp CompanionMod/FrameProfiler.cpp CompanionMod/TuningConfig.cpp
+//          CompanionMod/JobSystem.cpp CompanionMod/WorldSnapshot.cpp
+//          -pthread -o companion_tests
+//
+//  USAGE:
+//      companion_tests
+//  (writes and removes companion_tests.ini / .save in the current
+//  directory)
+//
+//  Exit code 0 = all passed, 1 = failures.
+// ============================================================
+
+#include "CoTask.h"
+#include "CompanionSave.h"
+#include "FrameProfiler.h"
+#include "GeometryKernels.h"
+#include "JobSystem.h"
+#include "SpatialGrid.h"
+#include "TeleportSearch.h"
+#include "ThreatEngine.h"
+#include "TuningConfig.h"
+#include "WorldSnapshot.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+static uint32_t g_checks = 0;
+static uint32_t g_failures = 0;
+
+#define CHECK(cond, ...)                                                \
+    do {                                                                \
+        g_checks++;                                                     \
+        if (!(cond))                                                    \
+        {                                                               \
+            g_failures++;                                               \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond); \
+            fprintf(stderr, __VA_ARGS__);                               \
+            fputc('\n', stderr);                                        \
+        }                                                               \
+    } while (0)
+
+// Small deterministic generator (xorshift32)
+struct TestRng
+{
+    uint32_t s;
+    explicit TestRng(uint32_t seed) : s(seed ? seed : 1) {}
+    uint32_t Next() { s ^= s << 13; s ^= s >> 17; s ^= s << 5; return s; }
+    float Range(float lo, float hi) { return lo + (hi - lo) * (float)(Next() & 0xFFFFFF) / (float)0x1000000; }
+};
+
+// --------------------------------------------------------
+//  geometry
+// --------------------------------------------------------
+// Same operations in the same order in every path, so results
+// must match bit for bit, not just within an epsilon.
+static void TestGeometryCount(SimdLevel level, uint32_t count, TestRng& rng)
+{
+    static const uint32_t kMax = 1100;          // > NearestK's 256-point chunks, not a multiple
+    static float x[kMax], y[kMax], z[kMax];
+    static float distRef[kMax + 1], dist[kMax + 1];
+    static uint8_t maskRef[kMax + 1], mask[kMax + 1];
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        x[i] = rng.Range(-100.0f, 100.0f);
+        y[i] = rng.Range(-100.0f, 100.0f);
+        z[i] = rng.Range(-10.0f, 10.0f);
+    }
+
+    PositionsSoA pts;
+    pts.x = x;
+    pts.y = y;
+    pts.z = z;
+    pts.count = count;
+
+    const Vec3 origin = { rng.Range(-20.0f, 20.0f), rng.Range(-20.0f, 20.0f), 0.0f };
+    const float radius = 60.0f;
+    const char* name = Geometry::SimdLevelName(level);
+
+    // Sentinel past the end: nothing may write beyond count
+    distRef[count] = dist[count] = -1.0f;
+    maskRef[count] = mask[count] = 0xAB;
+
+    Geometry::ForceSimdLevel(SimdLevel::Scalar);
+    Geometry::DistSqBatch(origin, pts, distRef);
+    uint32_t hitsRef = Geometry::RangeMask(origin, pts, radius, maskRef);
+    uint32_t idxRef[Geometry::kMaxNearestK];
+    float nearRef[Geometry::kMaxNearestK];
+    uint32_t foundRef = Geometry::NearestK(origin, pts, 5, radius, idxRef, nearRef);
+
+    Geometry::ForceSimdLevel(level);
+    Geometry::DistSqBatch(origin, pts, dist);
+    uint32_t hits = Geometry::RangeMask(origin, pts, radius, mask);
+    uint32_t idx[Geometry::kMaxNearestK];
+    float nearD[Geometry::kMaxNearestK];
+    uint32_t found = Geometry::NearestK(origin, pts, 5, radius, idx, nearD);
+
+    uint32_t badDist = 0, badMask = 0, badPair = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (memcmp(&dist[i], &distRef[i], sizeof(float)) != 0)
+            badDist++;
+        if (mask[i] != maskRef[i])
+            badMask++;
+
+        // The scalar reference itself against the single-pair helper
+        if (distRef[i] != Geometry::DistSq(origin, Vec3{ x[i], y[i], z[i] }))
+            badPair++;
+    }
+
+    CHECK(badDist == 0, "%s DistSqBatch n=%u: %u values differ from scalar", name, count, badDist);
+    CHECK(badMask == 0, "%s RangeMask n=%u: %u mask bytes differ from scalar", name, count, badMask);
+    CHECK(badPair == 0, "scalar DistSqBatch n=%u: %u values differ from DistSq", count, badPair);
+    CHECK(hits == hitsRef, "%s RangeMask n=%u: %u hits, scalar %u", name, count, hits, hitsRef);
+    CHECK(dist[count] == -1.0f && mask[count] == 0xAB, "%s n=%u: wrote past the end", name, count);
+
+    CHECK(found == foundRef, "%s NearestK n=%u: found %u, scalar %u", name, count, found, foundRef);
+    for (uint32_t k = 0; k < found && k < foundRef; ++k)
+    {
+        CHECK(idx[k] == idxRef[k] && nearD[k] == nearRef[k], "%s NearestK n=%u: #%u is %u (%g), scalar %u (%g)",
+            name, count, k, idx[k], nearD[k], idxRef[k], nearRef[k]);
+    }
+}
+
+static void TestGeometry()
+{
+    static const SimdLevel kLevels[] = { SimdLevel::Scalar, SimdLevel::SSE, SimdLevel::AVX2 };
+
+    for (SimdLevel level : kLevels)
+    {
+        // Clamped to what the CPU supports: skip levels it doesn't have
+        Geometry::ForceSimdLevel(level);
+        if (Geometry::ActiveSimdLevel() != level)
+        {
+            printf("geometry: %s not supported here, skipped\n", Geometry::SimdLevelName(level));
+            continue;
+        }
+
+        TestRng rng(1234);
+
+        // Zero, every tail length past 0/1/2 full vectors, odd
+        // sizes, and around NearestK's 256-point chunk edge
+        for (uint32_t n = 0; n <= 24; ++n)
+            TestGeometryCount(level, n, rng);
+
+        static const uint32_t kLarge[] = { 255, 256, 257, 511, 513, 1023, 1099 };
+        for (uint32_t n : kLarge)
+            TestGeometryCount(level, n, rng);
+
+        printf("geometry: %s checked\n", Geometry::SimdLevelName(level));
+    }
+
+    Geometry::ForceSimdLevel(SimdLevel::AVX2);
+}
+
+// --------------------------------------------------------
+//  threats
+// --------------------------------------------------------
+static void TestThreatTopK()
+{
+    static const uint32_t kPeds = 24;
+    static SpatialGrid grid(10.0f);
+    static ThreatEngine threats;
+
+    const Vec3 player = { 0.0f, 0.0f, 0.0f };
+    Vec3 pos[kPeds];
+    PedThreatInfo info[kPeds];
+    bool sampled[kPeds] = {};
+
+    grid.BeginRebuild();
+    for (uint32_t i = 0; i < kPeds; ++i)
+    {
+        pos[i] = { 1.5f + 1.5f * (float)i, 0.5f * (float)(i % 3), 0.0f };
+        grid.Insert((int)i + 1, EntityKind_Ped, pos[i]);
+    }
+    grid.FinishRebuild();
+
+    threats.Reset();
+    threats.SyncCandidates(grid, player, 1);
+
+    TestRng rng(99);
+    uint32_t badTicks = 0;
+
+    for (uint32_t t = 2; t < 4000; ++t)
+    {
+        // Re-sample one ped with a random mix (no damage: the
+        // score then depends on the sample and distance only)
+        uint32_t i = rng.Next() % kPeds;
+        PedThreatInfo& p = info[i];
+        p = {};
+        p.exists = true;
+        p.hostile = (rng.Next() & 1) != 0;
+        p.inCombatWithPlayer = (rng.Next() & 1) != 0;
+        p.aimingAtPlayer = (rng.Next() % 3) == 0;
+        p.weapon = (WeaponClass)(rng.Next() % 3);
+        sampled[i] = true;
+        threats.ApplySample((int)i + 1, p, t);
+
+        // Reference: every sampled ped's score, best first
+        float expected[kPeds];
+        uint32_t n = 0;
+        for (uint32_t j = 0; j < kPeds; ++j)
+        {
+            if (!sampled[j])
+                continue;
+            float score = threats.Score(info[j], Geometry::DistSq(pos[j], player), 0xFFFFFFFFu);
+            if (score < threats.config.minScore)
+                continue;
+
+            uint32_t k = n++;
+            while (k > 0 && expected[k - 1] < score)
+            {
+                expected[k] = expected[k - 1];
+                --k;
+            }
+            expected[k] = score;
+        }
+        if (n > ThreatEngine::kTopK)
+            n = ThreatEngine::kTopK;
+
+        // Ties may order handles differently; the scores may not
+        ThreatEntry top[ThreatEngine::kTopK];
+        uint32_t got = threats.TopThreats(top, ThreatEngine::kTopK);
+        bool same = got == n;
+        for (uint32_t k = 0; same && k < n; ++k)
+            same = top[k].score == expected[k];
+
+        if (!same && badTicks++ == 0)
+        {
+            fprintf(stderr, "threats: tick %u top-%u differs from a full sort (top %g, expected %g)\n",
+                t, n, got > 0 ? top[0].score : 0.0f, n > 0 ? expected[0] : 0.0f);
+        }
+    }
+
+    CHECK(badTicks == 0, "ThreatEngine top-K stale on %u of 3998 samples", badTicks);
+    printf("threats: top-K checked\n");
+}
+
+// --------------------------------------------------------
+//  profiler
+// --------------------------------------------------------
+static void TestProfilerDepth()
+{
+    static FrameProfiler prof;
+    static const uint32_t kExtra = 4;
+    static const uint32_t kNested = FrameProfiler::kMaxDepth - 1 + kExtra;   // under Frame
+    static const uint64_t kSpinNs = 200000;
+
+    ProfZone zones[kNested];
+    for (uint32_t i = 0; i < kNested; ++i)
+        zones[i] = (ProfZone)(1 + i % ((int)ProfZone::Count - 1));
+
+    prof.BeginFrame();
+    for (uint32_t i = 0; i < kNested; ++i)
+        prof.Begin(zones[i]);
+
+    // Close the dropped zones, then let the innermost recorded one
+    // run on: it must get this time, not lose it to an early pop
+    uint32_t i = kNested;
+    for (; i > FrameProfiler::kMaxDepth - 1; --i)
+        prof.End(zones[i - 1]);
+
+    uint64_t spinUntil = ProfileNowNs() + kSpinNs;
+    while (ProfileNowNs() < spinUntil) {}
+
+    for (; i > 0; --i)
+        prof.End(zones[i - 1]);
+    prof.EndFrame();
+
+    const ProfileFrame* f = prof.LastFrame();
+    CHECK(f != nullptr, "no frame recorded");
+    if (f == nullptr)
+        return;
+
+    const ProfileEvent* e = prof.Events(*f);
+    CHECK(prof.Mismatches() == 0, "%u Begin/End mismatches", prof.Mismatches());
+    CHECK(f->dropped == kExtra, "dropped %u zones, expected %u", f->dropped, kExtra);
+    CHECK(f->eventCount == FrameProfiler::kMaxDepth, "%u events, expected %u", f->eventCount, FrameProfiler::kMaxDepth);
+
+    // Each zone closes after the one nested in it
+    for (uint32_t d = 1; d < f->eventCount; ++d)
+    {
+        CHECK(e[d].depth == d && e[d].zone == (uint8_t)zones[d - 1], "event %u: depth %u zone %u", d, e[d].depth, e[d].zone);
+        CHECK(e[d - 1].startNs + e[d - 1].durNs >= e[d].startNs + e[d].durNs,
+            "event %u (depth %u) ends before the zone nested in it", d - 1, e[d - 1].depth);
+    }
+    CHECK(e[f->eventCount - 1].durNs >= kSpinNs, "innermost recorded zone got %u ns, expected >= %u",
+        e[f->eventCount - 1].durNs, (uint32_t)kSpinNs);
+
+    // The next frame starts clean
+    prof.BeginFrame();
+    prof.Begin(zones[0]);
+    prof.End(zones[0]);
+    prof.EndFrame();
+    CHECK(prof.Mismatches() == 0 && prof.LastFrame()->eventCount == 2, "frame after the deep one: %u mismatches, %u events",
+        prof.Mismatches(), prof.LastFrame()->eventCount);
+
+    printf("profiler: depth overflow checked\n");
+}
+
+// --------------------------------------------------------
+//  tuning
+// --------------------------------------------------------
+static bool WriteText(const char* path, const char* text)
+{
+    FILE* f = fopen(path, "wb");
+    if (f == nullptr)
+        return false;
+    fputs(text, f);
+    return fclose(f) == 0;
+}
+
+// Applies whatever the watcher published within `ms`
+static const TuningSnapshot* AwaitReload(TuningWatcher& watcher, uint32_t ms)
+{
+    for (uint32_t waited = 0; waited < ms; waited += 10)
+    {
+        if (const TuningSnapshot* s = watcher.Apply())
+            return s;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return nullptr;
+}
+
+static void TestTuningReload()
+{
+    static const char* kPath = "companion_tests.ini";
+    const uint32_t kTimeoutMs = TuningWatcher::kPollMs * 3;
+
+    CHECK(WriteText(kPath, "follow_refresh_ticks = 20\n"), "can't write %s", kPath);
+
+    TuningWatcher watcher;
+    watcher.Start(kPath);
+    CHECK(watcher.Current().followRefreshTicks == 20, "initial load: refresh %u", watcher.Current().followRefreshTicks);
+
+    // Same size, well inside one second of each other (and of the
+    // initial write): whole-second mtimes would miss the second one
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    WriteText(kPath, "follow_refresh_ticks = 30\n");
+    const TuningSnapshot* first = AwaitReload(watcher, kTimeoutMs);
+    CHECK(first != nullptr && first->values.followRefreshTicks == 30, "first save not picked up");
+
+    WriteText(kPath, "follow_refresh_ticks = 40\n");
+    const TuningSnapshot* second = AwaitReload(watcher, kTimeoutMs);
+    CHECK(second != nullptr && second->values.followRefreshTicks == 40, "second same-size save not picked up");
+
+    watcher.RequestStop();
+    CHECK(watcher.WaitStopped(kTimeoutMs), "watcher still in its loop %u ms after RequestStop", kTimeoutMs);
+    watcher.Stop();
+    remove(kPath);
+    printf("tuning: same-size reloads, stop checked\n");
+}
+
+// --------------------------------------------------------
+//  jobs
+// --------------------------------------------------------
+static void CountJob(Job&, const void* data)
+{
+    JobSystem::Data<std::atomic<uint32_t>*>(data)->fetch_add(1, std::memory_order_relaxed);
+}
+
+static void TestJobWakeups()
+{
+    static JobSystem jobs;
+    jobs.Start(2);
+
+    const uint32_t kRounds = 2000;
+    std::atomic<uint32_t> ran{ 0 };
+    uint32_t stuck = 0;
+
+    for (uint32_t i = 0; i < kRounds; ++i)
+    {
+        // Now and then, long enough for both workers to go to sleep
+        if (i % 8 == 0)
+            std::this_thread::sleep_for(std::chrono::microseconds(300));
+
+        std::atomic<uint32_t>* counter = &ran;
+        Job* job = jobs.Create(CountJob, counter);
+        jobs.Run(job);
+
+        // Don't help: only a worker can run it
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (!jobs.IsDone(job) && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+
+        if (!jobs.IsDone(job))
+            stuck++;
+        jobs.Wait(job);
+    }
+
+    CHECK(stuck == 0, "%u of %u jobs waited 2s for a worker (lost wake-up)", stuck, kRounds);
+    CHECK(ran.load() == kRounds, "%u of %u jobs ran", ran.load(), kRounds);
+
+    // Asleep by now; a stop has to wake them
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    jobs.RequestStop();
+    CHECK(jobs.WaitStopped(2000), "workers still in their loops 2s after RequestStop");
+    jobs.Stop();
+    printf("jobs: wake-ups, stop checked\n");
+}
+
+// --------------------------------------------------------
+//  snapshot
+// --------------------------------------------------------
+// Publish k: every field says k, so a copy mixing two publishes
+// shows up as fields that disagree
+static void FillSnapshot(WorldSnapshot& s, uint32_t k)
+{
+    s.tick = k;
+    s.playerPosition = { (float)k, -(float)k, 0.5f * (float)k };
+    s.nearbyTick = k;
+    s.nearbyCount = k % 769;
+    s.companionCount = k % (WorldSnapshot::kMaxCompanions + 1);
+    for (uint32_t i = 0; i < WorldSnapshot::kMaxCompanions; ++i)
+    {
+        s.companions[i].position = { (float)i, (float)k, 0.0f };
+        s.companions[i].positionTick = k;
+        s.companions[i].vehicle = (int)(k * 10u + i);
+    }
+    s.seats.vehicle = (int)k;
+    s.seats.checkedTick = k;
+}
+
+static bool SnapshotConsistent(const WorldSnapshot& s)
+{
+    const uint32_t k = s.tick;
+    if (s.sequence != k || s.nearbyTick != k || s.nearbyCount != k % 769 || s.companionCount != k % (WorldSnapshot::kMaxCompanions + 1))
+        return false;
+    if (s.seats.vehicle != (int)k || s.seats.checkedTick != k)
+        return false;
+    if (s.playerPosition.x != (float)k || s.playerPosition.y != -(float)k || s.playerPosition.z != 0.5f * (float)k)
+        return false;
+    for (uint32_t i = 0; i < WorldSnapshot::kMaxCompanions; ++i)
+    {
+        const SnapshotCompanion& c = s.companions[i];
+        if (c.position.y != (float)k || c.positionTick != k || c.vehicle != (int)(k * 10u + i))
+            return false;
+    }
+    return true;
+}
+
+static void TestSnapshotSeqlock()
+{
+    static WorldSnapshotBuffer buffer;
+    const uint32_t kPublishes = 100000;
+    const uint32_t kReaders = 2;
+
+    std::atomic<bool> done{ false };
+    std::atomic<uint32_t> torn{ 0 }, backwards{ 0 }, succeeded{ 0 };
+
+    auto reader = [&]()
+    {
+        WorldSnapshot* s = new WorldSnapshot();
+        uint32_t last = 0;
+        while (!done.load(std::memory_order_acquire))
+        {
+            if (!buffer.Read(*s))
+                continue;
+
+            succeeded.fetch_add(1, std::memory_order_relaxed);
+            if (!SnapshotConsistent(*s))
+                torn.fetch_add(1, std::memory_order_relaxed);
+            else if (s->tick < last)
+                backwards.fetch_add(1, std::memory_order_relaxed);
+            else
+                last = s->tick;
+        }
+        delete s;
+    };
+
+    std::thread readers[kReaders];
+    for (std::thread& t : readers)
+        t = std::thread(reader);
+
+    // Publishing from another thread than main() too: the buffer
+    // only needs a single writer, not a particular one
+    std::thread writer([&]()
+    {
+        for (uint32_t k = 1; k <= kPublishes; ++k)
+        {
+            FillSnapshot(buffer.BeginWrite(), k);
+            buffer.Publish();
+            if (k % 64 == 0)
+                std::this_thread::yield();      // let readers in mid-stream on one core
+        }
+    });
+
+    writer.join();
+    done.store(true, std::memory_order_release);
+    for (std::thread& t : readers)
+        t.join();
+
+    WorldSnapshotStats stats = buffer.Stats();
+    CHECK(torn.load() == 0, "%u of %u reads mixed two publishes", torn.load(), succeeded.load());
+    CHECK(backwards.load() == 0, "%u reads went back in time", backwards.load());
+    CHECK(succeeded.load() > 0, "no read succeeded (%llu failed)", (unsigned long long)stats.failures);
+    CHECK(buffer.Latest().tick == kPublishes, "latest is publish %u, expected %u", buffer.Latest().tick, kPublishes);
+
+    printf("snapshot: %u reads (%llu retried, %llu gave up) checked\n", succeeded.load(),
+        (unsigned long long)stats.retries, (unsigned long long)stats.failures);
+}
+
+// --------------------------------------------------------
+//  tasks
+// --------------------------------------------------------
+// Tick k is at k * 0.25 s (exact in binary, so Seconds() lands on
+// a known tick)
+static void TaskFrame(CoScheduler& tasks, uint32_t tick)
+{
+    tasks.BeginFrame(tick, tick * 0.25);
+    tasks.Tick();
+}
+
+struct TaskProbe
+{
+    uint32_t step = 0;
+    uint32_t stepTick[4] = {};
+    bool result[4] = {};
+    bool ready = false;          // for Until()
+    uint32_t destroyed = 0;      // locals' destructors, on finish or Cancel()
+};
+
+struct TaskLocal
+{
+    TaskProbe* probe;
+    ~TaskLocal() { probe->destroyed++; }
+};
+
+static bool TaskReady(void* user)
+{
+    return static_cast<TaskProbe*>(user)->ready;
+}
+
+static void Mark(TaskProbe* p, const CoScheduler& tasks, bool result)
+{
+    p->stepTick[p->step] = tasks.CurrentTick();
+    p->result[p->step] = result;
+    p->step++;
+}
+
+static CoTask WaitChain(TaskProbe* p, const CoScheduler* tasks)
+{
+    TaskLocal local{ p };
+    Mark(p, *tasks, co_await NextFrame());
+    Mark(p, *tasks, co_await Frames(3));
+    Mark(p, *tasks, co_await Seconds(1.0));
+}
+
+static CoTask WaitUntil(TaskProbe* p, const CoScheduler* tasks, double timeout)
+{
+    TaskLocal local{ p };
+    Mark(p, *tasks, co_await Until(TaskReady, p, timeout));
+}
+
+static CoTask WaitLong(TaskProbe* p, const CoScheduler* tasks)
+{
+    TaskLocal local{ p };
+    Mark(p, *tasks, co_await Seconds(1000.0));
+}
+
+// A local that lives across the co_await lands in the frame
+static CoTask BigFrame(TaskProbe* p)
+{
+    volatile char big[CoScheduler::kBlockBytes + 64];
+    big[0] = 1;
+    co_await NextFrame();
+    p->step = big[0];
+}
+
+static void TestTasks()
+{
+    CoScheduler tasks;
+    TaskProbe chain, until, timeout, woken;
+
+    // NextFrame / Frames / Seconds: start at tick 0, t = 0
+    tasks.BeginFrame(0, 0.0);
+    CoTaskId chainId = tasks.Start(WaitChain(&chain, &tasks));
+    CHECK(chainId != 0 && chain.step == 0, "chain didn't start and park (id %u, step %u)", chainId, chain.step);
+
+    for (uint32_t tick = 1; tick <= 12; ++tick)
+        TaskFrame(tasks, tick);
+
+    CHECK(chain.step == 3, "chain reached step %u of 3", chain.step);
+    CHECK(chain.stepTick[0] == 1, "NextFrame resumed at tick %u, expected 1", chain.stepTick[0]);
+    CHECK(chain.stepTick[1] == 4, "Frames(3) resumed at tick %u, expected 4", chain.stepTick[1]);
+    CHECK(chain.stepTick[2] == 8, "Seconds(1.0) resumed at tick %u, expected 8", chain.stepTick[2]);
+    CHECK(chain.result[0] && chain.result[1] && chain.result[2], "a plain wait returned false");
+    CHECK(!tasks.IsRunning(chainId) && chain.destroyed == 1, "finished chain still running or leaked its locals");
+
+    // Until: true when the predicate holds, false at the timeout
+    tasks.BeginFrame(20, 5.0);
+    CoTaskId untilId = tasks.Start(WaitUntil(&until, &tasks, 10.0));
+    tasks.Start(WaitUntil(&timeout, &tasks, 1.0));
+    for (uint32_t tick = 21; tick <= 30; ++tick)
+    {
+        if (tick == 22)
+            until.ready = true;
+        TaskFrame(tasks, tick);
+    }
+    CHECK(until.step == 1 && until.result[0] && until.stepTick[0] == 22,
+        "Until: step %u result %d at tick %u, expected true at 22", until.step, (int)until.result[0], until.stepTick[0]);
+    CHECK(timeout.step == 1 && !timeout.result[0] && timeout.stepTick[0] == 24,
+        "Until timeout: step %u result %d at tick %u, expected false at 24", timeout.step, (int)timeout.result[0], timeout.stepTick[0]);
+
+    // Wake: a long wait ends on the next Tick, returning false
+    CoTaskId wokenId = tasks.Start(WaitLong(&woken, &tasks));
+    TaskFrame(tasks, 31);
+    tasks.Wake(wokenId);
+    CHECK(woken.step == 0, "woken task resumed before Tick");
+    TaskFrame(tasks, 32);
+    CHECK(woken.step == 1 && !woken.result[0], "Wake: step %u result %d, expected false", woken.step, (int)woken.result[0]);
+
+    // Cancel with a stale id: the slot has a new task by now
+    TaskProbe reused;
+    CoTaskId reusedId = tasks.Start(WaitLong(&reused, &tasks));
+    CHECK(reusedId != untilId && reusedId != wokenId, "reused slot got a stale id %u", reusedId);
+    uint32_t cancelledBefore = tasks.Stats().cancelled;
+    tasks.Cancel(untilId);
+    tasks.Cancel(wokenId);
+    CHECK(tasks.IsRunning(reusedId) && tasks.Stats().cancelled == cancelledBefore,
+        "a stale id cancelled the slot's new task");
+    tasks.Cancel(reusedId);
+    CHECK(!tasks.IsRunning(reusedId) && reused.destroyed == 1 && reused.step == 0,
+        "Cancel didn't destroy the task's locals (destroyed %u)", reused.destroyed);
+
+    // Full pool: the coroutine call itself comes back empty
+    // (get_return_object_on_allocation_failure), Start() says 0
+    CHECK(tasks.Stats().poolBlocksUsed == 0, "%u pool blocks still used", tasks.Stats().poolBlocksUsed);
+    {
+        TaskProbe held;
+        CoTask frames[CoScheduler::kPoolBlocks];
+        for (CoTask& f : frames)
+            f = WaitLong(&held, &tasks);
+        for (const CoTask& f : frames)
+            CHECK(f.Valid(), "pool ran out before kPoolBlocks frames");
+
+        uint32_t failuresBefore = tasks.Stats().startFailures;
+        CoTask extra = WaitLong(&held, &tasks);
+        CHECK(!extra.Valid(), "got a frame from a full pool");
+        CHECK(tasks.Start(std::move(extra)) == 0 && tasks.Stats().startFailures == failuresBefore + 1,
+            "Start() of an empty task didn't fail");
+    }
+    CHECK(tasks.Stats().poolBlocksUsed == 0, "never-started tasks kept %u blocks", tasks.Stats().poolBlocksUsed);
+
+    // A frame bigger than a block fails the same way
+    TaskProbe big;
+    CoTask tooBig = BigFrame(&big);
+    CHECK(!tooBig.Valid(), "a %u-byte frame fit a %u-byte block", tasks.Stats().largestFrame, CoScheduler::kBlockBytes);
+    CHECK(tasks.Start(std::move(tooBig)) == 0, "Start() of an oversized task didn't fail");
+
+    printf("tasks: waits, wake, stale cancel, full pool checked\n");
+}
+
+// --------------------------------------------------------
+//  teleport
+// --------------------------------------------------------
+// Flat ground at z = 0 with one feature of each kind placed where
+// a test wants it. The player stands at the origin facing +y, so
+// the preferred spots (behind) are at -y.
+struct TestField
+{
+    struct Box
+    {
+        float x0 = 0.0f, y0 = 0.0f, x1 = 0.0f, y1 = 0.0f;
+        bool on = false;
+
+        bool Contains(float x, float y, float pad = 0.0f) const
+        {
+            return on && x > x0 - pad && x < x1 + pad && y > y0 - pad && y < y1 + pad;
+        }
+    };
+
+    Box wall;                    // solid, full height: blocks probes
+    Box lake;                    // bed at -3, surface at 0
+    Box cliff;                   // ground raised by cliffHeight
+    float cliffHeight = 6.0f;
+    bool probesHang = false;     // probes never answer
+
+    struct Probe
+    {
+        Vec3 from, to;
+        float radius;
+        uint32_t startStep;
+        bool used;
+    };
+    Probe probes[32] = {};
+    uint32_t step = 0;           // Step() being run
+    uint32_t groundCalls = 0;
+    uint32_t starts = 0;
+    Vec3 started[64] = {};       // probe targets, in start order
+
+    float GroundZ(float x, float y) const
+    {
+        if (lake.Contains(x, y))
+            return -3.0f;
+        return cliff.Contains(x, y) ? cliffHeight : 0.0f;
+    }
+
+    bool Blocked(const Vec3& from, const Vec3& to, float radius) const
+    {
+        for (uint32_t i = 0; i <= 100; ++i)
+        {
+            float t = (float)i / 100.0f;
+            if (wall.Contains(from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t, radius))
+                return true;
+        }
+        return false;
+    }
+
+    static GroundSample Ground(void* user, float x, float y, float zTop)
+    {
+        TestField& f = *static_cast<TestField*>(user);
+        f.groundCalls++;
+
+        GroundSample g;
+        g.groundZ = f.GroundZ(x, y);
+        g.found = g.groundZ <= zTop;
+        g.water = f.lake.Contains(x, y);
+        g.waterZ = 0.0f;
+        return g;
+    }
+
+    static int Start(void* user, const Vec3& from, const Vec3& to, float radius)
+    {
+        TestField& f = *static_cast<TestField*>(user);
+        if (f.starts < 64)
+            f.started[f.starts] = to;
+        f.starts++;
+
+        for (uint32_t i = 0; i < 32; ++i)
+        {
+            if (f.probes[i].used)
+                continue;
+            f.probes[i] = { from, to, radius, f.step, true };
+            return (int)i + 1;
+        }
+        return 0;
+    }
+
+    // Answers from the Step after the one that started it
+    static ProbeStatus Poll(void* user, int handle)
+    {
+        TestField& f = *static_cast<TestField*>(user);
+        if (handle <= 0 || handle > 32 || !f.probes[handle - 1].used)
+            return ProbeStatus::Failed;
+
+        Probe& p = f.probes[handle - 1];
+        if (f.probesHang || f.step <= p.startStep)
+            return ProbeStatus::Pending;
+
+        p.used = false;
+        return f.Blocked(p.from, p.to, p.radius) ? ProbeStatus::Blocked : ProbeStatus::Clear;
+    }
+};
+
+static const Vec3 kTeleportPlayer = { 0.0f, 0.0f, 1.0f };   // feet on the ground
+
+static TeleportSearchStatus RunTeleport(TeleportSearch& search, TestField& field, const Vec3& player, double now)
+{
+    TeleportProbes probes;
+    probes.ground = TestField::Ground;
+    probes.startProbe = TestField::Start;
+    probes.pollProbe = TestField::Poll;
+    probes.user = &field;
+
+    TeleportSearchStatus status = search.Begin(player, 0.0f, 1.0f, now);
+    for (uint32_t i = 0; status == TeleportSearchStatus::Running && i < 100; ++i)
+    {
+        field.step++;
+        status = search.Step(probes, now);
+    }
+    return status;
+}
+
+// The search's preference score, recomputed (player at the origin facing +y)
+static float TeleportPreference(const TeleportSearchConfig& cfg, const Vec3& spot)
+{
+    float dist = sqrtf(spot.x * spot.x + spot.y * spot.y);
+    return fabsf(dist - cfg.preferredRadius) * cfg.radiusWeight + (1.0f + spot.y / dist) * cfg.frontWeight;
+}
+
+static void TestTeleportSearch()
+{
+    const double now = 100.0;
+
+    // Open ground: spots are tried best first and the best one wins
+    {
+        TeleportSearch search;
+        TestField field;
+        TeleportSearchStatus status = RunTeleport(search, field, kTeleportPlayer, now);
+        const Vec3& p = search.Position();
+
+        CHECK(status == TeleportSearchStatus::Found, "open ground: %s", TeleportSearchStatusName(status));
+        CHECK(fabsf(p.x) < 0.01f && fabsf(p.y + 2.0f) < 0.01f && fabsf(p.z - 1.0f) < 0.01f,
+            "open ground: picked (%.2f, %.2f, %.2f), expected right behind at (0, -2, 1)", p.x, p.y, p.z);
+        CHECK(field.starts == search.config.enoughAccepted, "open ground: %u probes for %u spots", field.starts, search.config.enoughAccepted);
+
+        // Cache: a second recall nearby, soon after, costs nothing
+        uint32_t groundCalls = field.groundCalls, starts = field.starts;
+        status = RunTeleport(search, field, Vec3{ 0.3f, 0.2f, 1.0f }, now + 10.0);
+        CHECK(status == TeleportSearchStatus::FoundCached, "cache: %s, expected FoundCached", TeleportSearchStatusName(status));
+        CHECK(field.groundCalls == groundCalls && field.starts == starts, "cache hit still called the probes");
+
+        // ...but not after it expired, from higher up, or elsewhere
+        status = RunTeleport(search, field, kTeleportPlayer, now + search.config.cacheMaxAgeSeconds + 1.0);
+        CHECK(status == TeleportSearchStatus::Found, "cache expiry: %s, expected a fresh Found", TeleportSearchStatusName(status));
+        CHECK(RunTeleport(search, field, Vec3{ 0.0f, 0.0f, 7.0f }, now + 40.0) != TeleportSearchStatus::FoundCached,
+            "cache: a spot 6 m below the player was reused");
+        CHECK(RunTeleport(search, field, Vec3{ 50.0f, 0.0f, 1.0f }, now + 40.0) != TeleportSearchStatus::FoundCached,
+            "cache: a spot 50 m away was reused");
+    }
+
+    // Every spot passes here, so the probes go out in the order
+    // the candidates were sorted in: wanting half of them shows it
+    {
+        TeleportSearch search;
+        TestField field;
+        search.config.enoughAccepted = TeleportSearch::kCandidates / 2;
+        RunTeleport(search, field, kTeleportPlayer, now);
+
+        CHECK(field.starts == search.config.enoughAccepted, "order: %u probes, expected %u", field.starts, search.config.enoughAccepted);
+        for (uint32_t i = 1; i < field.starts && i < 64; ++i)
+        {
+            CHECK(TeleportPreference(search.config, field.started[i - 1]) <= TeleportPreference(search.config, field.started[i]) + 1e-4f,
+                "order: probe %u went to a worse spot than probe %u", i - 1, i);
+        }
+    }
+
+    // A wall across the back: nothing behind it, and the probes said so
+    {
+        TeleportSearch search;
+        TestField field;
+        field.wall = { -10.0f, -1.2f, 10.0f, -0.8f, true };
+        TeleportSearchStatus status = RunTeleport(search, field, kTeleportPlayer, now);
+        const Vec3& p = search.Position();
+
+        CHECK(status == TeleportSearchStatus::Found, "wall: %s", TeleportSearchStatusName(status));
+        CHECK(p.y > -0.8f && !field.Blocked(kTeleportPlayer, p, search.config.probeRadius),
+            "wall: picked (%.2f, %.2f) behind the wall", p.x, p.y);
+        CHECK(search.Stats().rejected[(int)TeleportReject::Blocked] > 0, "wall: no probe was blocked");
+    }
+
+    // Water behind the player: rejected on the ground check, never probed
+    {
+        TeleportSearch search;
+        TestField field;
+        field.lake = { -100.0f, -100.0f, 100.0f, -1.0f, true };
+        TeleportSearchStatus status = RunTeleport(search, field, kTeleportPlayer, now);
+
+        CHECK(status == TeleportSearchStatus::Found && !field.lake.Contains(search.Position().x, search.Position().y),
+            "water: %s at (%.2f, %.2f)", TeleportSearchStatusName(status), search.Position().x, search.Position().y);
+        CHECK(search.Stats().rejected[(int)TeleportReject::Water] > 0, "water: nothing rejected as water");
+        for (uint32_t i = 0; i < field.starts && i < 64; ++i)
+            CHECK(!field.lake.Contains(field.started[i].x, field.started[i].y), "water: probed a spot in the lake");
+    }
+
+    // A cliff behind (its top is above where the ground check
+    // starts: no ground), then a bank (low enough, too steep)
+    const float heights[2] = { 6.0f, 2.0f };
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        TeleportSearch search;
+        TestField field;
+        field.cliff = { -100.0f, -100.0f, 100.0f, -1.0f, true };
+        field.cliffHeight = heights[i];
+        TeleportSearchStatus status = RunTeleport(search, field, kTeleportPlayer, now);
+        const Vec3& p = search.Position();
+        const uint32_t* rejected = search.Stats().rejected;
+
+        CHECK(status == TeleportSearchStatus::Found && !field.cliff.Contains(p.x, p.y) && fabsf(p.z - 1.0f) < 0.01f,
+            "cliff %.0f m: %s at (%.2f, %.2f, %.2f)", heights[i], TeleportSearchStatusName(status), p.x, p.y, p.z);
+        if (i == 0)
+            CHECK(rejected[(int)TeleportReject::NoGround] + rejected[(int)TeleportReject::Height] > 0, "cliff: nothing rejected as out of reach");
+        else
+            CHECK(rejected[(int)TeleportReject::Steep] > 0, "bank: nothing rejected as too steep");
+    }
+
+    // Probes that never answer: give up after exactly maxFrames
+    {
+        TeleportSearch search;
+        TestField field;
+        field.probesHang = true;
+        TeleportSearchStatus status = RunTeleport(search, field, kTeleportPlayer, now);
+
+        CHECK(status == TeleportSearchStatus::Failed, "hung probes: %s, expected Failed", TeleportSearchStatusName(status));
+        CHECK(search.Frames() == search.config.maxFrames, "hung probes: gave up after %u frames, expected %u",
+            search.Frames(), search.config.maxFrames);
+        CHECK(search.CacheCount() == 0, "hung probes: %u unchecked spots cached", search.CacheCount());
+    }
+
+    printf("teleport: preference, wall / water / cliff, cache, give-up checked\n");
+}
+
+// --------------------------------------------------------
+//  save
+// --------------------------------------------------------
+// Writes a save file by hand: header + `size` record bytes
+static void WriteRawSave(const char* path, const CompanionSaveHeader& h, const void* record, uint32_t size)
+{
+    FILE* f = fopen(path, "wb");
+    if (f == nullptr)
+        return;
+    fwrite(&h, sizeof(h), 1, f);
+    fwrite(record, size, 1, f);
+    fclose(f);
+}
+
+static void TestSaveFormat()
+{
+    const char* kPath = "companion_tests.save";
+    remove(kPath);
+
+    CompanionSaveRecord rec{};
+    rec.mode = 2;
+    rec.flags = SaveFlag_Spawned | SaveFlag_Stay | SaveFlag_HasAnchor;
+    rec.activity = 3;
+    rec.stayAnchor[0] = 12.5f;
+    rec.stayAnchor[1] = -40.25f;
+    rec.stayAnchor[2] = 31.0f;
+    rec.rideSeat = 1;
+    rec.reserved[2] = 0xA5A5A5A5u;
+
+    CompanionSaveRecord out;
+    CHECK(CompanionSave::Load(kPath, out) == SaveLoadResult::Missing, "no file didn't load as Missing");
+
+    // Round trip
+    CHECK(CompanionSave::Write(kPath, rec), "Write failed");
+    SaveLoadResult r = CompanionSave::Load(kPath, out);
+    CHECK(r == SaveLoadResult::Loaded && memcmp(&out, &rec, sizeof(rec)) == 0, "round trip: %s, record differs", SaveLoadResultName(r));
+
+    // An older writer's shorter record: its fields load, the rest reads 0
+    const uint16_t kOldSize = 16;               // up to and including stayAnchor
+    CompanionSaveHeader h{};
+    h.magic = kSaveMagic;
+    h.version = kSaveVersion;
+    h.recordSize = kOldSize;
+    h.checksum = CompanionSave::Checksum(&rec, kOldSize);
+    WriteRawSave(kPath, h, &rec, kOldSize);
+
+    r = CompanionSave::Load(kPath, out);
+    CHECK(r == SaveLoadResult::Loaded, "older record: %s", SaveLoadResultName(r));
+    CHECK(memcmp(&out, &rec, kOldSize) == 0 && out.rideSeat == 0 && out.reserved[2] == 0,
+        "older record: fields wrong or the missing tail isn't zero (seat %d)", (int)out.rideSeat);
+
+    // A newer writer's longer record: cut to what we know
+    unsigned char longer[sizeof(rec) + 8];
+    memcpy(longer, &rec, sizeof(rec));
+    memset(longer + sizeof(rec), 0x7F, 8);
+    h.recordSize = (uint16_t)sizeof(longer);
+    h.checksum = CompanionSave::Checksum(longer, sizeof(longer));
+    WriteRawSave(kPath, h, longer, sizeof(longer));
+    r = CompanionSave::Load(kPath, out);
+    CHECK(r == SaveLoadResult::Loaded && memcmp(&out, &rec, sizeof(rec)) == 0, "newer record: %s, record differs", SaveLoadResultName(r));
+
+    // Damaged: one byte flipped, or the file cut short
+    unsigned char damaged[sizeof(rec)];
+    memcpy(damaged, &rec, sizeof(rec));
+    damaged[5] ^= 0x10;
+    h.recordSize = (uint16_t)sizeof(rec);
+    h.checksum = CompanionSave::Checksum(&rec, sizeof(rec));
+    WriteRawSave(kPath, h, damaged, sizeof(damaged));
+    r = CompanionSave::Load(kPath, out);
+    CHECK(r == SaveLoadResult::Invalid, "flipped byte: %s, expected Invalid", SaveLoadResultName(r));
+
+    WriteRawSave(kPath, h, &rec, sizeof(rec) - 4);
+    r = CompanionSave::Load(kPath, out);
+    CHECK(r == SaveLoadResult::Invalid, "truncated: %s, expected Invalid", SaveLoadResultName(r));
+
+    // A version this build doesn't know
+    h.version = kSaveVersion + 1;
+    WriteRawSave(kPath, h, &rec, sizeof(rec));
+    r = CompanionSave::Load(kPath, out);
+    CHECK(r == SaveLoadResult::TooNew, "next version: %s, expected TooNew", SaveLoadResultName(r));
+
+    // Written over a damaged file: loads again, no .tmp left behind
+    CHECK(CompanionSave::Write(kPath, rec), "Write over a bad file failed");
+    CHECK(CompanionSave::Load(kPath, out) == SaveLoadResult::Loaded, "rewritten save didn't load");
+    FILE* tmp = fopen("companion_tests.save.tmp", "rb");
+    CHECK(tmp == nullptr, "the .tmp file was left behind");
+    if (tmp != nullptr)
+        fclose(tmp);
+
+    // Stopped mid-settle: the saver writes the offer itself, without
+    // anyone joining it (DllMain on FreeLibrary)
+    remove(kPath);
+    CompanionSaver saver;
+    saver.Start(kPath);
+    rec.activity = 4;
+    saver.Offer(rec);
+    saver.RequestStop();
+    CHECK(saver.WaitStopped(2000), "saver still in its loop 2s after RequestStop");
+    r = CompanionSave::Load(kPath, out);
+    CHECK(r == SaveLoadResult::Loaded && out.activity == 4 && saver.Writes() == 1,
+        "stopped saver: %s, activity %d, %u writes", SaveLoadResultName(r), (int)out.activity, saver.Writes());
+    saver.Stop();
+
+    remove(kPath);
+    printf("save: round trip, old / new records, damage, version, stop checked\n");
+}
+
+int main()
+{
+    TestGeometry();
+    TestThreatTopK();
+    TestProfilerDepth();
+    TestTuningReload();
+    TestJobWakeups();
+    TestSnapshotSeqlock();
+    TestTasks();
+    TestTeleportSearch();
+    TestSaveFormat();
+
+    printf("%u checks, %u failed\n", g_checks, g_failures);
+    return g_failures == 0 ? 0 : 1;
+}
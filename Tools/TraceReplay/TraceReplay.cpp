@@ -0,0 +1,63 @@
+// ============================================================
+//  TraceReplay.cpp — Headless replay of a CompanionMod.trace
+// ============================================================
+//
+//  PURPOSE:
+//  Re-runs the companion decision logic (CompanionCore, the
+//  lifecycle FSM, the event bus, the vehicle ride phases) over
+//  a trace recorded in game (trace_recording = 1 in the ini)
+//  and reports every tick where the commands differ from what
+//  the game build emitted. No GTA, no ScriptHookV — it builds
+//  and runs on Linux or Windows as a plain console program.
+//
+//  BUILD (from the repo root):
+//      g++ -std=c++17 -O2 -ICompanionMod
+//          Tools/TraceReplay/TraceReplay.cpp
+//          CompanionMod/TickTrace.cpp CompanionMod/EventBus.cpp
+//          CompanionMod/VehicleRide.cpp -o trace_replay
+//  (one command line)
+//
+//  USAGE:
+//      trace_replay CompanionMod.trace [maxDiffLines]
+//
+//  Exit code 0 = identical to the recording, 1 = mismatches,
+//  2 = couldn't read the trace.
+// ============================================================
+
+#include "TickTrace.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <trace> [maxDiffLines]\n", argv[0]);
+        return 2;
+    }
+
+    uint32_t maxDiffLines = (argc >= 3) ? (uint32_t)strtoul(argv[2], nullptr, 10) : 50;
+
+    TickTraceReader reader;
+    if (!reader.Open(argv[1]))
+    {
+        fprintf(stderr, "cannot read trace '%s' (missing, not a trace, or newer version)\n", argv[1]);
+        return 2;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    ReplayReport report = ReplayTrace(reader, stdout, maxDiffLines);
+    auto t1 = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+    double gameSeconds = report.ticks / 60.0;
+
+    printf("ticks=%u (%.1f min of play) mismatched=%u", report.ticks, gameSeconds / 60.0, report.mismatchedTicks);
+    if (report.mismatchedTicks > 0)
+        printf(" first=%u", report.firstMismatchTick);
+    printf(" replay=%.3fs (%.0fx real time)\n", seconds, seconds > 0.0 ? gameSeconds / seconds : 0.0);
+    printf("ride steps=%u desyncs=%u\n", report.rideSteps, report.rideEvictions);
+
+    return report.mismatchedTicks == 0 ? 0 : 1;
+}